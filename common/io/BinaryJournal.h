@@ -0,0 +1,352 @@
+#ifndef MIDAS_BINARY_JOURNAL_H
+#define MIDAS_BINARY_JOURNAL_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include "Journal.h"
+
+using namespace std;
+
+namespace midas {
+
+constexpr uint32_t BinaryJournalSchemaVersion = 1;
+constexpr uint32_t BinaryJournalPageSize = 4096;
+constexpr char BinaryJournalMagic[8] = {'M', 'I', 'D', 'A', 'S', 'J', 'N', 'L'};
+
+/**
+ * fixed size record stored in binary journal, payload is copied as it is
+ */
+template <typename T>
+struct JournalRecord {
+    uint64_t rcvt;
+    int64_t id;
+    T data;
+};
+
+/**
+ * first page of each segment file, followed by rcvt index, followed by records
+ * | header | index (one rcvt every indexInterval records) | padding to page | records ... |
+ */
+struct BinaryJournalHeader {
+    char magic[8];
+    uint32_t schemaVersion;
+    uint32_t headerSize;  // offset of first record in bytes
+    uint32_t recordSize;
+    uint32_t payloadSize;
+    uint32_t indexInterval;
+    uint32_t indexOffset;
+    uint64_t capacity;  // max records
+    int64_t birth;      // seconds since epoch
+    uint64_t firstRcvt;
+    std::atomic<uint64_t> lastRcvt;
+    std::atomic<uint64_t> count;  // committed records, writer releases it after record copied
+};
+
+static_assert(sizeof(BinaryJournalHeader) <= BinaryJournalPageSize, "journal header must fit in one page");
+
+inline uint64_t round_up_journal_page(uint64_t x) {
+    return (x + BinaryJournalPageSize - 1) & ~static_cast<uint64_t>(BinaryJournalPageSize - 1);
+}
+
+/**
+ * one mmap'd segment file which can hold up to capacity records
+ * single writer, append only, record copy is the only work on hot path
+ */
+template <typename T>
+class BinaryJournalSegment {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "binary journal payload must be POD");
+    typedef JournalRecord<T> TRecord;
+
+    string path;
+    int fd{-1};
+    uint8_t* address{nullptr};
+    uint64_t mapSize{0};
+    BinaryJournalHeader* header{nullptr};
+    uint64_t* index{nullptr};
+    TRecord* records{nullptr};
+
+public:
+    BinaryJournalSegment(const string& path_, uint64_t capacity, uint32_t indexInterval, ostream& err) : path(path_) {
+        uint64_t indexEntries = capacity / indexInterval + 1;
+        uint64_t headerSize = round_up_journal_page(BinaryJournalPageSize + indexEntries * sizeof(uint64_t));
+        mapSize = headerSize + capacity * sizeof(TRecord);
+
+        fd = open(path.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+        if (fd < 0) {
+            err << "open() failed " << path << " " << strerror(errno) << '\n';
+            return;
+        }
+        if (ftruncate(fd, mapSize) < 0) {
+            err << "ftruncate() failed " << path << " " << strerror(errno) << '\n';
+            shutdown();
+            return;
+        }
+        // reserve blocks up front, so append neither allocates them nor hits full disk, not every file system can
+        if (fallocate(fd, 0, 0, mapSize) < 0 && errno != EOPNOTSUPP) {
+            err << "fallocate() failed " << path << " " << strerror(errno) << '\n';
+            shutdown();
+            return;
+        }
+        void* addr = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            err << "mmap() failed " << path << " " << strerror(errno) << '\n';
+            shutdown();
+            return;
+        }
+        address = static_cast<uint8_t*>(addr);
+
+        header = new (address) BinaryJournalHeader;
+        memcpy(header->magic, BinaryJournalMagic, sizeof(header->magic));
+        header->schemaVersion = BinaryJournalSchemaVersion;
+        header->headerSize = static_cast<uint32_t>(headerSize);
+        header->recordSize = sizeof(TRecord);
+        header->payloadSize = sizeof(T);
+        header->indexInterval = indexInterval;
+        header->indexOffset = BinaryJournalPageSize;
+        header->capacity = capacity;
+        header->birth = time(nullptr);
+        header->firstRcvt = 0;
+        header->lastRcvt.store(0, std::memory_order_relaxed);
+        header->count.store(0, std::memory_order_release);
+
+        index = reinterpret_cast<uint64_t*>(address + header->indexOffset);
+        records = reinterpret_cast<TRecord*>(address + headerSize);
+    }
+
+    ~BinaryJournalSegment() { shutdown(); }
+
+    BinaryJournalSegment(const BinaryJournalSegment&) = delete;
+    BinaryJournalSegment& operator=(const BinaryJournalSegment&) = delete;
+
+    bool bad() const { return header == nullptr; }
+
+    bool full() const { return count() >= header->capacity; }
+
+    uint64_t count() const { return header->count.load(std::memory_order_relaxed); }
+
+    uint64_t bytes() const { return header->headerSize + count() * sizeof(TRecord); }
+
+    int64_t birth() const { return header->birth; }
+
+    /**
+     * segment may be prepared long before it is used
+     */
+    void rebirth() { header->birth = time(nullptr); }
+
+    /**
+     * read every page in so that append on hot path takes at most a minor fault, done by thread preparing segment
+     * pages are only read, writing them would dirty whole file and kernel would flush all of it
+     */
+    void prefault() {
+        if (bad()) return;
+        madvise(address, mapSize, MADV_WILLNEED);
+        volatile const uint8_t* p = address;
+        for (uint64_t offset = 0; offset < mapSize; offset += BinaryJournalPageSize) (void)p[offset];
+    }
+
+    /**
+     * caller makes sure segment is not full
+     */
+    void append(const T& data, uint64_t rcvt, int64_t id) {
+        uint64_t n = header->count.load(std::memory_order_relaxed);
+        TRecord& record = records[n];
+        record.rcvt = rcvt;
+        record.id = id;
+        memcpy(&record.data, &data, sizeof(T));
+
+        if (n % header->indexInterval == 0) index[n / header->indexInterval] = rcvt;
+        if (n == 0) header->firstRcvt = rcvt;
+        header->lastRcvt.store(rcvt, std::memory_order_relaxed);
+        header->count.store(n + 1, std::memory_order_release);
+    }
+
+    /**
+     * unmap and truncate file to real size, after that only path is valid
+     */
+    void close_segment() {
+        uint64_t realSize = bad() ? 0 : bytes();
+        if (address) {
+            munmap(address, mapSize);
+            address = nullptr;
+            header = nullptr;
+        }
+        if (fd >= 0) {
+            if (realSize && ftruncate(fd, realSize) < 0) {
+                cerr << "ftruncate() failed " << path << " " << strerror(errno) << '\n';
+            }
+            close(fd);
+            fd = -1;
+        }
+    }
+
+private:
+    void shutdown() {
+        if (address) munmap(address, mapSize);
+        if (fd >= 0) close(fd);
+        address = nullptr;
+        header = nullptr;
+        fd = -1;
+    }
+};
+
+/**
+ * read only view of a segment file, file can still be written by journal process
+ */
+template <typename T>
+class BinaryJournalReader {
+public:
+    typedef JournalRecord<T> TRecord;
+
+    string path;
+    int fd{-1};
+    const uint8_t* address{nullptr};
+    uint64_t mapSize{0};
+    const BinaryJournalHeader* header{nullptr};
+    const uint64_t* index{nullptr};
+    const TRecord* records{nullptr};
+
+public:
+    BinaryJournalReader(const string& path_, ostream& err) : path(path_) {
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            err << "open() failed " << path << " " << strerror(errno) << '\n';
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) < 0 || static_cast<uint64_t>(st.st_size) < BinaryJournalPageSize) {
+            err << path << " is not a binary journal\n";
+            shutdown();
+            return;
+        }
+        mapSize = static_cast<uint64_t>(st.st_size);
+        void* addr = mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            err << "mmap() failed " << path << " " << strerror(errno) << '\n';
+            shutdown();
+            return;
+        }
+        address = static_cast<const uint8_t*>(addr);
+
+        const BinaryJournalHeader* h = reinterpret_cast<const BinaryJournalHeader*>(address);
+        if (memcmp(h->magic, BinaryJournalMagic, sizeof(h->magic)) != 0) {
+            err << path << " magic mismatch\n";
+        } else if (h->schemaVersion != BinaryJournalSchemaVersion) {
+            err << path << " schema version " << h->schemaVersion << " not supported\n";
+        } else if (h->recordSize != sizeof(TRecord) || h->payloadSize != sizeof(T)) {
+            err << path << " record size " << h->recordSize << " mismatch with " << sizeof(TRecord) << '\n';
+        } else {
+            header = h;
+            index = reinterpret_cast<const uint64_t*>(address + header->indexOffset);
+            records = reinterpret_cast<const TRecord*>(address + header->headerSize);
+            return;
+        }
+        shutdown();
+    }
+
+    ~BinaryJournalReader() { shutdown(); }
+
+    BinaryJournalReader(const BinaryJournalReader&) = delete;
+    BinaryJournalReader& operator=(const BinaryJournalReader&) = delete;
+
+    bool bad() const { return header == nullptr; }
+
+    /**
+     * number of records fully visible in the mapping
+     */
+    uint64_t count() const {
+        uint64_t n = header->count.load(std::memory_order_acquire);
+        uint64_t mapped = (mapSize - header->headerSize) / sizeof(TRecord);
+        return std::min(n, mapped);
+    }
+
+    const TRecord& get(uint64_t i) const { return records[i]; }
+
+    uint64_t first_rcvt() const { return header->firstRcvt; }
+
+    uint64_t last_rcvt() const { return header->lastRcvt.load(std::memory_order_acquire); }
+
+    /**
+     * position of first record whose rcvt >= given rcvt, use index to narrow down then binary search
+     */
+    uint64_t lower_bound(uint64_t rcvt) const {
+        uint64_t n = count();
+        if (n == 0) return 0;
+
+        uint64_t interval = header->indexInterval;
+        uint64_t entries = (n - 1) / interval + 1;
+        const uint64_t* itr = std::lower_bound(index, index + entries, rcvt);
+        uint64_t hi = std::min(n, static_cast<uint64_t>(itr - index) * interval);
+        uint64_t lo = (itr == index) ? 0 : hi - interval;
+
+        const TRecord* pos = std::lower_bound(records + lo, records + hi, rcvt,
+                                              [](const TRecord& r, uint64_t t) { return r.rcvt < t; });
+        return static_cast<uint64_t>(pos - records);
+    }
+
+private:
+    void shutdown() {
+        if (address) munmap(const_cast<uint8_t*>(address), mapSize);
+        if (fd >= 0) close(fd);
+        address = nullptr;
+        header = nullptr;
+        fd = -1;
+    }
+};
+
+/**
+ * compress a closed segment into path.gz and remove raw file
+ */
+inline bool seal_journal_segment(const string& path, ostream& err) {
+    FILE* in = fopen(path.c_str(), "rb");
+    if (!in) {
+        err << "fopen() failed " << path << " " << strerror(errno) << '\n';
+        return false;
+    }
+
+    string gzPath = path + ".gz";
+    gzFile out = gzopen(gzPath.c_str(), "wb");
+    if (!out) {
+        err << "gzopen() failed " << gzPath << '\n';
+        fclose(in);
+        return false;
+    }
+
+    const size_t BufSize = 1024 * 1024;
+    std::unique_ptr<char[]> buf(new char[BufSize]);
+    bool ok = true;
+    size_t n;
+    while ((n = fread(buf.get(), 1, BufSize, in)) > 0) {
+        if (gzwrite(out, buf.get(), static_cast<unsigned>(n)) != static_cast<int>(n)) {
+            err << "gzwrite() failed " << gzPath << '\n';
+            ok = false;
+            break;
+        }
+    }
+    fclose(in);
+    if (gzclose(out) != Z_OK) ok = false;
+
+    if (ok) {
+        remove(path.c_str());
+    } else {
+        remove(gzPath.c_str());
+    }
+    return ok;
+}
+}
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef MIDAS_BINARY_JOURNAL_MANAGER_H
+#define MIDAS_BINARY_JOURNAL_MANAGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "BinaryJournal.h"
+#include "process/ThreadPlacement.h"
+#include "utils/MidasUtils.h"
+
+namespace midas {
+
+/**
+ * append fixed size POD records into mmap'd segment files
+ * record() is called from single consumer thread, it only does a memcpy in normal case
+ * segment creation with prefault, truncation and compression are done in background thread
+ */
+template <typename T>
+class BinaryJournalManager {
+public:
+    typedef BinaryJournalSegment<T> TSegment;
+
+    bool isZip{true};
+    string journalDirectory;
+    string suffix{".mdj"};
+    uint64_t segmentRecords{1 << 20};
+    uint32_t indexInterval{1024};
+    long maxJournalSecs{86400};
+    long long totalMsgs{0};    // msg received
+    long long droppedMsgs{0};  // msg lost due to bad segment
+    long spareMisses{0};       // rollover found no spare and created segment on record thread
+    std::atomic<long> sealedSegments{0};
+
+private:
+    std::unique_ptr<TSegment> journal;
+    std::unique_ptr<TSegment> spare;  // prepared by background thread
+    uint64_t deadline{0};             // rcvt to rollover current segment
+    std::deque<std::unique_ptr<TSegment>> toSeal;
+    std::atomic<bool> cut{false};  // trigger by admin command
+    bool isRunning{true};
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::thread sealThread;
+    std::atomic<int> segmentSequence{0};
+
+public:
+    BinaryJournalManager(const string& dir, bool isZip = true, uint64_t segmentRecords_ = 1 << 20)
+        : isZip(isZip), journalDirectory(dir), segmentRecords(segmentRecords_) {
+        Journal::create_directory(journalDirectory, cerr);
+        journal = create_segment();
+        journal->prefault();
+        set_deadline(static_cast<uint64_t>(time(nullptr)) * 1000000000);
+        sealThread = std::thread([this] { seal_loop(); });
+    }
+
+    ~BinaryJournalManager() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (journal) toSeal.push_back(std::move(journal));
+            isRunning = false;
+        }
+        cv.notify_one();
+        if (sealThread.joinable()) sealThread.join();
+        if (spare) {
+            string path = spare->path;
+            spare.reset();
+            remove(path.c_str());
+        }
+    }
+
+    BinaryJournalManager(const BinaryJournalManager&) = delete;
+    BinaryJournalManager& operator=(const BinaryJournalManager&) = delete;
+
+    void record(const T& data, uint64_t rcvt, int64_t id) {
+        if (is_unlikely_hint(rcvt >= deadline || cut.load(std::memory_order_relaxed) ||
+                             (!journal->bad() && journal->full()))) {
+            rollover(rcvt);
+        }
+
+        if (is_unlikely_hint(journal->bad())) {
+            ++droppedMsgs;
+            return;
+        }
+
+        journal->append(data, rcvt, id);
+        ++totalMsgs;
+    }
+
+    /**
+     * force current segment to be sealed, take effect on next record, thread safe
+     */
+    void flush() { cut = true; }
+
+    bool is_spare_ready() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return spare != nullptr;
+    }
+
+    void stats(ostream& os) const {
+        os << "journal msgs     = " << totalMsgs << '\n'
+           << "journal dropped  = " << droppedMsgs << '\n'
+           << "journal sealed   = " << sealedSegments << '\n'
+           << "spare misses     = " << spareMisses << '\n';
+    }
+
+private:
+    void rollover(uint64_t rcvt) {
+        cut = false;
+        std::unique_ptr<TSegment> next;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (journal) toSeal.push_back(std::move(journal));
+            next = std::move(spare);
+        }
+        cv.notify_one();
+
+        if (next && !next->bad()) {
+            next->rebirth();
+            journal = std::move(next);
+        } else {
+            // spare not ready, have to create it on this thread and take page faults while appending
+            ++spareMisses;
+            journal = create_segment();
+        }
+        if (journal->bad()) {
+            cerr << "binary journal " << journal->path << " is bad\n";
+        }
+        set_deadline(rcvt);
+    }
+
+    /**
+     * rollover due to time, or retry after 3 secs if segment is bad
+     */
+    void set_deadline(uint64_t rcvt) {
+        if (journal->bad()) {
+            deadline = rcvt + 3000000000UL;
+        } else {
+            deadline = static_cast<uint64_t>(journal->birth() + maxJournalSecs) * 1000000000;
+        }
+    }
+
+    std::unique_ptr<TSegment> create_segment() {
+        char sequence[16];
+        snprintf(sequence, sizeof sequence, ".%04d", segmentSequence++);
+        string path = journalDirectory + "/" + Journal::date_time(time(nullptr)) + sequence + suffix;
+        return std::unique_ptr<TSegment>(new TSegment(path, segmentRecords, indexInterval, cerr));
+    }
+
+    void seal_loop() {
+        ThreadPlacement::instance().place("journal_seal", "journal");
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            cv.wait(lock, [this] { return !isRunning || !toSeal.empty() || !spare; });
+
+            // spare first, compressing a sealed segment can take long
+            if (isRunning && !spare) {
+                lock.unlock();
+                std::unique_ptr<TSegment> next = create_segment();
+                next->prefault();
+                lock.lock();
+                spare = std::move(next);
+            }
+
+            while (!toSeal.empty()) {
+                std::unique_ptr<TSegment> segment = std::move(toSeal.front());
+                toSeal.pop_front();
+                lock.unlock();
+                seal(*segment);
+                lock.lock();
+            }
+
+            if (!isRunning) return;
+        }
+    }
+
+    void seal(TSegment& segment) {
+        bool isEmpty = segment.bad() || segment.count() == 0;
+        segment.close_segment();
+        if (isEmpty) {
+            remove(segment.path.c_str());
+            return;
+        }
+
+        if (isZip) seal_journal_segment(segment.path, cerr);
+        ++sealedSegments;
+    }
+};
+}
+
+#endif
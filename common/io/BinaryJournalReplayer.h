@@ -0,0 +1,367 @@
+#ifndef MIDAS_BINARY_JOURNAL_REPLAYER_H
+#define MIDAS_BINARY_JOURNAL_REPLAYER_H
+
+#include <dirent.h>
+#include <zlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "BinaryJournal.h"
+
+namespace midas {
+
+/**
+ * time range and rcvt index of one segment, loaded from segment header without touching records
+ * sealed .gz segment keeps header and index at front, so only that part is inflated
+ */
+struct BinaryJournalSegmentInfo {
+    string path;
+    bool isZip{false};
+    uint32_t headerSize{0};
+    uint32_t recordSize{0};
+    uint32_t indexInterval{0};
+    uint64_t count{0};
+    uint64_t firstRcvt{0};
+    uint64_t lastRcvt{0};
+    vector<uint64_t> index;
+
+    bool overlap(uint64_t start, uint64_t end) const {
+        return count > 0 && (start == 0 || lastRcvt >= start) && (end == 0 || firstRcvt <= end);
+    }
+
+    /**
+     * first record position whose block may contain rcvt >= start, caller still needs to skip earlier records
+     */
+    uint64_t block_start(uint64_t start) const {
+        if (start == 0 || index.empty()) return 0;
+        auto itr = std::lower_bound(index.begin(), index.end(), start);
+        if (itr == index.begin()) return 0;
+        return static_cast<uint64_t>(itr - index.begin() - 1) * indexInterval;
+    }
+};
+
+/**
+ * replay binary journal segments of a directory within time window [start, end], 0 means unbounded
+ * speed 0 replays as fast as possible, 1 at recorded pace, N at N times recorded pace
+ * callback has same signature as producer data callback so it can feed a Disruptor directly
+ */
+template <typename T>
+class BinaryJournalReplayer {
+public:
+    typedef JournalRecord<T> TRecord;
+    typedef std::function<size_t(const T&, uint64_t /*rcvt*/, int64_t /*id*/)> TCallback;
+
+    string suffix{".mdj"};
+    double speed{0};
+    size_t batchRecords{256};  // records inflated per gzread
+    vector<BinaryJournalSegmentInfo> segments;
+    long long replayedMsgs{0};
+    long long skippedMsgs{0};  // not delivered as outside time window, replayed + skipped + failed adds up to count
+    long long failedMsgs{0};   // in segments that could not be read at replay
+
+private:
+    std::atomic<bool> isRunning{false};
+    uint64_t baseRcvt{0};
+    std::chrono::steady_clock::time_point baseWall;
+
+public:
+    BinaryJournalReplayer(double speed_ = 0) : speed(speed_) {}
+
+    /**
+     * collect .mdj and .mdj.gz segments in directory, sorted by first rcvt
+     */
+    bool load(const string& directory, ostream& err) {
+        DIR* dir = opendir(directory.c_str());
+        if (!dir) {
+            err << "opendir() failed " << directory << " " << strerror(errno) << '\n';
+            return false;
+        }
+
+        segments.clear();
+        const string zipSuffix = suffix + ".gz";
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            string name(entry->d_name);
+            bool isZip = ends_with(name, zipSuffix);
+            if (!isZip && !ends_with(name, suffix)) continue;
+
+            BinaryJournalSegmentInfo info;
+            info.path = directory + "/" + name;
+            info.isZip = isZip;
+            if (load_segment_info(info, err)) segments.push_back(std::move(info));
+        }
+        closedir(dir);
+
+        std::sort(segments.begin(), segments.end(),
+                  [](const BinaryJournalSegmentInfo& l, const BinaryJournalSegmentInfo& r) {
+                      return l.firstRcvt < r.firstRcvt;
+                  });
+        return true;
+    }
+
+    uint64_t first_rcvt() const {
+        for (auto& segment : segments) {
+            if (segment.count > 0) return segment.firstRcvt;
+        }
+        return 0;
+    }
+
+    uint64_t last_rcvt() const {
+        uint64_t last = 0;
+        for (auto& segment : segments) last = std::max(last, segment.lastRcvt);
+        return last;
+    }
+
+    /**
+     * blocking replay on caller thread, return number of records delivered
+     */
+    long long play(uint64_t start, uint64_t end, const TCallback& callback, ostream& err) {
+        isRunning = true;
+        baseRcvt = 0;
+        long long delivered = replayedMsgs;
+        for (auto& segment : segments) {
+            if (!isRunning) break;
+            if (!segment.overlap(start, end)) {
+                skippedMsgs += segment.count;
+                continue;
+            }
+
+            if (segment.isZip)
+                play_zip(segment, start, end, callback, err);
+            else
+                play_mmap(segment, start, end, callback, err);
+        }
+        isRunning = false;
+        return replayedMsgs - delivered;
+    }
+
+    /**
+     * stop replay, can be called from another thread
+     */
+    void stop() { isRunning = false; }
+
+    void stats(ostream& os) const {
+        os << "replay segments  = " << segments.size() << '\n'
+           << "replay msgs      = " << replayedMsgs << '\n'
+           << "replay skipped   = " << skippedMsgs << '\n'
+           << "replay failed    = " << failedMsgs << '\n';
+    }
+
+private:
+    static bool ends_with(const string& s, const string& tail) {
+        return s.size() > tail.size() && s.compare(s.size() - tail.size(), tail.size(), tail) == 0;
+    }
+
+    bool load_segment_info(BinaryJournalSegmentInfo& info, ostream& err) {
+        if (!info.isZip) {
+            BinaryJournalReader<T> reader(info.path, err);
+            if (reader.bad()) return false;
+            return fill_segment_info(info, *reader.header, reader.count(), reader.index);
+        }
+
+        gzFile gz = gzopen(info.path.c_str(), "rb");
+        if (!gz) {
+            err << "gzopen() failed " << info.path << '\n';
+            return false;
+        }
+
+        bool ok = false;
+        std::unique_ptr<uint64_t[]> page(new uint64_t[BinaryJournalPageSize / sizeof(uint64_t)]);
+        if (gzread(gz, page.get(), BinaryJournalPageSize) == static_cast<int>(BinaryJournalPageSize)) {
+            const BinaryJournalHeader& header = *reinterpret_cast<const BinaryJournalHeader*>(page.get());
+            if (check_header(info.path, header, err)) {
+                uint64_t n = header.count.load(std::memory_order_relaxed);
+                uint64_t entries = n ? (n - 1) / header.indexInterval + 1 : 0;
+                vector<uint64_t> index(entries);
+                int indexBytes = static_cast<int>(entries * sizeof(uint64_t));
+                if (header.indexOffset == BinaryJournalPageSize &&
+                    gzread(gz, index.data(), indexBytes) == indexBytes) {
+                    ok = fill_segment_info(info, header, n, index.data());
+                } else {
+                    err << info.path << " truncated index\n";
+                }
+            }
+        } else {
+            err << info.path << " is not a binary journal\n";
+        }
+        gzclose(gz);
+        return ok;
+    }
+
+    static bool check_header(const string& path, const BinaryJournalHeader& header, ostream& err) {
+        if (memcmp(header.magic, BinaryJournalMagic, sizeof(header.magic)) != 0) {
+            err << path << " magic mismatch\n";
+        } else if (header.schemaVersion != BinaryJournalSchemaVersion) {
+            err << path << " schema version " << header.schemaVersion << " not supported\n";
+        } else if (header.recordSize != sizeof(TRecord) || header.payloadSize != sizeof(T)) {
+            err << path << " record size " << header.recordSize << " mismatch with " << sizeof(TRecord) << '\n';
+        } else {
+            return true;
+        }
+        return false;
+    }
+
+    static bool fill_segment_info(BinaryJournalSegmentInfo& info, const BinaryJournalHeader& header, uint64_t count,
+                                  const uint64_t* index) {
+        info.headerSize = header.headerSize;
+        info.recordSize = header.recordSize;
+        info.indexInterval = header.indexInterval;
+        info.count = count;
+        info.firstRcvt = header.firstRcvt;
+        info.lastRcvt = header.lastRcvt.load(std::memory_order_acquire);
+        uint64_t entries = count ? (count - 1) / header.indexInterval + 1 : 0;
+        info.index.assign(index, index + entries);
+        return true;
+    }
+
+    void play_mmap(const BinaryJournalSegmentInfo& info, uint64_t start, uint64_t end, const TCallback& callback,
+                   ostream& err) {
+        BinaryJournalReader<T> reader(info.path, err);
+        if (reader.bad()) {
+            failedMsgs += info.count;
+            return;
+        }
+
+        // records before start are passed over by index search, those after end are left unread
+        uint64_t n = reader.count();
+        uint64_t i = start ? reader.lower_bound(start) : 0;
+        skippedMsgs += i;
+        for (; i < n && isRunning; ++i) {
+            if (!deliver(reader.get(i), end, callback)) {
+                skippedMsgs += n - i;
+                break;
+            }
+        }
+    }
+
+    void play_zip(const BinaryJournalSegmentInfo& info, uint64_t start, uint64_t end, const TCallback& callback,
+                  ostream& err) {
+        gzFile gz = gzopen(info.path.c_str(), "rb");
+        if (!gz) {
+            err << "gzopen() failed " << info.path << '\n';
+            failedMsgs += info.count;
+            return;
+        }
+        gzbuffer(gz, 1024 * 1024);
+
+        // gzip stream can only be inflated forward, index limits the skipped part to one block
+        uint64_t pos = info.block_start(start);
+        z_off_t offset = static_cast<z_off_t>(info.headerSize + pos * sizeof(TRecord));
+        if (gzseek(gz, offset, SEEK_SET) != offset) {
+            err << "gzseek() failed " << info.path << '\n';
+            failedMsgs += info.count;
+            gzclose(gz);
+            return;
+        }
+        skippedMsgs += pos;
+
+        vector<TRecord> batch(batchRecords);
+        bool isDone = false;
+        while (!isDone && pos < info.count && isRunning) {
+            uint64_t want = std::min<uint64_t>(batchRecords, info.count - pos);
+            int bytes = gzread(gz, batch.data(), static_cast<unsigned>(want * sizeof(TRecord)));
+            if (bytes <= 0) break;
+
+            uint64_t got = static_cast<uint64_t>(bytes) / sizeof(TRecord);
+            for (uint64_t i = 0; i < got && isRunning; ++i) {
+                if (batch[i].rcvt < start) {
+                    ++skippedMsgs;
+                    continue;
+                }
+                if (!deliver(batch[i], end, callback)) {
+                    skippedMsgs += info.count - pos - i;
+                    isDone = true;
+                    break;
+                }
+            }
+            pos += got;
+        }
+        if (!isDone && isRunning && pos < info.count) {
+            err << info.path << " truncated at record " << pos << '\n';
+            failedMsgs += info.count - pos;
+        }
+        gzclose(gz);
+    }
+
+    /**
+     * return false once record is beyond end of time window
+     */
+    bool deliver(const TRecord& record, uint64_t end, const TCallback& callback) {
+        if (end && record.rcvt > end) return false;
+        pace(record.rcvt);
+        callback(record.data, record.rcvt, record.id);
+        ++replayedMsgs;
+        return true;
+    }
+
+    /**
+     * wait until wall clock catches up with recorded rcvt scaled by speed
+     */
+    void pace(uint64_t rcvt) {
+        if (speed <= 0) return;
+        auto now = std::chrono::steady_clock::now();
+        if (baseRcvt == 0 || rcvt < baseRcvt) {
+            baseRcvt = rcvt;
+            baseWall = now;
+            return;
+        }
+
+        auto target = baseWall + std::chrono::nanoseconds(static_cast<int64_t>((rcvt - baseRcvt) / speed));
+        if (target - now > std::chrono::microseconds(100)) {
+            std::this_thread::sleep_until(target - std::chrono::microseconds(50));
+        }
+        while (std::chrono::steady_clock::now() < target) {
+        }
+    }
+};
+
+/**
+ * journal replay as a Disruptor producer of raw records, which are filled into ring slot by Ingest
+ * Ingest is the one live producer fills slots with, so replayed ticks take the same normalize path
+ * Ingest provides bool fill(const T& raw, ElementType& slot, long sequence)
+ */
+template <typename T, typename Ingest>
+class BinaryJournalReplayProducer {
+public:
+    typedef std::shared_ptr<BinaryJournalReplayProducer> SharedPtr;
+    typedef T SourceType;
+    typedef std::function<size_t(const SourceType*, size_t /*count*/, uint64_t /*rcvt*/, int64_t /*id*/)> TCallback;
+
+    BinaryJournalReplayer<T> replayer;
+    std::shared_ptr<Ingest> ingest;
+    TCallback dataCallback;
+
+public:
+    BinaryJournalReplayProducer(const string& directory, double speed, std::shared_ptr<Ingest> ingest_,
+                                ostream& err)
+        : replayer(speed), ingest(ingest_) {
+        replayer.load(directory, err);
+    }
+
+    void register_data_callback(const TCallback& cb) { dataCallback = cb; }
+
+    template <typename ElementType>
+    bool fill(const SourceType& raw, ElementType& slot, long sequence) {
+        return ingest->fill(raw, slot, sequence);
+    }
+
+    long long play(uint64_t start, uint64_t end, ostream& err) {
+        if (!dataCallback) {
+            err << "no data callback registered for replay\n";
+            return 0;
+        }
+        auto publish = [this](const T& raw, uint64_t rcvt, int64_t id) { return dataCallback(&raw, 1, rcvt, id); };
+        return replayer.play(start, end, publish, err);
+    }
+
+    void stop() { replayer.stop(); }
+
+    void stats(ostream& os) const { replayer.stats(os); }
+};
+}
+
+#endif
@@ -1,114 +1,150 @@
 #ifndef MIDAS_CSV_PARSER_H
 #define MIDAS_CSV_PARSER_H
 
-#include <list>
+#include <cctype>
+#include <cstring>
 #include <map>
+#include <sstream>
 #include <string>
 #include <vector>
-#include "utils/convert/StringHelper.h"
+#include "io/MappedFile.h"
+#include "midas/MidasException.h"
+#include "utils/convert/NumberParser.h"
 
 using namespace std;
 
 namespace midas {
 
+/**
+ * csv file is mmap'd and only cell boundaries are recorded, cells are converted when asked for
+ * empty lines are skipped, a row may miss its last cell which then reads as "null"
+ */
 class CsvParser {
 public:
     bool hasHeader{true};
-    int dataCount{0};  // number of column
+    size_t dataCount{0};  // number of column
     char delimiter{','};
 
-    map<string, vector<string>> columns;
-    vector<vector<string>> rows;
     vector<string> header;
     map<string, int> column2index;
-    map<string, string> metadata;  // key value of metadata
 
 public:
     CsvParser() {}
 
-    void parse(string filePath) {
+    void parse(const string& filePath) {
         clear();
+        ostringstream err;
+        if (!file.open(filePath, err)) THROW_MIDAS_EXCEPTION(err.str());
+
+        const char *p = file.begin(), *end = file.end();
+        size_t rowCount = 0;
+        vector<size_t> rowCells;
+        while (p < end) {
+            const char* nl = static_cast<const char*>(memchr(p, '\n', end - p));
+            const char* lineEnd = nl ? nl : end;
+            const char* lineBegin = p;
+            p = nl ? nl + 1 : end;
+            while (lineBegin < lineEnd && isspace(static_cast<unsigned char>(*lineBegin))) ++lineBegin;
+            while (lineEnd > lineBegin && isspace(static_cast<unsigned char>(lineEnd[-1]))) --lineEnd;
+            if (lineBegin == lineEnd) continue;
+
+            rowCells.clear();
+            for (const char* c = lineBegin;;) {
+                const char* d = static_cast<const char*>(memchr(c, delimiter, lineEnd - c));
+                rowCells.push_back(c - file.begin());
+                rowCells.push_back((d ? d : lineEnd) - file.begin());
+                if (!d) break;
+                c = d + 1;
+            }
 
-        ifstream ifs(filePath, ifstream::in);
-
-        if (ifs.is_open()) {
-            string line;
-            while (getline(ifs, line)) {
-                boost::trim(line);
-                if (line.size() > 0) {
-                    vector<string> lets = string_split(line, delimiter);
-
-                    if (hasHeader && header.size() == 0) {
-                        header = lets;
-                    } else {
-                        rows.push_back(lets);
-                    }
+            if (hasHeader && header.empty()) {
+                for (size_t i = 0; i < rowCells.size(); i += 2) {
+                    header.emplace_back(file.begin() + rowCells[i], rowCells[i + 1] - rowCells[i]);
                 }
+                dataCount = header.size();
+                continue;
             }
+            if (dataCount == 0) dataCount = rowCells.size() / 2;
+
+            size_t count = rowCells.size() / 2;
+            if (count == dataCount - 1) {
+                rowCells.push_back(NullCell);  // last value can be null
+                rowCells.push_back(NullCell);
+            } else if (count != dataCount) {
+                THROW_MIDAS_EXCEPTION(filePath << " : data count not correct in row " << rowCount);
+            }
+            cells.insert(cells.end(), rowCells.begin(), rowCells.end());
+            ++rowCount;
+        }
 
-            ifs.close();
+        if (!hasHeader) {
+            for (size_t i = 0; i < dataCount; ++i) header.push_back("header" + std::to_string(i));
+        }
+        int missingCount = 0;
+        for (size_t i = 0; i < header.size(); ++i) {
+            if (header[i].empty()) header[i] = "default" + std::to_string(missingCount++);
+            column2index[header[i]] = static_cast<int>(i);
         }
+    }
 
-        if (rows.size() == 0) return;
+    size_t row_count() const { return dataCount ? cells.size() / 2 / dataCount : 0; }
 
-        parse_header();
+    string get(size_t row, size_t column) const {
+        const size_t* c = cell(row, column);
+        if (c[0] == NullCell) return "null";
+        return string(file.begin() + c[0], c[1] - c[0]);
+    }
 
-        vector<vector<string>> columnArray;
-        columnArray.resize(dataCount);
+    double get_double(size_t row, size_t column) const {
+        const size_t* c = cell(row, column);
+        if (c[0] == NullCell) return 0;
+        return parse_double(file.begin() + c[0], file.begin() + c[1]);
+    }
 
-        int cnt = 0;
-        for (vector<string>& row : rows) {
-            if (row.size() == dataCount) {
-                for (int i = 0; i < dataCount; ++i) {
-                    columnArray[i].push_back(row[i]);
-                }
-            } else if (row.size() == dataCount - 1) {
-                for (int i = 0; i < dataCount - 1; ++i) {
-                    columnArray[i].push_back(row[i]);
-                }
-                // last value can be null, like a,b,c,
-                columnArray[dataCount - 1].push_back("null");
-            } else {
-                THROW_MIDAS_EXCEPTION(filePath << " : data count not correct in row " << cnt);
-            }
-            cnt++;
-        }
+    int64_t get_int(size_t row, size_t column) const {
+        const size_t* c = cell(row, column);
+        if (c[0] == NullCell) return 0;
+        return parse_int64(file.begin() + c[0], file.begin() + c[1]);
+    }
 
-        int missingCount = 0;
-        for (int i = 0; i < dataCount; ++i) {
-            string columnName = header.get(i);
-            if (StringUtils.isEmpty(columnName)) {
-                columnName = "default" + missingCount;
-                missingCount++;
-            }
-            columns[columnName] = columnArray[i];
-            column2index.put(columnName, i);
-        }
+    int index_of(const string& column) const {
+        auto itr = column2index.find(column);
+        return itr == column2index.end() ? -1 : itr->second;
     }
 
-    void parse_header() {
-        if (hasHeader) {
-            dataCount = header.size();
-        } else {
-            dataCount = rows[0].size();
-            for (size_t i = 0; i < dataCount; ++i) {
-                header.push_back("header" + i);
-            }
-        }
+    vector<string> column_strings(const string& column) const {
+        vector<string> result;
+        int index = index_of(column);
+        if (index < 0) return result;
+        result.reserve(row_count());
+        for (size_t r = 0; r < row_count(); ++r) result.push_back(get(r, index));
+        return result;
+    }
+
+    vector<double> column_doubles(const string& column) const {
+        vector<double> result;
+        int index = index_of(column);
+        if (index < 0) return result;
+        result.reserve(row_count());
+        for (size_t r = 0; r < row_count(); ++r) result.push_back(get_double(r, index));
+        return result;
     }
 
     void clear() {
-        columns.clear();
-        rows.clear();
+        file.close();
+        cells.clear();
         header.clear();
         column2index.clear();
-        metadata.clear();
         dataCount = 0;
     }
 
-    string getRowAt(vector<string> row, int columnIndex) { return row.get(columnIndex); }
+private:
+    enum : size_t { NullCell = ~size_t(0) };
+
+    const size_t* cell(size_t row, size_t column) const { return &cells[(row * dataCount + column) * 2]; }
 
-    string getRowAt(vector<string> row, string column) { return row.get(column2index.get(column)); }
+    MappedFile file;
+    vector<size_t> cells;  // begin and end offset of each cell in file, row major
 };
 }
 
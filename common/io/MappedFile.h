@@ -0,0 +1,79 @@
+#ifndef MIDAS_MAPPED_FILE_H
+#define MIDAS_MAPPED_FILE_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+using namespace std;
+
+namespace midas {
+
+/**
+ * read only view of whole file through mmap, pages are read ahead as file is expected to be scanned once
+ * empty file is valid with size 0 and no mapping
+ */
+class MappedFile {
+public:
+    MappedFile() {}
+    MappedFile(const string& path, ostream& err) { open(path, err); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const string& path, ostream& err) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            err << "open() failed " << path << " " << strerror(errno) << '\n';
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            err << "fstat() failed " << path << " " << strerror(errno) << '\n';
+            ::close(fd);
+            return false;
+        }
+        isOpen = true;
+        mapSize = static_cast<size_t>(st.st_size);
+        if (mapSize > 0) {
+            void* addr = mmap(nullptr, mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                err << "mmap() failed " << path << " " << strerror(errno) << '\n';
+                isOpen = false;
+                mapSize = 0;
+            } else {
+                address = static_cast<const char*>(addr);
+                madvise(addr, mapSize, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);  // mapping stays valid
+        return isOpen;
+    }
+
+    void close() {
+        if (address) munmap(const_cast<char*>(address), mapSize);
+        address = nullptr;
+        mapSize = 0;
+        isOpen = false;
+    }
+
+    bool is_open() const { return isOpen; }
+    const char* begin() const { return address; }
+    const char* end() const { return address + mapSize; }
+    size_t size() const { return mapSize; }
+
+private:
+    const char* address{nullptr};
+    size_t mapSize{0};
+    bool isOpen{false};
+};
+}
+
+#endif
@@ -0,0 +1,294 @@
+#ifndef MIDAS_TICK_CODEC_H
+#define MIDAS_TICK_CODEC_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include "utils/convert/NumberParser.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MIDAS_TICK_CODEC_AVX2 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define MIDAS_TICK_CODEC_SSE2 1
+#endif
+
+/**
+ * schema driven tick codec decoding into a plain struct without allocation
+ * a schema is a struct with
+ *   typedef <pod> TPod;
+ *   static constexpr uint16_t version();
+ *   static constexpr TickFieldTable<N> fields();   built with MIDAS_TICK_FIELD
+ * binary record is 4 byte header (version, record size) followed by schema fields packed in schema order,
+ * host byte order, all offsets are compile time constants
+ * text path reads legacy "key value ,key value ,;" format written for MidasTick
+ */
+namespace midas {
+
+enum class TickFieldType : uint8_t { Chars, Integer, Real };
+
+struct TickFieldSpec {
+    const char* key;
+    size_t offset;  // in pod
+    size_t size;    // in pod and on wire
+    TickFieldType type;
+};
+
+template <size_t N>
+struct TickFieldTable {
+    TickFieldSpec specs[N];
+
+    static constexpr size_t size() { return N; }
+    constexpr const TickFieldSpec& operator[](size_t i) const { return specs[i]; }
+};
+
+template <typename T>
+constexpr TickFieldType tick_field_type() {
+    return std::is_array<T>::value ? TickFieldType::Chars
+                                   : std::is_floating_point<T>::value ? TickFieldType::Real : TickFieldType::Integer;
+}
+
+#define MIDAS_TICK_FIELD(Pod, key, member)                                                         \
+    midas::TickFieldSpec {                                                                         \
+        key, offsetof(Pod, member), sizeof(std::declval<Pod&>().member),                           \
+            midas::tick_field_type<typename std::remove_reference<decltype(std::declval<Pod&>().member)>::type>() \
+    }
+
+namespace detail {
+/**
+ * positions of one delimiter in a buffer, 32 or 16 bytes compared per step, scalar without simd
+ */
+class DelimiterScanner {
+public:
+    DelimiterScanner(const char* begin, const char* end_, char delimiter_)
+        : block(begin), end(end_), delimiter(delimiter_) {
+        load();
+    }
+
+    /**
+     * @return next delimiter position, end when no more
+     */
+    const char* next() {
+        while (mask == 0) {
+            block += Width;
+            if (block >= end) return end;
+            load();
+        }
+        const char* pos = block + __builtin_ctz(mask);
+        mask &= mask - 1;
+        return pos;
+    }
+
+private:
+#if defined(MIDAS_TICK_CODEC_AVX2)
+    static constexpr size_t Width = 32;
+#else
+    static constexpr size_t Width = 16;
+#endif
+
+    void load() {
+        if (block + Width <= end) {
+#if defined(MIDAS_TICK_CODEC_AVX2)
+            __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+            mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(delimiter))));
+            return;
+#elif defined(MIDAS_TICK_CODEC_SSE2)
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+            mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(delimiter))));
+            return;
+#endif
+        }
+        // tail, never read past end
+        mask = 0;
+        for (size_t i = 0; i < Width && block + i < end; ++i) {
+            if (block[i] == delimiter) mask |= 1u << i;
+        }
+    }
+
+    const char* block;
+    const char* const end;
+    const char delimiter;
+    uint32_t mask{0};
+};
+
+/**
+ * key of up to 8 chars packed into an integer, longer keys never match
+ */
+constexpr uint64_t pack_key(const char* key, size_t n) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < n && i < 8; ++i) v |= static_cast<uint64_t>(static_cast<unsigned char>(key[i])) << (8 * i);
+    return n > 8 ? ~uint64_t(0) : v;
+}
+
+constexpr size_t key_length(const char* key) {
+    size_t n = 0;
+    while (key[n]) ++n;
+    return n;
+}
+}
+
+template <class Schema>
+class TickCodec {
+public:
+    typedef typename Schema::TPod TPod;
+
+    static constexpr size_t HeaderSize = 4;
+
+    static constexpr size_t field_count() { return decltype(Schema::fields())::size(); }
+
+    /**
+     * offset of i-th field on wire, counted from end of header
+     */
+    static constexpr size_t wire_offset(size_t i) {
+        size_t offset = 0;
+        for (size_t k = 0; k < i; ++k) offset += Schema::fields()[k].size;
+        return offset;
+    }
+
+    static constexpr size_t wire_size() { return HeaderSize + wire_offset(field_count()); }
+
+    /**
+     * @return bytes written, 0 if capacity is too small
+     */
+    static size_t encode(const TPod& pod, char* out, size_t capacity) {
+        static_assert(std::is_trivially_copyable<TPod>::value, "tick codec decodes into plain struct only");
+        static_assert(wire_size() <= UINT16_MAX, "record size must fit header");
+        if (capacity < wire_size()) return 0;
+        const uint16_t header[2] = {Schema::version(), static_cast<uint16_t>(wire_size())};
+        memcpy(out, header, HeaderSize);
+        encode_fields(reinterpret_cast<const char*>(&pod), out + HeaderSize,
+                      std::make_index_sequence<field_count()>());
+        return wire_size();
+    }
+
+    /**
+     * only schema fields of pod are written, others keep their value
+     * @return false if record is short or written with another schema version
+     */
+    static bool decode(const char* in, size_t size, TPod& pod) {
+        if (size < wire_size()) return false;
+        uint16_t header[2];
+        memcpy(header, in, HeaderSize);
+        if (header[0] != Schema::version() || header[1] != wire_size()) return false;
+        decode_fields(in + HeaderSize, reinterpret_cast<char*>(&pod), std::make_index_sequence<field_count()>());
+        return true;
+    }
+
+    /**
+     * parse legacy text tick, unknown keys are skipped
+     * fields usually come in schema order, so expected next field is compared first
+     * @return number of schema fields set
+     */
+    static size_t parse_text(const char* input, size_t size, TPod& pod) {
+        const char* start = input;
+        const char* end = input + size;
+        char* base = reinterpret_cast<char*>(&pod);
+        size_t found = 0, hint = 0;
+        detail::DelimiterScanner commas(input, end, ',');
+        while (start < end && *start != ';') {
+            const char* comma = commas.next();
+            if (comma == end) break;
+            const char* space = start;
+            while (space < comma && *space != ' ') ++space;
+            if (space < comma) {
+                int index = find_field(detail::pack_key(start, space - start), hint);
+                if (index >= 0) {
+                    const char* valueEnd = comma;
+                    while (valueEnd > space + 1 && valueEnd[-1] == ' ') --valueEnd;
+                    set_field(spec_table()[index], base, space + 1, valueEnd);
+                    hint = index + 1;
+                    ++found;
+                }
+            }
+            start = comma + 1;
+        }
+        return found;
+    }
+
+    /**
+     * @return index of field with given key, -1 if not in schema
+     */
+    static int field_index(const char* key) { return find_field(detail::pack_key(key, strlen(key)), 0); }
+
+private:
+    template <size_t I>
+    struct Field {
+        static constexpr size_t podOffset = Schema::fields()[I].offset;
+        static constexpr size_t wireOffset = wire_offset(I);
+        static constexpr size_t size = Schema::fields()[I].size;
+        static constexpr uint64_t key =
+            detail::pack_key(Schema::fields()[I].key, detail::key_length(Schema::fields()[I].key));
+        static_assert(detail::key_length(Schema::fields()[I].key) <= 8, "tick field key is at most 8 chars");
+    };
+
+    template <size_t... I>
+    static void encode_fields(const char* pod, char* wire, std::index_sequence<I...>) {
+        int expand[] = {0, (memcpy(wire + Field<I>::wireOffset, pod + Field<I>::podOffset, Field<I>::size), 0)...};
+        (void)expand;
+    }
+
+    template <size_t... I>
+    static void decode_fields(const char* wire, char* pod, std::index_sequence<I...>) {
+        int expand[] = {0, (memcpy(pod + Field<I>::podOffset, wire + Field<I>::wireOffset, Field<I>::size), 0)...};
+        (void)expand;
+    }
+
+    /**
+     * schema table materialized once, runtime index into fields() would rebuild it on every call
+     */
+    static const TickFieldSpec* spec_table() {
+        static constexpr decltype(Schema::fields()) table = Schema::fields();
+        return table.specs;
+    }
+
+    template <size_t... I>
+    static const uint64_t* keys(std::index_sequence<I...>) {
+        static const uint64_t table[] = {Field<I>::key...};
+        return table;
+    }
+
+    static int find_field(uint64_t key, size_t hint) {
+        static const uint64_t* table = keys(std::make_index_sequence<field_count()>());
+        if (hint < field_count() && table[hint] == key) return static_cast<int>(hint);
+        for (size_t i = 0; i < field_count(); ++i) {
+            if (table[i] == key) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    static void set_field(const TickFieldSpec& spec, char* base, const char* begin, const char* end) {
+        char* dest = base + spec.offset;
+        switch (spec.type) {
+            case TickFieldType::Chars: {
+                size_t n = std::min<size_t>(end - begin, spec.size - 1);
+                memcpy(dest, begin, n);
+                memset(dest + n, 0, spec.size - n);
+                break;
+            }
+            case TickFieldType::Integer: {
+                // low bytes of little endian value fit any integer width
+                int64_t v = parse_int64(begin, end);
+                memcpy(dest, &v, std::min(spec.size, sizeof(v)));
+                break;
+            }
+            case TickFieldType::Real: {
+                double v = parse_double(begin, end);
+                if (spec.size == sizeof(float)) {
+                    float f = static_cast<float>(v);
+                    memcpy(dest, &f, sizeof(f));
+                } else {
+                    memcpy(dest, &v, sizeof(v));
+                }
+                break;
+            }
+        }
+    }
+};
+}
+
+#endif
@@ -2,7 +2,9 @@
 #define MIDAS_MD_BOOK_H
 
 #include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <new>
 #include "MdDefs.h"
 
 namespace midas {
@@ -54,15 +56,43 @@ struct MdBook {
 
     MdBook() = default;
 
-    ~MdBook() {
+    ~MdBook() { release(); }
+
+    /**
+     * fixed capacity level arrays owned by book, each array starts at a cache line, all levels start blank
+     */
+    void allocate(uint16_t depth, BookType type = BookType::price) {
+        release();
+        bidLevels = allocate_levels<BidBookLevel>(depth);
+        askLevels = allocate_levels<AskBookLevel>(depth);
+        numBidLevels = numAskLevels = depth;
+        bookType = type;
+        myAlloc = 1;
+    }
+
+    void release() {
         if (myAlloc) {
-            delete[] bidLevels;
-            delete[] askLevels;
+            free(bidLevels);
+            free(askLevels);
         }
+        bidLevels = nullptr;
+        askLevels = nullptr;
+        numBidLevels = numAskLevels = 0;
     }
 
     MdBook(MdBook const&) = delete;
     MdBook& operator=(MdBook const&) = delete;
+
+private:
+    template <typename Level>
+    static Level* allocate_levels(uint16_t depth) {
+        void* memory = nullptr;
+        if (depth == 0) return nullptr;
+        if (posix_memalign(&memory, 64, sizeof(Level) * depth) != 0) throw std::bad_alloc();
+        Level* levels = static_cast<Level*>(memory);
+        for (uint16_t i = 0; i < depth; ++i) new (levels + i) Level;
+        return levels;
+    }
 };
 
 #pragma pack(pop)
@@ -0,0 +1,93 @@
+#ifndef MIDAS_MD_BOOK_ENGINE_H
+#define MIDAS_MD_BOOK_ENGINE_H
+
+#include <cstdint>
+#include "MdBook.h"
+#include "net/raw/MdProtocol.h"
+
+namespace midas {
+
+constexpr uint16_t MdBookMaxDepth = 32;  // one bit per level in BookChanged
+
+/**
+ * top of book as sent by feed, already in book price unit, levels beyond depth are blank
+ */
+struct BookSnapshot {
+    uint16_t bidDepth{0};
+    uint16_t askDepth{0};
+    int64_t bidPrice[MdBookMaxDepth];
+    uint64_t bidShares[MdBookMaxDepth];
+    int64_t askPrice[MdBookMaxDepth];
+    uint64_t askShares[MdBookMaxDepth];
+};
+
+/**
+ * compare every level without branch and collect changed ones in a mask, then write changed levels only
+ */
+template <typename Level>
+inline uint32_t apply_book_side(Level* levels, uint16_t numLevels, const int64_t* price, const uint64_t* shares,
+                                uint16_t depth, uint64_t sequence, uint64_t timestamp) {
+    uint32_t mask = 0;
+    if (numLevels > MdBookMaxDepth) numLevels = MdBookMaxDepth;
+    for (uint16_t i = 0; i < numLevels; ++i) {
+        const bool isPresent = i < depth;
+        const int64_t p = isPresent ? price[i] : PriceBlank;
+        const uint64_t s = isPresent ? shares[i] : 0;
+        mask |= static_cast<uint32_t>((levels[i].price != p) | (levels[i].shares != s)) << i;
+    }
+    for (uint32_t m = mask; m != 0; m &= m - 1) {
+        const int i = __builtin_ctz(m);
+        const bool isPresent = i < depth;
+        levels[i].price = isPresent ? price[i] : PriceBlank;
+        levels[i].shares = isPresent ? shares[i] : 0;
+        levels[i].sequence = sequence;
+        levels[i].updateTS = timestamp;
+    }
+    return mask;
+}
+
+/**
+ * merge snapshot into book, changed holds which levels of which side moved
+ * @return false if book is same as before
+ */
+inline bool apply_book_snapshot(MdBook& book, const BookSnapshot& snapshot, uint64_t sequence, uint64_t timestamp,
+                                BookChanged& changed) {
+    changed.bidLevels = apply_book_side(book.bidLevels, book.numBidLevels, snapshot.bidPrice, snapshot.bidShares,
+                                        snapshot.bidDepth, sequence, timestamp);
+    changed.askLevels = apply_book_side(book.askLevels, book.numAskLevels, snapshot.askPrice, snapshot.askShares,
+                                        snapshot.askDepth, sequence, timestamp);
+    static const BookChanged::ChangedSide sides[4] = {BookChanged::ChangedSide::none, BookChanged::ChangedSide::bid,
+                                                      BookChanged::ChangedSide::ask, BookChanged::ChangedSide::both};
+    changed.side = sides[(changed.bidLevels != 0) | ((changed.askLevels != 0) << 1)];
+    return changed.side != BookChanged::ChangedSide::none;
+}
+
+/**
+ * turns snapshots into book deltas, cbBookChanged is only called when some level really changed
+ */
+class MdBookEngine {
+public:
+    MDConsumerCallbacks callbacks;
+    void* userData{nullptr};
+    uint64_t snapshotCount{0};
+    uint64_t changedCount{0};
+
+public:
+    /**
+     * @return false if nothing changed
+     */
+    bool update(const char* symbol, uint16_t exchange, MdBook& book, const BookSnapshot& snapshot,
+                const Timestamps& timestamps, BookChanged& changed) {
+        ++snapshotCount;
+        const uint64_t sequence = snapshotCount;
+        changed.timestamps = timestamps;
+        if (!apply_book_snapshot(book, snapshot, sequence, timestamps.producerReceive, changed)) return false;
+
+        ++changedCount;
+        if (callbacks.cbBookChanged) callbacks.cbBookChanged(symbol, exchange, &changed, userData);
+        return true;
+    }
+};
+}
+
+#endif
@@ -34,7 +34,10 @@ public:
     uint64_t time{0};  // receive time, nanosec since epoch
     AllocatorFunctor allocator;
     DeleterFunctor deleter;
-    BufferData* next{nullptr};
+    union {
+        BufferData* next{nullptr};  // while buffer sits on free list
+        void* owner;                // optional, while buffer is in use, pool cache which buffer returns to
+    };
 
     BufferData* data() { return reinterpret_cast<BufferData*>(this + 1); }
     BufferPrefix(size_t c, AllocatorFunctor a, DeleterFunctor d) : capacity(c), allocator(a), deleter(d) {
@@ -42,6 +45,8 @@ public:
     }
 };
 
+static_assert(sizeof(BufferPrefix) == 64, "buffer prefix must stay one cache line, pool size classes depend on it");
+
 // dynamically allocate buffer data, works like union, used to access pool or allocated memory
 class BufferData {
 public:
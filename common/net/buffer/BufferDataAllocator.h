@@ -3,6 +3,7 @@
 
 #include <climits>
 #include "BufferData.h"
+#include "ThreadBufferPool.h"
 #include "net/common/NetData.h"
 
 namespace midas {
@@ -35,6 +36,13 @@ struct FastPoolAllocator {
     void* operator()(size_t n) const { return FastBufferPool<S, Tag, AllocatorType, ChunkSize>::malloc(n); }
 };
 
+// per thread free list, buffer freed on other thread returns to owner thread
+template <size_t S, typename Tag = DefaultPoolTag, size_t ChunkSize = 0>
+struct ThreadPoolAllocator {
+    static const size_t max_size = S;  // for chunk allocation
+    void* operator()(size_t n) const { return ThreadBufferPool<S, Tag, ChunkSize>::malloc(n); }
+};
+
 template <typename AllocT1 = HeapAllocator, typename AllocT2 = HeapAllocator, typename AllocT3 = HeapAllocator>
 struct Allocator {
     typedef char value_type;
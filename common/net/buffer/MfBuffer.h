@@ -433,11 +433,11 @@ public:
 
 struct MfBufferPoolTag {};
 static const size_t fastSize1 = BufferSize<128>::size;
-typedef FastPoolAllocator<fastSize1, MfBufferPoolTag> PoolAlloc1;
+typedef ThreadPoolAllocator<fastSize1, MfBufferPoolTag> PoolAlloc1;
 static const size_t fastSize2 = BufferSize<256>::size;
-typedef FastPoolAllocator<fastSize2, MfBufferPoolTag> PoolAlloc2;
+typedef ThreadPoolAllocator<fastSize2, MfBufferPoolTag> PoolAlloc2;
 static const size_t fastSize3 = BufferSize<512>::size;
-typedef FastPoolAllocator<fastSize3, MfBufferPoolTag> PoolAlloc3;
+typedef ThreadPoolAllocator<fastSize3, MfBufferPoolTag> PoolAlloc3;
 
 template <typename AllocT1 = PoolAlloc1, typename AllocT2 = PoolAlloc2, typename AllocT3 = PoolAlloc3>
 class MfBufferAlloc : public TMfBuffer<Allocator<AllocT1, AllocT2, AllocT3>> {
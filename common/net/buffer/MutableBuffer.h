@@ -51,7 +51,7 @@ public:
         if (capacity() < newSize) {
             // reallocate 50% larger buffer
             size_t newCapacity = newSize + newSize / 2;
-            BufferDataPtr newData(new (heap_allocator(newCapacity)) BufferData);
+            BufferDataPtr newData(new (thread_pool_allocator(newCapacity)) BufferData);
             size_t oldSize = size();
             memcpy(newData->data, bdp->data, oldSize);
             newData->prefix().size = oldSize;
@@ -0,0 +1,232 @@
+#ifndef MIDAS_THREAD_BUFFER_POOL_H
+#define MIDAS_THREAD_BUFFER_POOL_H
+
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <vector>
+#include "BufferData.h"
+#include "midas/MidasException.h"
+#include "net/common/NetData.h"
+
+namespace midas {
+
+/**
+ * pool statistics of all size classes in use, each pool registers itself on first allocation
+ */
+class BufferPoolRegistry {
+public:
+    typedef std::function<void(std::ostream&)> TStats;
+
+private:
+    std::mutex mtx;
+    std::vector<TStats> pools;
+
+public:
+    static BufferPoolRegistry& instance() {
+        static BufferPoolRegistry registry;
+        return registry;
+    }
+
+    void add(const TStats& stats) {
+        std::lock_guard<std::mutex> guard(mtx);
+        pools.push_back(stats);
+    }
+
+    void report(std::ostream& os) {
+        std::lock_guard<std::mutex> guard(mtx);
+        if (pools.empty()) {
+            os << "no buffer pool in use" << '\n';
+            return;
+        }
+        for (auto& stats : pools) stats(os);
+    }
+};
+
+/**
+ * size class S of BufferData with one free list per thread
+ * allocation pops from calling thread's own list, no atomic op on hit
+ * buffer freed by owner thread goes back to owner list directly, buffer freed by other thread is pushed to
+ * owner's lock free return stack, owner takes whole stack by one exchange when own list runs empty
+ * cache of exited thread is orphaned and adopted by next thread using this pool, memory is never returned to os
+ * ChunkSize 0 carves about 1M per refill, between 1 and 64 buffers
+ */
+template <size_t S, typename Tag = DefaultPoolTag, size_t ChunkSize = 0>
+class ThreadBufferPool {
+public:
+    static const size_t poolSize = (sizeof(BufferPrefix) + S + 63) / 64 * 64;
+    static const size_t chunkCount =
+        ChunkSize ? ChunkSize : ((1 << 20) / poolSize > 64 ? 64 : ((1 << 20) / poolSize ? (1 << 20) / poolSize : 1));
+
+    struct Cache {
+        BufferData* local{nullptr};  // owner thread only
+        std::atomic<bool> isOrphan{false};
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};  // allocation which has to carve a new chunk
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> localFrees{0};
+        std::atomic<uint64_t> chunks{0};
+        char padding[64];
+        std::atomic<BufferData*> remote{nullptr};  // returned by other threads
+        std::atomic<uint64_t> remoteFrees{0};
+    };
+
+public:
+    /**
+     * every slot reports capacity S whether carved or recycled, larger request belongs to a larger size class
+     */
+    static void* malloc(size_t n) {
+        if (n > S) THROW_MIDAS_EXCEPTION("buffer of " << n << " bytes exceeds pool size class " << S);
+        Cache& cache = local_cache();
+        BufferData* p = cache.local;
+        if (!p) p = cache.remote.exchange(nullptr, std::memory_order_acquire);
+        if (p) {
+            cache.local = p->prefix().next;
+            bump(cache.hits);
+        } else {
+            p = refill(cache);
+            bump(cache.misses);
+        }
+        bump(cache.allocations);
+
+        BufferPrefix* prefix = ::new (&p->prefix()) BufferPrefix(S, ThreadBufferPool::malloc, ThreadBufferPool::free);
+        prefix->owner = &cache;
+        return p;
+    }
+
+    // owner shares storage with next, so read it before buffer is linked into a list
+    static void free(void* ptr) {
+        BufferData* p = reinterpret_cast<BufferData*>(ptr);
+        Cache* owner = static_cast<Cache*>(p->prefix().owner);
+        if (owner == holder().cache) {
+            p->prefix().next = owner->local;
+            owner->local = p;
+            bump(owner->localFrees);
+        } else {
+            BufferData* head = owner->remote.load(std::memory_order_relaxed);
+            do {
+                p->prefix().next = head;
+            } while (!owner->remote.compare_exchange_weak(head, p, std::memory_order_release,
+                                                          std::memory_order_relaxed));
+            owner->remoteFrees.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * one line summed over all thread caches, outstanding is allocated but not yet freed
+     */
+    static void stats(std::ostream& os) {
+        uint64_t hits = 0, misses = 0, allocations = 0, frees = 0, remoteFrees = 0, chunks = 0;
+        size_t threads = 0;
+        {
+            std::lock_guard<std::mutex> guard(registry_mutex());
+            for (Cache* c : caches()) {
+                hits += c->hits.load(std::memory_order_relaxed);
+                misses += c->misses.load(std::memory_order_relaxed);
+                allocations += c->allocations.load(std::memory_order_relaxed);
+                frees += c->localFrees.load(std::memory_order_relaxed);
+                remoteFrees += c->remoteFrees.load(std::memory_order_relaxed);
+                chunks += c->chunks.load(std::memory_order_relaxed);
+                if (!c->isOrphan.load(std::memory_order_relaxed)) ++threads;
+            }
+        }
+        frees += remoteFrees;
+        uint64_t outstanding = allocations > frees ? allocations - frees : 0;
+        os << "buffer pool " << S << " threads " << threads << " hits " << hits << " misses " << misses
+           << " remote frees " << remoteFrees << " outstanding " << outstanding << " bytes outstanding "
+           << outstanding * S << " bytes reserved " << chunks * chunkCount * poolSize << '\n';
+    }
+
+private:
+    struct Holder {
+        Cache* cache{nullptr};
+        ~Holder() {
+            if (cache) cache->isOrphan.store(true, std::memory_order_release);
+            cache = nullptr;
+        }
+    };
+
+    static Holder& holder() {
+        static thread_local Holder h;
+        return h;
+    }
+
+    static Cache& local_cache() {
+        Holder& h = holder();
+        if (!h.cache) h.cache = adopt_or_create();
+        return *h.cache;
+    }
+
+    static Cache* adopt_or_create() {
+        Cache* cache = new Cache;
+        bool isFirst;
+        {
+            std::lock_guard<std::mutex> guard(registry_mutex());
+            std::vector<Cache*>& all = caches();
+            for (Cache* c : all) {
+                bool expected = true;
+                if (c->isOrphan.compare_exchange_strong(expected, false, std::memory_order_acquire)) {
+                    delete cache;
+                    return c;
+                }
+            }
+            isFirst = all.empty();
+            all.push_back(cache);
+        }
+        // outside of pool lock since report takes registry lock before pool lock
+        if (isFirst) BufferPoolRegistry::instance().add(&ThreadBufferPool::stats);
+        return cache;
+    }
+
+    /**
+     * carve one chunk, first buffer is returned and the rest go to local list
+     */
+    static BufferData* refill(Cache& cache) {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, 64, chunkCount * poolSize) != 0) throw std::bad_alloc();
+        bump(cache.chunks);
+
+        char* p = static_cast<char*>(memory);
+        BufferData* first = (::new (p) BufferPrefix(S, ThreadBufferPool::malloc, ThreadBufferPool::free))->data();
+        for (size_t i = 1; i < chunkCount; ++i) {
+            p += poolSize;
+            BufferPrefix* prefix = ::new (p) BufferPrefix(S, ThreadBufferPool::malloc, ThreadBufferPool::free);
+            prefix->next = cache.local;
+            cache.local = prefix->data();
+        }
+        return first;
+    }
+
+    // single writer counter, readers only need a relaxed view
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    static std::mutex& registry_mutex() {
+        static std::mutex mtx;
+        return mtx;
+    }
+
+    static std::vector<Cache*>& caches() {
+        static std::vector<Cache*> all;
+        return all;
+    }
+};
+
+/**
+ * smallest thread pool size class holding n, from 128 to 64K payload, heap beyond that
+ */
+inline void* thread_pool_allocator(size_t n) {
+    if (n <= 128) return ThreadBufferPool<128>::malloc(n);
+    if (n <= 512) return ThreadBufferPool<512>::malloc(n);
+    if (n <= 2048) return ThreadBufferPool<2048>::malloc(n);
+    if (n <= 8192) return ThreadBufferPool<8192>::malloc(n);
+    if (n <= 65536) return ThreadBufferPool<65536>::malloc(n);
+    return heap_allocator(n);
+}
+}
+
+#endif
@@ -16,6 +16,7 @@
 #include "midas/Lock.h"
 #include "midas/MidasConstants.h"
 #include "net/buffer/ConstBuffer.h"
+#include "process/ThreadPlacement.h"
 #include "process/admin/MidasAdminBase.h"
 #include "utils/ConvertHelper.h"
 #include "utils/MidasUtils.h"
@@ -92,11 +93,9 @@ public:
     void run(bool enableThrow = true, int workers = -1) {
         string localLabel{label};
         MIDAS_LOG_INFO("thread " << localLabel << " running... ");
-        if (!affinity.empty()) {
-            MIDAS_LOG_INFO("set cpu affinity for channel " << localLabel << " to " << affinity);
-            set_cpu_affinity(get_tid(), affinity);
-        }
         if (workers == -1) workers = ++workerCount;
+        // cpu_affinity of channel takes precedence over midas.threads.channel
+        ThreadPlacement::instance().place(localLabel, "channel", workers - 1, affinity);
         if (workers == 1) iosvc.reset();
         for (;;) {
             try {
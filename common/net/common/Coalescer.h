@@ -0,0 +1,129 @@
+#ifndef MIDAS_COALESCER_H
+#define MIDAS_COALESCER_H
+
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include "midas/MidasConfig.h"
+
+using namespace std;
+
+namespace midas {
+
+/**
+ * coalescing mode of async publisher, msgs delivered while sender holds are flushed by one syscall
+ * sender holds pending msgs until they reach byte budget or window timer fires, whichever first
+ * all calls but budget_crossed are made by the sender that owns the send flag, on its strand
+ * config: <cfg>.coalesce_window (time duration, 0 disables coalescing), <cfg>.coalesce_bytes
+ */
+class Coalescer {
+public:
+    uint64_t window;  // in ns
+    long byteBudget;
+    uint64_t batches{0};        // coalesced batches sent, each one released by budget or window
+    uint64_t writes{0};         // number of syscalls issued for coalesced batches
+    uint64_t msgs{0};           // msgs sent by those syscalls
+    uint64_t maxBatch{0};       // largest batch in msgs
+    uint64_t budgetFlushes{0};  // batches released by byte budget
+    uint64_t windowFlushes{0};  // batches released by window timer
+
+private:
+    boost::asio::deadline_timer timer;
+    bool isArmed{false};
+
+public:
+    Coalescer(const string& cfg, boost::asio::io_service& iosvc)
+        : window(Config::instance()
+                     .get<boost::posix_time::time_duration>(cfg + ".coalesce_window", boost::posix_time::microseconds(0))
+                     .total_nanoseconds()),
+          byteBudget(Config::instance().get<long>(cfg + ".coalesce_bytes", 65536)),
+          timer(iosvc) {}
+
+    bool enabled() const { return window != 0; }
+
+    bool armed() const { return isArmed; }
+
+    /**
+     * producer side, true for the one msg whose push made pending bytes reach byte budget
+     */
+    bool budget_crossed(long pendingBytes, size_t msgBytes) const {
+        return pendingBytes >= byteBudget && pendingBytes - static_cast<long>(msgBytes) < byteBudget;
+    }
+
+    /**
+     * hold pending msgs, arms window timer unless it is armed already
+     * @param onWindow strand wrapped handler of timer, it must call expire() to tell a stale wake up
+     * @return true if byte budget is reached and batch shall be sent now
+     */
+    template <typename Handler>
+    bool hold(long pendingBytes, Handler&& onWindow) {
+        if (release(pendingBytes)) return true;
+        if (!isArmed) {
+            isArmed = true;
+            timer.expires_from_now(boost::posix_time::microseconds(static_cast<int64_t>((window + 999) / 1000)));
+            timer.async_wait(std::forward<Handler>(onWindow));
+        }
+        return false;
+    }
+
+    /**
+     * budget reached while timer is armed, timer is cancelled
+     * @return true if batch shall be sent now
+     */
+    bool release(long pendingBytes) {
+        if (pendingBytes < byteBudget) return false;
+        if (isArmed) {
+            isArmed = false;
+            timer.cancel();
+        }
+        ++budgetFlushes;
+        return true;
+    }
+
+    /**
+     * called by window handler, a handler cancelled too late or of an earlier window is stale
+     * @return true if batch shall be sent now
+     */
+    bool expire(const boost::system::error_code& ec) {
+        if (ec == boost::asio::error::operation_aborted || !isArmed ||
+            timer.expires_at() > boost::asio::deadline_timer::traits_type::now()) {
+            return false;
+        }
+        isArmed = false;
+        ++windowFlushes;
+        return true;
+    }
+
+    void cancel() {
+        isArmed = false;
+        timer.cancel();
+    }
+
+    void count(size_t writeCount, size_t msgCount) {
+        ++batches;
+        writes += writeCount;
+        msgs += msgCount;
+        maxBatch = std::max<uint64_t>(maxBatch, msgCount);
+    }
+
+    double msgs_per_write() const { return writes ? static_cast<double>(msgs) / writes : 0; }
+
+    void stats(ostream& os) const {
+        os << "coalesce window  = " << window / 1000 << " usec" << '\n'
+           << "coalesce bytes   = " << byteBudget << '\n'
+           << "coalesce batches = " << batches << '\n'
+           << "coalesce writes  = " << writes << '\n'
+           << "coalesce msgs    = " << msgs << '\n'
+           << "msgs per write   = " << msgs_per_write() << '\n'
+           << "max batch        = " << maxBatch << '\n'
+           << "budget flushes   = " << budgetFlushes << '\n'
+           << "window flushes   = " << windowFlushes << '\n';
+    }
+};
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define MIDAS_PUBLISHER_ASYNC_H
 
 #include <tbb/atomic.h>
+#include <boost/asio/placeholders.hpp>
 #include <boost/system/error_code.hpp>
 #include <iostream>
 #include <sstream>
@@ -9,6 +10,7 @@
 #include "net/buffer/ConstBuffer.h"
 #include "net/buffer/ConstBufferSequence.h"
 #include "net/channel/Channel.h"
+#include "net/common/Coalescer.h"
 #include "utils/Backoff.h"
 
 using namespace std;
@@ -20,6 +22,7 @@ namespace midas {
  * io thread will consume msgs to send to clients.
  * if total pending msgs exceed given threshold, the connection will be closed
  * slow clients will be disconnected
+ * in coalescing mode msgs are held up to coalesce_window or coalesce_bytes and sent by one gather write
  */
 template <typename Protocol, typename Derived, template <typename, typename> class PublisherBase,
           bool ThreadPerConnection, size_t WriteThreshold>
@@ -31,6 +34,7 @@ public:
     uint64_t pollTime;           // poll time for non-blocking mode before block
     tbb::atomic<bool> sendFlag;  // indicate in progress sending
     BufferManager buffer;
+    Coalescer coalescer;
 
 public:
     PublisherAsync(CChannel& channel, const string& cfg)
@@ -38,7 +42,8 @@ public:
           writeThreshold(Config::instance().get<long>(cfg + ".writelist_threshold", WriteThreshold)),
           pollTime(Config::instance()
                        .get<boost::posix_time::time_duration>(cfg + ".poll_time", boost::posix_time::microseconds(100))
-                       .total_nanoseconds()) {
+                       .total_nanoseconds()),
+          coalescer(cfg, channel.iosvc) {
         sendFlag = false;
     }
 
@@ -50,6 +55,7 @@ public:
         os << "threshold        = " << writeThreshold << '\n'
            << "poll time        = " << pollTime / 1000 << " usec" << '\n'
            << "bytes wait       = " << buffer.pending_bytes() << '\n';
+        coalescer.stats(os);
     }
 
     /**
@@ -67,9 +73,14 @@ public:
             }
             if (!sendFlag.compare_and_swap(true, false)) {
                 // no other consumer can run at this stage so safe to swap
-                this->_strand.post(
-                    boost::bind(&PublisherAsync::async_send<ConstBufferSequence>, (Derived*)this, buffer.swap()));
+                this->_strand.post(boost::bind(&PublisherAsync::send_pending, (Derived*)this));
+            } else if (coalescer.enabled() && coalescer.budget_crossed(pendingBytes, msg.size())) {
+                // batch held by window timer may go now
+                this->_strand.post(boost::bind(&PublisherAsync::flush_budget, (Derived*)this));
             }
+        } else if (coalescer.enabled()) {
+            buffer.push_back(msg);
+            this->_strand.post(boost::bind(&PublisherAsync::flush, (Derived*)this));
         } else {
             // no other consumer can run at this stage so safe to swap
             if (!buffer.empty()) {
@@ -105,8 +116,52 @@ public:
         }
     }
 
+    /**
+     * send pending msgs if they reach byte budget, otherwise hold them until window timer fires
+     * called on strand, caller owns sendFlag
+     */
+    void flush() {
+        if (this->closed()) {
+            sendFlag = false;
+            return;
+        }
+        if (coalescer.hold(buffer.pending_bytes(),
+                           this->_strand.wrap(boost::bind(&PublisherAsync::on_window,
+                                                          typename TPublisherBase::SharedPtr((Derived*)this),
+                                                          boost::asio::placeholders::error)))) {
+            async_send(buffer.swap());
+        }
+    }
+
+    /**
+     * caller owns sendFlag, in coalescing mode pending msgs still wait for window or byte budget
+     */
+    void send_pending() {
+        if (coalescer.enabled()) {
+            flush();
+        } else {
+            async_send(buffer.swap());
+        }
+    }
+
+    void flush_budget() {
+        if (!this->closed() && coalescer.armed() && coalescer.release(buffer.pending_bytes())) {
+            async_send(buffer.swap());
+        }
+    }
+
+    void on_window(const boost::system::error_code& ec) {
+        if (!coalescer.expire(ec)) return;
+        if (this->closed()) {
+            sendFlag = false;
+            return;
+        }
+        async_send(buffer.swap());
+    }
+
     template <typename BufferType>
     void async_send(const BufferType& b) {
+        count_write(b);
         try {
             boost::asio::async_write(
                 this->skt, b, this->_strand.wrap(boost::bind(
@@ -131,13 +186,13 @@ public:
                 while (buffer.empty() && (ntime() - pollStartTime) < pollTime) backOff.pause();
             }
 
-            if (!buffer.empty())
-                async_send(buffer.swap());
-            else {
+            if (!buffer.empty()) {
+                send_pending();
+            } else {
                 sendFlag = false;
                 // make sure that other thread do not put something on queue
                 if (!buffer.empty() && !sendFlag.compare_and_swap(true, false)) {
-                    async_send(buffer.swap());
+                    send_pending();
                 }
             }
         } else {
@@ -147,6 +202,11 @@ public:
         }
     }
 
+    void count_write(const ConstBuffer&) { coalescer.count(1, 1); }
+
+    // asio gathers at most 64 buffers per writev
+    void count_write(const ConstBufferSequence& b) { coalescer.count((b.size() + 63) / 64, b.size()); }
+
     friend class PublisherBase<Protocol, Derived>;
 };
 }
@@ -3,9 +3,25 @@
 
 #include <atomic>
 #include <boost/shared_ptr.hpp>
+#include <cstddef>
 
 namespace midas {
 
+/**
+ * entries of a sequence range as at most two contiguous parts, second part is set when range wraps around ring end
+ */
+template <typename Payload>
+struct RingView {
+    Payload* first{nullptr};
+    size_t firstCount{0};
+    Payload* second{nullptr};
+    size_t secondCount{0};
+
+    size_t size() const { return firstCount + secondCount; }
+
+    Payload& operator[](size_t i) const { return i < firstCount ? first[i] : second[i - firstCount]; }
+};
+
 template <typename Payload, class Derived>
 class ProducerBarrier {
 public:
@@ -18,6 +34,47 @@ public:
 
     void publish_entry(Payload& entry, bool isValid) { impl().publish_entry(entry, isValid); }
 
+    /**
+     * claim count consecutive entries in one go, fill each by entry_at then publish_batch
+     * @return last claimed sequence, first one is last - count + 1
+     */
+    long claim_batch(long count) { return impl().claim_batch(count); }
+
+    Payload& entry_at(long sequence) { return impl().entry_at(sequence); }
+
+    void publish_batch(long first, long last) { impl().publish_batch(first, last); }
+
+    /**
+     * build entry inside its slot, fill returns false to publish it as invalid so consumers skip it
+     */
+    template <typename Fill>
+    bool claim_and_publish(Fill&& fill) {
+        Payload& entry = get_next_entry();
+        const bool isValid = fill(entry);
+        publish_entry(entry, isValid);
+        return isValid;
+    }
+
+    /**
+     * build one entry per source in place, burst of more than one source is claimed and published as one batch
+     * fill(source, entry) returns false to publish that entry as invalid
+     */
+    template <typename Source, typename Fill>
+    size_t fill_and_publish(const Source* sources, size_t count, Fill&& fill) {
+        if (count == 1) {
+            claim_and_publish([&](Payload& entry) { return fill(sources[0], entry); });
+        } else if (count > 1) {
+            const long last = claim_batch(static_cast<long>(count));
+            const long first = last - static_cast<long>(count) + 1;
+            for (long sequence = first; sequence <= last; ++sequence) {
+                Payload& entry = entry_at(sequence);
+                entry.set_is_valid(fill(sources[sequence - first], entry));
+            }
+            publish_batch(first, last);
+        }
+        return count;
+    }
+
 private:
     Derived& impl() { return *static_cast<Derived*>(this); }
 };
@@ -32,6 +89,11 @@ public:
 
     Payload& get_entry(const long sequence) { return impl().get_entry(sequence); }
 
+    /**
+     * entries from first to last in place, both must be available from wait_for
+     */
+    RingView<Payload> get_view(const long first, const long last) { return impl().get_view(first, last); }
+
     template <typename TPostQueue>
     long wait_for(const long sequence, std::atomic<bool>& interruptRef, TPostQueue& queue) {
         return impl().wait_for(sequence, interruptRef, queue);
@@ -39,6 +101,11 @@ public:
 
     void interrupt() { impl().interrupt(); }
 
+    /**
+     * wake consumers gated on this one after its sequence moved
+     */
+    void signal_consumed() { impl().signal_consumed(); }
+
 private:
     Derived& impl() { return *static_cast<Derived*>(this); }
 };
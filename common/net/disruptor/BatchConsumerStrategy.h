@@ -25,6 +25,7 @@ public:
     using BaseType::isRunning;
     using BaseType::postQueueRef;
     using BaseType::consumerThreadPtr;
+    using BaseType::disruptorName;
     using BaseType::handle_post;
     using typename BaseType::TPostCallback;
     using typename BaseType::TPostQueue;
@@ -37,6 +38,7 @@ public:
 
     template <class Consumer, class Payload, class ConsumerBarrier, ConsumerStages Stages>
     void run(Consumer& consumerRef, ConsumerBarrier& consumerBarrierPtr) {
+        ThreadPlacement::instance().place(disruptorName, disruptorName);
         ConsumerDispatcher<Consumer, Payload, Stages> dispatcher;
         long availableSequence = 0;
         long nextSequence = 0;
@@ -77,6 +79,7 @@ public:
                     consumedTo.store(entry->get_sequence_value(), std::memory_order::memory_order_release);
                 }
             }
+            consumerBarrierPtr->signal_consumed();
         }
     }
 
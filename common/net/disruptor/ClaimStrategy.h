@@ -23,6 +23,12 @@ public:
 
     long increment_and_get() { return impl().increment_and_get(); }
 
+    /**
+     * claim delta sequences at once
+     * @return last claimed sequence
+     */
+    long increment_and_get(const long delta) { return impl().increment_and_get(delta); }
+
     void set_sequence(const long sequence) { impl().set_sequence(sequence); }
 
     std::string print() { return impl().print(); }
@@ -45,6 +51,8 @@ public:
 
     long increment_and_get() { return ++sequence; }
 
+    long increment_and_get(const long delta) { return sequence += delta; }
+
     void set_sequence(const long& sequence_) { sequence = sequence_; }
 
     std::string print() const { return "SINGLE_THREADED"; }
@@ -61,6 +69,10 @@ public:
 
     long increment_and_get() { return sequence.fetch_add(1, std::memory_order::memory_order_release) + 1; }
 
+    long increment_and_get(const long delta) {
+        return sequence.fetch_add(delta, std::memory_order::memory_order_release) + delta;
+    }
+
     void set_sequence(const long& sequence_) { sequence = sequence_; }
 
     std::string print() const { return "MULTI_THREADED"; }
@@ -8,8 +8,10 @@
 #include <boost/make_shared.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread.hpp>
+#include <limits>
 #include <string>
 #include <vector>
+#include "process/ThreadPlacement.h"
 #include "utils/log/Log.h"
 
 using namespace std;
@@ -31,6 +33,7 @@ public:
     std::atomic<bool> isRunning;
     ThreadPtr consumerThreadPtr;
     TPostQueue& postQueueRef;
+    const std::string disruptorName;  // also thread group in midas.threads
 
 private:
     TPostCallback postCallback;
@@ -39,8 +42,13 @@ private:
     std::vector<ConsumerStrategy::SharedPtr> otherConsumers;
 
 public:
-    ConsumerStrategy(TPostQueue& postQueue_, bool postHandler_, const std::string& disruptorName)
-        : consumedTo(-1), isRunning(true), postQueueRef(postQueue_), postHandler(postHandler_), isPaused(false) {}
+    ConsumerStrategy(TPostQueue& postQueue_, bool postHandler_, const std::string& disruptorName_)
+        : consumedTo(-1),
+          isRunning(true),
+          postQueueRef(postQueue_),
+          disruptorName(disruptorName_),
+          postHandler(postHandler_),
+          isPaused(false) {}
 
     virtual ~ConsumerStrategy() {}
 
@@ -48,7 +56,7 @@ public:
 
     template <class Consumer, class Payload, class ConsumerBarrier, ConsumerStages Stages>
     void start(ConsumerBarrier& consumerBarrierPtr, Consumer& consumerRef) {
-        impl().start<Consumer, Payload, ConsumerBarrier, Stages>(consumerBarrierPtr, consumerRef);
+        impl().template start<Consumer, Payload, ConsumerBarrier, Stages>(consumerBarrierPtr, consumerRef);
     }
 
     /**
@@ -56,7 +64,7 @@ public:
      */
     template <class Consumer, class Payload, class ConsumerBarrier, ConsumerStages Stages>
     void start(ConsumerBarrier& consumerBarrierPtr, Consumer& consumerRef, boost::asio::io_service& io) {
-        impl().start<Consumer, Payload, ConsumerBarrier, Stages>(consumerBarrierPtr, consumerRef, io);
+        impl().template start<Consumer, Payload, ConsumerBarrier, Stages>(consumerBarrierPtr, consumerRef, io);
     }
 
     template <class ConsumerBarrier>
@@ -124,6 +132,29 @@ private:
     Derived& impl() { return *static_cast<Derived*>(this); }
 };
 
+/**
+ * slowest of a set of consumers, a consumer gated on several upstream consumers or the producer gated on all
+ * terminal consumers waits on this the same way as on a single consumer
+ */
+template <class ConsumerStrategy>
+class SequenceGroup {
+public:
+    typedef boost::shared_ptr<SequenceGroup> SharedPtr;
+    typedef typename ConsumerStrategy::SharedPtr TConsumerPtr;
+    typedef typename ConsumerStrategy::TPostQueue TPostQueue;
+
+    const std::vector<TConsumerPtr> members;
+
+public:
+    explicit SequenceGroup(const std::vector<TConsumerPtr>& members_) : members(members_) {}
+
+    long get_consumption_point() const {
+        long minimum = std::numeric_limits<long>::max();
+        for (const TConsumerPtr& member : members) minimum = std::min(minimum, member->get_consumption_point());
+        return minimum;
+    }
+};
+
 template <class Consumer, class Payload, class RingBuffer, class ConsumerStrategy, ConsumerStages Stages>
 class ConsumerHolder {
 public:
@@ -167,12 +198,22 @@ template <class Consumer, class Payload>
 class ConsumerDispatcher<Consumer, Payload, ConsumerStages::OneStage> {
 public:
     void dispatch(Consumer& consumerRef, Payload& payload) { consumerRef.data_callback1(payload); }
+
+    void dispatch(Consumer& consumerRef, Payload& payload, bool hasMoreData) {
+        payload.set_has_more_data(hasMoreData);
+        consumerRef.data_callback1(payload);
+    }
 };
 
 template <class Consumer, class Payload>
 class ConsumerDispatcher<Consumer, Payload, ConsumerStages::TwoStage> {
 public:
     void dispatch(Consumer& consumerRef, Payload& payload) { consumerRef.data_callback2(payload); }
+
+    void dispatch(Consumer& consumerRef, Payload& payload, bool hasMoreData) {
+        payload.set_has_more_data(hasMoreData);
+        consumerRef.data_callback2(payload);
+    }
 };
 
 /**
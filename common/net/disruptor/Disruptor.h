@@ -9,6 +9,7 @@
 #include <vector>
 #include "BatchConsumerStrategy.h"
 #include "DisruptorImpl.h"
+#include "process/ThreadPlacement.h"
 #include "SequentialConsumerStrategy.h"
 
 using namespace std;
@@ -33,29 +34,37 @@ public:
         const uint32_t maxMsgSize = cfg.get<uint32_t>(cfgPath + ".max_msg_size", 4096);
         const uint32_t ringSizeExponent = cfg.get<uint32_t>(cfgPath + ".ring_size_exponent", 10);
         waitStrategy = cfg.get<std::string>(cfgPath + ".wait_strategy", "");
+        // ring buffer is first touched here, consumer thread spawned below inherits the node preference
+        NumaScope numaScope(cfg.get<int>(cfgPath + ".numa_node", -1));
 
         if (producers.size() > 1) {
             if (waitStrategy == BusySpinTag)
                 disruptorPtr = boost::make_shared<TMultiBusySpinDisruptor>(name_, maxMsgSize, ringSizeExponent,
-                                                                           producers, dataConsumer);
+                                                                           producers, dataConsumer, cfgPath);
             else if (waitStrategy == YieldTag)
                 disruptorPtr = boost::make_shared<TMultiYieldDisruptor>(name_, maxMsgSize, ringSizeExponent, producers,
-                                                                        dataConsumer);
+                                                                        dataConsumer, cfgPath);
             else if (waitStrategy == BlockTag)
                 disruptorPtr = boost::make_shared<TMultiBlockDisruptor>(name_, maxMsgSize, ringSizeExponent, producers,
-                                                                        dataConsumer);
+                                                                        dataConsumer, cfgPath);
+            else if (waitStrategy == AdaptiveTag)
+                disruptorPtr = boost::make_shared<TMultiAdaptiveDisruptor>(name_, maxMsgSize, ringSizeExponent,
+                                                                           producers, dataConsumer, cfgPath);
             else
                 THROW_MIDAS_EXCEPTION("Disruptor=" << name_ << " unknown wait_strategy=" << waitStrategy);
         } else {
             if (waitStrategy == BusySpinTag)
                 disruptorPtr = boost::make_shared<TSingleBusySpinDisruptor>(name_, maxMsgSize, ringSizeExponent,
-                                                                            producers, dataConsumer);
+                                                                            producers, dataConsumer, cfgPath);
             else if (waitStrategy == YieldTag)
                 disruptorPtr = boost::make_shared<TSingleYieldDisruptor>(name_, maxMsgSize, ringSizeExponent, producers,
-                                                                         dataConsumer);
+                                                                         dataConsumer, cfgPath);
             else if (waitStrategy == BlockTag)
                 disruptorPtr = boost::make_shared<TSingleBlockDisruptor>(name_, maxMsgSize, ringSizeExponent, producers,
-                                                                         dataConsumer);
+                                                                         dataConsumer, cfgPath);
+            else if (waitStrategy == AdaptiveTag)
+                disruptorPtr = boost::make_shared<TSingleAdaptiveDisruptor>(name_, maxMsgSize, ringSizeExponent,
+                                                                            producers, dataConsumer, cfgPath);
             else
                 THROW_MIDAS_EXCEPTION("Disruptor=" << name_ << " unknown wait_strategy=" << waitStrategy);
         }
@@ -89,6 +98,7 @@ public:
     static const std::string BusySpinTag;
     static const std::string YieldTag;
     static const std::string BlockTag;
+    static const std::string AdaptiveTag;
 
 private:
     typedef midas::DisruptorImpl<Producer, Consumer, Payload, Stages, MultiThreadedStrategy, BusySpinWaitStrategy,
@@ -103,6 +113,10 @@ private:
                                  ConsumerStrategy>
         TMultiBlockDisruptor;
 
+    typedef midas::DisruptorImpl<Producer, Consumer, Payload, Stages, MultiThreadedStrategy, AdaptiveWaitStrategy,
+                                 ConsumerStrategy>
+        TMultiAdaptiveDisruptor;
+
     typedef midas::DisruptorImpl<Producer, Consumer, Payload, Stages, SingleThreadedStrategy, BusySpinWaitStrategy,
                                  ConsumerStrategy>
         TSingleBusySpinDisruptor;
@@ -114,6 +128,10 @@ private:
     typedef midas::DisruptorImpl<Producer, Consumer, Payload, Stages, SingleThreadedStrategy, BlockWaitStrategy,
                                  ConsumerStrategy>
         TSingleBlockDisruptor;
+
+    typedef midas::DisruptorImpl<Producer, Consumer, Payload, Stages, SingleThreadedStrategy, AdaptiveWaitStrategy,
+                                 ConsumerStrategy>
+        TSingleAdaptiveDisruptor;
 };
 
 template <class Producer, class Consumer, class Payload, ConsumerStages Stages, class ConsumerStrategy>
@@ -124,6 +142,9 @@ const std::string Disruptor<Producer, Consumer, Payload, Stages, ConsumerStrateg
 
 template <class Producer, class Consumer, class Payload, ConsumerStages Stages, class ConsumerStrategy>
 const std::string Disruptor<Producer, Consumer, Payload, Stages, ConsumerStrategy>::BlockTag{"block"};
+
+template <class Producer, class Consumer, class Payload, ConsumerStages Stages, class ConsumerStrategy>
+const std::string Disruptor<Producer, Consumer, Payload, Stages, ConsumerStrategy>::AdaptiveTag{"adaptive"};
 }
 
 #endif
@@ -0,0 +1,360 @@
+#ifndef MIDAS_DISRUPTOR_GRAPH_H
+#define MIDAS_DISRUPTOR_GRAPH_H
+
+#include <midas/MidasConfig.h>
+#include <midas/MidasException.h>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "BatchConsumerStrategy.h"
+#include "ClaimStrategy.h"
+#include "Payload.h"
+#include "RingBuffer.h"
+#include "VarRingBuffer.h"
+#include "SequentialConsumerStrategy.h"
+#include "WaitStrategy.h"
+#include "process/ThreadPlacement.h"
+
+using namespace std;
+
+namespace midas {
+
+/**
+ * adapts a callback to the data_callback1 interface of consumer strategies
+ * payload is read by several consumers at once and must be treated as read only
+ */
+template <class Payload>
+class GraphConsumer {
+public:
+    typedef std::function<void(Payload&)> TCallback;
+
+    TCallback callback;
+    long receivedMsgCount{0};
+
+public:
+    explicit GraphConsumer(const TCallback& callback_) : callback(callback_) {}
+
+    void data_callback1(Payload& payload) {
+        ++receivedMsgCount;
+        callback(payload);
+    }
+};
+
+/**
+ * parallel consumers share the entry, so has_more_data is not written into it
+ */
+template <class Payload>
+class ConsumerDispatcher<GraphConsumer<Payload>, Payload, ConsumerStages::OneStage> {
+public:
+    void dispatch(GraphConsumer<Payload>& consumerRef, Payload& payload) { consumerRef.data_callback1(payload); }
+
+    void dispatch(GraphConsumer<Payload>& consumerRef, Payload& payload, bool hasMoreData) {
+        consumerRef.data_callback1(payload);
+    }
+};
+
+template <class Producer, class Payload, class ConsumerStrategy>
+class DisruptorGraphImplBase {
+public:
+    typedef boost::shared_ptr<DisruptorGraphImplBase> SharedPtr;
+    typedef typename GraphConsumer<Payload>::TCallback TCallback;
+
+    virtual ~DisruptorGraphImplBase() {}
+    virtual std::string name() const = 0;
+    virtual int add_consumer(const std::string& consumerName, const TCallback& callback,
+                             const std::vector<int>& after) = 0;
+    virtual void start() = 0;
+    virtual void post(const typename ConsumerStrategy::TPostCallback& cb) = 0;
+    virtual void stop() = 0;
+    virtual void stats(ostream& os) = 0;
+};
+
+/**
+ * every consumer runs on its own thread with its own sequence over the same ring buffer
+ * consumer without upstream reads as soon as producer publishes, consumer with upstream waits for the slowest of them
+ * producer is gated on terminal consumers only, which are behind all others
+ * each consumer takes all available entries in one go and publishes its sequence once per batch
+ */
+template <class Producer, class Payload, class ClaimStrategy, class WaitStrategy, class ConsumerStrategy>
+class DisruptorGraphImpl : public DisruptorGraphImplBase<Producer, Payload, ConsumerStrategy> {
+public:
+    typedef typename RingBufferOf<Payload, ClaimStrategy, WaitStrategy, ConsumerStrategy>::type TRingBuffer;
+    typedef typename TRingBuffer::TSequenceGroup TSequenceGroup;
+    typedef ConsumerHolder<GraphConsumer<Payload>, Payload, TRingBuffer, ConsumerStrategy, ConsumerStages::OneStage>
+        THolder;
+    typedef std::vector<typename Producer::SharedPtr> TProducerStore;
+    typedef typename GraphConsumer<Payload>::TCallback TCallback;
+    typedef typename ConsumerStrategy::TPostCallback TPostCallback;
+    typedef typename ConsumerStrategy::TPostQueue TPostQueue;
+
+private:
+    struct Node {
+        std::string name;
+        std::vector<int> after;
+        bool isTerminal{true};
+        GraphConsumer<Payload> consumer;  // holder keeps a reference, node address must be stable
+        typename THolder::SharedPtr holderPtr;
+
+        Node(const std::string& name_, const std::vector<int>& after_, const TCallback& callback)
+            : name(name_), after(after_), consumer(callback) {}
+    };
+
+    const std::string disruptorName;
+    TProducerStore producers;
+    typename TRingBuffer::SharedPtr ringBufferPtr;
+    typename TRingBuffer::TProducerBarrier::SharedPtr producerBarrierPtr;
+    std::vector<std::unique_ptr<Node>> nodes;
+    TPostQueue postQueue;
+    long receivedMsgCount{0};
+
+public:
+    DisruptorGraphImpl(std::string disruptorName_, const uint32_t maxMsgSize_, const uint32_t ringSizeExponent_,
+                       TProducerStore& producers_, const std::string& cfgPath = std::string())
+        : disruptorName(disruptorName_),
+          producers(producers_),
+          ringBufferPtr(new TRingBuffer(maxMsgSize_, (uint32_t)pow(2, ringSizeExponent_), disruptorName_, cfgPath)) {}
+
+    ~DisruptorGraphImpl() {
+        stop();
+        nodes.clear();
+    }
+
+    /**
+     * @param after ids of upstream consumers returned by earlier add_consumer, empty to read from producer directly
+     * @return id of new consumer
+     */
+    int add_consumer(const std::string& consumerName, const TCallback& callback, const std::vector<int>& after) {
+        if (producerBarrierPtr) THROW_MIDAS_EXCEPTION("Disruptor=" << disruptorName << " already started");
+        for (int id : after) {
+            if (id < 0 || id >= static_cast<int>(nodes.size()))
+                THROW_MIDAS_EXCEPTION("Disruptor=" << disruptorName << " consumer " << consumerName
+                                                   << " has unknown upstream " << id);
+        }
+
+        std::unique_ptr<Node> node(new Node(consumerName, after, callback));
+        typename TRingBuffer::TConsumerBarrier::SharedPtr barrierPtr;
+        if (after.empty()) {
+            barrierPtr = ringBufferPtr->create_consumer_barrier();
+        } else {
+            std::vector<typename TSequenceGroup::TConsumerPtr> upstream;
+            for (int id : after) {
+                upstream.push_back(nodes[id]->holderPtr->get_consumer_handler());
+                nodes[id]->isTerminal = false;
+            }
+            barrierPtr = ringBufferPtr->create_consumer_barrier(boost::make_shared<TSequenceGroup>(upstream));
+        }
+
+        // first consumer runs posted callbacks while others pause
+        const bool postHandler = nodes.empty();
+        node->holderPtr = boost::make_shared<THolder>(barrierPtr, node->consumer, postQueue, postHandler,
+                                                      disruptorName + "." + consumerName);
+        if (!postHandler) {
+            nodes.front()->holderPtr->get_consumer_handler()->add_other_consumer(
+                node->holderPtr->get_consumer_handler());
+        }
+        MIDAS_LOG_INFO(disruptorName << " consumer " << consumerName << " created.");
+
+        nodes.push_back(std::move(node));
+        return static_cast<int>(nodes.size()) - 1;
+    }
+
+    /**
+     * gate producer on terminal consumers and start taking data from producers
+     */
+    void start() {
+        if (nodes.empty()) THROW_MIDAS_EXCEPTION("Disruptor=" << disruptorName << " has no consumer");
+        if (producerBarrierPtr) return;
+
+        std::vector<typename TSequenceGroup::TConsumerPtr> terminals;
+        for (auto& node : nodes) {
+            if (node->isTerminal) terminals.push_back(node->holderPtr->get_consumer_handler());
+        }
+        producerBarrierPtr =
+            ringBufferPtr->create_producer_barrier(producers.size() > 1, boost::make_shared<TSequenceGroup>(terminals));
+        setup_producers();
+    }
+
+    std::string name() const { return disruptorName; }
+
+    void post(const TPostCallback& cb) {
+        postQueue.push(cb);
+        for (auto& node : nodes) node->holderPtr->interrupt();
+    }
+
+    void stop() override {
+        for (auto& node : nodes) node->holderPtr->stop();
+    }
+
+    void stats(ostream& os) {
+        const long cursor = ringBufferPtr->get_cursor();
+        os << "Disruptor stats:" << '\n' << "msgs recv        = " << receivedMsgCount << '\n';
+        for (auto& node : nodes) {
+            os << "consumer " << node->name << " msgs " << node->consumer.receivedMsgCount << " lag "
+               << cursor - node->holderPtr->get_consumer_handler()->get_consumption_point() << " after";
+            if (node->after.empty()) os << " producer";
+            for (int id : node->after) os << ' ' << nodes[id]->name;
+            os << '\n';
+        }
+        ringBufferPtr->waitStrategyPtr->stats(os);
+    }
+
+private:
+    template <typename PL = Payload>
+    typename std::enable_if<std::is_base_of<typename midas::Payload, PL>::value, void>::type setup_producers() {
+        for_each(producers.begin(), producers.end(), [this](typename Producer::SharedPtr producerPtr) {
+            producerPtr->register_data_callback(
+                [this](const char* data, size_t size, uint64_t rcvt, int64_t id) -> std::size_t {
+                    ++receivedMsgCount;
+                    Payload& entry = producerBarrierPtr->get_next_entry();
+                    bool isValid = entry.set_value(data, size, rcvt, id);
+                    producerBarrierPtr->publish_entry(entry, isValid);
+                    return size;
+                });
+        });
+    }
+
+    template <typename PL = Payload, typename P = Producer>
+    typename std::enable_if<!std::is_base_of<typename midas::Payload, PL>::value && !has_fill_source<P>::value &&
+                                !std::is_same<PL, VarRecord>::value,
+                            void>::type
+    setup_producers() {
+        for_each(producers.begin(), producers.end(), [this](typename Producer::SharedPtr producerPtr) {
+            producerPtr->register_data_callback(
+                [this](const typename Payload::ElementType& data, uint64_t rcvt, int64_t id) -> std::size_t {
+                    ++receivedMsgCount;
+                    Payload& entry = producerBarrierPtr->get_next_entry();
+                    bool isValid = entry.set_value(data, rcvt, id);
+                    producerBarrierPtr->publish_entry(entry, isValid);
+                    return 0;
+                });
+        });
+    }
+
+    template <typename P = Producer>
+    typename std::enable_if<has_fill_source<P>::value, void>::type setup_producers() {
+        for_each(producers.begin(), producers.end(), [this](typename Producer::SharedPtr producerPtr) {
+            Producer* producer = producerPtr.get();
+            producerPtr->register_data_callback(
+                [this, producer](const typename Producer::SourceType* sources, size_t count, uint64_t rcvt,
+                                 int64_t id) -> std::size_t {
+                    receivedMsgCount += count;
+                    return producerBarrierPtr->fill_and_publish(
+                        sources, count,
+                        [producer, rcvt, id](const typename Producer::SourceType& source, Payload& entry) {
+                            return producer->fill(source, entry.claim_data(rcvt, id), entry.get_sequence_value());
+                        });
+                });
+        });
+    }
+
+    template <typename PL = Payload>
+    typename std::enable_if<std::is_same<PL, VarRecord>::value, void>::type setup_producers() {
+        for_each(producers.begin(), producers.end(), [this](typename Producer::SharedPtr producerPtr) {
+            producerPtr->register_data_callback(
+                [this](const char* data, size_t size, uint64_t rcvt, int64_t id) -> std::size_t {
+                    ++receivedMsgCount;
+                    VarRecord& record = producerBarrierPtr->claim(size);
+                    bool isValid = record.set_value(data, size, rcvt, id);
+                    producerBarrierPtr->publish_entry(record, isValid);
+                    return size;
+                });
+        });
+    }
+};
+
+/**
+ * disruptor with a dag of consumers over one ring buffer, configured the same way as Disruptor
+ * usage: construct, add_consumer for each stage in topological order, then start
+ */
+template <class Producer, class Payload, class ConsumerStrategy = SequentialConsumerStrategy<> >
+class DisruptorGraph {
+public:
+    typedef boost::shared_ptr<DisruptorGraph> SharedPtr;
+    typedef typename ConsumerStrategy::TPostCallback TPostCallback;
+    typedef typename GraphConsumer<Payload>::TCallback TCallback;
+
+    typename DisruptorGraphImplBase<Producer, Payload, ConsumerStrategy>::SharedPtr disruptorPtr;
+    std::string waitStrategy;
+    size_t ringSize{0};  // entries in ring, size of SideRing riding along
+
+public:
+    DisruptorGraph(const std::string& name_, const std::string& cfgPath,
+                   std::vector<typename Producer::SharedPtr>& producers) {
+        midas::Config& cfg = midas::Config::instance();
+        const uint32_t maxMsgSize = cfg.get<uint32_t>(cfgPath + ".max_msg_size", 4096);
+        const uint32_t ringSizeExponent = cfg.get<uint32_t>(cfgPath + ".ring_size_exponent", 10);
+        waitStrategy = cfg.get<std::string>(cfgPath + ".wait_strategy", "");
+        ringSize = size_t(1) << ringSizeExponent;
+        NumaScope numaScope(cfg.get<int>(cfgPath + ".numa_node", -1));
+
+        const bool isMulti = producers.size() > 1;
+        if (waitStrategy == BusySpinTag)
+            disruptorPtr = create<BusySpinWaitStrategy>(isMulti, name_, cfgPath, maxMsgSize, ringSizeExponent, producers);
+        else if (waitStrategy == YieldTag)
+            disruptorPtr = create<YieldWaitStrategy>(isMulti, name_, cfgPath, maxMsgSize, ringSizeExponent, producers);
+        else if (waitStrategy == BlockTag)
+            disruptorPtr = create<BlockWaitStrategy>(isMulti, name_, cfgPath, maxMsgSize, ringSizeExponent, producers);
+        else if (waitStrategy == AdaptiveTag)
+            disruptorPtr = create<AdaptiveWaitStrategy>(isMulti, name_, cfgPath, maxMsgSize, ringSizeExponent, producers);
+        else
+            THROW_MIDAS_EXCEPTION("Disruptor=" << name_ << " unknown wait_strategy=" << waitStrategy);
+    }
+
+    std::string name() const { return disruptorPtr->name(); }
+
+    int add_consumer(const std::string& consumerName, const TCallback& callback,
+                     const std::vector<int>& after = std::vector<int>()) {
+        return disruptorPtr->add_consumer(consumerName, callback, after);
+    }
+
+    void start() { disruptorPtr->start(); }
+
+    void post(const TPostCallback& cb) { disruptorPtr->post(cb); }
+
+    void stop() { disruptorPtr->stop(); }
+
+    std::string wait_strategy() { return waitStrategy; }
+
+    size_t ring_size() const { return ringSize; }
+
+    void stats(ostream& os) { disruptorPtr->stats(os); }
+
+    static const std::string BusySpinTag;
+    static const std::string YieldTag;
+    static const std::string BlockTag;
+    static const std::string AdaptiveTag;
+
+private:
+    template <class WaitStrategy>
+    static typename DisruptorGraphImplBase<Producer, Payload, ConsumerStrategy>::SharedPtr create(
+        bool isMulti, const std::string& name_, const std::string& cfgPath, uint32_t maxMsgSize,
+        uint32_t ringSizeExponent, std::vector<typename Producer::SharedPtr>& producers) {
+        if (isMulti)
+            return boost::make_shared<
+                DisruptorGraphImpl<Producer, Payload, MultiThreadedStrategy, WaitStrategy, ConsumerStrategy> >(
+                name_, maxMsgSize, ringSizeExponent, producers, cfgPath);
+        return boost::make_shared<
+            DisruptorGraphImpl<Producer, Payload, SingleThreadedStrategy, WaitStrategy, ConsumerStrategy> >(
+            name_, maxMsgSize, ringSizeExponent, producers, cfgPath);
+    }
+};
+
+template <class Producer, class Payload, class ConsumerStrategy>
+const std::string DisruptorGraph<Producer, Payload, ConsumerStrategy>::BusySpinTag{"busy_spin"};
+
+template <class Producer, class Payload, class ConsumerStrategy>
+const std::string DisruptorGraph<Producer, Payload, ConsumerStrategy>::YieldTag{"yield"};
+
+template <class Producer, class Payload, class ConsumerStrategy>
+const std::string DisruptorGraph<Producer, Payload, ConsumerStrategy>::BlockTag{"block"};
+
+template <class Producer, class Payload, class ConsumerStrategy>
+const std::string DisruptorGraph<Producer, Payload, ConsumerStrategy>::AdaptiveTag{"adaptive"};
+}
+
+#endif
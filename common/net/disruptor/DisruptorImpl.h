@@ -10,6 +10,7 @@
 #include "ClaimStrategy.h"
 #include "Payload.h"
 #include "RingBuffer.h"
+#include "VarRingBuffer.h"
 #include "WaitStrategy.h"
 
 using namespace std;
@@ -32,7 +33,7 @@ template <class Producer, class Consumer, class Payload, ConsumerStages Stages,
           class ConsumerStrategy>
 class DisruptorImpl : public DisruptorImplBase<ConsumerStrategy> {
 public:
-    typedef RingBuffer<Payload, ClaimStrategy, WaitStrategy, ConsumerStrategy> TRingBuffer;
+    typedef typename RingBufferOf<Payload, ClaimStrategy, WaitStrategy, ConsumerStrategy>::type TRingBuffer;
     typedef NStageConsumer<Consumer, Payload, TRingBuffer, ConsumerStrategy, Stages> TStageConsumer;
     typedef std::vector<typename Producer::SharedPtr> TProducerStore;
 
@@ -50,10 +51,10 @@ private:
 
 public:
     DisruptorImpl(std::string disruptorName_, const uint32_t maxMsgSize_, const uint32_t ringSizeExponent_,
-                  TProducerStore& producers, Consumer& consumerRef_)
+                  TProducerStore& producers, Consumer& consumerRef_, const std::string& cfgPath = std::string())
         : disruptorName(disruptorName_),
           consumerRef(consumerRef_),
-          ringBufferPtr(new TRingBuffer(maxMsgSize_, (uint32_t)pow(2, ringSizeExponent_), disruptorName_)) {
+          ringBufferPtr(new TRingBuffer(maxMsgSize_, (uint32_t)pow(2, ringSizeExponent_), disruptorName_, cfgPath)) {
         consumerStagesPtr = boost::make_shared<TStageConsumer>(consumerRef_, ringBufferPtr, disruptorName_, postQueue);
 
         setup_producers(producers.size() > 1, producers);
@@ -84,9 +85,11 @@ public:
     }
 
     // Dealing with generic payload type
-    template <typename PL = Payload>
-    typename std::enable_if<!std::is_base_of<typename midas::Payload, PL>::value, void>::type setup_producers(
-        const bool multiProducer, TProducerStore& producers) {
+    template <typename PL = Payload, typename P = Producer>
+    typename std::enable_if<!std::is_base_of<typename midas::Payload, PL>::value && !has_fill_source<P>::value &&
+                                !std::is_same<PL, VarRecord>::value,
+                            void>::type
+    setup_producers(const bool multiProducer, TProducerStore& producers) {
         producerBarrierPtr =
             ringBufferPtr->create_producer_barrier(multiProducer, consumerStagesPtr->get_last_consumer());
 
@@ -102,6 +105,47 @@ public:
         });
     }
 
+    // Dealing with producer building entry in place
+    template <typename P = Producer>
+    typename std::enable_if<has_fill_source<P>::value, void>::type setup_producers(
+        const bool multiProducer, TProducerStore& producers) {
+        producerBarrierPtr =
+            ringBufferPtr->create_producer_barrier(multiProducer, consumerStagesPtr->get_last_consumer());
+
+        for_each(producers.begin(), producers.end(), [this](typename Producer::SharedPtr producerPtr) {
+            Producer* producer = producerPtr.get();
+            producerPtr->register_data_callback(
+                [this, producer](const typename Producer::SourceType* sources, size_t count, uint64_t rcvt,
+                                 int64_t id) -> std::size_t {
+                    receivedMsgCount += count;
+                    return producerBarrierPtr->fill_and_publish(
+                        sources, count,
+                        [producer, rcvt, id](const typename Producer::SourceType& source, Payload& entry) {
+                            return producer->fill(source, entry.claim_data(rcvt, id), entry.get_sequence_value());
+                        });
+                });
+        });
+    }
+
+    // Dealing with variable length records
+    template <typename PL = Payload>
+    typename std::enable_if<std::is_same<PL, VarRecord>::value, void>::type setup_producers(
+        const bool multiProducer, TProducerStore& producers) {
+        producerBarrierPtr =
+            ringBufferPtr->create_producer_barrier(multiProducer, consumerStagesPtr->get_last_consumer());
+
+        for_each(producers.begin(), producers.end(), [this](typename Producer::SharedPtr producerPtr) {
+            producerPtr->register_data_callback(
+                [this](const char* data, size_t size, uint64_t rcvt, int64_t id) -> std::size_t {
+                    ++receivedMsgCount;
+                    VarRecord& record = producerBarrierPtr->claim(size);
+                    bool isValid = record.set_value(data, size, rcvt, id);
+                    producerBarrierPtr->publish_entry(record, isValid);
+                    return size;
+                });
+        });
+    }
+
     std::string name() const { return disruptorName; }
 
     void post(const TPostCallback& cb) {
@@ -111,7 +155,10 @@ public:
 
     void stop() override { consumerStagesPtr->stop(); }
 
-    void stats(ostream& os) { os << "Disruptor stats:" << '\n' << "msgs recv        = " << receivedMsgCount << '\n'; }
+    void stats(ostream& os) {
+        os << "Disruptor stats:" << '\n' << "msgs recv        = " << receivedMsgCount << '\n';
+        ringBufferPtr->waitStrategyPtr->stats(os);
+    }
 };
 }
 
@@ -71,6 +71,15 @@ public:
         return true;
     }
 
+    /**
+     * for producer to build data inside the slot instead of copying it in by set_value
+     */
+    T& claim_data(const uint64_t rcvt_, uint64_t id_) {
+        rcvt = rcvt_;
+        id = id_;
+        return data_;
+    }
+
     const T& get_data() const { return data_; }
 
     bool is_valid() { return isValid; }
@@ -90,6 +99,17 @@ public:
     friend ostream& operator<<(ostream& s, const PayloadObject<U>);
 };
 
+/**
+ * producer declaring SourceType and bool fill(const SourceType&, ElementType&, long sequence) registers callback
+ * taking (const SourceType* sources, size_t count, uint64_t rcvt, int64_t id), disruptor then builds entry inside its
+ * slot, sequence of the entry lets producer fill a SideRing slot along with it
+ */
+template <typename Producer, typename = void>
+struct has_fill_source : std::false_type {};
+
+template <typename Producer>
+struct has_fill_source<Producer, decltype(void(sizeof(typename Producer::SourceType)))> : std::true_type {};
+
 template <class T>
 ostream& operator<<(ostream& s, const PayloadObject<T> payload) {
     s << "id_ " << payload.get_id() << " ,rcvt " << payload.get_rcvt() << " ," << payload.get_data();
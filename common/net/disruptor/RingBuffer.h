@@ -1,6 +1,7 @@
 #ifndef MIDAS_RINGBUFFER_H
 #define MIDAS_RINGBUFFER_H
 
+#include <algorithm>
 #include <atomic>
 #include <boost/lexical_cast.hpp>
 #include <boost/make_shared.hpp>
@@ -9,6 +10,8 @@
 #include <string>
 #include <vector>
 #include "Barrier.h"
+#include "ConsumerStrategy.h"
+#include "midas/MidasException.h"
 #include "utils/ConvertHelper.h"
 #include "utils/log/Log.h"
 
@@ -33,14 +36,14 @@ public:
     typename WaitStrategy::SharedPtr waitStrategyPtr;
 
 public:
-    RingBuffer(const uint32_t maxMsgSize, const size_t ringSize_, string name_)
+    RingBuffer(const uint32_t maxMsgSize, const size_t ringSize_, string name_, const string& cfgPath = string())
         : cursor(-1),
           bitMask(ringSize_ - 1),
           name(name_),
           ringSize(ringSize_),
           ring(ringSize_, Payload(maxMsgSize)),
           claimStrategyPtr(boost::make_shared<ClaimStrategy>()),
-          waitStrategyPtr(boost::make_shared<WaitStrategy>()) {
+          waitStrategyPtr(WaitStrategy::create(cfgPath)) {
         MIDAS_LOG_INFO(name << " maxMsgSize: " << maxMsgSize);
         MIDAS_LOG_INFO(name << " ringSize: " << ringSize);
         MIDAS_LOG_INFO(name << " ClaimStrategy: " << claimStrategyPtr->print());
@@ -53,18 +56,23 @@ public:
     void set_cursor(long seq) { return cursor.store(seq, std::memory_order::memory_order_release); }
 
 public:
+    typedef SequenceGroup<ConsumerStrategy> TSequenceGroup;
+
+    /**
+     * producer is gated on the slowest terminal consumer, a plain pipeline has only one
+     */
     class ConsumerTrackingProducerBarrier : public ProducerBarrier<Payload, ConsumerTrackingProducerBarrier> {
     private:
         const bool multiProducer;
         RingBuffer<Payload, ClaimStrategy, WaitStrategy, ConsumerStrategy>& ringBufferRef;
-        const typename ConsumerStrategy::SharedPtr consumerPtr;
+        const typename TSequenceGroup::SharedPtr consumerPtr;
         typename WaitStrategy::SharedPtr waitStrategyPtr;
         long previousSize;
 
     public:
         ConsumerTrackingProducerBarrier(const bool multiProducer_,
                                         RingBuffer<Payload, ClaimStrategy, WaitStrategy, ConsumerStrategy>& ringBuffer_,
-                                        const typename ConsumerStrategy::SharedPtr consumerPtr_,
+                                        const typename TSequenceGroup::SharedPtr consumerPtr_,
                                         typename WaitStrategy::SharedPtr waitStrategyPtr_)
             : multiProducer(multiProducer_),
               ringBufferRef(ringBuffer_),
@@ -75,8 +83,41 @@ public:
         Payload& get_next_entry() {
             const long consumptionPoint = consumerPtr->get_consumption_point();
             const long nextSeqNo = ringBufferRef.claimStrategyPtr->increment_and_get();
+            wait_for_free_slot(nextSeqNo);
+
+            Payload& entry = ringBufferRef.ring[nextSeqNo & ringBufferRef.bitMask];
+
+            entry.set_sequence_value(nextSeqNo, consumptionPoint);
+            return entry;
+        }
+
+        void publish_entry(Payload& entry, bool isValid = true) {
+            entry.set_is_valid(isValid);
+            publish(entry.get_sequence_value(), entry.get_sequence_value());
+        }
+
+        long claim_batch(long count) {
+            if (midas::is_unlikely_hint(count <= 0 || count > static_cast<long>(ringBufferRef.ringSize)))
+                THROW_MIDAS_EXCEPTION(ringBufferRef.name << " cannot claim " << count << " entries in one batch");
+
+            const long consumptionPoint = consumerPtr->get_consumption_point();
+            const long last = ringBufferRef.claimStrategyPtr->increment_and_get(count);
+            wait_for_free_slot(last);
+            for (long sequence = last - count + 1; sequence <= last; ++sequence) {
+                Payload& entry = ringBufferRef.ring[sequence & ringBufferRef.bitMask];
+                entry.set_sequence_value(sequence, consumptionPoint);
+                entry.set_is_valid(true);
+            }
+            return last;
+        }
+
+        Payload& entry_at(long sequence) { return ringBufferRef.ring[sequence & ringBufferRef.bitMask]; }
+
+        void publish_batch(long first, long last) { publish(first, last); }
 
-            const long wrapPoint = nextSeqNo - ringBufferRef.ringSize;
+    private:
+        void wait_for_free_slot(long sequence) {
+            const long wrapPoint = sequence - ringBufferRef.ringSize;
             if (midas::is_unlikely_hint(wrapPoint > consumerPtr->get_consumption_point())) {
                 bool loggedRingFullMsg = false;
                 while (wrapPoint > consumerPtr->get_consumption_point()) {
@@ -88,24 +129,17 @@ public:
                     sched_yield();
                 }
             }
-
-            Payload& entry = ringBufferRef.ring[nextSeqNo & ringBufferRef.bitMask];
-
-            entry.set_sequence_value(nextSeqNo, consumptionPoint);
-            return entry;
         }
 
-        void publish_entry(Payload& entry, bool isValid = true) {
-            entry.set_is_valid(isValid);
-
+        void publish(long first, long last) {
             if (multiProducer) {
-                while ((entry.get_sequence_value() - 1) != ringBufferRef.get_cursor()) {
+                while ((first - 1) != ringBufferRef.get_cursor()) {
                     // Wait here until preceding producers have published their entries
                     sched_yield();
                 }
             }
 
-            ringBufferRef.set_cursor(entry.get_sequence_value());
+            ringBufferRef.set_cursor(last);
             waitStrategyPtr->data_available();
         }
     };
@@ -120,18 +154,42 @@ public:
                                         const ConsumerStrategy* pConsumer_)
             : ringBufferRef(ringBuffer_), pConsumer(pConsumer_) {}
 
+        ConsumerTrackingConsumerBarrier(RingBuffer<Payload, ClaimStrategy, WaitStrategy, ConsumerStrategy>& ringBuffer_,
+                                        typename TSequenceGroup::SharedPtr upstream_)
+            : ringBufferRef(ringBuffer_), pConsumer(nullptr), upstream(upstream_) {}
+
         Payload& get_entry(const long sequence) { return ringBufferRef.ring[sequence & ringBufferRef.bitMask]; }
 
+        RingView<Payload> get_view(const long first, const long last) {
+            RingView<Payload> view;
+            if (last < first) return view;
+            const size_t begin = static_cast<size_t>(first & ringBufferRef.bitMask);
+            const size_t count = static_cast<size_t>(last - first + 1);
+            view.first = &ringBufferRef.ring[begin];
+            view.firstCount = std::min(count, ringBufferRef.ringSize - begin);
+            if (view.firstCount < count) {
+                view.second = &ringBufferRef.ring[0];
+                view.secondCount = count - view.firstCount;
+            }
+            return view;
+        }
+
         long wait_for(const long sequence, std::atomic<bool>& interruptRef,
                       typename ConsumerStrategy::TPostQueue& postQueue) {
+            if (upstream)
+                return ringBufferRef.waitStrategyPtr->wait_for(sequence, ringBufferRef, upstream.get(), interruptRef,
+                                                               postQueue);
             return ringBufferRef.waitStrategyPtr->wait_for(sequence, ringBufferRef, pConsumer, interruptRef, postQueue);
         }
 
         void interrupt() { ringBufferRef.waitStrategyPtr->data_available(); }
 
+        void signal_consumed() { ringBufferRef.waitStrategyPtr->data_available(); }
+
     private:
         RingBuffer<Payload, ClaimStrategy, WaitStrategy, ConsumerStrategy>& ringBufferRef;
         const ConsumerStrategy* pConsumer;
+        typename TSequenceGroup::SharedPtr upstream;  // set when gated on more than one consumer
     };
 
     typedef ProducerBarrier<Payload, ConsumerTrackingProducerBarrier> TProducerBarrier;
@@ -139,12 +197,31 @@ public:
 
     typename TProducerBarrier::SharedPtr create_producer_barrier(
         bool multiProducer, const typename ConsumerStrategy::SharedPtr consumerPtr) {
-        return boost::make_shared<ConsumerTrackingProducerBarrier>(multiProducer, *this, consumerPtr, waitStrategyPtr);
+        std::vector<typename TSequenceGroup::TConsumerPtr> consumers{consumerPtr};
+        return create_producer_barrier(multiProducer, boost::make_shared<TSequenceGroup>(consumers));
+    }
+
+    typename TProducerBarrier::SharedPtr create_producer_barrier(bool multiProducer,
+                                                                 typename TSequenceGroup::SharedPtr terminalConsumers) {
+        return boost::make_shared<ConsumerTrackingProducerBarrier>(multiProducer, *this, terminalConsumers,
+                                                                   waitStrategyPtr);
     }
 
     typename TConsumerBarrier::SharedPtr create_consumer_barrier(const ConsumerStrategy* pConsumerToTrack = nullptr) {
         return boost::make_shared<ConsumerTrackingConsumerBarrier>(*this, pConsumerToTrack);
     }
+
+    typename TConsumerBarrier::SharedPtr create_consumer_barrier(typename TSequenceGroup::SharedPtr upstream) {
+        return boost::make_shared<ConsumerTrackingConsumerBarrier>(*this, upstream);
+    }
+};
+
+/**
+ * ring buffer type of payload, VarRingBuffer.h maps VarRecord to variable length ring
+ */
+template <typename Payload, typename ClaimStrategy, typename WaitStrategy, typename ConsumerStrategy>
+struct RingBufferOf {
+    typedef RingBuffer<Payload, ClaimStrategy, WaitStrategy, ConsumerStrategy> type;
 };
 }
 
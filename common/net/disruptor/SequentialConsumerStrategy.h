@@ -27,6 +27,7 @@ public:
     using BaseType::isRunning;
     using BaseType::postQueueRef;
     using BaseType::consumerThreadPtr;
+    using BaseType::disruptorName;
     using BaseType::handle_post;
     using typename BaseType::TPostCallback;
     using typename BaseType::TPostQueue;
@@ -40,6 +41,7 @@ public:
 
     template <class Consumer, class Payload, class ConsumerBarrier, ConsumerStages Stages>
     void run(Consumer& consumerRef, ConsumerBarrier& consumerBarrierPtr) {
+        ThreadPlacement::instance().place(disruptorName, disruptorName);
         ConsumerDispatcher<Consumer, Payload, Stages> dispatcher;
         long availableSequence = 0;
         long nextSequence = 0;
@@ -52,6 +54,7 @@ public:
                 handle_post();
             }
 
+            const long batchStart = nextSequence;
             while (nextSequence <= availableSequence) {
                 entry = &(consumerBarrierPtr->get_entry(nextSequence));
                 ++nextSequence;
@@ -60,13 +63,13 @@ public:
                     continue;  // skip this payload
                 }
 
-                entry->set_has_more_data(nextSequence <= availableSequence);
-
-                dispatcher.dispatch(consumerRef, *entry);
+                dispatcher.dispatch(consumerRef, *entry, nextSequence <= availableSequence);
             }
 
-            if (midas::is_likely_hint(entry)) {
-                consumedTo.store(entry->get_sequence_value(), std::memory_order::memory_order_release);
+            // publish own count rather than sequence of last entry, that slot may be reused once downstream passed it
+            if (midas::is_likely_hint(nextSequence != batchStart)) {
+                consumedTo.store(nextSequence - 1, std::memory_order::memory_order_release);
+                consumerBarrierPtr->signal_consumed();
             }
         }
     }
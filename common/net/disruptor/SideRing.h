@@ -0,0 +1,41 @@
+#ifndef MIDAS_SIDE_RING_H
+#define MIDAS_SIDE_RING_H
+
+#include <cstddef>
+#include <vector>
+#include "midas/MidasException.h"
+
+using namespace std;
+
+namespace midas {
+
+/**
+ * data that rides along a disruptor entry without being part of its payload, slot is indexed by entry sequence
+ * producer writes slot of the sequence it claimed, consumers read slot of payload.get_sequence_value()
+ * ring must have size of disruptor ring, then producer cannot reuse a slot before terminal consumers passed it
+ */
+template <typename T>
+class SideRing {
+private:
+    vector<T> slots;
+    long bitMask{-1};
+
+public:
+    SideRing() {}
+
+    explicit SideRing(size_t ringSize) : slots(ringSize), bitMask(static_cast<long>(ringSize) - 1) {
+        if (ringSize == 0 || (ringSize & (ringSize - 1)) != 0)
+            THROW_MIDAS_EXCEPTION("side ring size " << ringSize << " is not power of 2");
+    }
+
+    bool empty() const { return slots.empty(); }
+
+    size_t size() const { return slots.size(); }
+
+    T& at(long sequence) { return slots[sequence & bitMask]; }
+
+    const T& at(long sequence) const { return slots[sequence & bitMask]; }
+};
+}
+
+#endif
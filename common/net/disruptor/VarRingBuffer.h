@@ -0,0 +1,309 @@
+#ifndef MIDAS_VAR_RINGBUFFER_H
+#define MIDAS_VAR_RINGBUFFER_H
+
+#include <sched.h>
+#include <stdlib.h>
+#include <atomic>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include "Barrier.h"
+#include "ConsumerStrategy.h"
+#include "RingBuffer.h"
+#include "midas/MidasConfig.h"
+#include "midas/MidasException.h"
+#include "utils/log/Log.h"
+
+using namespace std;
+
+namespace midas {
+
+/**
+ * header of one record in VarRingBuffer, size bytes of message follow it in place
+ * works with SequentialConsumerStrategy, records cannot be merged for BatchConsumerStrategy
+ */
+struct VarRecord {
+    uint32_t size{0};
+    bool isValid{false};
+    bool hasMoreData{false};
+    uint16_t reserved{0};
+    long sequenceValue{-1};
+    uint64_t rcvt{0};
+    int64_t id{0};
+
+    char* data() { return reinterpret_cast<char*>(this + 1); }
+    const char* data() const { return reinterpret_cast<const char*>(this + 1); }
+    uint32_t get_size() const { return size; }
+
+    void set_sequence_value(const long value, long cursorWhenAdded) {
+        sequenceValue = value;
+        (void)cursorWhenAdded;
+    }
+
+    long get_sequence_value() const { return sequenceValue; }
+
+    bool set_value(const char* d, size_t n, const uint64_t rcvt_, int64_t id_) {
+        memcpy(data(), d, n);
+        rcvt = rcvt_;
+        id = id_;
+        return true;
+    }
+
+    bool is_valid() { return isValid; }
+    void set_is_valid(bool isValid_) { isValid = isValid_; }
+    void reset() { hasMoreData = false; }
+    uint64_t get_rcvt() const { return rcvt; }
+    int64_t get_id() const { return id; }
+    void set_has_more_data(bool hasMoreData_) { hasMoreData = hasMoreData_; }
+    bool has_more_data() { return hasMoreData; }
+};
+
+static_assert(sizeof(VarRecord) == 32, "record header is 32 bytes so message starts 8 byte aligned");
+
+/**
+ * ring of variable length records, sequence and barrier semantics are the same as RingBuffer
+ * records are packed into a byte arena, header plus message rounded up to record_alignment (8 or 64)
+ * a record never wraps, tail of arena too short for it is skipped
+ * index ring keeps arena position of every sequence in flight, so ring_size_exponent bounds records in flight
+ * and arena_size_exponent bounds their bytes, max_msg_size only bounds one record
+ * cfg under cfgPath: arena_size_exponent (default 18, stays in L2), record_alignment (default 8)
+ */
+template <typename ClaimStrategy, typename WaitStrategy, typename ConsumerStrategy>
+class VarRingBuffer {
+public:
+    typedef boost::shared_ptr<VarRingBuffer> SharedPtr;
+
+    // one cache line
+    std::atomic<long> cursor;
+    const long bitMask;
+    const string name;
+    const size_t ringSize;
+    uint64_t padding2preventFalseSharing[4];
+
+    const uint32_t maxMsgSize;
+    const uint64_t alignment;
+    const uint64_t arenaSize;
+    const uint64_t arenaMask;
+    char* arena{nullptr};
+    vector<uint64_t> starts;  // arena position of record by sequence
+    vector<uint64_t> ends;    // arena position after record by sequence, read by producer only
+    uint64_t bytePosition{0};
+    std::atomic_flag claimLock = ATOMIC_FLAG_INIT;
+
+    typename ClaimStrategy::SharedPtr claimStrategyPtr;
+    typename WaitStrategy::SharedPtr waitStrategyPtr;
+
+public:
+    VarRingBuffer(const uint32_t maxMsgSize_, const size_t ringSize_, string name_, const string& cfgPath = string())
+        : cursor(-1),
+          bitMask(ringSize_ - 1),
+          name(name_),
+          ringSize(ringSize_),
+          maxMsgSize(maxMsgSize_),
+          alignment(Config::instance().get<uint64_t>(cfgPath + ".record_alignment", 8)),
+          arenaSize(uint64_t(1) << Config::instance().get<uint32_t>(cfgPath + ".arena_size_exponent", 18)),
+          arenaMask(arenaSize - 1),
+          starts(ringSize_, 0),
+          ends(ringSize_, 0),
+          claimStrategyPtr(boost::make_shared<ClaimStrategy>()),
+          waitStrategyPtr(WaitStrategy::create(cfgPath)) {
+        if (alignment != 8 && alignment != 64)
+            THROW_MIDAS_EXCEPTION(name << " record_alignment must be 8 or 64, not " << alignment);
+        if (record_bytes(maxMsgSize) > arenaSize)
+            THROW_MIDAS_EXCEPTION(name << " arena of " << arenaSize << " bytes cannot hold max_msg_size "
+                                       << maxMsgSize);
+
+        void* memory = nullptr;
+        if (posix_memalign(&memory, 64, arenaSize) != 0) throw std::bad_alloc();
+        arena = static_cast<char*>(memory);
+        memset(arena, 0, arenaSize);  // touch pages here so numa preference of caller applies
+
+        MIDAS_LOG_INFO(name << " maxMsgSize: " << maxMsgSize);
+        MIDAS_LOG_INFO(name << " ringSize: " << ringSize);
+        MIDAS_LOG_INFO(name << " arenaSize: " << arenaSize << " recordAlignment: " << alignment);
+        MIDAS_LOG_INFO(name << " ClaimStrategy: " << claimStrategyPtr->print());
+        MIDAS_LOG_INFO(name << " WaitStrategy: " << waitStrategyPtr->print());
+        MIDAS_LOG_INFO(name << " ConsumerStrategy: " << ConsumerStrategy::print());
+    }
+
+    ~VarRingBuffer() { free(arena); }
+
+    VarRingBuffer(const VarRingBuffer&) = delete;
+    VarRingBuffer& operator=(const VarRingBuffer&) = delete;
+
+    long get_cursor() const { return cursor.load(std::memory_order::memory_order_acquire); }
+
+    void set_cursor(long seq) { return cursor.store(seq, std::memory_order::memory_order_release); }
+
+    /**
+     * arena bytes taken by record of message size
+     */
+    uint64_t record_bytes(uint64_t size) const {
+        return (sizeof(VarRecord) + size + alignment - 1) & ~(alignment - 1);
+    }
+
+    VarRecord& record_at(long sequence) {
+        return *reinterpret_cast<VarRecord*>(arena + (starts[sequence & bitMask] & arenaMask));
+    }
+
+public:
+    typedef SequenceGroup<ConsumerStrategy> TSequenceGroup;
+
+    /**
+     * producer is gated on sequence of slowest terminal consumer as in RingBuffer, and on arena bytes it has released
+     * claim of several producers is serialized so arena is handed out in sequence order
+     */
+    class VarProducerBarrier {
+    public:
+        typedef boost::shared_ptr<VarProducerBarrier> SharedPtr;
+
+    private:
+        const bool multiProducer;
+        VarRingBuffer& ringBufferRef;
+        const typename TSequenceGroup::SharedPtr consumerPtr;
+        typename WaitStrategy::SharedPtr waitStrategyPtr;
+
+    public:
+        VarProducerBarrier(const bool multiProducer_, VarRingBuffer& ringBuffer_,
+                           const typename TSequenceGroup::SharedPtr consumerPtr_,
+                           typename WaitStrategy::SharedPtr waitStrategyPtr_)
+            : multiProducer(multiProducer_),
+              ringBufferRef(ringBuffer_),
+              consumerPtr(consumerPtr_),
+              waitStrategyPtr(waitStrategyPtr_) {}
+
+        /**
+         * @return record with room for size bytes at data(), publish it by publish_entry
+         */
+        VarRecord& claim(size_t size) {
+            if (midas::is_unlikely_hint(size > ringBufferRef.maxMsgSize))
+                THROW_MIDAS_EXCEPTION(ringBufferRef.name << " record of " << size << " bytes exceeds max_msg_size "
+                                                         << ringBufferRef.maxMsgSize);
+            const uint64_t bytes = ringBufferRef.record_bytes(size);
+
+            if (multiProducer) {
+                while (ringBufferRef.claimLock.test_and_set(std::memory_order_acquire)) sched_yield();
+            }
+            const long consumptionPoint = consumerPtr->get_consumption_point();
+            const long sequence = ringBufferRef.claimStrategyPtr->increment_and_get();
+            wait_for_free_slot(sequence);
+
+            uint64_t start = ringBufferRef.bytePosition;
+            const uint64_t offset = start & ringBufferRef.arenaMask;
+            if (offset + bytes > ringBufferRef.arenaSize) start += ringBufferRef.arenaSize - offset;
+            const uint64_t end = start + bytes;
+            wait_for_free_bytes(end);
+
+            ringBufferRef.bytePosition = end;
+            ringBufferRef.starts[sequence & ringBufferRef.bitMask] = start;
+            ringBufferRef.ends[sequence & ringBufferRef.bitMask] = end;
+            if (multiProducer) ringBufferRef.claimLock.clear(std::memory_order_release);
+
+            VarRecord& record = *reinterpret_cast<VarRecord*>(ringBufferRef.arena + (start & ringBufferRef.arenaMask));
+            record.size = static_cast<uint32_t>(size);
+            record.hasMoreData = false;
+            record.set_sequence_value(sequence, consumptionPoint);
+            return record;
+        }
+
+        void publish_entry(VarRecord& record, bool isValid = true) {
+            record.set_is_valid(isValid);
+
+            if (multiProducer) {
+                while ((record.get_sequence_value() - 1) != ringBufferRef.get_cursor()) {
+                    // Wait here until preceding producers have published their entries
+                    sched_yield();
+                }
+            }
+
+            ringBufferRef.set_cursor(record.get_sequence_value());
+            waitStrategyPtr->data_available();
+        }
+
+    private:
+        void wait_for_free_slot(long sequence) {
+            const long wrapPoint = sequence - ringBufferRef.ringSize;
+            if (midas::is_unlikely_hint(wrapPoint > consumerPtr->get_consumption_point())) {
+                MIDAS_LOG_WARNING(ringBufferRef.name << " Ring full detected");
+                while (wrapPoint > consumerPtr->get_consumption_point()) sched_yield();
+            }
+        }
+
+        /**
+         * bytes up to end of consumed record are free, slot of consumption point is not reused before this claim
+         */
+        uint64_t released_bytes() const {
+            const long consumed = consumerPtr->get_consumption_point();
+            return consumed < 0 ? 0 : ringBufferRef.ends[consumed & ringBufferRef.bitMask];
+        }
+
+        void wait_for_free_bytes(uint64_t end) {
+            if (midas::is_unlikely_hint(end > released_bytes() + ringBufferRef.arenaSize)) {
+                MIDAS_LOG_WARNING(ringBufferRef.name << " Arena full detected");
+                while (end > released_bytes() + ringBufferRef.arenaSize) sched_yield();
+            }
+        }
+    };
+
+    class VarConsumerBarrier : public ConsumerBarrier<VarRecord, VarConsumerBarrier> {
+    public:
+        VarConsumerBarrier(VarRingBuffer& ringBuffer_, const ConsumerStrategy* pConsumer_)
+            : ringBufferRef(ringBuffer_), pConsumer(pConsumer_) {}
+
+        VarConsumerBarrier(VarRingBuffer& ringBuffer_, typename TSequenceGroup::SharedPtr upstream_)
+            : ringBufferRef(ringBuffer_), pConsumer(nullptr), upstream(upstream_) {}
+
+        VarRecord& get_entry(const long sequence) { return ringBufferRef.record_at(sequence); }
+
+        long wait_for(const long sequence, std::atomic<bool>& interruptRef,
+                      typename ConsumerStrategy::TPostQueue& postQueue) {
+            if (upstream)
+                return ringBufferRef.waitStrategyPtr->wait_for(sequence, ringBufferRef, upstream.get(), interruptRef,
+                                                               postQueue);
+            return ringBufferRef.waitStrategyPtr->wait_for(sequence, ringBufferRef, pConsumer, interruptRef, postQueue);
+        }
+
+        void interrupt() { ringBufferRef.waitStrategyPtr->data_available(); }
+
+        void signal_consumed() { ringBufferRef.waitStrategyPtr->data_available(); }
+
+    private:
+        VarRingBuffer& ringBufferRef;
+        const ConsumerStrategy* pConsumer;
+        typename TSequenceGroup::SharedPtr upstream;  // set when gated on more than one consumer
+    };
+
+    typedef VarProducerBarrier TProducerBarrier;
+    typedef ConsumerBarrier<VarRecord, VarConsumerBarrier> TConsumerBarrier;
+
+    typename TProducerBarrier::SharedPtr create_producer_barrier(
+        bool multiProducer, const typename ConsumerStrategy::SharedPtr consumerPtr) {
+        std::vector<typename TSequenceGroup::TConsumerPtr> consumers{consumerPtr};
+        return create_producer_barrier(multiProducer, boost::make_shared<TSequenceGroup>(consumers));
+    }
+
+    typename TProducerBarrier::SharedPtr create_producer_barrier(bool multiProducer,
+                                                                 typename TSequenceGroup::SharedPtr terminalConsumers) {
+        return boost::make_shared<VarProducerBarrier>(multiProducer, *this, terminalConsumers, waitStrategyPtr);
+    }
+
+    typename TConsumerBarrier::SharedPtr create_consumer_barrier(const ConsumerStrategy* pConsumerToTrack = nullptr) {
+        return boost::make_shared<VarConsumerBarrier>(*this, pConsumerToTrack);
+    }
+
+    typename TConsumerBarrier::SharedPtr create_consumer_barrier(typename TSequenceGroup::SharedPtr upstream) {
+        return boost::make_shared<VarConsumerBarrier>(*this, upstream);
+    }
+};
+
+template <typename ClaimStrategy, typename WaitStrategy, typename ConsumerStrategy>
+struct RingBufferOf<VarRecord, ClaimStrategy, WaitStrategy, ConsumerStrategy> {
+    typedef VarRingBuffer<ClaimStrategy, WaitStrategy, ConsumerStrategy> type;
+};
+}
+
+#endif
@@ -1,15 +1,25 @@
 #ifndef MIDAS_WAIT_STRATEGY_H
 #define MIDAS_WAIT_STRATEGY_H
 
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
 #include <atomic>
 #include <boost/make_shared.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/lock_guard.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/pthread/condition_variable_fwd.hpp>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
 #include <string>
 #include "ConsumerStrategy.h"
+#include "midas/MidasConfig.h"
 #include "utils/log/Log.h"
+#include "utils/math/LatencyHistogram.h"
 
 using namespace std;
 
@@ -34,6 +44,13 @@ public:
 
     std::string print() { return impl().print(); }
 
+    void stats(ostream& os) { impl().stats(os); }
+
+    /**
+     * strategy taking settings under disruptor cfgPath hides this
+     */
+    static SharedPtr create(const std::string& cfgPath) { return boost::make_shared<Derived>(); }
+
 private:
     Derived& impl() { return *static_cast<Derived*>(this); }
 };
@@ -66,6 +83,8 @@ public:
     void data_available() {}
 
     std::string print() const { return "BUSY_SPIN"; }
+
+    void stats(ostream& os) const {}
 };
 
 /**
@@ -96,6 +115,8 @@ public:
     void data_available() {}
 
     std::string print() const { return "YIELD"; }
+
+    void stats(ostream& os) const {}
 };
 
 /**
@@ -107,46 +128,196 @@ class BlockWaitStrategy : public WaitStrategy<BlockWaitStrategy> {
 public:
     BlockWaitStrategy() {}
 
+    /**
+     * sleeps until producer publishes or, for dependent consumer, upstream consumer signals its progress
+     * condition is rechecked under lock after registering as waiter so neither wakeup can be lost
+     */
     template <class RingBuffer, class ConsumerStrategy>
     long wait_for(const long sequence, RingBuffer& ringBuffer, const ConsumerStrategy* pConsumer,
                   std::atomic<bool>& runningRef, typename ConsumerStrategy::TPostQueue& postQueue) {
+        auto available = [&]() { return pConsumer ? pConsumer->get_consumption_point() : ringBuffer.get_cursor(); };
+
         long availableSequence = 0;
+        while (((availableSequence = available()) < sequence) && runningRef && postQueue.empty()) {
+            boost::unique_lock<boost::mutex> lock(dataAvailableMutex);
+            waiters.fetch_add(1, std::memory_order_seq_cst);
+            if (available() < sequence && runningRef && postQueue.empty()) {
+                dataAvailableCondition.wait(lock);  // BLOCK here!
+            }
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return availableSequence;
+    }
 
-        if (pConsumer) {
-            while (((availableSequence = pConsumer->get_consumption_point()) < sequence) && runningRef &&
-                   postQueue.empty()) {
-                boost::unique_lock<boost::mutex> lock(dataAvailableMutex);
-                while (!dataAvailable) {
-                    dataAvailableCondition.wait(lock);  // BLOCK here!
+    void data_available() {
+        // pairs with waiters increment, skip lock and notify when nobody sleeps
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) == 0) return;
+        boost::lock_guard<boost::mutex> lock(dataAvailableMutex);
+        dataAvailableCondition.notify_all();
+    }
+
+    std::string print() const { return "BLOCK"; }
+
+    void stats(ostream& os) const {}
+
+private:
+    std::atomic<int> waiters{0};
+    boost::mutex dataAvailableMutex;
+    boost::condition_variable dataAvailableCondition;
+};
+/**
+ * spins for spin_ns, then yields until yield_ns, then parks on a futex until producer or upstream consumer signals
+ * spin budget is converted to pause count once per process so spinning does not read clock
+ * outside trading session all waits park right away, see set_session_open
+ * settings under <cfgPath>.adaptive: spin_ns default 20000, yield_ns default 200000, park_timeout_ms default 100
+ */
+class AdaptiveWaitStrategy : public WaitStrategy<AdaptiveWaitStrategy> {
+public:
+    explicit AdaptiveWaitStrategy(const std::string& cfgPath = std::string()) {
+        Config& cfg = Config::instance();
+        const std::string prefix = cfgPath.empty() ? std::string() : cfgPath + ".";
+        spinNs = cfg.get<uint64_t>(prefix + "adaptive.spin_ns", 20000);
+        yieldNs = cfg.get<uint64_t>(prefix + "adaptive.yield_ns", 200000);
+        parkTimeoutMs = cfg.get<long>(prefix + "adaptive.park_timeout_ms", 100);
+        spinCount = static_cast<uint64_t>(spinNs / pause_ns());
+    }
+
+    static SharedPtr create(const std::string& cfgPath) { return boost::make_shared<AdaptiveWaitStrategy>(cfgPath); }
+
+    template <class RingBuffer, class ConsumerStrategy>
+    long wait_for(const long sequence, RingBuffer& ringBuffer, const ConsumerStrategy* pConsumer,
+                  std::atomic<bool>& runningRef, typename ConsumerStrategy::TPostQueue& postQueue) {
+        long availableSequence = 0;
+        auto isDone = [&]() {
+            availableSequence = pConsumer ? pConsumer->get_consumption_point() : ringBuffer.get_cursor();
+            return availableSequence >= sequence || !runningRef.load(std::memory_order_acquire) || !postQueue.empty();
+        };
+        if (isDone()) return availableSequence;
+
+        const uint64_t start = now();
+        if (session_open().load(std::memory_order_relaxed)) {
+            for (uint64_t i = 0; i < spinCount; ++i) {
+                __asm__ __volatile__("pause");
+                if (isDone()) {
+                    spinWakes.fetch_add(1, std::memory_order_relaxed);
+                    waitTime.record(now() - start);
+                    return availableSequence;
                 }
             }
-        } else {
-            while (((availableSequence = ringBuffer.get_cursor()) < sequence) && runningRef && postQueue.empty()) {
-                boost::unique_lock<boost::mutex> lock(dataAvailableMutex);
-                while (!dataAvailable) {
-                    dataAvailableCondition.wait(lock);  // BLOCK here!
+            while (now() - start < spinNs + yieldNs) {
+                sched_yield();
+                if (isDone()) {
+                    yieldWakes.fetch_add(1, std::memory_order_relaxed);
+                    waitTime.record(now() - start);
+                    return availableSequence;
                 }
+            }
+        }
 
-                dataAvailable = false;
+        // register before reading epoch and rechecking, pairs with fence in data_available so no wakeup is lost
+        const struct timespec timeout { parkTimeoutMs / 1000, (parkTimeoutMs % 1000) * 1000000 };
+        while (true) {
+            parked.fetch_add(1, std::memory_order_seq_cst);
+            const int expected = epoch.load(std::memory_order_acquire);
+            if (isDone()) {
+                parked.fetch_sub(1, std::memory_order_relaxed);
+                break;
+            }
+            long rc = syscall(SYS_futex, reinterpret_cast<int*>(&epoch), FUTEX_WAIT_PRIVATE, expected, &timeout,
+                              nullptr, 0);
+            parked.fetch_sub(1, std::memory_order_relaxed);
+            if (rc != 0 && errno == ETIMEDOUT) parkTimeouts.fetch_add(1, std::memory_order_relaxed);
+            if (isDone()) {
+                const uint64_t signaled = signalTime.load(std::memory_order_relaxed), woken = now();
+                if (rc == 0 && woken > signaled) wakeupLatency.record(woken - signaled);
+                break;
             }
         }
+        parkWakes.fetch_add(1, std::memory_order_relaxed);
+        waitTime.record(now() - start);
         return availableSequence;
     }
 
     void data_available() {
-        {
-            boost::lock_guard<boost::mutex> lock(dataAvailableMutex);
-            dataAvailable = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_relaxed) == 0) return;
+        signalTime.store(now(), std::memory_order_relaxed);
+        epoch.fetch_add(1, std::memory_order_release);
+        syscall(SYS_futex, reinterpret_cast<int*>(&epoch), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+    }
+
+    std::string print() const { return "ADAPTIVE"; }
+
+    /**
+     * which phase ended waits, wait duration of waits that did not find data at once,
+     * and latency from producer signal to parked consumer running again, all in nanoseconds
+     */
+    void stats(ostream& os) {
+        os << "wait spin/yield/park = " << spinWakes.load(std::memory_order_relaxed) << '/'
+           << yieldWakes.load(std::memory_order_relaxed) << '/' << parkWakes.load(std::memory_order_relaxed)
+           << " park timeouts " << parkTimeouts.load(std::memory_order_relaxed) << " session "
+           << (session_open().load(std::memory_order_relaxed) ? "open" : "closed") << '\n';
+        print_histogram(os, "wait", waitTime.snapshot());
+        print_histogram(os, "wakeup", wakeupLatency.snapshot());
+    }
+
+    /**
+     * process wide switch, closed makes every adaptive wait park without spinning
+     */
+    static void set_session_open(bool isOpen) {
+        if (session_open().exchange(isOpen) != isOpen) {
+            MIDAS_LOG_INFO("adaptive wait strategy " << (isOpen ? "spins in session" : "parks out of session"));
         }
-        dataAvailableCondition.notify_all();
     }
 
-    std::string print() const { return "BLOCK"; }
+    static std::atomic<bool>& session_open() {
+        static std::atomic<bool> isOpen{true};
+        return isOpen;
+    }
+
+    /**
+     * cost of one pause instruction measured once per process
+     */
+    static double pause_ns() {
+        static const double cost = []() {
+            const int loops = 10000;
+            const uint64_t begin = now();
+            for (int i = 0; i < loops; ++i) __asm__ __volatile__("pause");
+            return std::max(1.0, static_cast<double>(now() - begin) / loops);
+        }();
+        return cost;
+    }
 
 private:
-    bool dataAvailable{false};
-    boost::mutex dataAvailableMutex;
-    boost::condition_variable dataAvailableCondition;
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    static void print_histogram(ostream& os, const char* name, const LatencyHistogram::Snapshot& s) {
+        os << name << " ns count " << s.count << " mean " << static_cast<uint64_t>(s.mean()) << " p50 "
+           << s.percentile(50) << " p99 " << s.percentile(99) << " p99.9 " << s.percentile(99.9) << " max " << s.max
+           << '\n';
+    }
+
+private:
+    uint64_t spinNs{0};
+    uint64_t yieldNs{0};
+    long parkTimeoutMs{100};
+    uint64_t spinCount{0};
+
+    std::atomic<int> epoch{0};  // futex word
+    std::atomic<int> parked{0};
+    std::atomic<uint64_t> signalTime{0};
+
+    std::atomic<uint64_t> spinWakes{0};
+    std::atomic<uint64_t> yieldWakes{0};
+    std::atomic<uint64_t> parkWakes{0};
+    std::atomic<uint64_t> parkTimeouts{0};
+    LatencyHistogram waitTime;
+    LatencyHistogram wakeupLatency;
 };
 }
 
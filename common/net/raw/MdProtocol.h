@@ -19,6 +19,8 @@ struct Timestamps {
 struct BookChanged {
     enum struct ChangedSide : uint8_t { bid = 0, ask = 1, both = 2, none = 255 };
     ChangedSide side = ChangedSide::none;
+    uint32_t bidLevels = 0;  // bit i is set if bid level i changed
+    uint32_t askLevels = 0;
     Timestamps timestamps;
 };
 
@@ -0,0 +1,332 @@
+#ifndef MIDAS_MARKET_DATA_BUS_H
+#define MIDAS_MARKET_DATA_BUS_H
+
+#include <signal.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "SharedMemory.h"
+#include "midas/MidasException.h"
+
+namespace midas {
+
+/**
+ * shared memory layout of market data bus, single writer broadcasts flat record T to any number of readers
+ * |Header|Entry * capacity|Slot * slotCount|
+ * entry and slot are guarded by seqlock stamp, odd while writer is copying, so writer never waits on readers
+ */
+template <typename T>
+struct MarketDataBusLayout {
+    static constexpr uint32_t BusMagic = 0x4d444253;
+    static constexpr uint32_t KeySize = 32;
+
+    struct alignas(64) Header {
+        uint32_t magic{BusMagic};
+        uint32_t recordSize{sizeof(T)};
+        uint32_t capacity{0};
+        uint32_t slotCount{0};
+        std::atomic<uint32_t> isInitialized{0};
+        std::atomic<uint32_t> slotUsed{0};  // slots [0, slotUsed) have key assigned
+        alignas(64) std::atomic<uint64_t> writeSequence{0};  // next sequence to publish
+    };
+
+    struct alignas(64) Entry {
+        std::atomic<uint64_t> stamp;  // 2 * sequence + 2 when entry holds sequence
+        uint64_t rcvt;
+        T data;
+    };
+
+    /**
+     * last value of one key, late joiner snapshots those before consuming ring
+     */
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> stamp;  // even when stable
+        uint64_t rcvt;
+        char key[KeySize];
+        T data;
+    };
+
+    Header* header{nullptr};
+    Entry* entries{nullptr};
+    Slot* slots{nullptr};
+
+    static uint64_t size(uint32_t capacity, uint32_t slotCount) {
+        return sizeof(Header) + static_cast<uint64_t>(capacity) * sizeof(Entry) +
+               static_cast<uint64_t>(slotCount) * sizeof(Slot);
+    }
+
+    void bind(uint8_t* base, uint32_t capacity) {
+        header = reinterpret_cast<Header*>(base);
+        entries = reinterpret_cast<Entry*>(base + sizeof(Header));
+        slots = reinterpret_cast<Slot*>(entries + capacity);
+    }
+};
+
+/**
+ * publisher side, publish only does memcpy and atomic stores on mapped memory, no syscall
+ * segment left by a writer that is gone is taken over, readers still attached to it go on from its sequence
+ */
+template <typename T>
+class MarketDataBusWriter {
+private:
+    using Layout = MarketDataBusLayout<T>;
+    SharedMemory shm;
+    Layout layout;
+    uint64_t mask;
+    uint64_t sequence{0};
+    uint32_t slotUsed{0};
+    std::vector<int32_t> slotOf;  // process local, dense key id to last value slot, -1 if none yet
+
+public:
+    uint64_t published{0};
+    uint64_t slotMisses{0};  // keys beyond slotCount, published to ring without last value
+    bool isReclaimed{false};
+
+public:
+    /**
+     * @param capacity ring size in records, rounded up to power of 2
+     * @param slotCount max keys tracked by last value slots
+     */
+    MarketDataBusWriter(const std::string& name, uint32_t capacity, uint32_t slotCount)
+        : shm(open(name, round_up(capacity), slotCount)), slotOf(slotCount, -1) {
+        uint32_t ringSize = round_up(capacity);
+        mask = ringSize - 1;
+        layout.bind(shm.buffer, ringSize);
+        typename Layout::Header* header = layout.header;
+        isReclaimed = header->isInitialized.load(std::memory_order_acquire) == 1;
+        if (isReclaimed) {
+            // key ids of this process differ, so slots are keyed again, a slot torn by crash is made stable
+            sequence = header->writeSequence.load(std::memory_order_acquire);
+            header->slotUsed.store(0, std::memory_order_release);
+            for (uint32_t i = 0; i < slotCount; ++i) {
+                uint64_t stamp = layout.slots[i].stamp.load(std::memory_order_relaxed);
+                if (stamp & 1) layout.slots[i].stamp.store(stamp + 1, std::memory_order_release);
+            }
+        } else {
+            header = new (shm.buffer) typename Layout::Header;
+            header->capacity = ringSize;
+            header->slotCount = slotCount;
+            header->isInitialized.store(1, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @param keyId dense id of key like InstrumentIndex id, negative if record has no last value slot
+     * @param key copied to slot when keyId is published first time
+     */
+    void publish(const T& data, int keyId, const char* key, uint64_t rcvt) {
+        typename Layout::Entry& entry = layout.entries[sequence & mask];
+        entry.stamp.store(2 * sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        entry.rcvt = rcvt;
+        memcpy(&entry.data, &data, sizeof(T));
+        entry.stamp.store(2 * sequence + 2, std::memory_order_release);
+        layout.header->writeSequence.store(++sequence, std::memory_order_release);
+        ++published;
+
+        if (keyId >= 0) update_slot(data, keyId, key, rcvt);
+    }
+
+    void stats(std::ostream& os) const {
+        os << "md bus " << shm.filename << " published " << published << " keys " << slotUsed << " slot misses "
+           << slotMisses << '\n';
+    }
+
+private:
+    void update_slot(const T& data, int keyId, const char* key, uint64_t rcvt) {
+        if (static_cast<size_t>(keyId) >= slotOf.size()) slotOf.resize(keyId + 1, -1);
+        int32_t& index = slotOf[keyId];
+        const bool isNew = index < 0;
+        if (isNew) {
+            if (slotUsed >= layout.header->slotCount) {
+                ++slotMisses;
+                return;
+            }
+            index = static_cast<int32_t>(slotUsed++);
+        }
+
+        typename Layout::Slot* slot = &layout.slots[index];
+        uint64_t stamp = slot->stamp.load(std::memory_order_relaxed);
+        slot->stamp.store(stamp + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        if (isNew) {
+            memset(slot->key, 0, Layout::KeySize);
+            strncpy(slot->key, key, Layout::KeySize - 1);
+        }
+        slot->rcvt = rcvt;
+        memcpy(&slot->data, &data, sizeof(T));
+        slot->stamp.store(stamp + 2, std::memory_order_release);
+
+        if (isNew) layout.header->slotUsed.store(slotUsed, std::memory_order_release);
+    }
+
+    /**
+     * create segment, or take over the one of a writer that is gone if it has same layout
+     * live writer of same name is an error, segment is never unlinked here as readers may be attached
+     */
+    static SharedMemory open(const std::string& name, uint32_t capacity, uint32_t slotCount) {
+        uint64_t size = Layout::size(capacity, slotCount);
+        if (size > std::numeric_limits<uint32_t>::max()) THROW_MIDAS_EXCEPTION("MarketDataBus: segment too large");
+        int fd = shm_open(name.c_str(), O_RDWR, 0666);
+        if (fd < 0) return SharedMemory::create_shared_memory(name, static_cast<uint32_t>(size));
+        close(fd);
+
+        {
+            SharedMemory previous = SharedMemory::attach_shared_memory(name);
+            pid_t owner = static_cast<pid_t>(previous.meta->ownerPid);
+            if (owner != 0 && (kill(owner, 0) == 0 || errno == EPERM))
+                THROW_MIDAS_EXCEPTION("MarketDataBus: " << name << " is written by running process " << owner);
+            if (previous.capacity() < size)
+                THROW_MIDAS_EXCEPTION("MarketDataBus: " << name << " left by previous writer is too small");
+            Layout old;
+            old.bind(previous.buffer, 0);
+            if (old.header->isInitialized.load(std::memory_order_acquire) == 1 &&
+                (old.header->magic != Layout::BusMagic || old.header->recordSize != sizeof(T) ||
+                 old.header->capacity != capacity || old.header->slotCount != slotCount)) {
+                THROW_MIDAS_EXCEPTION("MarketDataBus: " << name << " left by previous writer has other layout");
+            }
+        }
+        return SharedMemory::reclaim_shared_memory(name);
+    }
+
+    static uint32_t round_up(uint32_t n) {
+        uint32_t v = 2;
+        while (v < n) v <<= 1;
+        return v;
+    }
+};
+
+/**
+ * subscriber side, each reader keeps its own cursor so readers never affect writer or each other
+ * reader falling more than capacity behind is overrun, it skips ahead and counts the gap
+ */
+template <typename T>
+class MarketDataBusReader {
+private:
+    using Layout = MarketDataBusLayout<T>;
+    SharedMemory shm;
+    Layout layout;
+    uint64_t capacity;
+    uint64_t mask;
+    uint64_t cursor{0};
+
+public:
+    uint64_t received{0};
+    uint64_t gaps{0};  // times this reader was overrun
+    uint64_t lost{0};  // records skipped because of overrun
+
+public:
+    /**
+     * @param fromOldest start from oldest record still in ring, otherwise only new records are delivered
+     */
+    explicit MarketDataBusReader(const std::string& name, bool fromOldest = false)
+        : shm(SharedMemory::attach_shared_memory(name)) {
+        layout.bind(shm.buffer, 0);
+        typename Layout::Header* header = layout.header;
+        if (header->isInitialized.load(std::memory_order_acquire) != 1)
+            THROW_MIDAS_EXCEPTION("MarketDataBus: writer initialization not finished");
+        if (header->magic != Layout::BusMagic) THROW_MIDAS_EXCEPTION("MarketDataBus: magic number mismatch");
+        if (header->recordSize != sizeof(T)) THROW_MIDAS_EXCEPTION("MarketDataBus: record size mismatch");
+
+        capacity = header->capacity;
+        mask = capacity - 1;
+        layout.bind(shm.buffer, header->capacity);
+
+        uint64_t head = header->writeSequence.load(std::memory_order_acquire);
+        cursor = (fromOldest && head > capacity) ? head - capacity : (fromOldest ? 0 : head);
+    }
+
+    /**
+     * deliver published records in order, callback is invoked as f(const T&, uint64_t rcvt, uint64_t sequence)
+     * @return number of records delivered
+     */
+    template <typename F>
+    size_t poll(F&& f, size_t maxCount = SIZE_MAX) {
+        size_t n = 0;
+        uint64_t head = layout.header->writeSequence.load(std::memory_order_acquire);
+        T data;
+        while (n < maxCount && cursor < head) {
+            if (head - cursor > capacity) {
+                skip(head);
+                continue;
+            }
+
+            typename Layout::Entry& entry = layout.entries[cursor & mask];
+            uint64_t stamp = entry.stamp.load(std::memory_order_acquire);
+            if (stamp != 2 * cursor + 2) {
+                head = layout.header->writeSequence.load(std::memory_order_acquire);
+                skip(head);
+                continue;
+            }
+            uint64_t rcvt = entry.rcvt;
+            memcpy(&data, &entry.data, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (entry.stamp.load(std::memory_order_relaxed) != stamp) {
+                head = layout.header->writeSequence.load(std::memory_order_acquire);
+                skip(head);
+                continue;
+            }
+
+            f(data, rcvt, cursor);
+            ++cursor;
+            ++received;
+            ++n;
+        }
+        return n;
+    }
+
+    /**
+     * read last value of every key, callback is invoked as f(const char* key, const T&, uint64_t rcvt)
+     * @return number of keys
+     */
+    template <typename F>
+    size_t snapshot(F&& f) const {
+        uint32_t used = layout.header->slotUsed.load(std::memory_order_acquire);
+        T data;
+        char key[Layout::KeySize];
+        for (uint32_t i = 0; i < used; ++i) {
+            typename Layout::Slot& slot = layout.slots[i];
+            uint64_t rcvt, stamp;
+            do {
+                stamp = slot.stamp.load(std::memory_order_acquire);
+                rcvt = slot.rcvt;
+                memcpy(key, slot.key, Layout::KeySize);
+                memcpy(&data, &slot.data, sizeof(T));
+                std::atomic_thread_fence(std::memory_order_acquire);
+            } while ((stamp & 1) || slot.stamp.load(std::memory_order_relaxed) != stamp);
+            f(key, data, rcvt);
+        }
+        return used;
+    }
+
+    uint64_t get_cursor() const { return cursor; }
+
+    /**
+     * records published but not yet consumed by this reader
+     */
+    uint64_t lag() const { return layout.header->writeSequence.load(std::memory_order_acquire) - cursor; }
+
+    void stats(std::ostream& os) const {
+        os << "md bus " << shm.filename << " received " << received << " gaps " << gaps << " lost " << lost
+           << " lag " << lag() << '\n';
+    }
+
+private:
+    /**
+     * jump to middle of ring so that a slow reader does not get overrun again immediately
+     */
+    void skip(uint64_t head) {
+        uint64_t target = head > capacity / 2 ? head - capacity / 2 : 0;
+        if (target <= cursor) target = cursor + 1;
+        ++gaps;
+        lost += target - cursor;
+        cursor = target;
+    }
+};
+}
+
+#endif
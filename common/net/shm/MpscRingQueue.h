@@ -0,0 +1,142 @@
+#ifndef MIDAS_MPSC_RING_QUEUE_H
+#define MIDAS_MPSC_RING_QUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include "utils/Backoff.h"
+
+namespace midas {
+/**
+ * bounded multiple writer single reader queue on pre-allocated slot array, no allocation after construction
+ * each slot is cache line padded and stamped with a sequence:
+ *   sequence == pos            slot free for writer who claims pos
+ *   sequence == pos + 1        slot published, reader can consume pos
+ *   sequence == pos + capacity slot released by reader for next lap
+ * T must be default constructible, value is assigned into slot by writer and moved out by reader
+ */
+template <typename T>
+class MpscRingQueue {
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        T value;
+    } __attribute__((aligned(64)));
+
+    const uint64_t capacity;
+    const uint64_t mask;
+    Slot* slots;
+    std::atomic<uint64_t> tail __attribute__((aligned(64))){0};  // next pos to claim - multiple threads
+    uint64_t head __attribute__((aligned(64))){0};               // next pos to read - single thread
+    char padding[64 - sizeof(uint64_t)];
+
+public:
+    using value_type = T;
+
+    /**
+     * capacity is rounded up to power of 2
+     */
+    explicit MpscRingQueue(uint64_t capacity_ = 1024)
+        : capacity(round_up(capacity_)), mask(capacity - 1), slots(nullptr) {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, 64, sizeof(Slot) * capacity) != 0) throw std::bad_alloc();
+        slots = static_cast<Slot*>(memory);
+        for (uint64_t i = 0; i < capacity; ++i) {
+            new (&slots[i]) Slot();
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpscRingQueue() {
+        for (uint64_t i = 0; i < capacity; ++i) slots[i].~Slot();
+        free(slots);
+    }
+
+    MpscRingQueue(const MpscRingQueue&) = delete;
+    MpscRingQueue& operator=(const MpscRingQueue&) = delete;
+
+    /**
+     * @return false if queue is full, args are untouched in that case
+     */
+    template <typename... Args>
+    bool try_put(Args&&... args_) {
+        uint64_t pos = tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[pos & mask];
+            uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // reader has not released this slot from last lap
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = T(std::forward<Args>(args_)...);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * block with exponential backoff until there is room
+     */
+    template <typename... Args>
+    void put(Args&&... args_) {
+        BackOff backOff;
+        while (!try_put(std::forward<Args>(args_)...)) {
+            backOff.pause();
+        }
+    }
+
+    bool get(T& elem_) {
+        Slot& slot = slots[head & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1) return false;
+        elem_ = std::move(slot.value);
+        slot.sequence.store(head + capacity, std::memory_order_release);
+        ++head;
+        return true;
+    }
+
+    /**
+     * consume up to maxCount published elements in place, callback is invoked as f(T&)
+     * @return number of elements consumed
+     */
+    template <typename F>
+    size_t drain(F&& f, size_t maxCount = SIZE_MAX) {
+        size_t n = 0;
+        while (n < maxCount) {
+            Slot& slot = slots[head & mask];
+            if (slot.sequence.load(std::memory_order_acquire) != head + 1) break;
+            f(slot.value);
+            slot.sequence.store(head + capacity, std::memory_order_release);
+            ++head;
+            ++n;
+        }
+        return n;
+    }
+
+    /**
+     * approximate, exact only when called from reader with writers idle
+     */
+    size_t size() const {
+        uint64_t t = tail.load(std::memory_order_acquire);
+        return t > head ? t - head : 0;
+    }
+
+    bool empty() const { return slots[head & mask].sequence.load(std::memory_order_acquire) != head + 1; }
+
+    uint64_t get_capacity() const { return capacity; }
+
+private:
+    static uint64_t round_up(uint64_t n) {
+        uint64_t v = 2;
+        while (v < n) v <<= 1;
+        return v;
+    }
+};
+}
+
+#endif
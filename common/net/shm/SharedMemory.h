@@ -87,7 +87,6 @@ public:
 
 private:
     uint8_t *_map(uint32_t mapSize, bool create_) {
-        int fd = -1;
         mapSize = _roundup_pagesize(mapSize);
         if (create_) {
             fd = shm_open(filename.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
@@ -128,7 +127,6 @@ private:
         }
         meta = reinterpret_cast<Meta *>(addr);
         buffer = reinterpret_cast<uint8_t *>(addr) + META_SIZE;
-        fd = fd;
 
         Meta dummy;
         if (create_) {
@@ -44,7 +44,7 @@ struct Retry {
 
 // object to listen and recv incoming msg
 template <typename Tag = DefaultTcpReceiverTag, size_t BufferSize = DefaultTcpRecvBufferSize,
-          typename Allocator = PoolAllocator<BufferSize, Tag>, bool UseStrand = false>
+          typename Allocator = ThreadPoolAllocator<BufferSize, Tag>, bool UseStrand = false>
 class TcpReceiver : public Member {
 public:
     template <bool T>
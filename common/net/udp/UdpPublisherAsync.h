@@ -1,16 +1,26 @@
 #ifndef MIDAS_UDP_PUBLISHER_ASYNC_H
 #define MIDAS_UDP_PUBLISHER_ASYNC_H
 
+#include <sys/socket.h>
 #include <tbb/atomic.h>
 #include <boost/asio/placeholders.hpp>
+#include <boost/asio/strand.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <vector>
 #include "net/buffer/BufferManager.h"
+#include "net/common/Coalescer.h"
 #include "net/common/TimerMember.h"
 #include "net/udp/UdpPublisherBase.h"
 #include "utils/Backoff.h"
 
 namespace midas {
 
+/**
+ * by default pending msgs are gathered into one datagram per send
+ * in coalescing mode every msg keeps its own datagram and a batch is sent by sendmmsg on io thread
+ */
 template <typename Tag = DefaultUdpPublisherTag>
 class UdpPublisherAsync : public UdpPublisherBase<UdpPublisherAsync<Tag>> {
 public:
@@ -22,6 +32,13 @@ public:
     tbb::atomic<bool> sendingFlag;
     uint64_t pollingTime;
     BufferManager outputBuffer;
+    boost::asio::strand coalesceStrand;  // serializes flush, budget and window handlers in coalescing mode
+    Coalescer coalescer;
+
+private:
+    static const size_t MaxSendBatch = 1024;  // UIO_MAXIOV, kernel limit of msgs per sendmmsg
+    vector<mmsghdr> batchHeaders;
+    vector<iovec> batchVectors;
 
 public:
     ~UdpPublisherAsync() {}
@@ -36,6 +53,16 @@ public:
     void deliver(const ConstBuffer& msg) {
         if (this->is_closed() || !this->is_multicast()) return;
 
+        if (coalescer.enabled()) {
+            long pendingBytes = outputBuffer.push_back(msg);  // multiple producer can push
+            if (!sendingFlag.compare_and_swap(true, false)) {
+                coalesceStrand.post(boost::bind(&UdpPublisherAsync::flush, SharedPtr(this)));
+            } else if (coalescer.budget_crossed(pendingBytes, msg.size())) {
+                coalesceStrand.post(boost::bind(&UdpPublisherAsync::flush_budget, SharedPtr(this)));
+            }
+            return;
+        }
+
         if (sendingFlag.compare_and_swap(true, false)) {
             // multiple producer can push
             outputBuffer.push_back(msg);
@@ -64,6 +91,7 @@ public:
 
         os << "polling time " << (pollingTime / 1000) << " usec" << '\n'
            << "bytes wait " << outputBuffer.pending_bytes() << '\n';
+        coalescer.stats(os);
     }
 
 private:
@@ -73,7 +101,89 @@ private:
           pollingTime(
               Config::instance()
                   .get<boost::posix_time::time_duration>(cfg + ".polling_time", boost::posix_time::microseconds(100))
-                  .total_nanoseconds()) {}
+                  .total_nanoseconds()),
+          coalesceStrand(output_channel.iosvc),
+          coalescer(cfg, output_channel.iosvc) {}
+
+    // coalesce strand, caller owns sendingFlag
+    void flush() {
+        if (this->is_closed()) {
+            sendingFlag = false;
+            return;
+        }
+        if (coalescer.hold(outputBuffer.pending_bytes(),
+                           coalesceStrand.wrap(boost::bind(&UdpPublisherAsync::on_window, SharedPtr(this),
+                                                           boost::asio::placeholders::error)))) {
+            send_pending();
+        }
+    }
+
+    void flush_budget() {
+        if (!this->is_closed() && coalescer.armed() && coalescer.release(outputBuffer.pending_bytes())) {
+            send_pending();
+        }
+    }
+
+    void on_window(const boost::system::error_code& e) {
+        if (!coalescer.expire(e)) return;
+        if (this->is_closed()) {
+            sendingFlag = false;
+            return;
+        }
+        send_pending();
+    }
+
+    void send_pending() {
+        send_batch(outputBuffer.swap());
+        if (outputBuffer.empty()) {
+            sendingFlag = false;
+            // make sure that other thread do not put something on queue
+            if (outputBuffer.empty() || sendingFlag.compare_and_swap(true, false)) return;
+        }
+        // msgs delivered meanwhile start next batch
+        coalesceStrand.post(boost::bind(&UdpPublisherAsync::flush, SharedPtr(this)));
+    }
+
+    /**
+     * one datagram per msg, at most MaxSendBatch msgs per sendmmsg call
+     */
+    void send_batch(const ConstBufferSequence& msgs) {
+        size_t n = msgs.size();
+        if (n == 0) return;
+        if (batchHeaders.size() < n) {
+            batchHeaders.resize(n);
+            batchVectors.resize(n);
+        }
+
+        size_t i = 0;
+        for (auto itr = msgs.begin(), itrEnd = msgs.end(); itr != itrEnd; ++itr, ++i) {
+            batchVectors[i].iov_base = const_cast<char*>(itr->data());
+            batchVectors[i].iov_len = itr->size();
+            memset(&batchHeaders[i], 0, sizeof(mmsghdr));
+            batchHeaders[i].msg_hdr.msg_iov = &batchVectors[i];
+            batchHeaders[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        size_t sent = 0, calls = 0;
+        while (sent < n) {
+            unsigned count = static_cast<unsigned>(std::min(n - sent, MaxSendBatch));
+            int rc = sendmmsg(this->skt.native_handle(), &batchHeaders[sent], count, 0);
+            ++calls;
+            if (rc < 0) {
+                if (errno == EINTR) continue;
+                MIDAS_LOG_ERROR("error writing to socket " << this->get_name() << " : " << strerror(errno));
+                PublisherBase::stop();
+                break;
+            }
+            for (int k = 0; k < rc; ++k) {
+                size_t s = batchHeaders[sent + k].msg_len;
+                this->add_sent_msg_2_stat(s);
+                if (s > this->peekBytesSent) this->peekBytesSent = s;
+            }
+            sent += rc;
+        }
+        coalescer.count(calls, sent);
+    }
 
     template <typename TBuffer>
     void async_send(const TBuffer& buffer) {
@@ -13,10 +13,11 @@
 using namespace std;
 
 #ifdef MIDAS_ENABLE_RECVMMSG
-#include <syscall.h>
-static inline int recvmmsg(int fd, struct mmsghdr* mmsg, unsigned vlen, unsigned flags) {
-    return syscall(__NR_recvmmsg, fd, mmsg, vlen, flags);
-}
+#include <sys/socket.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
 #endif
 
 namespace midas {
@@ -25,7 +26,7 @@ static const size_t DefaultUdpRecvBufferSize = 8 * 1024;
 
 // object to listen and recv incoming msg
 template <typename Tag = DefaultUdpReceiverTag, size_t BufferSize = DefaultUdpRecvBufferSize,
-          typename Allocator = PoolAllocator<BufferSize, Tag>, bool UseStrand = false>
+          typename Allocator = ThreadPoolAllocator<BufferSize, Tag>, bool UseStrand = false>
 class UdpReceiver : public Member {
 public:
     static const int DefaultReceiveBufferSize = 8388608;  // 8M
@@ -50,6 +51,30 @@ public:
     uint64_t receiveTimeout;
     uint64_t pollingTime;
 
+#ifdef MIDAS_ENABLE_RECVMMSG
+    static const size_t MaxBatchSize = 256;
+    // room for SCM_TIMESTAMPNS and SO_RXQ_OVFL, in 8 byte words to keep cmsghdr aligned
+    static const size_t ControlWords = (CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(uint32_t)) + 7) / 8;
+
+    // slot buffers kernel writes into, a filled slot takes a spare and its buffer stays in flight until dispatched
+    // after dispatch buffers no client kept a reference to become spares again, so steady state allocates nothing
+    size_t batchSize;
+    vector<MutableBuffer> batchBuffers;
+    vector<MutableBuffer> batchInFlight;
+    vector<MutableBuffer> batchSpares;
+    vector<mmsghdr> batchHeaders;
+    vector<iovec> batchVectors;
+    vector<uint64_t> batchControls;
+
+    uint64_t batchCount{0};       // recvmmsg calls returning data
+    uint64_t batchMsgCount{0};    // datagrams received by those calls
+    uint64_t maxBatch{0};         // largest batch seen
+    uint64_t fullBatchCount{0};   // batches which filled all slots, socket likely still has pending data
+    uint64_t truncatedCount{0};   // datagrams larger than buffer, tail discarded by kernel
+    uint64_t kernelDropCount{0};  // datagrams dropped by kernel on full socket buffer, from SO_RXQ_OVFL
+    uint64_t batchAllocCount{0};  // buffers allocated as no spare was left, client kept previous ones
+#endif
+
 public:
     UdpReceiver(const string& ip, const string& port, const string& interface, const string& cfg, CChannel& input)
         : channel(input),
@@ -69,6 +94,11 @@ public:
             ip, port, !interface.empty() ? interface : Config::instance().get<string>(cfg + ".bind_address", ""));
         resolve(address);
         buffer.store(reserve_header_size());
+#ifdef MIDAS_ENABLE_RECVMMSG
+        size_t batch = Config::instance().get<size_t>(cfg + ".recvmmsg_batch", 32);
+        batchSize = std::min(std::max<size_t>(1, batch), size_t(MaxBatchSize));  // copy, member has no definition
+        prepare_batch();
+#endif
     }
 
     ~UdpReceiver() {}
@@ -222,6 +252,18 @@ public:
                     os << "polling time " << pollingTime / 1000 << " usec" << '\n';
                     os << "receive timeout " << receiveTimeout / 1000 << " usec" << '\n';
                 }
+#ifdef MIDAS_ENABLE_RECVMMSG
+                os << "recvmmsg batch size " << batchSize << '\n'
+                   << "recvmmsg batches " << batchCount << '\n'
+                   << "recvmmsg msgs " << batchMsgCount << '\n'
+                   << "recvmmsg avg batch " << (batchCount ? static_cast<double>(batchMsgCount) / batchCount : 0.0)
+                   << '\n'
+                   << "recvmmsg max batch " << maxBatch << '\n'
+                   << "recvmmsg full batches " << fullBatchCount << '\n'
+                   << "truncated msgs " << truncatedCount << '\n'
+                   << "kernel drops " << kernelDropCount << '\n'
+                   << "recvmmsg buffer allocs " << batchAllocCount << '\n';
+#endif
             } catch (boost::system::system_error& e) {
                 MIDAS_LOG_ERROR("error get socket statistics for " << get_name() << " : " << e.what());
             }
@@ -265,7 +307,116 @@ private:
         }
 
         skt.non_blocking(Config::instance().get<bool>(configPath + ".non_block_io", false));
+
+#ifdef MIDAS_ENABLE_RECVMMSG
+        // kernel receive time stamp and socket drop counter are delivered as ancillary data of each datagram
+        int on = 1;
+        if (setsockopt(skt.native_handle(), SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) != 0) {
+            MIDAS_LOG_ERROR("failed to enable SO_TIMESTAMPNS for " << get_name() << " : " << strerror(errno));
+        }
+        if (setsockopt(skt.native_handle(), SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) != 0) {
+            MIDAS_LOG_ERROR("failed to enable SO_RXQ_OVFL for " << get_name() << " : " << strerror(errno));
+        }
+#endif
+    }
+
+#ifdef MIDAS_ENABLE_RECVMMSG
+    MutableBuffer new_batch_buffer() {
+        MutableBuffer b(BufferSize, Allocator());
+        if (reserve_header_size()) b.store(reserve_header_size());
+        return b;
+    }
+
+    void prepare_batch() {
+        batchBuffers.clear();
+        batchInFlight.clear();
+        batchSpares.clear();
+        batchInFlight.reserve(4 * batchSize);
+        batchSpares.reserve(4 * batchSize);
+        for (size_t i = 0; i < batchSize; ++i) {
+            batchBuffers.push_back(new_batch_buffer());
+            batchSpares.push_back(new_batch_buffer());
+        }
+        batchHeaders.resize(batchSize);
+        batchVectors.resize(batchSize);
+        batchControls.assign(batchSize * ControlWords, 0);
+        for (size_t i = 0; i < batchSize; ++i) rearm_slot(i);
+    }
+
+    // point slot i at its buffer again, kernel overwrites msg_controllen and msg_flags on every receive
+    void rearm_slot(size_t i) {
+        MutableBuffer& b = batchBuffers[i];
+        batchVectors[i].iov_base = b.write_ptr();
+        batchVectors[i].iov_len = b.writeCapacity();
+
+        msghdr& h = batchHeaders[i].msg_hdr;
+        memset(&batchHeaders[i], 0, sizeof(mmsghdr));
+        h.msg_iov = &batchVectors[i];
+        h.msg_iovlen = 1;
+        h.msg_control = &batchControls[i * ControlWords];
+        h.msg_controllen = ControlWords * sizeof(uint64_t);
+    }
+
+    MutableBuffer take_spare() {
+        if (batchSpares.empty()) {
+            ++batchAllocCount;
+            return new_batch_buffer();
+        }
+        MutableBuffer b(std::move(batchSpares.back()));
+        batchSpares.pop_back();
+        return b;
+    }
+
+    // called after bufferSequence is dispatched and cleared, buffer with single reference is only held here
+    void recycle_batch() {
+        for (auto& b : batchInFlight) {
+            if (b.bdp->prefix().references != 1) continue;
+            b.clear();
+            if (reserve_header_size()) b.store(reserve_header_size());
+            batchSpares.push_back(std::move(b));
+        }
+        batchInFlight.clear();
+    }
+
+    /**
+     * hand over first count slots to bufferSequence and refill them with spares
+     * buffer time is kernel receive time if available, otherwise time when recvmmsg returned
+     */
+    void collect_batch(size_t count, uint64_t recvTime) {
+        for (size_t i = 0; i < count; ++i) {
+            mmsghdr& mh = batchHeaders[i];
+            uint64_t kernelTime = 0;
+            for (cmsghdr* c = CMSG_FIRSTHDR(&mh.msg_hdr); c; c = CMSG_NXTHDR(&mh.msg_hdr, c)) {
+                if (c->cmsg_level != SOL_SOCKET) continue;
+                if (c->cmsg_type == SCM_TIMESTAMPNS) {
+                    timespec ts;
+                    memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+                    kernelTime = static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+                } else if (c->cmsg_type == SO_RXQ_OVFL) {
+                    uint32_t drops;
+                    memcpy(&drops, CMSG_DATA(c), sizeof(drops));
+                    kernelDropCount = drops;  // cumulative since option enabled
+                }
+            }
+            if (mh.msg_hdr.msg_flags & MSG_TRUNC) ++truncatedCount;
+
+            MutableBuffer& b = batchBuffers[i];
+            b.time(kernelTime ? kernelTime : recvTime);
+            b.source(Member::id);
+            b.store(mh.msg_len);
+            bufferSequence.push_back(b);
+
+            batchInFlight.push_back(std::move(b));
+            b = take_spare();
+            rearm_slot(i);
+        }
+
+        ++batchCount;
+        batchMsgCount += count;
+        if (count > maxBatch) maxBatch = count;
+        if (count == batchSize) ++fullBatchCount;
     }
+#endif
 
     // async read from channel main strand for sync
     void async_receive_from(StrandType<true>) {
@@ -443,6 +594,17 @@ private:
                     uint64_t recvStartTime = (receiveTimeout ? ntime() : 0);
                     do {
 #ifdef MIDAS_ENABLE_RECVMMSG
+                        int count = recvmmsg(skt.native_handle(), batchHeaders.data(),
+                                             static_cast<unsigned>(batchSize), MSG_DONTWAIT, nullptr);
+                        if (count <= 0) {
+                            if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                                MIDAS_LOG_ERROR("error recvmmsg from " << get_name() << " : " << strerror(errno));
+                            }
+                            break;  // no more pending msg
+                        }
+
+                        recvTime = ntime();
+                        collect_batch(static_cast<size_t>(count), recvTime);
 #else
                         size_t byteReceived = skt.receive_from(buffer, senderEndpoint, 0, e);
                         if (e == boost::asio::error::would_block) break;  // no more pending msg
@@ -470,6 +632,9 @@ private:
                         add_recv_msg_2_stat(bufferSequence.byteSize);
 
                         bufferSequence.clear();
+#ifdef MIDAS_ENABLE_RECVMMSG
+                        recycle_batch();
+#endif
                         pollingStartTime = recvTime;
                     }
                 } while (pollingTime && (ntime() - pollingStartTime) < pollingTime);
@@ -11,9 +11,11 @@
 #include "CommandArg.h"
 #include "midas/MidasConfig.h"
 #include "midas/MidasException.h"
+#include "net/buffer/ThreadBufferPool.h"
 #include "process/admin/AdminHandler.h"
 #include "process/admin/MidasAdminBase.h"
 #include "process/admin/MidasAdminManager.h"
+#include "process/ThreadPlacement.h"
 #include "process/admin/TcpAdminPortal.h"
 #include "utils/log/Log.h"
 
@@ -81,6 +83,8 @@ private:
     string admin_set_config(const string& cmd, const TAdminCallbackArgs& args);
     string admin_shutdown(const string& cmd, const TAdminCallbackArgs& args);
     string admin_get_env(const string& cmd, const TAdminCallbackArgs& args);
+    string admin_buffer_pool(const string& cmd, const TAdminCallbackArgs& args);
+    string admin_threads(const string& cmd, const TAdminCallbackArgs& args);
     void _init_admin();
 
     void set_log_level(int argc, char** argv) const;
@@ -93,6 +93,8 @@ inline void MidasProcessBase::setup_signal_handler() {
 }
 
 inline void MidasProcessBase::on_signal() {
+    // only named, placement would log before log writer is set up
+    pthread_setname_np(pthread_self(), "signal");
     int tid = ::syscall(__NR_gettid);
     int ret = 0;
     do {
@@ -253,6 +255,12 @@ inline void MidasProcessBase::_init_admin() {
 
         portal->register_admin("get_env", boost::bind(&MidasProcessBase::admin_get_env, this, _1, _2),
                                "get/set environment variables", "getenv all|variable");
+
+        portal->register_admin("buffer_pool", boost::bind(&MidasProcessBase::admin_buffer_pool, this, _1, _2),
+                               "show thread buffer pool statistics", "buffer_pool");
+
+        portal->register_admin("threads", boost::bind(&MidasProcessBase::admin_threads, this, _1, _2),
+                               "show cpu placement and cpu time of threads", "threads");
     }
 }
 
@@ -348,6 +356,18 @@ inline string MidasProcessBase::admin_shutdown(const string& cmd, const TAdminCa
     stop();
     return "";
 }
+inline string MidasProcessBase::admin_buffer_pool(const string& cmd, const TAdminCallbackArgs& args) {
+    ostringstream os;
+    BufferPoolRegistry::instance().report(os);
+    return os.str();
+}
+
+inline string MidasProcessBase::admin_threads(const string& cmd, const TAdminCallbackArgs& args) {
+    ostringstream os;
+    ThreadPlacement::instance().report(os);
+    return os.str();
+}
+
 inline string MidasProcessBase::admin_get_env(const string& cmd, const TAdminCallbackArgs& args) {
     ostringstream os;
     char* currentEnv = *environ;
@@ -2,20 +2,31 @@
 #define MIDAS_MIDAS_THREAD_POOL_H
 
 #include <utils/log/Log.h>
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <exception>
 #include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <string>
 #include <thread>
 #include <vector>
+#include "process/ThreadPlacement.h"
+#include "utils/Backoff.h"
+#include "utils/MidasUtils.h"
 
 /**
- * thread pool to run user's functor with signature:
+ * work stealing thread pool to run user's functor with signature:
  * ret func(int id, other_params)
  * where id is the index of the thread that runs the functor
+ *
+ * every worker owns a deque, task pushed from a worker goes to its own deque and is popped LIFO by owner,
+ * idle workers steal FIFO from other deques. task pushed from outside goes to a shared injection queue
+ * waiting on a future from inside a worker keeps running other tasks, so nested parallel_for never deadlocks
  */
 
 namespace midas {
@@ -28,31 +39,130 @@ public:
     bool push(T const &value) {
         std::unique_lock<std::mutex> lock(this->mutex);
         this->q.push(value);
+        this->count.store(this->q.size(), std::memory_order_release);
         return true;
     }
     // deletes the retrieved element, do not use for non integral types
     bool pop(T &v) {
+        if (this->count.load(std::memory_order_acquire) == 0) return false;
         std::unique_lock<std::mutex> lock(this->mutex);
         if (this->q.empty()) return false;
         v = this->q.front();
         this->q.pop();
+        this->count.store(this->q.size(), std::memory_order_release);
         return true;
     }
-    bool empty() {
-        std::unique_lock<std::mutex> lock(this->mutex);
-        return this->q.empty();
-    }
+    bool empty() { return this->count.load(std::memory_order_acquire) == 0; }
 
 private:
     std::queue<T> q;
     std::mutex mutex;
+    std::atomic<size_t> count{0};  // lets idle workers skip the lock
+};
+
+/**
+ * Chase-Lev deque of pointers, owner pushes and pops at bottom, thieves steal from top
+ * array grows by doubling, old arrays are kept until deque is destroyed since a thief may still read them
+ */
+template <typename T>
+class WorkStealingDeque {
+    struct Array {
+        int64_t capacity;
+        int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> items;
+
+        explicit Array(int64_t c) : capacity(c), mask(c - 1), items(new std::atomic<T>[c]) {}
+        T get(int64_t i) const { return items[i & mask].load(std::memory_order_relaxed); }
+        void put(int64_t i, T v) { items[i & mask].store(v, std::memory_order_relaxed); }
+    };
+
+    std::atomic<int64_t> top{0};
+    std::atomic<int64_t> bottom{0};
+    std::atomic<Array *> array;
+    std::vector<std::unique_ptr<Array>> arrays;  // owner only
+
+public:
+    explicit WorkStealingDeque(int64_t capacity = 256) {
+        arrays.emplace_back(new Array(capacity));
+        array.store(arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    // owner only
+    void push(T v) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        Array *a = array.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1) a = grow(a, t, b);
+        a->put(b, v);
+        bottom.store(b + 1, std::memory_order_release);
+    }
+
+    // owner only
+    bool pop(T &v) {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Array *a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        v = a->get(b);
+        if (t == b) {
+            // last item, race with thieves
+            bool isWon = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return isWon;
+        }
+        return true;
+    }
+
+    // any thread
+    bool steal(T &v) {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) return false;
+        Array *a = array.load(std::memory_order_acquire);
+        v = a->get(t);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    int64_t size() const {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_relaxed);
+        return b > t ? b - t : 0;
+    }
+
+private:
+    Array *grow(Array *a, int64_t t, int64_t b) {
+        arrays.emplace_back(new Array(a->capacity * 2));
+        Array *bigger = arrays.back().get();
+        for (int64_t i = t; i < b; ++i) bigger->put(i, a->get(i));
+        array.store(bigger, std::memory_order_release);
+        return bigger;
+    }
 };
 }
 
 class ThreadPool {
 public:
-    ThreadPool(int nThreads = std::thread::hardware_concurrency()) {
-        MIDAS_LOG_INFO("start thread pool with " << nThreads << " threads");
+    typedef std::function<void(int id)> TTask;
+    typedef detail::WorkStealingDeque<TTask *> TDeque;
+    static const int MaxThreads = 256;
+
+    /**
+     * @param affinity optional cpu list such as "2,4,6-8", worker i is pinned to i-th cpu of list round robin
+     * without affinity workers follow midas.threads.pool placement
+     */
+    ThreadPool(int nThreads = std::thread::hardware_concurrency(), const std::string &affinity = std::string())
+        : cpus(ThreadPlacement::parse_cpu_list(affinity)) {
+        MIDAS_LOG_INFO("start thread pool with " << nThreads << " threads"
+                                                 << (affinity.empty() ? string() : " on cpu " + affinity));
         this->init();
         this->resize(nThreads);
     }
@@ -60,7 +170,10 @@ public:
     /**
      * the destructor waits for all the functions in the queue to be finished
      */
-    ~ThreadPool() { this->stop(true); }
+    ~ThreadPool() {
+        this->stop(true);
+        for (auto &d : this->deques) delete d.load(std::memory_order_relaxed);
+    }
 
     /**
      * @return the number of running threads in the pool
@@ -70,6 +183,9 @@ public:
     // number of idle threads
     int n_idle() { return this->nWaiting; }
 
+    // number of tasks taken from other workers' deques
+    uint64_t n_steals() const { return this->steals.load(std::memory_order_relaxed); }
+
     std::thread &get_thread(int i) { return *this->threads[i]; }
 
     /**
@@ -78,6 +194,7 @@ public:
      * @param nThreads must be >= 0
      */
     void resize(int nThreads) {
+        nThreads = std::min(nThreads, static_cast<int>(MaxThreads));
         if (!this->isStop && !this->isDone) {
             int oldNThreads = static_cast<int>(this->threads.size());
             if (oldNThreads <= nThreads) {  // if the number of threads is increased
@@ -90,7 +207,7 @@ public:
                 }
             } else {  // the number of threads is decreased
                 for (int i = oldNThreads - 1; i >= nThreads; --i) {
-                    *this->flags[i] = true;  // this thread will finish
+                    *this->flags[i] = true;  // this thread will finish, its pending tasks move to shared queue
                     this->threads[i]->detach();
                 }
                 {
@@ -106,18 +223,18 @@ public:
     }
 
     void clear_queue() {
-        std::function<void(int id)> *_f;
+        TTask *_f;
         while (this->q.pop(_f)) delete _f;
     }
 
     /**
-     * pops a functional wrapper to the original function
+     * pops a functional wrapper to the original function from shared queue
      * at return, delete the function even if an exception occurred
      */
     std::function<void(int)> pop() {
-        std::function<void(int id)> *_f = nullptr;
+        TTask *_f = nullptr;
         this->q.pop(_f);
-        std::unique_ptr<std::function<void(int id)>> func(_f);
+        std::unique_ptr<TTask> func(_f);
         std::function<void(int)> f;
         if (_f) f = *_f;
         return f;
@@ -161,10 +278,7 @@ public:
     auto push(F &&f, Rest &&... rest) -> std::future<decltype(f(0, rest...))> {
         auto pck = std::make_shared<std::packaged_task<decltype(f(0, rest...))(int)>>(
             std::bind(std::forward<F>(f), std::placeholders::_1, std::forward<Rest>(rest)...));
-        auto _f = new std::function<void(int id)>([pck](int id) { (*pck)(id); });
-        this->q.push(_f);
-        std::unique_lock<std::mutex> lock(this->mutex);
-        this->cv.notify_one();
+        this->enqueue(new TTask([pck](int id) { (*pck)(id); }));
         return pck->get_future();
     }
 
@@ -175,48 +289,228 @@ public:
     template <typename F>
     auto push(F &&f) -> std::future<decltype(f(0))> {
         auto pck = std::make_shared<std::packaged_task<decltype(f(0))(int)>>(std::forward<F>(f));
-        auto _f = new std::function<void(int id)>([pck](int id) { (*pck)(id); });
-        this->q.push(_f);
-        std::unique_lock<std::mutex> lock(this->mutex);
-        this->cv.notify_one();
+        this->enqueue(new TTask([pck](int id) { (*pck)(id); }));
         return pck->get_future();
     }
 
+    /**
+     * block until future is ready, a worker of this pool runs other tasks while waiting
+     */
+    template <typename T>
+    void wait(const std::future<T> &fut) {
+        WorkerContext &c = context();
+        if (c.pool != this) {
+            fut.wait();
+            return;
+        }
+
+        TTask *task = nullptr;
+        BackOff backOff;
+        while (fut.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (this->next_task(c.id, c.deque, task)) {
+                this->run(task, c.id);
+                backOff.reset();
+            } else {
+                backOff.pause();
+            }
+        }
+    }
+
+    /**
+     * continuation, run f(id, value) once fut is ready, exception of fut is passed on to returned future
+     */
+    template <typename T, typename F>
+    auto then(std::future<T> &&fut, F &&f) -> std::future<decltype(f(0, std::declval<T>()))> {
+        auto dep = std::make_shared<std::future<T>>(std::move(fut));
+        typename std::decay<F>::type fn(std::forward<F>(f));
+        return this->push([this, dep, fn](int id) {
+            this->wait(*dep);
+            return fn(id, dep->get());
+        });
+    }
+
+    template <typename F>
+    auto then(std::future<void> &&fut, F &&f) -> std::future<decltype(f(0))> {
+        auto dep = std::make_shared<std::future<void>>(std::move(fut));
+        typename std::decay<F>::type fn(std::forward<F>(f));
+        return this->push([this, dep, fn](int id) {
+            this->wait(*dep);
+            dep->get();
+            return fn(id);
+        });
+    }
+
+    /**
+     * run f(id, i) for i in [begin, end) split into chunks of grain indexes, grain 0 gives about 4 chunks per thread
+     * returns when all chunks are done, first exception is rethrown after that
+     */
+    template <typename F>
+    void parallel_for(size_t begin, size_t end, F &&f, size_t grain = 0) {
+        if (begin >= end) return;
+        size_t n = end - begin;
+        int nThreads = this->size();
+        if (nThreads == 0) {  // nobody to run tasks, caller acts as the only worker
+            for (size_t i = begin; i < end; ++i) f(0, i);
+            return;
+        }
+        if (grain == 0) grain = std::max<size_t>(1, n / (static_cast<size_t>(nThreads) * 4));
+
+        WorkerContext &c = context();
+        if (n <= grain && c.pool == this) {
+            for (size_t i = begin; i < end; ++i) f(c.id, i);
+            return;
+        }
+
+        std::vector<std::future<void>> parts;
+        parts.reserve((n + grain - 1) / grain);
+        for (size_t lo = begin; lo < end; lo += std::min(grain, end - lo)) {
+            size_t hi = lo + std::min(grain, end - lo);
+            parts.push_back(this->push([&f, lo, hi](int id) {
+                for (size_t i = lo; i < hi; ++i) f(id, i);
+            }));
+        }
+        for (auto &p : parts) this->wait(p);
+        for (auto &p : parts) p.get();
+    }
+
+    /**
+     * reduce(... reduce(reduce(identity, f(id, begin)), f(id, begin + 1)) ...) over [begin, end)
+     * each chunk is folded by one worker, partial results are combined in index order so the result is
+     * deterministic for associative reduce even if it is not commutative
+     */
+    template <typename T, typename F, typename R>
+    T parallel_reduce(size_t begin, size_t end, const T &identity, F &&f, R &&reduce, size_t grain = 0) {
+        if (begin >= end) return identity;
+        size_t n = end - begin;
+        int nThreads = std::max(this->size(), 1);
+        if (grain == 0) grain = std::max<size_t>(1, n / (static_cast<size_t>(nThreads) * 4));
+        size_t chunks = (n + grain - 1) / grain;
+
+        std::vector<T> partials(chunks, identity);
+        this->parallel_for(0, chunks,
+                           [&](int id, size_t k) {
+                               size_t lo = begin + k * grain;
+                               size_t hi = std::min(end, lo + grain);
+                               T acc = identity;
+                               for (size_t i = lo; i < hi; ++i) acc = reduce(acc, f(id, i));
+                               partials[k] = std::move(acc);
+                           },
+                           1);
+
+        T result = identity;
+        for (auto &p : partials) result = reduce(result, p);
+        return result;
+    }
+
 private:
+    struct WorkerContext {
+        ThreadPool *pool{nullptr};
+        int id{-1};
+        TDeque *deque{nullptr};
+    };
+
     ThreadPool(const ThreadPool &) = delete;
     ThreadPool(ThreadPool &&) = delete;
     ThreadPool &operator=(const ThreadPool &) = delete;
     ThreadPool &operator=(ThreadPool &&) = delete;
 
+    static WorkerContext &context() {
+        static thread_local WorkerContext c;
+        return c;
+    }
+
+    void enqueue(TTask *task) {
+        WorkerContext &c = context();
+        if (c.pool == this)
+            c.deque->push(task);
+        else
+            this->q.push(task);
+
+        // pairs with ++nWaiting before sleeping worker checks for tasks again
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (this->nWaiting.load(std::memory_order_relaxed) > 0) {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->cv.notify_one();
+        }
+    }
+
+    bool next_task(int self, TDeque *own, TTask *&task) {
+        if (own && own->pop(task)) return true;
+        if (this->q.pop(task)) return true;
+
+        int n = this->nDeques.load(std::memory_order_acquire);
+        for (int k = 1; k <= n; ++k) {
+            int victim = (self + k) % n;
+            if (victim == self) continue;
+            TDeque *d = this->deques[victim].load(std::memory_order_acquire);
+            if (d && d->steal(task)) {
+                this->steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(TTask *task, int id) {
+        std::unique_ptr<TTask> func(task);
+        (*task)(id);
+    }
+
     void set_thread(int i) {
         std::shared_ptr<std::atomic<bool>> flag(this->flags[i]);
-        auto f = [this, i, flag]() {
+        TDeque *deque = new TDeque;
+        TDeque *old = this->deques[i].exchange(deque, std::memory_order_acq_rel);
+        // a detached thread of earlier resize may still use old deque
+        if (old) this->retired.emplace_back(old);
+        if (this->nDeques.load(std::memory_order_relaxed) < i + 1) this->nDeques.store(i + 1, std::memory_order_release);
+
+        std::string cpu = this->cpus.empty() ? std::string() : std::to_string(this->cpus[i % this->cpus.size()]);
+        auto f = [this, i, flag, deque, cpu]() {
+            ThreadPlacement::instance().place("pool." + std::to_string(i), "pool", i, cpu);
+            WorkerContext &c = context();
+            c.pool = this;
+            c.id = i;
+            c.deque = deque;
+
             std::atomic<bool> &_flag = *flag;
-            std::function<void(int id)> *_f;
-            bool isPop = this->q.pop(_f);
+            TTask *task = nullptr;
             while (true) {
-                while (isPop) {  // if there is anything in the queue
-                    std::unique_ptr<std::function<void(int id)>> func(_f);
-                    (*_f)(i);
-
-                    // the thread is wanted to stop, return even if the queue is not empty yet
-                    if (_flag)
-                        return;
-                    else
-                        isPop = this->q.pop(_f);
+                bool isPop = this->next_task(i, deque, task);
+                if (!isPop) {
+                    // spin a little before sleep, a burst of small tasks usually follows
+                    BackOff backOff;
+                    while (!isPop && !_flag && !this->isDone && backOff.bounded_pause()) {
+                        isPop = this->next_task(i, deque, task);
+                    }
+                }
+                if (!isPop) {
+                    // the queues are empty here, wait for the next command
+                    std::unique_lock<std::mutex> lock(this->mutex);
+                    ++this->nWaiting;
+                    this->cv.wait(lock, [this, i, deque, &task, &isPop, &_flag]() {
+                        isPop = this->next_task(i, deque, task);
+                        return isPop || this->isDone || _flag;
+                    });
+                    --this->nWaiting;
+                    if (!isPop) break;  // if the queue is empty and this->isDone == true or *flag then stop
                 }
 
-                // the queue is empty here, wait for the next command
+                this->run(task, i);
+                // the thread is wanted to stop, return even if the queue is not empty yet
+                if (_flag) break;
+            }
+
+            // hand over what is left so that resize does not strand tasks
+            bool isMoved = false;
+            while (deque->pop(task)) {
+                this->q.push(task);
+                isMoved = true;
+            }
+            if (isMoved) {
                 std::unique_lock<std::mutex> lock(this->mutex);
-                ++this->nWaiting;
-                this->cv.wait(lock, [this, &_f, &isPop, &_flag]() {
-                    isPop = this->q.pop(_f);
-                    return isPop || this->isDone || _flag;
-                });
-
-                --this->nWaiting;
-                if (!isPop) return;  // if the queue is empty and this->isDone == true or *flag then return
+                this->cv.notify_all();
             }
+            c = WorkerContext();
         };
         this->threads[i].reset(new std::thread(f));  // compiler may not support std::make_unique()
     }
@@ -225,14 +519,20 @@ private:
         this->nWaiting = 0;
         this->isStop = false;
         this->isDone = false;
+        for (auto &d : this->deques) d.store(nullptr, std::memory_order_relaxed);
     }
 
     std::vector<std::unique_ptr<std::thread>> threads;
     std::vector<std::shared_ptr<std::atomic<bool>>> flags;
-    detail::Queue<std::function<void(int id)> *> q;
+    detail::Queue<TTask *> q;  // injection queue for tasks pushed from outside of pool
+    std::atomic<TDeque *> deques[MaxThreads];
+    std::atomic<int> nDeques{0};
+    std::vector<std::unique_ptr<TDeque>> retired;
+    std::vector<int> cpus;
     std::atomic<bool> isDone;
     std::atomic<bool> isStop;
     std::atomic<int> nWaiting;  // how many threads are waiting
+    std::atomic<uint64_t> steals{0};
 
     std::mutex mutex;
     std::condition_variable cv;
@@ -0,0 +1,327 @@
+#ifndef MIDAS_THREAD_PLACEMENT_H
+#define MIDAS_THREAD_PLACEMENT_H
+
+#include <dirent.h>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "midas/MidasConfig.h"
+#include "utils/MidasUtils.h"
+#include "utils/log/Log.h"
+
+using namespace std;
+
+namespace midas {
+
+/**
+ * config driven placement of framework threads, each thread calls place() once at start of its run loop
+ * config under midas.threads, group is the role of thread such as channel, pool, market, trade or disruptor name,
+ * dotted group such as mktdata_disruptor.journal falls back to settings of mktdata_disruptor:
+ *   midas.threads.<group>.cpu_set    cpu list "2,4,6-8" (inclusive ranges)
+ *   midas.threads.<group>.spread     true to pin i-th thread of group to i-th cpu of cpu_set only
+ *   midas.threads.<group>.numa_node  preferred memory node of thread, -1 leaves os default
+ *   midas.threads.avoid_isolated     thread without cpu_set is kept off isolcpus, default true
+ * cpus listed in /sys/devices/system/cpu/isolated are reserved for explicitly configured threads
+ */
+class ThreadPlacement {
+public:
+    struct Entry {
+        string name;
+        string group;
+        string cpus;
+        int numaNode;
+    };
+
+private:
+    std::mutex mtx;
+    std::map<pid_t, Entry> entries;
+    vector<int> isolatedCpus;
+    vector<int> onlineCpus;
+
+public:
+    static ThreadPlacement& instance() {
+        static ThreadPlacement placement;
+        return placement;
+    }
+
+    /**
+     * name calling thread and apply placement of its group
+     * @param index position of thread within group, used by spread
+     * @param cpuOverride cpu list taking precedence over group cpu_set, e.g. channel cpu_affinity
+     */
+    bool place(const string& name, const string& group, int index = -1, const string& cpuOverride = string()) {
+        pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+
+        Config& cfg = Config::instance();
+        vector<int> cpus = parse_cpu_list(cpuOverride.empty() ? setting(group, "cpu_set") : cpuOverride);
+        if (!cpus.empty() && index >= 0 && setting(group, "spread") == "true") {
+            cpus = vector<int>{cpus[index % cpus.size()]};
+        }
+        if (cpus.empty() && !isolatedCpus.empty() && cfg.get<bool>("midas.threads.avoid_isolated", true)) {
+            cpus = housekeeping_cpus();
+        }
+
+        bool isOk = true;
+        if (!cpus.empty()) {
+            cpu_set_t mask;
+            CPU_ZERO(&mask);
+            for (int cpu : cpus) CPU_SET(cpu, &mask);
+            if (sched_setaffinity(0, sizeof(mask), &mask) != 0) {
+                MIDAS_LOG_ERROR("failed to pin thread " << name << " to cpu " << to_cpu_list(cpus) << " : "
+                                                        << strerror(errno));
+                isOk = false;
+            }
+        }
+
+        const string numaSetting = setting(group, "numa_node");
+        int numaNode = numaSetting.empty() ? -1 : atoi(numaSetting.c_str());
+        if (numaNode >= 0 && !set_memory_node(numaNode)) {
+            MIDAS_LOG_ERROR("failed to bind memory of thread " << name << " to numa node " << numaNode << " : "
+                                                               << strerror(errno));
+            isOk = false;
+        }
+
+        pid_t tid = get_tid();
+        MIDAS_LOG_INFO("thread " << name << " tid " << tid << " group " << group << " cpu "
+                                 << (cpus.empty() ? string("any") : to_cpu_list(cpus)) << " numa node " << numaNode);
+        std::lock_guard<std::mutex> guard(mtx);
+        entries[tid] = Entry{name, group, to_cpu_list(cpus), numaNode};
+        return isOk;
+    }
+
+    const vector<int>& isolated() const { return isolatedCpus; }
+
+    /**
+     * online cpus not in isolcpus
+     */
+    vector<int> housekeeping_cpus() const {
+        vector<int> result;
+        for (int cpu : onlineCpus) {
+            if (!std::binary_search(isolatedCpus.begin(), isolatedCpus.end(), cpu)) result.push_back(cpu);
+        }
+        return result;
+    }
+
+    /**
+     * one line per thread of process, framework threads show their group, others such as vendor api threads show '-'
+     * cpu time is user plus system time, last is the cpu the thread last ran on
+     */
+    void report(ostream& os) {
+        std::map<pid_t, Entry> placed;
+        {
+            std::lock_guard<std::mutex> guard(mtx);
+            placed = entries;
+        }
+
+        os << "online cpu " << to_cpu_list(onlineCpus) << " isolated cpu "
+           << (isolatedCpus.empty() ? string("none") : to_cpu_list(isolatedCpus)) << '\n';
+        os << std::left << setw(8) << "tid" << setw(17) << "name" << setw(20) << "group" << setw(16) << "affinity"
+           << setw(6) << "numa" << setw(6) << "last" << setw(12) << "cpu ms" << "nvcsw" << '\n';
+
+        const double msPerTick = 1000.0 / sysconf(_SC_CLK_TCK);
+        vector<pid_t> tids = task_ids();
+        {
+            // forget exited threads so a reused tid is not reported under old name
+            std::lock_guard<std::mutex> guard(mtx);
+            for (auto itr = entries.begin(); itr != entries.end();) {
+                if (std::binary_search(tids.begin(), tids.end(), itr->first))
+                    ++itr;
+                else
+                    itr = entries.erase(itr);
+            }
+        }
+        for (pid_t tid : tids) {
+            string taskPath = "/proc/self/task/" + std::to_string(tid);
+            string comm;
+            std::ifstream(taskPath + "/comm") >> comm;
+
+            long utime = 0, stime = 0;
+            int lastCpu = -1;
+            {
+                std::ifstream statFile(taskPath + "/stat");
+                string stat((std::istreambuf_iterator<char>(statFile)), std::istreambuf_iterator<char>());
+                size_t end = stat.rfind(')');
+                if (end == string::npos) continue;  // exited meanwhile
+                istringstream fields(stat.substr(end + 2));
+                string field;
+                for (int i = 3; fields >> field; ++i) {
+                    if (i == 14)
+                        utime = atol(field.c_str());
+                    else if (i == 15)
+                        stime = atol(field.c_str());
+                    else if (i == 39) {
+                        lastCpu = atoi(field.c_str());
+                        break;
+                    }
+                }
+            }
+
+            long nonVoluntary = 0;
+            {
+                std::ifstream statusFile(taskPath + "/status");
+                string line;
+                while (std::getline(statusFile, line)) {
+                    if (line.compare(0, 27, "nonvoluntary_ctxt_switches:") == 0) nonVoluntary = atol(line.c_str() + 27);
+                }
+            }
+
+            string affinity;
+            cpu_set_t mask;
+            CPU_ZERO(&mask);
+            if (sched_getaffinity(tid, sizeof(mask), &mask) == 0) {
+                vector<int> cpus;
+                for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                    if (CPU_ISSET(cpu, &mask)) cpus.push_back(cpu);
+                }
+                affinity = to_cpu_list(cpus);
+            }
+
+            auto itr = placed.find(tid);
+            const bool isPlaced = itr != placed.end();
+            string node = isPlaced && itr->second.numaNode >= 0 ? std::to_string(itr->second.numaNode) : string("-");
+            os << setw(8) << tid << setw(17) << (isPlaced ? itr->second.name : comm) << setw(20)
+               << (isPlaced ? itr->second.group : string("-")) << setw(16) << affinity << setw(6) << node << setw(6)
+               << lastCpu << setw(12) << static_cast<long>((utime + stime) * msPerTick) << nonVoluntary << '\n';
+        }
+        os << std::right;
+    }
+
+    /**
+     * parse kernel cpu list format "0-3,8,10-11", ranges are inclusive
+     */
+    static vector<int> parse_cpu_list(const string& list) {
+        vector<int> result;
+        size_t start = 0;
+        while (start < list.size()) {
+            size_t comma = list.find(',', start);
+            string part = list.substr(start, comma == string::npos ? string::npos : comma - start);
+            size_t dash = part.find('-');
+            if (dash != string::npos) {
+                int lo = atoi(part.substr(0, dash).c_str()), hi = atoi(part.substr(dash + 1).c_str());
+                for (int i = lo; i <= hi; ++i) result.push_back(i);
+            } else if (part.find_first_of("0123456789") != string::npos) {
+                result.push_back(atoi(part.c_str()));
+            }
+            if (comma == string::npos) break;
+            start = comma + 1;
+        }
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    static string to_cpu_list(const vector<int>& cpus) {
+        ostringstream os;
+        for (size_t i = 0; i < cpus.size();) {
+            size_t j = i;
+            while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+            if (i) os << ',';
+            os << cpus[i];
+            if (j > i) os << '-' << cpus[j];
+            i = j + 1;
+        }
+        return os.str();
+    }
+
+    /**
+     * preferred memory node of calling thread, -1 goes back to os default
+     * threads spawned afterwards by calling thread inherit the policy
+     */
+    static bool set_memory_node(int node) {
+        if (node < 0) return syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0) == 0;
+        unsigned long mask[16] = {0};
+        if (node >= static_cast<int>(sizeof(mask) * 8)) {
+            errno = EINVAL;
+            return false;
+        }
+        mask[node / (sizeof(unsigned long) * 8)] = 1UL << (node % (sizeof(unsigned long) * 8));
+        return syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask, sizeof(mask) * 8) == 0;
+    }
+
+private:
+    ThreadPlacement() {
+        isolatedCpus = parse_cpu_list(read_line("/sys/devices/system/cpu/isolated"));
+        onlineCpus = parse_cpu_list(read_line("/sys/devices/system/cpu/online"));
+        if (onlineCpus.empty()) {
+            for (long cpu = 0; cpu < sysconf(_SC_NPROCESSORS_ONLN); ++cpu) onlineCpus.push_back(static_cast<int>(cpu));
+        }
+    }
+
+    /**
+     * value of midas.threads.<group>.<key>, searched up the dotted group, empty if not configured
+     */
+    static string setting(string group, const string& key) {
+        Config& cfg = Config::instance();
+        while (true) {
+            string value = cfg.get<string>("midas.threads." + group + "." + key, "");
+            if (!value.empty()) return value;
+            size_t dot = group.rfind('.');
+            if (dot == string::npos) return value;
+            group.erase(dot);
+        }
+    }
+
+    static string read_line(const string& path) {
+        string line;
+        std::ifstream file(path);
+        std::getline(file, line);
+        return line;
+    }
+
+    static vector<pid_t> task_ids() {
+        vector<pid_t> tids;
+        DIR* dir = opendir("/proc/self/task");
+        if (!dir) return tids;
+        while (struct dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') tids.push_back(static_cast<pid_t>(atoi(entry->d_name)));
+        }
+        closedir(dir);
+        std::sort(tids.begin(), tids.end());
+        return tids;
+    }
+};
+
+/**
+ * allocations made by calling thread within scope prefer given numa node, used to place ring buffer near its consumer
+ * previous policy of thread is restored on exit
+ */
+class NumaScope {
+    const bool isBound;
+    int oldMode{MPOL_DEFAULT};
+    unsigned long oldMask[16] = {0};
+
+public:
+    explicit NumaScope(int node) : isBound(node >= 0) {
+        if (!isBound) return;
+        if (syscall(SYS_get_mempolicy, &oldMode, oldMask, sizeof(oldMask) * 8, nullptr, 0) != 0) oldMode = MPOL_DEFAULT;
+        if (!ThreadPlacement::set_memory_node(node)) {
+            MIDAS_LOG_ERROR("failed to prefer numa node " << node << " : " << strerror(errno));
+        }
+    }
+    ~NumaScope() {
+        if (!isBound) return;
+        if (oldMode == MPOL_DEFAULT)
+            syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+        else
+            syscall(SYS_set_mempolicy, oldMode, oldMask, sizeof(oldMask) * 8);
+    }
+
+    NumaScope(const NumaScope&) = delete;
+    NumaScope& operator=(const NumaScope&) = delete;
+};
+}
+
+#endif
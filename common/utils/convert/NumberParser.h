@@ -0,0 +1,51 @@
+#ifndef MIDAS_NUMBER_PARSER_H
+#define MIDAS_NUMBER_PARSER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * number parsing over [begin, end) without terminating zero and without allocation
+ * parsing stops at first character which does not belong to number
+ */
+namespace midas {
+
+inline int64_t parse_int64(const char* begin, const char* end) {
+    bool isNegative = begin < end && *begin == '-';
+    if (isNegative || (begin < end && *begin == '+')) ++begin;
+    int64_t v = 0;
+    for (; begin < end && *begin >= '0' && *begin <= '9'; ++begin) v = v * 10 + (*begin - '0');
+    return isNegative ? -v : v;
+}
+
+/**
+ * plain decimal up to 15 significant digits is exact, exponent, nan, inf or longer go through strtod
+ */
+inline double parse_double(const char* begin, const char* end) {
+    static const double pow10[] = {1e0, 1e1, 1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                   1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+    const char* p = begin;
+    bool isNegative = p < end && *p == '-';
+    if (isNegative || (p < end && *p == '+')) ++p;
+    uint64_t mantissa = 0;
+    int digits = 0, fraction = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p, ++digits) mantissa = mantissa * 10 + (*p - '0');
+    if (p < end && *p == '.') {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, ++digits, ++fraction) mantissa = mantissa * 10 + (*p - '0');
+    }
+    bool isPlain = p == end || (*p != 'e' && *p != 'E');
+    if (isPlain && digits > 0 && digits <= 15) {
+        double v = static_cast<double>(mantissa) / pow10[fraction];
+        return isNegative ? -v : v;
+    }
+    char tmp[64];
+    size_t n = std::min<size_t>(end - begin, sizeof(tmp) - 1);
+    memcpy(tmp, begin, n);
+    tmp[n] = '\0';
+    return strtod(tmp, nullptr);
+}
+}
+
+#endif
@@ -99,6 +99,8 @@ inline void LogWriterT<Output, Format, LogWriterPolicy::ASYNC>::process_queue(si
 
 template <class Output, class Format>
 inline void LogWriterT<Output, Format, LogWriterPolicy::ASYNC>::service() {
+    // only named, thread placement logs through this writer
+    pthread_setname_np(pthread_self(), "log_writer");
     try {
         keepAliveTimer_m.expires_from_now(boost::posix_time::pos_infin);
         keepAliveTimer_m.async_wait(boost::bind(&LogWriterT::keep_alive, this, boost::asio::placeholders::error));
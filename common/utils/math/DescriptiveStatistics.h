@@ -3,16 +3,122 @@
 
 #include <algorithm>
 #include <cmath>
-#include <deque>
+#include <cstdint>
 #include <functional>
+#include <vector>
 
 namespace midas {
 
+/**
+ * circular buffer with random access, grows only when full
+ * fixed size window never grows after first allocation
+ */
+template <typename T>
+class RingWindow {
+private:
+    std::vector<T> buffer;
+    size_t head{0};
+    size_t count{0};
+
+public:
+    void reserve(size_t n) {
+        if (n > buffer.size()) relocate(n);
+    }
+
+    size_t size() const { return count; }
+
+    bool empty() const { return count == 0; }
+
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+
+    T& operator[](size_t i) { return buffer[wrap(head + i)]; }
+
+    const T& operator[](size_t i) const { return buffer[wrap(head + i)]; }
+
+    T& front() { return buffer[head]; }
+
+    T& back() { return buffer[wrap(head + count - 1)]; }
+
+    void push_back(const T& v) {
+        if (count == buffer.size()) relocate(std::max<size_t>(16, buffer.size() * 2));
+        buffer[wrap(head + count)] = v;
+        ++count;
+    }
+
+    void pop_front() {
+        head = wrap(head + 1);
+        --count;
+    }
+
+    void pop_back() { --count; }
+
+    /**
+     * make elements contiguous from buffer begin so that std algorithms can work on them
+     */
+    T* linearize() {
+        if (head + count > buffer.size()) relocate(buffer.size());
+        if (head != 0) {
+            std::move(buffer.begin() + head, buffer.begin() + head + count, buffer.begin());
+            head = 0;
+        }
+        return buffer.data();
+    }
+
+private:
+    size_t wrap(size_t i) const { return i >= buffer.size() ? i - buffer.size() : i; }
+
+    void relocate(size_t capacity) {
+        std::vector<T> v(capacity);
+        for (size_t i = 0; i < count; ++i) v[i] = (*this)[i];
+        buffer.swap(v);
+        head = 0;
+    }
+};
+
+/**
+ * Kahan compensated running sum, values can be added and removed
+ */
+struct KahanSum {
+    double sum{0};
+    double compensation{0};
+
+    void add(double v) {
+        double y = v - compensation;
+        double t = sum + y;
+        compensation = (t - sum) - y;
+        sum = t;
+    }
+
+    void clear() { sum = compensation = 0; }
+};
+
+/**
+ * rolling window statistics, mean, variance, skewness, kurtosis, min and max cost O(1) per update
+ * power sums are kept over values shifted by a reference close to data to limit cancellation,
+ * and rebuilt from window every max(window, 1024) evictions, so shift follows data and add/remove error is bounded
+ * min and max are kept by monotonic queues, rebuilt lazily after out of order modification like sort
+ */
 class DescriptiveStatistics {
 private:
+    struct Extreme {
+        uint64_t sequence;
+        double value;
+    };
+
     const size_t INFINITE_WINDOW = 0;
+    const size_t MIN_RESYNC_INTERVAL = 1 << 10;
     size_t windowSize{INFINITE_WINDOW};
-    std::deque<double> dq;
+    RingWindow<double> dq;
+    double shift{0};
+    KahanSum s1, s2, s3, s4;  // sum of (x - shift)^k
+    size_t evictions{0};      // since last rebuild of sums
+    RingWindow<Extreme> maxQueue;
+    RingWindow<Extreme> minQueue;
+    uint64_t headSequence{0};  // sequence of dq[0]
+    bool isExtremeDirty{false};
 
 public:
     DescriptiveStatistics() {}
@@ -23,17 +129,21 @@ public:
         if (windowSize != INFINITE_WINDOW) {
             size_t n = size();
             if (n == windowSize) {
-                dq.pop_front();
-                dq.push_back(v);
+                evict_front();
+                push(v);
             } else if (n < windowSize) {
-                dq.push_back(v);
+                push(v);
             }
         } else {
-            dq.push_back(v);
+            push(v);
         }
     }
 
-    void sort() { std::sort(dq.begin(), dq.end()); }
+    void sort() {
+        double* p = dq.linearize();
+        std::sort(p, p + size());
+        isExtremeDirty = true;
+    }
 
     /**
      * favor percentile operation, those need sorted data
@@ -44,25 +154,31 @@ public:
         insert_sort();
     }
 
-    void remove_most_recent_value() { dq.pop_back(); }
+    void remove_most_recent_value() {
+        accumulate(dq.back(), -1.0);
+        dq.pop_back();
+        isExtremeDirty = true;
+    }
 
     double replace_most_recent_value(double v) {
-        double old = *(dq.end() - 1);
-        *(dq.end() - 1) = v;
+        double old = dq.back();
+        accumulate(old, -1.0);
+        accumulate(v, 1.0);
+        dq.back() = v;
+        isExtremeDirty = true;
         return old;
     }
 
     double get_mean() {
         if (size() == 0) return 0;
-        double sum = get_sum();
-        return sum / size();
+        return shift + s1.sum / size();
     }
 
     double get_geometric_mean() {
         if (size() == 0) return 0;
         double sumOfLog = 0;
-        for (double x : dq) {
-            sumOfLog += std::log(x);
+        for (size_t i = 0; i < size(); ++i) {
+            sumOfLog += std::log(dq[i]);
         }
         return std::exp(sumOfLog / size());
     }
@@ -82,68 +198,66 @@ public:
         size_t n = size();
         if (n <= 2) return 0;
 
-        double m = get_mean();
-        double accum = 0.0;
-        double accum2 = 0.0;
+        double variance = get_variance();
+        if (variance <= 0) return 0;
 
-        for (double x : dq) {
-            double d = x - m;
-            accum += d * d;
-            accum2 += d;
-        }
+        double accum3 = central_moment3() / (variance * std::sqrt(variance));
+        return n / ((n - 1.0) * (n - 2.0)) * accum3;
+    }
 
-        double variance = (accum - accum2 * accum2 / n) / (n - 1);
-        double accum3 = 0.0;
+    /**
+     * bias corrected excess kurtosis
+     */
+    double get_kurtosis() {
+        double n = size();
+        if (n <= 3) return 0;
 
-        for (double x : dq) {
-            double d = x - m;
-            accum3 += d * d * d;
-        }
+        double variance = get_variance();
+        if (variance <= 0) return 0;
 
-        accum3 /= variance * std::sqrt(variance);
-        return n / ((n - 1.0) * (n - 2.0)) * accum3;
+        double accum4 = central_moment4() / (variance * variance);
+        return (n * (n + 1.0)) / ((n - 1.0) * (n - 2.0) * (n - 3.0)) * accum4 -
+               3.0 * (n - 1.0) * (n - 1.0) / ((n - 2.0) * (n - 3.0));
     }
 
     double get_max() {
-        if (size() == 0)
-            return 0;
-        else
-            return *std::max_element(dq.begin(), dq.end());
+        if (size() == 0) return 0;
+        rebuild_extremes();
+        return maxQueue.front().value;
     }
 
     double get_min() {
-        if (size() == 0)
-            return 0;
-        else
-            return *std::min_element(dq.begin(), dq.end());
+        if (size() == 0) return 0;
+        rebuild_extremes();
+        return minQueue.front().value;
     }
 
     size_t size() const { return dq.size(); }
 
-    double get_sum() { return std::accumulate(dq.begin(), dq.end(), 0.0); }
+    double get_sum() { return s1.sum + size() * shift; }
 
-    double get_sum_square() {
-        double sumSq = 0.0;
+    double get_sum_square() { return s2.sum + 2 * shift * s1.sum + size() * shift * shift; }
 
-        for (double x : dq) {
-            sumSq += x * x;
-        }
-
-        return sumSq;
+    void clear() {
+        dq.clear();
+        reset_sums();
+        maxQueue.clear();
+        minQueue.clear();
+        headSequence = 0;
+        isExtremeDirty = false;
     }
 
-    void clear() { dq.clear(); }
-
     size_t get_window_size() { return windowSize; }
 
     void set_window_size(size_t _windowSize) {
         windowSize = _windowSize;
-        if (windowSize != INFINITE_WINDOW && windowSize < dq.size()) {
-            auto count = dq.size() - windowSize;
-            while (count > 0) {
-                dq.pop_front();
-                --count;
+        if (windowSize != INFINITE_WINDOW) {
+            while (windowSize < dq.size()) {
+                evict_front();
             }
+            dq.reserve(windowSize);
+            maxQueue.reserve(windowSize);
+            minQueue.reserve(windowSize);
         }
     }
 
@@ -162,26 +276,99 @@ public:
     }
 
 private:
-    double _get_variance(bool isBiasCorrected) {
-        if (size() <= 1) return 0;
-        double mean = get_mean();
+    void push(double v) {
+        if (dq.empty()) reset_sums(v);
+        dq.push_back(v);
+        accumulate(v, 1.0);
+
+        if (!isExtremeDirty) push_extreme(headSequence + dq.size() - 1, v);
+    }
 
-        double accum = 0.0;
-        double dev = 0.0;
-        double accum2 = 0.0;
+    void evict_front() {
+        double v = dq.front();
+        dq.pop_front();
+        accumulate(v, -1.0);
 
-        for (double x : dq) {
-            dev = x - mean;
-            accum += dev * dev;
-            accum2 += dev;
+        if (!isExtremeDirty) {
+            if (!maxQueue.empty() && maxQueue.front().sequence == headSequence) maxQueue.pop_front();
+            if (!minQueue.empty() && minQueue.front().sequence == headSequence) minQueue.pop_front();
         }
+        ++headSequence;
+
+        if (++evictions >= std::max(MIN_RESYNC_INTERVAL, windowSize)) resync();
+    }
+
+    void accumulate(double v, double sign) {
+        double y = v - shift;
+        double y2 = y * y;
+        s1.add(sign * y);
+        s2.add(sign * y2);
+        s3.add(sign * y2 * y);
+        s4.add(sign * y2 * y2);
+    }
+
+    void reset_sums(double newShift = 0) {
+        shift = newShift;
+        s1.clear();
+        s2.clear();
+        s3.clear();
+        s4.clear();
+        evictions = 0;
+    }
+
+    /**
+     * recompute power sums from window around current data
+     */
+    void resync() {
+        reset_sums(dq.empty() ? 0 : dq.front());
+        for (size_t i = 0; i < size(); ++i) accumulate(dq[i], 1.0);
+    }
+
+    void push_extreme(uint64_t sequence, double v) {
+        while (!maxQueue.empty() && maxQueue.back().value <= v) maxQueue.pop_back();
+        maxQueue.push_back(Extreme{sequence, v});
+        while (!minQueue.empty() && minQueue.back().value >= v) minQueue.pop_back();
+        minQueue.push_back(Extreme{sequence, v});
+    }
+
+    void rebuild_extremes() {
+        if (!isExtremeDirty) return;
+        maxQueue.clear();
+        minQueue.clear();
+        headSequence = 0;
+        for (size_t i = 0; i < size(); ++i) push_extreme(i, dq[i]);
+        isExtremeDirty = false;
+    }
+
+    /**
+     * sum of (x - mean)^3 from shifted power sums
+     */
+    double central_moment3() {
+        double n = size();
+        double m = s1.sum / n;
+        return s3.sum - 3 * m * s2.sum + 3 * m * m * s1.sum - n * m * m * m;
+    }
+
+    /**
+     * sum of (x - mean)^4 from shifted power sums
+     */
+    double central_moment4() {
+        double n = size();
+        double m = s1.sum / n;
+        double m2 = m * m;
+        return s4.sum - 4 * m * s3.sum + 6 * m2 * s2.sum - 4 * m2 * m * s1.sum + n * m2 * m2;
+    }
+
+    double _get_variance(bool isBiasCorrected) {
+        if (size() <= 1) return 0;
 
         double len = size();
+        double accum = std::max(0.0, s2.sum - s1.sum * s1.sum / len);
 
         if (isBiasCorrected) {
-            return (accum - accum2 * accum2 / len) / (len - 1.0);
+            return accum / (len - 1.0);
         } else {
-            return (accum - accum2 * accum2 / len) / len;
+            return accum / len;
         }
     }
 
@@ -191,14 +378,14 @@ private:
     void insert_sort() {
         if (size() <= 1) return;
 
-        auto itr = dq.end() - 1;
-        double key = *itr;
-        --itr;
-        while (itr >= dq.begin() && (key < *itr)) {
-            *(itr + 1) = *itr;
-            --itr;
+        size_t i = size() - 1;
+        double key = dq[i];
+        while (i > 0 && key < dq[i - 1]) {
+            dq[i] = dq[i - 1];
+            --i;
         }
-        *(itr + 1) = key;
+        dq[i] = key;
+        isExtremeDirty = true;
     }
 };
 }
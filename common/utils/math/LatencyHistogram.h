@@ -0,0 +1,176 @@
+#ifndef MIDAS_LATENCY_HISTOGRAM_H
+#define MIDAS_LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace midas {
+
+/**
+ * lock free log linear histogram of nanosecond latency, HDR like layout
+ * values below 64 are exact, above that every power of 2 is split into 32 buckets, relative error under 1/32
+ * record is a few relaxed atomic adds so it can be called from hot path of any thread
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 5;
+    static constexpr uint64_t SUB_COUNT = 1 << SUB_BITS;
+    static constexpr int MAX_BITS = 40;  // about 18 minutes, larger value is clamped
+    static constexpr uint64_t MAX_VALUE = (uint64_t(1) << MAX_BITS) - 1;
+    static constexpr size_t BUCKET_COUNT = (MAX_BITS - SUB_BITS) * SUB_COUNT + SUB_COUNT;
+
+    /**
+     * plain copy of counters taken by snapshot
+     */
+    struct Snapshot {
+        uint64_t count{0};
+        uint64_t sum{0};
+        uint64_t min{0};
+        uint64_t max{0};
+        std::vector<uint64_t> buckets;
+
+        double mean() const { return count ? static_cast<double>(sum) / count : 0; }
+
+        /**
+         * upper bound of bucket holding the p-th percentile, p in [0, 100]
+         */
+        uint64_t percentile(double p) const {
+            if (count == 0) return 0;
+            uint64_t rank = static_cast<uint64_t>(std::max(1.0, p * 0.01 * count + 0.5));
+            rank = std::min(rank, count);
+            uint64_t seen = 0;
+            for (size_t i = 0; i < buckets.size(); ++i) {
+                seen += buckets[i];
+                if (seen >= rank) return std::min(max, bucket_upper(i));
+            }
+            return max;
+        }
+    };
+
+private:
+    std::atomic<uint64_t> buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> min;
+    std::atomic<uint64_t> max;
+
+public:
+    LatencyHistogram() { reset(); }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t ns) {
+        if (ns > MAX_VALUE) ns = MAX_VALUE;
+        buckets[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(ns, std::memory_order_relaxed);
+
+        uint64_t m = max.load(std::memory_order_relaxed);
+        while (ns > m && !max.compare_exchange_weak(m, ns, std::memory_order_relaxed)) {
+        }
+        m = min.load(std::memory_order_relaxed);
+        while (ns < m && !min.compare_exchange_weak(m, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * copy counters, optionally reset them in same pass so that next interval starts empty
+     * a value recorded concurrently lands in either interval, never lost
+     */
+    Snapshot snapshot(bool isReset = false) {
+        Snapshot s;
+        s.buckets.resize(BUCKET_COUNT);
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            s.buckets[i] = isReset ? buckets[i].exchange(0, std::memory_order_relaxed)
+                                   : buckets[i].load(std::memory_order_relaxed);
+            s.count += s.buckets[i];
+        }
+        if (isReset) {
+            count.store(0, std::memory_order_relaxed);
+            s.sum = sum.exchange(0, std::memory_order_relaxed);
+            s.min = min.exchange(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+            s.max = max.exchange(0, std::memory_order_relaxed);
+        } else {
+            s.sum = sum.load(std::memory_order_relaxed);
+            s.min = min.load(std::memory_order_relaxed);
+            s.max = max.load(std::memory_order_relaxed);
+        }
+        if (s.count == 0) s.min = 0;
+        return s;
+    }
+
+    void reset() {
+        for (auto& b : buckets) b.store(0, std::memory_order_relaxed);
+        count.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t get_count() const { return count.load(std::memory_order_relaxed); }
+
+    static size_t bucket_index(uint64_t v) {
+        if (v < 2 * SUB_COUNT) return static_cast<size_t>(v);
+        int shift = 63 - __builtin_clzll(v) - SUB_BITS;
+        return static_cast<size_t>(shift) * SUB_COUNT + static_cast<size_t>(v >> shift);
+    }
+
+    static uint64_t bucket_upper(size_t index) {
+        if (index < 2 * SUB_COUNT) return index;
+        uint64_t shift = index / SUB_COUNT - 1;
+        uint64_t sub = index - shift * SUB_COUNT;
+        return ((sub + 1) << shift) - 1;
+    }
+};
+
+/**
+ * named latency histograms of pipeline stages, stages are fixed at construction
+ */
+class LatencyRecorder {
+public:
+    std::atomic<bool> isEnabled{true};
+
+private:
+    std::vector<std::string> names;
+    std::vector<std::unique_ptr<LatencyHistogram>> stages;
+
+public:
+    explicit LatencyRecorder(const std::vector<std::string>& names_) : names(names_) {
+        for (size_t i = 0; i < names.size(); ++i) stages.emplace_back(new LatencyHistogram);
+    }
+
+    void record(size_t stage, uint64_t ns) { stages[stage]->record(ns); }
+
+    LatencyHistogram& get(size_t stage) { return *stages[stage]; }
+
+    size_t size() const { return stages.size(); }
+
+    /**
+     * one line per stage in nanoseconds, reset starts a new interval
+     */
+    void report(std::ostream& os, bool isReset = false) {
+        os << std::setw(12) << "stage" << std::setw(12) << "count" << std::setw(12) << "mean" << std::setw(12)
+           << "p50" << std::setw(12) << "p99" << std::setw(12) << "p99.9" << std::setw(12) << "max" << '\n';
+        for (size_t i = 0; i < stages.size(); ++i) {
+            LatencyHistogram::Snapshot s = stages[i]->snapshot(isReset);
+            os << std::setw(12) << names[i] << std::setw(12) << s.count << std::setw(12)
+               << static_cast<uint64_t>(s.mean()) << std::setw(12) << s.percentile(50) << std::setw(12)
+               << s.percentile(99) << std::setw(12) << s.percentile(99.9) << std::setw(12) << s.max << '\n';
+        }
+    }
+
+    void reset() {
+        for (auto& stage : stages) stage->reset();
+    }
+};
+}
+
+#endif
@@ -0,0 +1,228 @@
+#ifndef MIDAS_ROLLING_KERNELS_H
+#define MIDAS_ROLLING_KERNELS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MIDAS_ROLLING_AVX2 1
+#endif
+
+/**
+ * rolling indicator kernels over contiguous columns, output has same length as input
+ * before window is full, value is calculated over available data, same as DescriptiveStatistics
+ * window 0 means infinite window, AVX2 path is used when compiled with -mavx2, otherwise scalar
+ */
+namespace midas {
+
+namespace detail {
+const size_t RollingBlock = 512;  // outputs per restart of prefix sums
+
+/**
+ * out[i] = (prefix[i + 1] - prefix[i + 1 - window]) * scale for i in [begin, n)
+ */
+inline void window_diff(const double* prefix, size_t begin, size_t n, size_t window, double scale, double* out) {
+    size_t i = begin;
+#ifdef MIDAS_ROLLING_AVX2
+    const __m256d s = _mm256_set1_pd(scale);
+    for (; i + 4 <= n; i += 4) {
+        __m256d hi = _mm256_loadu_pd(prefix + i + 1);
+        __m256d lo = _mm256_loadu_pd(prefix + i + 1 - window);
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_sub_pd(hi, lo), s));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = (prefix[i + 1] - prefix[i + 1 - window]) * scale;
+    }
+}
+
+/**
+ * block prefix and suffix max of van Herk/Gil-Werman, combine step is branch free
+ */
+template <typename Compare>
+inline void rolling_extreme(const double* in, size_t n, size_t window, double* out, Compare better) {
+    if (n == 0) return;
+    if (window == 0 || window > n) window = n;
+
+    std::vector<double> prefix(n), suffix(n);
+    for (size_t start = 0; start < n; start += window) {
+        size_t end = std::min(n, start + window);
+        prefix[start] = in[start];
+        for (size_t i = start + 1; i < end; ++i) prefix[i] = better(in[i], prefix[i - 1]) ? in[i] : prefix[i - 1];
+        suffix[end - 1] = in[end - 1];
+        for (size_t i = end - 1; i > start; --i) suffix[i - 1] = better(in[i - 1], suffix[i]) ? in[i - 1] : suffix[i];
+    }
+
+    size_t full = window - 1;
+    for (size_t i = 0; i < full; ++i) out[i] = prefix[i];
+    for (size_t i = full; i < n; ++i) {
+        double a = suffix[i - full], b = prefix[i];
+        out[i] = better(b, a) ? b : a;
+    }
+}
+}
+
+/**
+ * simple moving average
+ * prefix sums restart every block of outputs and are taken over values shifted by first value of block range,
+ * so error depends on block and window length instead of history length
+ */
+inline void rolling_mean(const double* in, size_t n, size_t window, double* out) {
+    if (n == 0) return;
+    if (window == 0 || window > n) window = n;
+
+    const size_t block = std::max(detail::RollingBlock, 4 * window);
+    std::vector<double> prefix(std::min(n, block + window) + 1);
+    for (size_t begin = 0; begin < n; begin += block) {
+        size_t end = std::min(n, begin + block);
+        size_t from = begin + 1 >= window ? begin + 1 - window : 0;
+        const double shift = in[from];
+        prefix[0] = 0;
+        for (size_t i = from; i < end; ++i) prefix[i + 1 - from] = prefix[i - from] + (in[i] - shift);
+
+        size_t full = std::max(begin, window - 1);
+        for (size_t i = begin; i < full; ++i) out[i] = prefix[i + 1] / (i + 1);
+        detail::window_diff(prefix.data(), full - from, end - from, window, 1.0 / window, out + from);
+        for (size_t i = begin; i < end; ++i) out[i] += shift;
+    }
+}
+
+/**
+ * bias corrected rolling standard deviation, 0 when less than 2 values
+ * sums restart per block like rolling_mean, shift keeps squares small to limit cancellation error
+ */
+inline void rolling_std(const double* in, size_t n, size_t window, double* out) {
+    if (n == 0) return;
+    if (window == 0 || window > n) window = n;
+
+    auto stddev = [](double s, double q, double k) {
+        if (k <= 1) return 0.0;
+        return std::sqrt(std::max(0.0, (q - s * s / k) / (k - 1)));
+    };
+
+    const size_t block = std::max(detail::RollingBlock, 4 * window);
+    std::vector<double> sum(std::min(n, block + window) + 1), sumSq(sum.size());
+    for (size_t begin = 0; begin < n; begin += block) {
+        size_t end = std::min(n, begin + block);
+        size_t from = begin + 1 >= window ? begin + 1 - window : 0;
+        const double shift = in[from];
+        sum[0] = sumSq[0] = 0;
+        for (size_t i = from; i < end; ++i) {
+            double y = in[i] - shift;
+            sum[i + 1 - from] = sum[i - from] + y;
+            sumSq[i + 1 - from] = sumSq[i - from] + y * y;
+        }
+
+        size_t full = std::max(begin, window - 1);
+        for (size_t i = begin; i < full; ++i) out[i] = stddev(sum[i + 1], sumSq[i + 1], i + 1);
+
+        // index relative to from, so sums and o share it
+        double* o = out + from;
+        size_t i = full - from, last = end - from;
+        if (window > 1) {
+#ifdef MIDAS_ROLLING_AVX2
+            const __m256d k = _mm256_set1_pd(static_cast<double>(window));
+            const __m256d k1 = _mm256_set1_pd(static_cast<double>(window - 1));
+            const __m256d zero = _mm256_setzero_pd();
+            for (; i + 4 <= last; i += 4) {
+                __m256d s = _mm256_sub_pd(_mm256_loadu_pd(&sum[i + 1]), _mm256_loadu_pd(&sum[i + 1 - window]));
+                __m256d q = _mm256_sub_pd(_mm256_loadu_pd(&sumSq[i + 1]), _mm256_loadu_pd(&sumSq[i + 1 - window]));
+                __m256d var = _mm256_div_pd(_mm256_sub_pd(q, _mm256_div_pd(_mm256_mul_pd(s, s), k)), k1);
+                _mm256_storeu_pd(o + i, _mm256_sqrt_pd(_mm256_max_pd(var, zero)));
+            }
+#endif
+        }
+        for (; i < last; ++i) {
+            o[i] = stddev(sum[i + 1] - sum[i + 1 - window], sumSq[i + 1] - sumSq[i + 1 - window], window);
+        }
+    }
+}
+
+inline void rolling_max(const double* in, size_t n, size_t window, double* out) {
+    detail::rolling_extreme(in, n, window, out, [](double a, double b) { return a > b; });
+}
+
+inline void rolling_min(const double* in, size_t n, size_t window, double* out) {
+    detail::rolling_extreme(in, n, window, out, [](double a, double b) { return a < b; });
+}
+
+/**
+ * exponential moving average with alpha = 2 / (window + 1), seeded by first value
+ * recursive by nature, so scalar only
+ */
+inline void ema(const double* in, size_t n, size_t window, double* out) {
+    if (n == 0) return;
+    const double alpha = 2.0 / (window + 1.0);
+    out[0] = in[0];
+    for (size_t i = 1; i < n; ++i) out[i] = out[i - 1] + alpha * (in[i] - out[i - 1]);
+}
+
+/**
+ * max(high - low, |high - previous close|, |low - previous close|), first bin is high - low
+ */
+inline void true_range(const double* high, const double* low, const double* close, size_t n, double* out) {
+    if (n == 0) return;
+    out[0] = high[0] - low[0];
+    size_t i = 1;
+#ifdef MIDAS_ROLLING_AVX2
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    for (; i + 4 <= n; i += 4) {
+        __m256d h = _mm256_loadu_pd(high + i);
+        __m256d l = _mm256_loadu_pd(low + i);
+        __m256d pc = _mm256_loadu_pd(close + i - 1);
+        __m256d hl = _mm256_sub_pd(h, l);
+        __m256d hc = _mm256_andnot_pd(signMask, _mm256_sub_pd(h, pc));
+        __m256d lc = _mm256_andnot_pd(signMask, _mm256_sub_pd(l, pc));
+        _mm256_storeu_pd(out + i, _mm256_max_pd(hl, _mm256_max_pd(hc, lc)));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = std::max(high[i] - low[i], std::max(std::abs(high[i] - close[i - 1]), std::abs(low[i] - close[i - 1])));
+    }
+}
+
+/**
+ * average true range with Wilder smoothing, alpha = 1 / window
+ */
+inline void atr(const double* high, const double* low, const double* close, size_t n, size_t window, double* out) {
+    if (n == 0) return;
+    true_range(high, low, close, n, out);
+    const double alpha = 1.0 / std::max<size_t>(window, 1);
+    for (size_t i = 1; i < n; ++i) out[i] = out[i - 1] + alpha * (out[i] - out[i - 1]);
+}
+
+/**
+ * 1.0 where fast crosses above slow, -1.0 where fast crosses below slow, 0 otherwise
+ * crossing means strict order flips between previous and current bin
+ */
+inline void cross_mask(const double* fast, const double* slow, size_t n, double* out) {
+    if (n == 0) return;
+    out[0] = 0;
+    size_t i = 1;
+#ifdef MIDAS_ROLLING_AVX2
+    const __m256d one = _mm256_set1_pd(1.0);
+    for (; i + 4 <= n; i += 4) {
+        __m256d f = _mm256_loadu_pd(fast + i);
+        __m256d s = _mm256_loadu_pd(slow + i);
+        __m256d pf = _mm256_loadu_pd(fast + i - 1);
+        __m256d ps = _mm256_loadu_pd(slow + i - 1);
+        __m256d up = _mm256_and_pd(_mm256_cmp_pd(f, s, _CMP_GT_OQ), _mm256_cmp_pd(pf, ps, _CMP_LT_OQ));
+        __m256d down = _mm256_and_pd(_mm256_cmp_pd(f, s, _CMP_LT_OQ), _mm256_cmp_pd(pf, ps, _CMP_GT_OQ));
+        _mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_and_pd(up, one), _mm256_and_pd(down, one)));
+    }
+#endif
+    for (; i < n; ++i) {
+        if (fast[i] > slow[i] && fast[i - 1] < slow[i - 1])
+            out[i] = 1.0;
+        else if (fast[i] < slow[i] && fast[i - 1] > slow[i - 1])
+            out[i] = -1.0;
+        else
+            out[i] = 0;
+    }
+}
+}
+
+#endif
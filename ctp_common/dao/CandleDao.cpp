@@ -35,6 +35,34 @@ void CandleDao::get_all_candles(std::unordered_map<std::string, std::vector<Cand
     }
 }
 
+bool CandleDao::get_candles_after(int cob, int time, std::unordered_map<std::string, CandleColumns>& data) {
+    static const string sql{
+        "select instrument, time, open, high, low, close, volume from ctp.candle15 where time > ? order by "
+        "instrument, time"};
+
+    try {
+        std::shared_ptr<sql::Connection> connection{driver.connect(account.ip, account.userName, account.password)};
+        connection->setSchema("ctp");
+        std::shared_ptr<sql::PreparedStatement> statement{connection->prepareStatement(sql)};
+        statement->setString(1, cob == 0 ? string{"1970-01-01 00:00:00"} : midas::Timestamp::to_string(cob, time));
+        std::shared_ptr<sql::ResultSet> resultSet{statement->executeQuery()};
+
+        while (resultSet->next()) {
+            string timeStr = resultSet->getString(2);
+            CandleColumns& columns = data[resultSet->getString(1)];
+            columns.scale = CandleScale::Minute15;
+            columns.append(midas::cob_from_dash(timeStr.c_str()), midas::intraday_time_HMS(timeStr.c_str() + 11),
+                           static_cast<double>(resultSet->getDouble(3)), static_cast<double>(resultSet->getDouble(4)),
+                           static_cast<double>(resultSet->getDouble(5)), static_cast<double>(resultSet->getDouble(6)),
+                           static_cast<double>(resultSet->getDouble(7)));
+        }
+    } catch (sql::SQLException& e) {
+        MIDAS_LOG_ERROR("get_candles_after error " << e);
+        return false;
+    }
+    return true;
+}
+
 int CandleDao::save_candles(const std::string& instrument, const std::vector<CandleData>& data, size_t pos) {
     static const string sql{
         "insert into ctp.candle15 (instrument, time, open, high, low, close, volume) values (?, ?, ?, ?, ?, ?, ?)"};
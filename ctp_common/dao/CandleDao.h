@@ -4,6 +4,7 @@
 #include <mysql_driver.h>
 #include <unordered_map>
 #include "MysqlCommon.h"
+#include "model/CandleColumns.h"
 #include "model/CandleData.h"
 
 using namespace std;
@@ -18,6 +19,12 @@ public:
 
     void get_all_candles(std::unordered_map<std::string, std::vector<CandleData>>& data);
 
+    /**
+     * candles later than (cob, time), used to refresh candle store incrementally, cob 0 gets all
+     * @return false if query failed
+     */
+    bool get_candles_after(int cob, int time, std::unordered_map<std::string, CandleColumns>& data);
+
     int save_candles(const std::string& instrument, const std::vector<CandleData>& data, size_t pos);
 };
 
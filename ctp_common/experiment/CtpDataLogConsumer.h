@@ -2,8 +2,7 @@
 #define MIDAS_CTP_DATA_LOG_CONSUMER_H
 
 #include <ctp/ThostFtdcUserApiStruct.h>
-#include <io/JournalManager.h>
-#include "helper/CtpVisualHelper.h"
+#include <io/BinaryJournalManager.h>
 #include "model/CtpData.h"
 
 class CtpDataLogConsumer {
@@ -14,22 +13,24 @@ public:
 
     std::shared_ptr<CtpData> data;
 
-    std::shared_ptr<JournalManager> manager;
+    /**
+     * payload carries normalized tick, so it goes to its own log instead of raw_msg_log
+     */
+    std::shared_ptr<BinaryJournalManager<CtpCompactTick>> manager;
 
 public:
     CtpDataLogConsumer(std::shared_ptr<CtpData> data) : data(data) {
-        manager = make_shared<JournalManager>(data->dataDirectory + "/raw_msg_log", true);
+        manager = make_shared<BinaryJournalManager<CtpCompactTick>>(data->dataDirectory + "/compact_msg_log");
     }
 
     void data_callback1(MktDataPayload& payload) {
         ++receivedMsgCount;
-        ostringstream oss;
-        oss << payload << '\n';
-        manager->record(oss.str());
+        manager->record(payload.get_data(), payload.get_rcvt(), payload.get_id());
     }
 
     void stats(ostream& os) {
         os << "CtpDataConsumer stats:" << '\n' << "msgs recv        = " << receivedMsgCount << '\n';
+        manager->stats(os);
     }
 
     void flush() { manager->flush(); }
@@ -0,0 +1,258 @@
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "CandleStore.h"
+
+namespace {
+uint64_t align_column(uint64_t x) { return (x + CandleStoreAlignment - 1) & ~(CandleStoreAlignment - 1); }
+
+template <typename T>
+void put_column(vector<char>& buffer, uint64_t offset, const vector<T>& column) {
+    if (!column.empty()) memcpy(&buffer[offset], column.data(), column.size() * sizeof(T));
+}
+
+template <typename T>
+void get_column(vector<T>& column, const T* data, size_t from, size_t to) {
+    column.assign(data + from, data + to);
+}
+}
+
+bool CandleStoreFile::open(const string& path, ostream& err) {
+    header = nullptr;
+    dates = nullptr;
+    if (!file.open(path, err)) return false;
+
+    const size_t size = file.size();
+    if (size < sizeof(CandleStoreHeader)) {
+        err << path << " is not a candle store file\n";
+        return false;
+    }
+    const CandleStoreHeader* h = reinterpret_cast<const CandleStoreHeader*>(file.begin());
+    if (memcmp(h->magic, CandleStoreMagic, sizeof(h->magic)) != 0) {
+        err << path << " is not a candle store file\n";
+        return false;
+    }
+    if (h->schemaVersion != CandleStoreSchemaVersion) {
+        err << path << " schema version " << h->schemaVersion << " expect " << CandleStoreSchemaVersion << '\n';
+        return false;
+    }
+    bool good = h->fileSize == size && h->dateIndexOffset + h->dateCount * sizeof(CandleStoreDate) <= size;
+    for (uint32_t i = 0; i < CandleStoreColumnCount; ++i) {
+        size_t width = i < 3 ? sizeof(int32_t) : sizeof(double);
+        good = good && h->columnOffset[i] % CandleStoreAlignment == 0 && h->columnOffset[i] + h->count * width <= size;
+    }
+    if (!good) {
+        err << path << " is truncated or corrupted\n";
+        return false;
+    }
+    header = h;
+    dates = reinterpret_cast<const CandleStoreDate*>(file.begin() + h->dateIndexOffset);
+    return true;
+}
+
+pair<size_t, size_t> CandleStoreFile::rows_between(int fromCob, int toCob) const {
+    if (!header || fromCob > toCob) return {0, 0};
+    const CandleStoreDate* end = dates + header->dateCount;
+    const CandleStoreDate* first =
+        std::lower_bound(dates, end, fromCob, [](const CandleStoreDate& d, int c) { return d.cob < c; });
+    const CandleStoreDate* last =
+        std::upper_bound(first, end, toCob, [](int c, const CandleStoreDate& d) { return c < d.cob; });
+    size_t from = first == end ? size() : first->row;
+    size_t to = last == end ? size() : last->row;
+    return {from, to};
+}
+
+void CandleStoreFile::copy_to(CandleColumns& columns, size_t from, size_t to) const {
+    columns.scale = scale();
+    get_column(columns.cob, cob(), from, to);
+    get_column(columns.time, time(), from, to);
+    get_column(columns.tickCount, tick_count(), from, to);
+    get_column(columns.open, open(), from, to);
+    get_column(columns.high, high(), from, to);
+    get_column(columns.low, low(), from, to);
+    get_column(columns.close, close(), from, to);
+    get_column(columns.volume, volume(), from, to);
+}
+
+vector<CandleData> CandleStoreFile::to_candles() const {
+    vector<CandleData> candles;
+    candles.reserve(size());
+    for (size_t i = 0; i < size(); ++i) {
+        candles.emplace_back(cob()[i], time()[i], open()[i], high()[i], low()[i], close()[i], volume()[i]);
+        candles.back().tickCount = tick_count()[i];
+    }
+    return candles;
+}
+
+string CandleStore::file_path(const string& instrument, CandleScale scale) const {
+    return directory + "/" + instrument + "." + std::to_string(static_cast<int>(scale)) + ".candle";
+}
+
+bool CandleStore::save(const string& instrument, const CandleColumns& columns, ostream& err) const {
+    const uint64_t count = columns.size();
+    vector<CandleStoreDate> dateIndex;
+    for (size_t i = 0; i < count; ++i) {
+        if (i == 0 || columns.cob[i] != columns.cob[i - 1]) {
+            dateIndex.push_back({columns.cob[i], static_cast<uint32_t>(i)});
+        }
+    }
+
+    CandleStoreHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CandleStoreMagic, sizeof(header.magic));
+    header.schemaVersion = CandleStoreSchemaVersion;
+    header.scale = static_cast<int32_t>(columns.scale);
+    header.count = count;
+    header.dateCount = dateIndex.size();
+    header.dateIndexOffset = align_column(sizeof(CandleStoreHeader));
+    uint64_t offset = header.dateIndexOffset + dateIndex.size() * sizeof(CandleStoreDate);
+    for (uint32_t i = 0; i < CandleStoreColumnCount; ++i) {
+        header.columnOffset[i] = align_column(offset);
+        offset = header.columnOffset[i] + count * (i < 3 ? sizeof(int32_t) : sizeof(double));
+    }
+    header.fileSize = offset;
+
+    vector<char> buffer(header.fileSize, 0);
+    memcpy(&buffer[0], &header, sizeof(header));
+    put_column(buffer, header.dateIndexOffset, dateIndex);
+    put_column(buffer, header.columnOffset[0], columns.cob);
+    put_column(buffer, header.columnOffset[1], columns.time);
+    put_column(buffer, header.columnOffset[2], columns.tickCount);
+    put_column(buffer, header.columnOffset[3], columns.open);
+    put_column(buffer, header.columnOffset[4], columns.high);
+    put_column(buffer, header.columnOffset[5], columns.low);
+    put_column(buffer, header.columnOffset[6], columns.close);
+    put_column(buffer, header.columnOffset[7], columns.volume);
+
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(directory, ec);
+    const string path = file_path(instrument, columns.scale);
+    const string tmpPath = path + ".tmp";
+    {
+        ofstream ofs(tmpPath, ofstream::binary | ofstream::trunc);
+        ofs.write(buffer.data(), buffer.size());
+        if (!ofs.good()) {
+            err << "write candle store failed " << tmpPath << '\n';
+            return false;
+        }
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        err << "rename() failed " << tmpPath << " " << strerror(errno) << '\n';
+        return false;
+    }
+    return true;
+}
+
+long CandleStore::merge(const string& instrument, const CandleColumns& update, ostream& err,
+                        bool isFullHistory) const {
+    CandleColumns columns;
+    columns.scale = update.scale;
+    const bool isThere = boost::filesystem::exists(file_path(instrument, update.scale));
+    if (!isThere || !load(instrument, update.scale, columns, err)) {
+        if (!isFullHistory) return CandleStoreRebuild;
+        columns.clear();
+    }
+
+    size_t from = 0;
+    if (columns.size() > 0) {
+        const int lastCob = columns.cob.back(), lastTime = columns.time.back();
+        while (from < update.size() &&
+               (update.cob[from] < lastCob || (update.cob[from] == lastCob && update.time[from] <= lastTime))) {
+            ++from;
+        }
+    }
+    if (from == update.size() && columns.size() > 0) return 0;
+
+    columns.append(update, from, update.size());
+    if (!save(instrument, columns, err)) return -1;
+    return static_cast<long>(update.size() - from);
+}
+
+bool CandleStore::is_readable(const string& instrument, CandleScale scale) const {
+    CandleStoreFile file;
+    ostringstream ignored;
+    return file.open(file_path(instrument, scale), ignored);
+}
+
+bool CandleStore::load(const string& instrument, CandleScale scale, CandleColumns& columns, ostream& err, int fromCob,
+                       int toCob) const {
+    CandleStoreFile file;
+    if (!file.open(file_path(instrument, scale), err)) return false;
+    pair<size_t, size_t> rows = file.rows_between(fromCob, toCob);
+    file.copy_to(columns, rows.first, rows.second);
+    return true;
+}
+
+map<string, CandleColumns> CandleStore::load_all(CandleScale scale, ostream& err) const {
+    map<string, CandleColumns> result;
+    if (!boost::filesystem::is_directory(directory)) return result;
+
+    const string suffix = "." + std::to_string(static_cast<int>(scale)) + ".candle";
+    boost::filesystem::directory_iterator end;
+    for (boost::filesystem::directory_iterator i(directory); i != end; ++i) {
+        string name = i->path().filename().string();
+        if (name.size() <= suffix.size() || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+            continue;
+        }
+        string instrument = name.substr(0, name.size() - suffix.size());
+        CandleColumns columns;
+        if (load(instrument, scale, columns, err)) result[instrument] = std::move(columns);
+    }
+    return result;
+}
+
+bool CandleStore::is_fresh(const string& instrument, CandleScale scale, const string& sourcePath) const {
+    boost::system::error_code ec;
+    std::time_t storeTime = boost::filesystem::last_write_time(file_path(instrument, scale), ec);
+    if (ec) return false;
+    std::time_t sourceTime = boost::filesystem::last_write_time(sourcePath, ec);
+    return !ec && storeTime > sourceTime;
+}
+
+void CandleStore::get_sync_point(const string& source, int& cob, int& time) const {
+    cob = time = 0;
+    uint32_t version = 0;
+    ifstream ifs(directory + "/" + source + ".sync");
+    // files written by other schema version are rebuilt, so start over from the beginning
+    if (!(ifs >> version >> cob >> time) || version != CandleStoreSchemaVersion) cob = time = 0;
+}
+
+bool CandleStore::set_sync_point(const string& source, int cob, int time, ostream& err) const {
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(directory, ec);
+    const string path = directory + "/" + source + ".sync";
+    {
+        ofstream ofs(path + ".tmp", ofstream::trunc);
+        ofs << CandleStoreSchemaVersion << ' ' << cob << ' ' << time << '\n';
+        if (!ofs.good()) {
+            err << "write sync point failed " << path << '\n';
+            return false;
+        }
+    }
+    if (std::rename((path + ".tmp").c_str(), path.c_str()) != 0) {
+        err << "rename() failed " << path << " " << strerror(errno) << '\n';
+        return false;
+    }
+    return true;
+}
+
+bool CandleStore::earliest_last_row(const vector<string>& instruments, CandleScale scale, int& cob, int& time) const {
+    bool isFound = false;
+    for (const auto& instrument : instruments) {
+        CandleStoreFile file;
+        ostringstream ignored;
+        if (!file.open(file_path(instrument, scale), ignored) || file.size() == 0) continue;
+        const int lastCob = file.cob()[file.size() - 1], lastTime = file.time()[file.size() - 1];
+        if (!isFound || lastCob < cob || (lastCob == cob && lastTime < time)) {
+            cob = lastCob;
+            time = lastTime;
+            isFound = true;
+        }
+    }
+    return isFound;
+}
@@ -0,0 +1,144 @@
+#ifndef MIDAS_CANDLE_STORE_H
+#define MIDAS_CANDLE_STORE_H
+
+#include <climits>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "io/MappedFile.h"
+#include "model/CandleColumns.h"
+
+using namespace std;
+
+constexpr uint32_t CandleStoreSchemaVersion = 1;
+constexpr char CandleStoreMagic[8] = {'M', 'I', 'D', 'A', 'S', 'C', 'D', 'L'};
+constexpr uint32_t CandleStoreColumnCount = 8;  // cob, time, tickCount, open, high, low, close, volume
+constexpr uint64_t CandleStoreAlignment = 64;
+constexpr long CandleStoreRebuild = -2;  // merge found no usable file and needs full history to create one
+
+/**
+ * | header | date index | column cob | column time | ... | column volume |
+ * every column starts at a 64 byte boundary so that it can be used in place
+ */
+struct CandleStoreHeader {
+    char magic[8];
+    uint32_t schemaVersion;
+    int32_t scale;
+    uint64_t count;      // rows
+    uint64_t dateCount;  // entries in date index
+    uint64_t dateIndexOffset;
+    uint64_t columnOffset[CandleStoreColumnCount];
+    uint64_t fileSize;
+};
+
+/**
+ * first row of each trading day, rows are sorted by (cob, time)
+ */
+struct CandleStoreDate {
+    int32_t cob;
+    uint32_t row;
+};
+
+/**
+ * read only view of one store file, a file with other magic, version or truncated is rejected
+ */
+class CandleStoreFile {
+public:
+    bool open(const string& path, ostream& err);
+
+    size_t size() const { return header ? header->count : 0; }
+
+    CandleScale scale() const { return static_cast<CandleScale>(header->scale); }
+
+    const int32_t* cob() const { return column<int32_t>(0); }
+    const int32_t* time() const { return column<int32_t>(1); }
+    const int32_t* tick_count() const { return column<int32_t>(2); }
+    const double* open() const { return column<double>(3); }
+    const double* high() const { return column<double>(4); }
+    const double* low() const { return column<double>(5); }
+    const double* close() const { return column<double>(6); }
+    const double* volume() const { return column<double>(7); }
+
+    /**
+     * rows [first, second) whose cob is within [fromCob, toCob], found by binary search on date index
+     */
+    pair<size_t, size_t> rows_between(int fromCob, int toCob) const;
+
+    void copy_to(CandleColumns& columns, size_t from, size_t to) const;
+
+    /**
+     * rows built straight from mapped columns for Candles which still keep array of CandleData
+     */
+    vector<CandleData> to_candles() const;
+
+private:
+    template <typename T>
+    const T* column(int i) const {
+        return reinterpret_cast<const T*>(file.begin() + header->columnOffset[i]);
+    }
+
+    midas::MappedFile file;
+    const CandleStoreHeader* header{nullptr};
+    const CandleStoreDate* dates{nullptr};
+};
+
+/**
+ * directory of binary candle files, one file per instrument and scale named <instrument>.<scale>.candle
+ * files are rewritten through temp file and rename, so readers never see half written file
+ */
+class CandleStore {
+public:
+    string directory;
+
+public:
+    CandleStore(const string& directory_) : directory(directory_) {}
+
+    string file_path(const string& instrument, CandleScale scale) const;
+
+    bool save(const string& instrument, const CandleColumns& columns, ostream& err) const;
+
+    /**
+     * append rows of update later than last stored row
+     * a missing, corrupted or old version file is only created from update when it holds full history,
+     * otherwise rows before update would be lost
+     * @return rows appended, -1 if store can not be written or CandleStoreRebuild
+     */
+    long merge(const string& instrument, const CandleColumns& update, ostream& err, bool isFullHistory = false) const;
+
+    /**
+     * file of instrument is there and has current version
+     */
+    bool is_readable(const string& instrument, CandleScale scale) const;
+
+    /**
+     * copy rows of file into columns, use CandleStoreFile to read mapped columns in place
+     */
+    bool load(const string& instrument, CandleScale scale, CandleColumns& columns, ostream& err, int fromCob = 0,
+              int toCob = INT_MAX) const;
+
+    map<string, CandleColumns> load_all(CandleScale scale, ostream& err) const;
+
+    /**
+     * store file is there and written after source file was last modified
+     */
+    bool is_fresh(const string& instrument, CandleScale scale, const string& sourcePath) const;
+
+    /**
+     * last (cob, time) taken from an incremental source like mysql, both 0 if never synced
+     */
+    void get_sync_point(const string& source, int& cob, int& time) const;
+
+    bool set_sync_point(const string& source, int cob, int time, ostream& err) const;
+
+    /**
+     * earliest last row over files of instruments, an incremental source queried after it misses no row of any of them
+     * files without rows are skipped
+     * @return false if none of instruments has a stored row
+     */
+    bool earliest_last_row(const vector<string>& instruments, CandleScale scale, int& cob, int& time) const;
+};
+
+#endif
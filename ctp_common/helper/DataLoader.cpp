@@ -1,8 +1,14 @@
-#include <utils/convert/StringHelper.h>
+#include <io/MappedFile.h>
+#include <process/MidasThreadPool.h>
+#include <utils/convert/NumberParser.h>
 #include <utils/convert/TimeHelper.h>
+#include <utils/log/Log.h>
 #include <boost/filesystem.hpp>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include "CandleStore.h"
 #include "DataLoader.h"
 
 std::map<string, std::shared_ptr<CThostFtdcProductField>> DataLoader::load_products(const string &pathName) {
@@ -47,106 +53,132 @@ std::map<string, std::shared_ptr<CThostFtdcProductField>> DataLoader::load_produ
 }
 
 void DataLoader::load(const string &pathName) {
+    vector<string> files;
     boost::filesystem::path file(pathName);
     if (boost::filesystem::is_regular_file(file)) {
-        load_single_file(pathName);
+        files.push_back(pathName);
     } else if (boost::filesystem::is_directory(file)) {
         boost::filesystem::directory_iterator end;
         for (boost::filesystem::directory_iterator i(file); i != end; ++i) {
-            boost::filesystem::path p = i->path();
-
-            if (is_regular_file(p)) load_single_file(p.string());
+            if (is_regular_file(i->path())) files.push_back(i->path().string());
         }
     }
-}
+    if (files.empty()) return;
 
-void DataLoader::load_single_file(const string &pathName) {
-    currentFileName = pathName;
-    boost::filesystem::path file(currentFileName);
-    instrumentName = file.filename().replace_extension().string();
-    rawData.clear();
-    ifstream ifs(currentFileName, ifstream::in);
+    vector<CandleColumns> results(files.size());
+    vector<ostringstream> errors(files.size());
+    vector<char> isLoaded(files.size(), 0);
+    vector<string> instruments(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        instruments[i] = boost::filesystem::path(files[i]).filename().replace_extension().string();
+    }
+    unique_ptr<CandleStore> store;
+    if (!storeDirectory.empty()) store.reset(new CandleStore(storeDirectory));
 
-    if (ifs.is_open()) {
-        string s;
-        while (getline(ifs, s)) {
-            if (!s.empty()) {
-                rawData.push_back(s);
+    auto loadOne = [&](int, size_t i) {
+        if (store && store->is_fresh(instruments[i], CandleScale::Minute1, files[i])) {
+            ostringstream ignored;  // stale version falls back to text file
+            if (store->load(instruments[i], CandleScale::Minute1, results[i], ignored)) {
+                isLoaded[i] = 1;
+                return;
             }
         }
-
-        ifs.close();
+        isLoaded[i] = load_file(files[i], results[i], errors[i]);
+        if (isLoaded[i] && store) store->save(instruments[i], results[i], errors[i]);
+    };
+    if (files.size() == 1) {
+        loadOne(0, 0);
+    } else {
+        int threads = threadCount > 0 ? threadCount : static_cast<int>(std::thread::hardware_concurrency());
+        midas::ThreadPool pool(std::min<int>(threads, static_cast<int>(files.size())));
+        pool.parallel_for(0, files.size(), loadOne, 1);
     }
 
-    process_data();
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!errors[i].str().empty()) MIDAS_LOG_ERROR(errors[i].str());
+        if (!isLoaded[i]) continue;
+        instrument2columns[instruments[i]] = std::move(results[i]);
+    }
 }
 
-void DataLoader::process_data() {
-    if (rawData.empty()) return;
-    analysis_header(rawData[0]);
-    if (hasHeader && rawData.size() == 1) return;
-    analysis_format(hasHeader ? rawData[1] : rawData[0]);
+bool DataLoader::load_file(const string &pathName, CandleColumns &columns, ostream &err) {
+    midas::MappedFile file(pathName, err);
+    if (!file.is_open()) return false;
+    columns.clear();
+    columns.scale = CandleScale::Minute1;
+
+    const char *p = file.begin(), *end = file.end();
+    auto nextLine = [&p, end](const char *&lineBegin, const char *&lineEnd) {
+        while (p < end) {
+            lineBegin = p;
+            const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+            lineEnd = nl ? nl : end;
+            p = nl ? nl + 1 : end;
+            if (lineEnd > lineBegin && lineEnd[-1] == '\r') --lineEnd;
+            if (lineEnd > lineBegin) return true;
+        }
+        return false;
+    };
 
-    if (format == RawDataFormat::Type1) {
-        load_format_type1();
-    } else if (format == RawDataFormat::Type2) {
-        load_format_type2();
+    const char *lineBegin, *lineEnd;
+    if (!nextLine(lineBegin, lineEnd)) return true;
+    if (is_header(lineBegin, lineEnd) && !nextLine(lineBegin, lineEnd)) return true;
+    const RawDataFormat format = analysis_format(lineBegin, lineEnd);
+    if (format == RawDataFormat::Unknown) {
+        err << pathName << " unknown candle format\n";
+        return false;
     }
-}
+    const size_t fieldCount = format == RawDataFormat::Type1 ? 7 : 6;
+    columns.reserve(file.size() / static_cast<size_t>(lineEnd - lineBegin + 1) + 1);
 
-void DataLoader::analysis_header(const string &content) {
-    long digitCount = count_if(content.begin(), content.end(), [](char c) { return c <= '9' && c >= '0'; });
-    long letterCount = count_if(content.begin(), content.end(),
-                                [](char c) { return (c <= 'z' && c >= 'a') || (c <= 'Z' && c >= 'A'); });
-    hasHeader = (letterCount > digitCount);
-}
+    const char *fields[8];
+    const char *fieldEnds[8];
+    do {
+        size_t n = 0;
+        for (const char *f = lineBegin; n < 8;) {
+            const char *comma = static_cast<const char *>(memchr(f, ',', lineEnd - f));
+            fields[n] = f;
+            fieldEnds[n++] = comma ? comma : lineEnd;
+            if (!comma) break;
+            f = comma + 1;
+        }
+        if (n != fieldCount) continue;
 
-void DataLoader::analysis_format(const string &content) {
-    long commaCount = count(content.begin(), content.end(), ',');
-    if (commaCount == 0)
-        format = RawDataFormat::Unknown;
-    else if (commaCount == 6)
-        format = RawDataFormat::Type1;
-    else if (commaCount == 5)
-        format = RawDataFormat::Type2;
+        int date, time;
+        size_t value = 1;
+        if (format == RawDataFormat::Type1) {
+            // 2017-01-03,09:01:00
+            if (fieldEnds[0] - fields[0] < 10 || fieldEnds[1] - fields[1] < 8) continue;
+            date = midas::cob_from_dash(fields[0]);
+            time = midas::intraday_time_HMS(fields[1]);
+            value = 2;
+        } else {
+            // 2017-01-03 09:01:00
+            if (fieldEnds[0] - fields[0] < 19) continue;
+            date = midas::cob_from_dash(fields[0]);
+            time = midas::intraday_time_HMS(fields[0] + 11);
+        }
+        columns.append(date, time, midas::parse_double(fields[value], fieldEnds[value]),
+                       midas::parse_double(fields[value + 1], fieldEnds[value + 1]),
+                       midas::parse_double(fields[value + 2], fieldEnds[value + 2]),
+                       midas::parse_double(fields[value + 3], fieldEnds[value + 3]),
+                       midas::parse_double(fields[value + 4], fieldEnds[value + 4]));
+    } while (nextLine(lineBegin, lineEnd));
+    return true;
 }
 
-void DataLoader::load_format_type1() {
-    vector<CandleData> result;
-    auto itr = rawData.begin();
-    if (hasHeader) ++itr;
-    for (; itr != rawData.end(); ++itr) {
-        vector<string> lets = midas::string_split(*itr);
-        if (lets.size() == 7) {
-            int date = midas::cob_from_dash(lets[0]);
-            int time = midas::intraday_time_HMS(lets[1]);
-            double open = std::atof(lets[2].c_str());
-            double high = std::atof(lets[3].c_str());
-            double low = std::atof(lets[4].c_str());
-            double close = std::atof(lets[5].c_str());
-            double volume = std::atof(lets[6].c_str());
-            result.push_back(CandleData{date, time, open, high, low, close, volume});
-        }
-    }
-    instrument2candle.insert({instrumentName, std::move(result)});
+bool DataLoader::is_header(const char *begin, const char *end) {
+    long digitCount = count_if(begin, end, [](char c) { return c <= '9' && c >= '0'; });
+    long letterCount =
+        count_if(begin, end, [](char c) { return (c <= 'z' && c >= 'a') || (c <= 'Z' && c >= 'A'); });
+    return letterCount > digitCount;
 }
 
-void DataLoader::load_format_type2() {
-    vector<CandleData> result;
-    auto itr = rawData.begin();
-    if (hasHeader) ++itr;
-    for (; itr != rawData.end(); ++itr) {
-        vector<string> lets = midas::string_split(*itr);
-        if (lets.size() == 6) {
-            int date = midas::cob_from_dash(lets[0]);
-            int time = midas::intraday_time_HMS(lets[0].c_str() + 11);
-            double open = std::atof(lets[1].c_str());
-            double high = std::atof(lets[2].c_str());
-            double low = std::atof(lets[3].c_str());
-            double close = std::atof(lets[4].c_str());
-            double volume = std::atof(lets[5].c_str());
-            result.push_back(CandleData{date, time, open, high, low, close, volume});
-        }
-    }
-    instrument2candle.insert({instrumentName, std::move(result)});
+RawDataFormat DataLoader::analysis_format(const char *begin, const char *end) {
+    long commaCount = count(begin, end, ',');
+    if (commaCount == 6)
+        return RawDataFormat::Type1;
+    else if (commaCount == 5)
+        return RawDataFormat::Type2;
+    return RawDataFormat::Unknown;
 }
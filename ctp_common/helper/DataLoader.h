@@ -2,8 +2,11 @@
 #define MIDAS_DATA_LOADER_H
 
 #include <map>
+#include <memory>
+#include <ostream>
 #include <string>
 #include <vector>
+#include "model/CandleColumns.h"
 #include "model/CandleData.h"
 
 using namespace std;
@@ -14,27 +17,30 @@ enum RawDataFormat {
     Type2   // "DateTime","Open","High","Low","Close","TotalVolume"
 };
 
+/**
+ * minute bar files, one instrument per file named after instrument, are mmap'd and parsed in place
+ * into columnar candle arrays, files of a directory are parsed in parallel on a thread pool
+ * with a store directory, file not modified since last parse is taken from binary candle store instead
+ */
 class DataLoader {
 public:
-    map<string, vector<CandleData>> instrument2candle;
-    string currentFileName;
-    string instrumentName;
-    vector<string> rawData;
-    bool hasHeader{true};
-    RawDataFormat format{RawDataFormat::Unknown};
+    map<string, CandleColumns> instrument2columns;
+    int threadCount{0};     // 0 uses one thread per core
+    string storeDirectory;  // empty means no candle store
 
 public:
     void load(const string& pathName);
 
     std::map<string, std::shared_ptr<CThostFtdcProductField>> load_products(const string& pathName);
 
-private:
-    void load_single_file(const string& pathName);
-    void process_data();
-    void load_format_type1();
-    void load_format_type2();
-    void analysis_header(const string& content);
-    void analysis_format(const string& content);
+    /**
+     * parse one file, lines with unexpected field count or too short date time are skipped
+     * @return false if file can not be read or its format is unknown
+     */
+    static bool load_file(const string& pathName, CandleColumns& columns, ostream& err);
+
+    static bool is_header(const char* begin, const char* end);
+    static RawDataFormat analysis_format(const char* begin, const char* end);
 };
 
 #endif
@@ -0,0 +1,142 @@
+#ifndef MIDAS_CANDLE_COLUMNS_H
+#define MIDAS_CANDLE_COLUMNS_H
+
+#include <vector>
+#include "CandleData.h"
+
+using namespace std;
+
+/**
+ * structure of arrays copy of Candles, one contiguous column per field so that
+ * rolling kernels can run over whole history instead of bin by bin
+ */
+class CandleColumns {
+public:
+    CandleScale scale{CandleScale::Minute15};
+    vector<int> cob;
+    vector<int> time;
+    vector<int> tickCount;
+    vector<double> open;
+    vector<double> high;
+    vector<double> low;
+    vector<double> close;
+    vector<double> volume;
+
+public:
+    size_t size() const { return close.size(); }
+
+    void clear() {
+        cob.clear();
+        time.clear();
+        tickCount.clear();
+        open.clear();
+        high.clear();
+        low.clear();
+        close.clear();
+        volume.clear();
+    }
+
+    void reserve(size_t n) {
+        cob.reserve(n);
+        time.reserve(n);
+        tickCount.reserve(n);
+        open.reserve(n);
+        high.reserve(n);
+        low.reserve(n);
+        close.reserve(n);
+        volume.reserve(n);
+    }
+
+    /**
+     * copy first count bins, count < 0 means all bins with data
+     */
+    void assign(const Candles& candles, int count = -1) {
+        clear();
+        scale = candles.scale;
+        sync(candles, count);
+    }
+
+    /**
+     * append bins not copied yet and refresh the last copied bin which may still be updating
+     */
+    void sync(const Candles& candles, int count = -1) {
+        size_t n = static_cast<size_t>(count < 0 ? candles.total_available_count() : count);
+        if (n < size()) clear();
+        reserve(candles.data.size());
+
+        size_t from = size();
+        if (from > 0) {
+            --from;
+            set(from, candles.data[from]);
+        }
+        for (size_t i = size(); i < n; ++i) {
+            push_back(candles.data[i]);
+        }
+    }
+
+    /**
+     * append one bar parsed from file, tick count is unknown there
+     */
+    void append(int date, int hms, double o, double h, double l, double c, double v) {
+        cob.push_back(date);
+        time.push_back(hms);
+        tickCount.push_back(0);
+        open.push_back(o);
+        high.push_back(h);
+        low.push_back(l);
+        close.push_back(c);
+        volume.push_back(v);
+    }
+
+    /**
+     * append rows [from, to) of other, tick count included
+     */
+    void append(const CandleColumns& other, size_t from, size_t to) {
+        cob.insert(cob.end(), other.cob.begin() + from, other.cob.begin() + to);
+        time.insert(time.end(), other.time.begin() + from, other.time.begin() + to);
+        tickCount.insert(tickCount.end(), other.tickCount.begin() + from, other.tickCount.begin() + to);
+        open.insert(open.end(), other.open.begin() + from, other.open.begin() + to);
+        high.insert(high.end(), other.high.begin() + from, other.high.begin() + to);
+        low.insert(low.end(), other.low.begin() + from, other.low.begin() + to);
+        close.insert(close.end(), other.close.begin() + from, other.close.begin() + to);
+        volume.insert(volume.end(), other.volume.begin() + from, other.volume.begin() + to);
+    }
+
+    /**
+     * row copy for Candles which still keep array of CandleData
+     */
+    vector<CandleData> to_candles() const {
+        vector<CandleData> candles;
+        candles.reserve(size());
+        for (size_t i = 0; i < size(); ++i) {
+            candles.emplace_back(cob[i], time[i], open[i], high[i], low[i], close[i], volume[i]);
+            candles.back().tickCount = tickCount[i];
+        }
+        return candles;
+    }
+
+private:
+    void push_back(const CandleData& candle) {
+        cob.push_back(candle.timestamp.cob);
+        time.push_back(candle.timestamp.time);
+        tickCount.push_back(candle.tickCount);
+        open.push_back(candle.open);
+        high.push_back(candle.high);
+        low.push_back(candle.low);
+        close.push_back(candle.close);
+        volume.push_back(candle.volume);
+    }
+
+    void set(size_t i, const CandleData& candle) {
+        cob[i] = candle.timestamp.cob;
+        time[i] = candle.timestamp.time;
+        tickCount[i] = candle.tickCount;
+        open[i] = candle.open;
+        high[i] = candle.high;
+        low[i] = candle.low;
+        close[i] = candle.close;
+        volume[i] = candle.volume;
+    }
+};
+
+#endif
@@ -67,21 +67,19 @@ void Candles::init(const vector<CandleData>& historicData, CandleScale historicS
     currentBinIndex = historicDataCount;
 }
 
-void Candles::update(const CThostFtdcDepthMarketDataField& tick, int ts, double newHigh, double newLow) {
-    int intradayMinute = TradeSessions::intraday_minute(tick.UpdateTime);
+void Candles::update(int date, int intradayMinute, double price, int ts, double newHigh, double newLow) {
     if (sessions.update_session(intradayMinute)) {  // in trading hour
         ++updateCount;
 
-        int date = midas::cob(tick.ActionDay);
         int startIntradayMinute = (intradayMinute - (intradayMinute % scale));
         startIntradayMinute = sessions.adjust_within_session(startIntradayMinute, scale);
         if (data[currentBinIndex].timestamp.cob == 0) {
-            data[currentBinIndex].update_first_tick(date, startIntradayMinute, tick.LastPrice, ts, newHigh, newLow);
+            data[currentBinIndex].update_first_tick(date, startIntradayMinute, price, ts, newHigh, newLow);
         } else if (data[currentBinIndex].timestamp.intradayMinute != startIntradayMinute) {
             ++currentBinIndex;
-            data[currentBinIndex].update_first_tick(date, startIntradayMinute, tick.LastPrice, ts, newHigh, newLow);
+            data[currentBinIndex].update_first_tick(date, startIntradayMinute, price, ts, newHigh, newLow);
         } else {
-            data[currentBinIndex].update_tick(tick.LastPrice, ts, newHigh, newLow);
+            data[currentBinIndex].update_tick(price, ts, newHigh, newLow);
         }
     }
 }
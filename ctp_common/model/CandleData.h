@@ -51,7 +51,10 @@ public:
 
     void init(const vector<CandleData>& historicData, CandleScale historicScale = CandleScale::Minute15);
 
-    void update(const CThostFtdcDepthMarketDataField& tick, int ts, double newHigh, double newLow);
+    /**
+     * @param date exchange date as yyyymmdd, intradayMinute of tick time
+     */
+    void update(int date, int intradayMinute, double price, int ts, double newHigh, double newLow);
 
     void set_session(const TradeSessions& ts) { sessions = ts; }
 
@@ -0,0 +1,47 @@
+#ifndef MIDAS_CTP_BOOK_H
+#define MIDAS_CTP_BOOK_H
+
+#include <cstring>
+#include "CtpCompactTick.h"
+#include "midas/md/MdBookEngine.h"
+
+constexpr uint16_t CtpBookDepth = 1 + CtpTickDepthLevels;
+
+/**
+ * fixed point price of a tick in book price unit, level without volume is blank
+ */
+inline int64_t ctp_book_price(int64_t price, uint8_t priceScale, bool isValid) {
+    return isValid ? midas::fixed_point_normalize(price, priceScale, midas::DefaultPriceScale) : midas::PriceBlank;
+}
+
+/**
+ * level 1 comes from compact tick, level 2 - 5 from its side record, they stay blank without side record
+ */
+inline void ctp_book_snapshot(const CtpCompactTick& tick, const CtpTickDepth* depth, midas::BookSnapshot& snapshot) {
+    snapshot.bidDepth = snapshot.askDepth = CtpBookDepth;
+    const bool isBid = tick.is_valid(TickValidBid);
+    const bool isAsk = tick.is_valid(TickValidAsk);
+    snapshot.bidPrice[0] = ctp_book_price(tick.bidPrice, tick.priceScale, isBid);
+    snapshot.bidShares[0] = isBid ? static_cast<uint64_t>(tick.bidVolume) : 0;
+    snapshot.askPrice[0] = ctp_book_price(tick.askPrice, tick.priceScale, isAsk);
+    snapshot.askShares[0] = isAsk ? static_cast<uint64_t>(tick.askVolume) : 0;
+    for (int i = 0; i < CtpTickDepthLevels; ++i) {
+        const int32_t bidVolume = depth ? depth->bidVolume[i] : 0;
+        const int32_t askVolume = depth ? depth->askVolume[i] : 0;
+        snapshot.bidPrice[i + 1] = ctp_book_price(depth ? depth->bidPrice[i] : 0, tick.priceScale, bidVolume > 0);
+        snapshot.bidShares[i + 1] = static_cast<uint64_t>(bidVolume);
+        snapshot.askPrice[i + 1] = ctp_book_price(depth ? depth->askPrice[i] : 0, tick.priceScale, askVolume > 0);
+        snapshot.askShares[i + 1] = static_cast<uint64_t>(askVolume);
+    }
+}
+
+inline uint16_t ctp_exchange(const char* exchangeId) {
+    if (strcmp(exchangeId, "SHFE") == 0) return midas::ExchangeSHFE;
+    if (strcmp(exchangeId, "DCE") == 0) return midas::ExchangeDCE;
+    if (strcmp(exchangeId, "CZCE") == 0) return midas::ExchangeCZCE;
+    if (strcmp(exchangeId, "CFFEX") == 0) return midas::ExchangeCFFEX;
+    if (strcmp(exchangeId, "INE") == 0) return midas::ExchangeINE;
+    return midas::ExchangeNone;
+}
+
+#endif
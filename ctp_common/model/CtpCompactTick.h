@@ -0,0 +1,274 @@
+#ifndef MIDAS_CTP_COMPACT_TICK_H
+#define MIDAS_CTP_COMPACT_TICK_H
+
+#include <ctp/ThostFtdcUserApiStruct.h>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "InstrumentIndex.h"
+#include "midas/md/MdDefs.h"
+#include "utils/convert/FloatHelper.h"
+
+/**
+ * bit set in CtpCompactTick::validMask when field was sent, ctp sends DBL_MAX or 0 volume otherwise
+ */
+enum CtpTickValid : uint8_t {
+    TickValidLast = 1 << 0,
+    TickValidBid = 1 << 1,
+    TickValidAsk = 1 << 2,
+    TickValidHigh = 1 << 3,
+    TickValidLow = 1 << 4,
+    TickValidTime = 1 << 5
+};
+
+constexpr int64_t CtpExchangeUtcOffset = 8 * 3600;  // seconds, exchange time zone is UTC+8 regardless of host
+
+/**
+ * depth market data normalized once at ingestion, size of one cache line instead of ~400 bytes
+ * prices are fixed point with priceScale decimals, invalid price is 0 with its valid bit clear
+ * not declared alignas(64) as ring buffer and journal allocate with plain new
+ */
+struct CtpCompactTick {
+    int64_t exchangeTime;  // ns since epoch, ActionDay UpdateTime UpdateMillisec in exchange time zone (UTC+8)
+    int64_t lastPrice;
+    int64_t bidPrice;
+    int64_t askPrice;
+    int64_t highPrice;
+    int64_t lowPrice;
+    int32_t volume;  // accumulated trade size of the day
+    int32_t bidVolume;
+    int32_t askVolume;
+    uint16_t instrumentId;  // dense id of InstrumentIndex
+    uint8_t priceScale;
+    uint8_t validMask;
+
+    bool is_valid(CtpTickValid field) const { return (validMask & field) != 0; }
+
+    double price(int64_t fixedPrice) const { return midas::fixed_point_2_double(fixedPrice, priceScale); }
+
+    /**
+     * exchange date as yyyymmdd
+     */
+    int cob() const;
+
+    /**
+     * exchange time of day as hhmmss
+     */
+    int hms() const;
+
+    int millisecond() const { return static_cast<int>(local_ns() % 1000000000LL / 1000000); }
+
+private:
+    int64_t local_ns() const { return exchangeTime + CtpExchangeUtcOffset * 1000000000LL; }
+};
+
+static_assert(sizeof(CtpCompactTick) == 64, "compact tick must be one cache line");
+
+constexpr int CtpTickDepthLevels = 4;  // level 2 - 5, level 1 is in compact tick
+
+/**
+ * session statistics of a tick, prices are fixed point with priceScale of its compact tick, 0 when not sent
+ */
+struct CtpTickStats {
+    int64_t preSettlementPrice;
+    int64_t preClosePrice;
+    int64_t openPrice;
+    int64_t closePrice;
+    int64_t settlementPrice;
+    int64_t upperLimitPrice;
+    int64_t lowerLimitPrice;
+    double preOpenInterest;
+    double openInterest;
+    double turnover;
+    double averagePrice;  // turnover based on some exchanges, not a multiple of price tick
+    double preDelta;
+    double currDelta;
+};
+
+/**
+ * side record of compact tick with level 2 - 5 and session statistics, read by book and image only
+ * it rides along disruptor entry in a SideRing so slot keeps one cache line, level without volume has price 0
+ */
+struct CtpTickDepth {
+    int64_t bidPrice[CtpTickDepthLevels];
+    int64_t askPrice[CtpTickDepthLevels];
+    int32_t bidVolume[CtpTickDepthLevels];
+    int32_t askVolume[CtpTickDepthLevels];
+    CtpTickStats stats;
+};
+
+namespace ctp_tick_detail {
+/**
+ * days since 1970-01-01 of proleptic gregorian date, H. Hinnant's days_from_civil
+ */
+inline int64_t days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097LL + static_cast<int64_t>(doe) - 719468;
+}
+
+inline int civil_from_days(int64_t z) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+    const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+    const int64_t y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+    return static_cast<int>(y * 10000 + m * 100 + d);
+}
+
+inline int digits(const char* s, int n) {
+    int v = 0;
+    for (int i = 0; i < n; ++i) v = v * 10 + (s[i] - '0');
+    return v;
+}
+}
+
+inline int CtpCompactTick::cob() const {
+    return ctp_tick_detail::civil_from_days(local_ns() / (86400 * 1000000000LL));
+}
+
+inline int CtpCompactTick::hms() const {
+    const int seconds = static_cast<int>(local_ns() / 1000000000LL % 86400);
+    return seconds / 3600 * 10000 + seconds / 60 % 60 * 100 + seconds % 60;
+}
+
+/**
+ * converts ctp depth market data to compact tick, price scale of each instrument comes from its PriceTick
+ * instrument index and scales are set up before market data starts, normalize is then read only
+ */
+class CtpTickNormalizer {
+public:
+    const InstrumentIndex* index{nullptr};
+    std::vector<uint8_t> priceScales;  // dense id to decimals
+
+public:
+    /**
+     * decimals needed to represent every multiple of price tick, default scale if tick is unknown
+     */
+    static uint8_t price_scale(double priceTick) {
+        if (!(priceTick > 0) || priceTick > 1e9) return midas::DefaultPriceScale;
+        for (uint8_t scale = 0; scale < 8; ++scale) {
+            double scaled = priceTick * static_cast<double>(midas::POWER_OF_TEN[scale]);
+            if (std::fabs(scaled - std::round(scaled)) < 1e-6) return scale;
+        }
+        return 8;
+    }
+
+    static int64_t to_fixed(double price, uint8_t scale) {
+        return static_cast<int64_t>(std::llround(price * static_cast<double>(midas::POWER_OF_TEN[scale])));
+    }
+
+    /**
+     * @return ns since epoch, 0 if date or time is malformed
+     */
+    static int64_t exchange_time(const char* day, const char* updateTime, int millisecond) {
+        using ctp_tick_detail::digits;
+        auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+        if (!isDigit(day[0]) || !isDigit(updateTime[0]) || updateTime[2] != ':' || updateTime[5] != ':') return 0;
+        const int64_t days = ctp_tick_detail::days_from_civil(digits(day, 4), digits(day + 4, 2), digits(day + 6, 2));
+        const int64_t seconds = days * 86400 + digits(updateTime, 2) * 3600 + digits(updateTime + 3, 2) * 60 +
+                                digits(updateTime + 6, 2) - CtpExchangeUtcOffset;
+        return seconds * 1000000000LL + millisecond * 1000000LL;
+    }
+
+    void init(const InstrumentIndex& instrumentIndex) {
+        index = &instrumentIndex;
+        priceScales.assign(instrumentIndex.size(), midas::DefaultPriceScale);
+    }
+
+    void set_price_tick(int id, double priceTick) { priceScales[id] = price_scale(priceTick); }
+
+    /**
+     * @return false if instrument is not known
+     */
+    bool normalize(const CThostFtdcDepthMarketDataField& field, CtpCompactTick& tick) const {
+        const int id = index ? index->find(field.InstrumentID) : -1;
+        if (id < 0 || id > UINT16_MAX) return false;
+
+        const uint8_t scale = priceScales[id];
+        tick.instrumentId = static_cast<uint16_t>(id);
+        tick.priceScale = scale;
+        tick.volume = field.Volume;
+        tick.bidVolume = field.BidVolume1;
+        tick.askVolume = field.AskVolume1;
+
+        uint8_t mask = 0;
+        mask |= set_price(tick.lastPrice, field.LastPrice, scale, true) ? TickValidLast : 0;
+        mask |= set_price(tick.bidPrice, field.BidPrice1, scale, field.BidVolume1 > 0) ? TickValidBid : 0;
+        mask |= set_price(tick.askPrice, field.AskPrice1, scale, field.AskVolume1 > 0) ? TickValidAsk : 0;
+        mask |= set_price(tick.highPrice, field.HighestPrice, scale, true) ? TickValidHigh : 0;
+        mask |= set_price(tick.lowPrice, field.LowestPrice, scale, true) ? TickValidLow : 0;
+
+        // night session of some exchanges leaves ActionDay empty
+        const char* day = field.ActionDay[0] ? field.ActionDay : field.TradingDay;
+        tick.exchangeTime = exchange_time(day, field.UpdateTime, field.UpdateMillisec);
+        mask |= tick.exchangeTime != 0 ? TickValidTime : 0;
+        tick.validMask = mask;
+        return true;
+    }
+
+    /**
+     * fill side record with scale of tick that normalize produced from the same field
+     */
+    static void normalize_depth(const CThostFtdcDepthMarketDataField& field, const CtpCompactTick& tick,
+                                CtpTickDepth& depth) {
+        const uint8_t scale = tick.priceScale;
+        const double bidPrices[CtpTickDepthLevels] = {field.BidPrice2, field.BidPrice3, field.BidPrice4,
+                                                      field.BidPrice5};
+        const double askPrices[CtpTickDepthLevels] = {field.AskPrice2, field.AskPrice3, field.AskPrice4,
+                                                      field.AskPrice5};
+        const int bidVolumes[CtpTickDepthLevels] = {field.BidVolume2, field.BidVolume3, field.BidVolume4,
+                                                    field.BidVolume5};
+        const int askVolumes[CtpTickDepthLevels] = {field.AskVolume2, field.AskVolume3, field.AskVolume4,
+                                                    field.AskVolume5};
+        for (int i = 0; i < CtpTickDepthLevels; ++i) {
+            bool isBid = set_price(depth.bidPrice[i], bidPrices[i], scale, bidVolumes[i] > 0);
+            depth.bidVolume[i] = isBid ? bidVolumes[i] : 0;
+            bool isAsk = set_price(depth.askPrice[i], askPrices[i], scale, askVolumes[i] > 0);
+            depth.askVolume[i] = isAsk ? askVolumes[i] : 0;
+        }
+
+        CtpTickStats& stats = depth.stats;
+        set_price(stats.preSettlementPrice, field.PreSettlementPrice, scale, true);
+        set_price(stats.preClosePrice, field.PreClosePrice, scale, true);
+        set_price(stats.openPrice, field.OpenPrice, scale, true);
+        set_price(stats.closePrice, field.ClosePrice, scale, true);
+        set_price(stats.settlementPrice, field.SettlementPrice, scale, true);
+        set_price(stats.upperLimitPrice, field.UpperLimitPrice, scale, true);
+        set_price(stats.lowerLimitPrice, field.LowerLimitPrice, scale, true);
+        stats.preOpenInterest = sent_or_zero(field.PreOpenInterest);
+        stats.openInterest = sent_or_zero(field.OpenInterest);
+        stats.turnover = sent_or_zero(field.Turnover);
+        stats.averagePrice = sent_or_zero(field.AveragePrice);
+        stats.preDelta = sent_or_zero(field.PreDelta);
+        stats.currDelta = sent_or_zero(field.CurrDelta);
+    }
+
+private:
+    static double sent_or_zero(double value) { return value < 1e15 ? value : 0; }
+
+    static bool set_price(int64_t& fixed, double price, uint8_t scale, bool isSent) {
+        const bool isValid = isSent && price > 0 && price < 1e15;
+        fixed = isValid ? to_fixed(price, scale) : 0;
+        return isValid;
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const CtpCompactTick& tick) {
+    os << "id " << tick.instrumentId << " ,t " << tick.cob() << ' ' << tick.hms() << '.' << tick.millisecond()
+       << " ,tp " << tick.price(tick.lastPrice) << " ,ts " << tick.volume << " ,hp " << tick.price(tick.highPrice)
+       << " ,lp " << tick.price(tick.lowPrice) << " ,bbp1 " << tick.price(tick.bidPrice) << " ,bbs1 "
+       << tick.bidVolume << " ,bap1 " << tick.price(tick.askPrice) << " ,bas1 " << tick.askVolume << " ,valid "
+       << static_cast<int>(tick.validMask) << " ,";
+    return os;
+}
+
+#endif
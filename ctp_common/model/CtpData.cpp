@@ -1,12 +1,42 @@
 #include "CtpData.h"
+#include <algorithm>
+#include <new>
 
 void CtpData::init_all_instruments() {
+    // one block for all instruments, each map entry shares ownership of whole block
+    size_t count = instrumentInfo.size();
+    void *memory = ::operator new(sizeof(CtpInstrument) * std::max<size_t>(count, 1));
+    CtpInstrument *block = static_cast<CtpInstrument *>(memory);
+    std::shared_ptr<size_t> live = make_shared<size_t>(0);
+    instrumentArena.reset(block, [live](CtpInstrument *p) {
+        for (size_t i = 0; i < *live; ++i) p[i].~CtpInstrument();
+        ::operator delete(p);
+    });
+
     for (auto itr = instrumentInfo.begin(); itr != instrumentInfo.end(); ++itr) {
         const string &instrumentId = itr->first;
         const TradeSessions &pts = tradeStatusManager.get_session(instrumentId);
-        std::shared_ptr<CtpInstrument> instrument = make_shared<CtpInstrument>(instrumentId, pts);
+        CtpInstrument *instrument = new (block + *live) CtpInstrument(instrumentId, pts);
+        ++*live;
         instrument->info = itr->second;
-        instruments.insert({instrumentId, std::move(instrument)});
+        instruments.insert({instrumentId, std::shared_ptr<CtpInstrument>(instrumentArena, instrument)});
+    }
+    build_instrument_index();
+}
+
+void CtpData::build_instrument_index() {
+    instrumentIndex.clear();
+    denseInstruments.clear();
+    denseInstruments.reserve(instruments.size());
+    for (auto &item : instruments) {
+        instrumentIndex.intern(item.first);
+        denseInstruments.push_back(item.second.get());
+        item.second->bookEngine = &bookEngine;
+    }
+    normalizer.init(instrumentIndex);
+    for (size_t i = 0; i < denseInstruments.size(); ++i) {
+        const CtpInstrument *instrument = denseInstruments[i];
+        if (instrument->info) normalizer.set_price_tick(static_cast<int>(i), instrument->info->PriceTick);
     }
 }
 
@@ -22,11 +52,10 @@ void CtpData::stream(ostream &os, const string &instrument, bool isImage) {
         itr->second->book_stream(os);
 }
 
-bool CtpData::update(const MktDataPayload &tick) {
-    string instrument{tick.get_data().InstrumentID};
-    auto itr = instruments.find(instrument);
-    if (itr == instruments.end()) return false;
+bool CtpData::update(const MktDataPayload &tick, const CtpTickDepth *depth) {
+    const uint16_t id = tick.get_data().instrumentId;
+    if (id >= denseInstruments.size()) return false;
 
-    itr->second->update_tick(tick);
+    denseInstruments[id]->update_tick(tick, depth);
     return true;
 }
@@ -11,7 +11,9 @@
 #include <mutex>
 #include <string>
 #include <vector>
+#include "CtpCompactTick.h"
 #include "CtpInstrument.h"
+#include "InstrumentIndex.h"
 #include "tbb/concurrent_hash_map.h"
 #include "trade/PositionManager.h"
 #include "trade/TradeStatusManager.h"
@@ -34,6 +36,7 @@ public:
     string tradeFront;
     string marketFront;
     string dataDirectory, tradeFlowPath, marketFlowPath;
+    string candleStoreDirectory;  // empty means historic candles are always read from mysql
 
     // 会话参数
     TThostFtdcFrontIDType frontId;        //前置编号
@@ -48,15 +51,38 @@ public:
     vector<CThostFtdcInvestorPositionField> positions;
 
     map<string, std::shared_ptr<CtpInstrument>> instruments;
+    /**
+     * hot path view of instruments, InstrumentID -> dense id -> instrument
+     * instruments created by init_all_instruments are laid out contiguously in instrumentArena
+     */
+    InstrumentIndex instrumentIndex;
+    vector<CtpInstrument*> denseInstruments;
+    std::shared_ptr<CtpInstrument> instrumentArena;
     TradeStatusManager tradeStatusManager;
     PositionManager positionManager;
+    midas::MdBookEngine bookEngine;  // set callbacks before market data starts
+    CtpTickNormalizer normalizer;    // follows instrumentIndex, price scale from instrument info
 
 public:
     void init_all_instruments();
 
+    /**
+     * assign dense id to every instrument in map and set up normalizer, call again after instruments is changed
+     */
+    void build_instrument_index();
+
+    CtpInstrument* find_instrument(const char* instrumentId) const {
+        int id = instrumentIndex.find(instrumentId);
+        return id < 0 ? nullptr : denseInstruments[id];
+    }
+
     void stream(ostream& os, const string& instrument, bool isImage);
 
-    bool update(const MktDataPayload& payload);
+    /**
+     * tick is normalized against current instrument index, so dense id maps to instrument directly
+     * @param depth side record of tick, may be null
+     */
+    bool update(const MktDataPayload& payload, const CtpTickDepth* depth = nullptr);
 };
 
 #endif
@@ -1,34 +1,62 @@
 #include "CtpInstrument.h"
+#include "CtpBook.h"
+#include "CtpLatency.h"
 #include "helper/CtpHelper.h"
+#include "utils/convert/TimeHelper.h"
 
 CtpInstrument::CtpInstrument(const string& _instrument, const TradeSessions& s) : id(_instrument), sessions(s) {
     productName = get_product_name(_instrument);
     candles15.set_session(s);
     candles30.set_session(s);
+    book.allocate(CtpBookDepth);
 }
 
-inline static bool is_volume_abnormal(int v) { return v <= 0 || v > 100000000; }
-
-void CtpInstrument::update_tick(const MktDataPayload& payload) {
+void CtpInstrument::update_tick(const MktDataPayload& payload, const CtpTickDepth* depth) {
     ++updateCount;
 
-    const CThostFtdcDepthMarketDataField& tick = payload.get_data();
+    const CtpCompactTick& tick = payload.get_data();
 
     int ts;  // trade size
-    if (tick.Volume == 0 || updateCount == 1) {
+    if (tick.volume == 0 || updateCount == 1) {
         ts = 0;
     } else {
-        ts = tick.Volume - image.Volume;
+        ts = tick.volume - image.volume;
+    }
+
+    // tick without valid exchange time cannot be placed in a candle
+    if (ts > 0 && tick.is_valid(TickValidTime)) {
+        CtpLatency& latency = CtpLatency::instance();
+        bool isTimed = latency.isEnabled.load(std::memory_order_relaxed);
+        uint64_t start = isTimed ? midas::ntime() : 0;
+
+        // price scale of one instrument never changes, so fixed point is compared directly
+        bool isNewHigh = tick.is_valid(TickValidHigh) && tick.highPrice > image.highPrice;
+        bool isNewLow =
+            tick.is_valid(TickValidLow) && (!image.is_valid(TickValidLow) || tick.lowPrice < image.lowPrice);
+        double newHigh = (isNewHigh ? tick.price(tick.highPrice) : -1);
+        double newLow = (isNewLow ? tick.price(tick.lowPrice) : -1);
+        int date = tick.cob();
+        int intradayMinute = midas::Timestamp::intraday_minute(tick.hms());
+        double price = tick.price(tick.lastPrice);
+        candles15.update(date, intradayMinute, price, ts, newHigh, newLow);
+        candles30.update(date, intradayMinute, price, ts, newHigh, newLow);
+
+        if (isTimed) latency.record(LatencyCandle, midas::ntime() - start);
     }
 
-    if (ts > 0) {
-        double newHigh = (tick.HighestPrice > image.HighestPrice ? tick.HighestPrice : -1);
-        double newLow = (tick.LowestPrice < image.LowestPrice ? tick.LowestPrice : -1);
-        candles15.update(tick, ts, newHigh, newLow);
-        candles30.update(tick, ts, newHigh, newLow);
+    if (bookEngine) {
+        if (exchange == midas::ExchangeNone && info) exchange = ctp_exchange(info->ExchangeID);
+        midas::BookSnapshot snapshot;
+        ctp_book_snapshot(tick, depth, snapshot);
+        midas::Timestamps timestamps;
+        timestamps.producerReceive = payload.get_rcvt();
+        if (bookEngine->update(id.c_str(), exchange, book, snapshot, timestamps, bookChanged) && strategy) {
+            strategy->on_book_changed(book, bookChanged);
+        }
     }
 
     image = tick;
+    if (depth) stats = depth->stats;
 }
 
 void CtpInstrument::load_historic_candle(vector<CandleData>& candles, CandleScale historicScale) {
@@ -50,40 +78,41 @@ const Candles& CtpInstrument::get_candle_reference(CandleScale scale) {
 void CtpInstrument::book_stream(ostream& os) {
     const static int defaultPrice = -99999;
     os << "Price          |         Volume" << '\n'
-       << left << setw(15) << (is_volume_abnormal(image.AskVolume5) ? defaultPrice : image.AskPrice5) << "|" << right
-       << setw(15) << image.AskVolume5 << '\n'
+       << left << setw(15) << (image.is_valid(TickValidAsk) ? image.price(image.askPrice) : defaultPrice) << "|"
+       << right << setw(15) << image.askVolume << '\n'
        << "---------------|---------------" << '\n'
-       << left << setw(15) << (is_volume_abnormal(image.BidVolume1) ? defaultPrice : image.BidPrice1) << "|" << right
-       << setw(15) << image.BidVolume1;
+       << left << setw(15) << (image.is_valid(TickValidBid) ? image.price(image.bidPrice) : defaultPrice) << "|"
+       << right << setw(15) << image.bidVolume;
 }
 
 void CtpInstrument::image_stream(ostream& os) {
-    os << left << setw(15) << "e " << right << setw(15) << image.ExchangeID << '\n'
-       << left << setw(15) << "id " << right << setw(15) << image.InstrumentID << '\n'
-       << left << setw(15) << "tp " << right << setw(15) << image.LastPrice << '\n'
-       << left << setw(15) << "lsp " << right << setw(15) << image.PreSettlementPrice << '\n'
-       << left << setw(15) << "lccp " << right << setw(15) << image.PreClosePrice << '\n'
-       << left << setw(15) << "lois " << right << setw(15) << image.PreOpenInterest << '\n'
-       << left << setw(15) << "op " << right << setw(15) << image.OpenPrice << '\n'
-       << left << setw(15) << "hp " << right << setw(15) << image.HighestPrice << '\n'
-       << left << setw(15) << "lp " << right << setw(15) << image.LowestPrice << '\n'
-       << left << setw(15) << "ts " << right << setw(15) << image.Volume << '\n'
-       << left << setw(15) << "to " << right << setw(15) << image.Turnover << '\n'
-       << left << setw(15) << "ois " << right << setw(15) << image.OpenInterest << '\n'
-       << left << setw(15) << "cp " << right << setw(15) << image.ClosePrice << '\n'
-       << left << setw(15) << "sp " << right << setw(15) << image.SettlementPrice << '\n'
-       << left << setw(15) << "ulp " << right << setw(15) << image.UpperLimitPrice << '\n'
-       << left << setw(15) << "llp " << right << setw(15) << image.LowerLimitPrice << '\n'
-       << left << setw(15) << "pd " << right << setw(15) << image.PreDelta << '\n'
-       << left << setw(15) << "cd " << right << setw(15) << image.CurrDelta << '\n'
-       << left << setw(15) << "ut " << right << setw(15) << image.UpdateTime << '\n'
-       << left << setw(15) << "um " << right << setw(15) << image.UpdateMillisec << '\n'
-       << left << setw(15) << "bbp1 " << right << setw(15) << image.BidPrice1 << '\n'
-       << left << setw(15) << "bbs1 " << right << setw(15) << image.BidVolume1 << '\n'
-       << left << setw(15) << "bap1 " << right << setw(15) << image.AskPrice1 << '\n'
-       << left << setw(15) << "bas1 " << right << setw(15) << image.AskVolume1 << '\n'
-       << left << setw(15) << "avgp " << right << setw(15) << image.AveragePrice << '\n'
-       << left << setw(15) << "ad " << right << setw(15) << image.ActionDay << '\n'
+    os << left << setw(15) << "e " << right << setw(15) << (info ? info->ExchangeID : "") << '\n'
+       << left << setw(15) << "id " << right << setw(15) << id << '\n'
+       << left << setw(15) << "tp " << right << setw(15) << image.price(image.lastPrice) << '\n'
+       << left << setw(15) << "lsp " << right << setw(15) << image.price(stats.preSettlementPrice) << '\n'
+       << left << setw(15) << "lccp " << right << setw(15) << image.price(stats.preClosePrice) << '\n'
+       << left << setw(15) << "lois " << right << setw(15) << stats.preOpenInterest << '\n'
+       << left << setw(15) << "op " << right << setw(15) << image.price(stats.openPrice) << '\n'
+       << left << setw(15) << "hp " << right << setw(15) << image.price(image.highPrice) << '\n'
+       << left << setw(15) << "lp " << right << setw(15) << image.price(image.lowPrice) << '\n'
+       << left << setw(15) << "ts " << right << setw(15) << image.volume << '\n'
+       << left << setw(15) << "to " << right << setw(15) << stats.turnover << '\n'
+       << left << setw(15) << "ois " << right << setw(15) << stats.openInterest << '\n'
+       << left << setw(15) << "cp " << right << setw(15) << image.price(stats.closePrice) << '\n'
+       << left << setw(15) << "sp " << right << setw(15) << image.price(stats.settlementPrice) << '\n'
+       << left << setw(15) << "ulp " << right << setw(15) << image.price(stats.upperLimitPrice) << '\n'
+       << left << setw(15) << "llp " << right << setw(15) << image.price(stats.lowerLimitPrice) << '\n'
+       << left << setw(15) << "pd " << right << setw(15) << stats.preDelta << '\n'
+       << left << setw(15) << "cd " << right << setw(15) << stats.currDelta << '\n'
+       << left << setw(15) << "ut " << right << setw(15) << image.hms() << '\n'
+       << left << setw(15) << "um " << right << setw(15) << image.millisecond() << '\n'
+       << left << setw(15) << "bbp1 " << right << setw(15) << image.price(image.bidPrice) << '\n'
+       << left << setw(15) << "bbs1 " << right << setw(15) << image.bidVolume << '\n'
+       << left << setw(15) << "bap1 " << right << setw(15) << image.price(image.askPrice) << '\n'
+       << left << setw(15) << "bas1 " << right << setw(15) << image.askVolume << '\n'
+       << left << setw(15) << "avgp " << right << setw(15) << stats.averagePrice << '\n'
+       << left << setw(15) << "ad " << right << setw(15) << image.cob() << '\n'
+       << left << setw(15) << "valid " << right << setw(15) << static_cast<int>(image.validMask) << '\n'
        << left << setw(15) << "updateCount " << right << setw(15) << updateCount << '\n';
 }
 
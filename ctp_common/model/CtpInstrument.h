@@ -8,11 +8,13 @@
 #include <string>
 #include <vector>
 #include "CandleData.h"
+#include "CtpCompactTick.h"
+#include "midas/md/MdBookEngine.h"
 #include "strategy/StrategyBase.h"
 
 using namespace std;
 
-typedef midas::PayloadObject<CThostFtdcDepthMarketDataField> MktDataPayload;
+typedef midas::PayloadObject<CtpCompactTick> MktDataPayload;
 
 class CtpInstrument {
 public:
@@ -23,7 +25,12 @@ public:
     Candles candles15{CandleScale::Minute15};
     Candles candles30{CandleScale::Minute30};
     TradeSessions sessions;
-    CThostFtdcDepthMarketDataField image;
+    CtpCompactTick image{};  // last tick
+    CtpTickStats stats{};    // session statistics of last tick that came with side record
+    uint16_t exchange{midas::ExchangeNone};
+    midas::MdBook book;
+    midas::BookChanged bookChanged;            // levels changed by last tick
+    midas::MdBookEngine* bookEngine{nullptr};  // book is maintained only with engine
     std::shared_ptr<CThostFtdcInstrumentField> info;
     std::unique_ptr<StrategyBase> strategy;
 
@@ -34,7 +41,10 @@ public:
 
     void image_stream(ostream& os);
 
-    void update_tick(const MktDataPayload& tick);
+    /**
+     * @param depth side record of tick, book keeps level 1 only and stats stay as they are without it
+     */
+    void update_tick(const MktDataPayload& tick, const CtpTickDepth* depth = nullptr);
 
     void load_historic_candle(vector<CandleData>& candles, CandleScale historicScale = CandleScale::Minute15);
 
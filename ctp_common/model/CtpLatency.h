@@ -0,0 +1,55 @@
+#ifndef MIDAS_CTP_LATENCY_H
+#define MIDAS_CTP_LATENCY_H
+
+#include <ctp/ThostFtdcUserApiStruct.h>
+#include <cstdint>
+#include "CtpCompactTick.h"
+#include "utils/math/LatencyHistogram.h"
+
+/**
+ * stages of tick pipeline, value is latency in ns
+ * exchange: UpdateTime of exchange to CTP callback, publish: CTP callback to disruptor publish done
+ * dequeue: CTP callback to consumer pick up, update: CtpData::update, candle: candle update, journal: raw journal record
+ */
+enum CtpLatencyStage : size_t {
+    LatencyExchange,
+    LatencyPublish,
+    LatencyDequeue,
+    LatencyUpdate,
+    LatencyCandle,
+    LatencyJournal
+};
+
+/**
+ * off by default as timing costs clock reads on hot path, turn on by ctp.latency.enable or admin command latency on
+ */
+class CtpLatency : public midas::LatencyRecorder {
+public:
+    CtpLatency() : midas::LatencyRecorder({"exchange", "publish", "dequeue", "update", "candle", "journal"}) {
+        isEnabled = false;
+    }
+
+    static CtpLatency& instance() {
+        static CtpLatency recorder;
+        return recorder;
+    }
+
+    /**
+     * exchange stamps only time of day in seconds plus millisecond, compare with time of day of rcvt in UTC+8
+     * tick stamped just before midnight and received after it wraps by one day
+     * @return 0 if clocks disagree
+     */
+    static uint64_t exchange_latency(const CThostFtdcDepthMarketDataField& tick, uint64_t rcvt) {
+        const char* t = tick.UpdateTime;  // HH:MM:SS
+        int64_t exchangeMs = ((t[0] - '0') * 10 + (t[1] - '0')) * 3600000LL +
+                             ((t[3] - '0') * 10 + (t[4] - '0')) * 60000LL +
+                             ((t[6] - '0') * 10 + (t[7] - '0')) * 1000LL + tick.UpdateMillisec;
+        const int64_t dayNs = 86400LL * 1000000000LL;
+        int64_t exchangeDayNs = (static_cast<int64_t>(rcvt) + CtpExchangeUtcOffset * 1000000000LL) % dayNs;
+        int64_t diff = exchangeDayNs - exchangeMs * 1000000LL;
+        if (diff < -dayNs / 2) diff += dayNs;
+        return diff > 0 ? static_cast<uint64_t>(diff) : 0;
+    }
+};
+
+#endif
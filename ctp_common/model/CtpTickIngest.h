@@ -0,0 +1,53 @@
+#ifndef MIDAS_CTP_TICK_INGEST_H
+#define MIDAS_CTP_TICK_INGEST_H
+
+#include <ctp/ThostFtdcUserApiStruct.h>
+#include <net/disruptor/SideRing.h>
+#include "CtpCompactTick.h"
+
+/**
+ * fills market data disruptor slot from raw depth data, shared by live md spi and journal replay
+ * slot gets compact tick, its depth side record and raw field go to side rings by sequence
+ * raw field is kept only when a raw journal consumer drains it
+ */
+class CtpTickIngest {
+public:
+    const CtpTickNormalizer& normalizer;
+    midas::SideRing<CtpTickDepth> depths;
+    midas::SideRing<CThostFtdcDepthMarketDataField> raws;
+    long unknownInstrumentCount{0};  // ticks dropped as instrument is not in index
+
+public:
+    explicit CtpTickIngest(const CtpTickNormalizer& normalizer_) : normalizer(normalizer_) {}
+
+    /**
+     * keep side records of every entry for consumers, ringSize must be size of disruptor ring
+     */
+    void attach(size_t ringSize, bool isRawKept) {
+        depths = midas::SideRing<CtpTickDepth>(ringSize);
+        if (isRawKept) raws = midas::SideRing<CThostFtdcDepthMarketDataField>(ringSize);
+    }
+
+    /**
+     * called on producer thread for the claimed slot
+     * @return false if instrument is unknown, slot is then published as invalid
+     */
+    bool fill(const CThostFtdcDepthMarketDataField& raw, CtpCompactTick& tick, long sequence) {
+        if (!normalizer.normalize(raw, tick)) {
+            ++unknownInstrumentCount;
+            return false;
+        }
+        if (!depths.empty()) normalizer.normalize_depth(raw, tick, depths.at(sequence));
+        if (!raws.empty()) raws.at(sequence) = raw;
+        return true;
+    }
+
+    /**
+     * @return side record of entry, null before attach
+     */
+    const CtpTickDepth* depth(long sequence) const { return depths.empty() ? nullptr : &depths.at(sequence); }
+
+    const CThostFtdcDepthMarketDataField& raw(long sequence) const { return raws.at(sequence); }
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef MIDAS_CTP_TICK_SCHEMA_H
+#define MIDAS_CTP_TICK_SCHEMA_H
+
+#include <ctp/ThostFtdcUserApiStruct.h>
+#include <cstdint>
+#include "midas/TickCodec.h"
+
+/**
+ * depth market data as recorded in text tick files, rcvt is local receive time in ns
+ */
+struct CtpTick {
+    CThostFtdcDepthMarketDataField data;
+    uint64_t rcvt;
+};
+
+/**
+ * keys are the ones written by operator<< of CThostFtdcDepthMarketDataField, same order
+ * bump version whenever fields are added, removed or reordered
+ */
+struct CtpTickSchema {
+    typedef CtpTick TPod;
+
+    static constexpr uint16_t version() { return 1; }
+
+    static constexpr midas::TickFieldTable<28> fields() {
+        return {{MIDAS_TICK_FIELD(CtpTick, "e", data.ExchangeID),
+                 MIDAS_TICK_FIELD(CtpTick, "id", data.InstrumentID),
+                 MIDAS_TICK_FIELD(CtpTick, "tp", data.LastPrice),
+                 MIDAS_TICK_FIELD(CtpTick, "lsp", data.PreSettlementPrice),
+                 MIDAS_TICK_FIELD(CtpTick, "lccp", data.PreClosePrice),
+                 MIDAS_TICK_FIELD(CtpTick, "lois", data.PreOpenInterest),
+                 MIDAS_TICK_FIELD(CtpTick, "op", data.OpenPrice),
+                 MIDAS_TICK_FIELD(CtpTick, "hp", data.HighestPrice),
+                 MIDAS_TICK_FIELD(CtpTick, "lp", data.LowestPrice),
+                 MIDAS_TICK_FIELD(CtpTick, "ts", data.Volume),
+                 MIDAS_TICK_FIELD(CtpTick, "to", data.Turnover),
+                 MIDAS_TICK_FIELD(CtpTick, "ois", data.OpenInterest),
+                 MIDAS_TICK_FIELD(CtpTick, "cp", data.ClosePrice),
+                 MIDAS_TICK_FIELD(CtpTick, "sp", data.SettlementPrice),
+                 MIDAS_TICK_FIELD(CtpTick, "ulp", data.UpperLimitPrice),
+                 MIDAS_TICK_FIELD(CtpTick, "llp", data.LowerLimitPrice),
+                 MIDAS_TICK_FIELD(CtpTick, "pd", data.PreDelta),
+                 MIDAS_TICK_FIELD(CtpTick, "cd", data.CurrDelta),
+                 MIDAS_TICK_FIELD(CtpTick, "ut", data.UpdateTime),
+                 MIDAS_TICK_FIELD(CtpTick, "um", data.UpdateMillisec),
+                 MIDAS_TICK_FIELD(CtpTick, "bbp1", data.BidPrice1),
+                 MIDAS_TICK_FIELD(CtpTick, "bbs1", data.BidVolume1),
+                 MIDAS_TICK_FIELD(CtpTick, "bap1", data.AskPrice1),
+                 MIDAS_TICK_FIELD(CtpTick, "bas1", data.AskVolume1),
+                 MIDAS_TICK_FIELD(CtpTick, "avgp", data.AveragePrice),
+                 MIDAS_TICK_FIELD(CtpTick, "tpd", data.TradingDay),
+                 MIDAS_TICK_FIELD(CtpTick, "ad", data.ActionDay),
+                 MIDAS_TICK_FIELD(CtpTick, "rcvt", rcvt)}};
+    }
+};
+
+typedef midas::TickCodec<CtpTickSchema> CtpTickCodec;
+
+#endif
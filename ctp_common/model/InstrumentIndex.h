@@ -0,0 +1,122 @@
+#ifndef MIDAS_INSTRUMENT_INDEX_H
+#define MIDAS_INSTRUMENT_INDEX_H
+
+#include <ctp/ThostFtdcUserApiDataType.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * intern instrument id into dense integer, 0, 1, 2 ... in order of interning
+ * open addressing with linear probing over fixed width keys, table is at most half full
+ * lookup hashes the char array in place, no std::string is built on hot path
+ */
+class InstrumentIndex {
+private:
+    static constexpr size_t KEY_SIZE = sizeof(TThostFtdcInstrumentIDType);
+
+    struct Entry {
+        uint32_t hash;
+        int32_t id{-1};  // -1 means empty
+        char key[KEY_SIZE];
+    };
+
+    std::vector<Entry> table;
+    size_t mask{0};
+    std::vector<std::string> names;  // dense id to instrument id
+
+public:
+    InstrumentIndex() { rehash(64); }
+
+    /**
+     * @return dense id of instrument, new id is assigned if not seen before
+     */
+    int intern(const char* instrument) {
+        size_t length;
+        uint32_t h = hash(instrument, length);
+        if (length == 0) return -1;
+
+        size_t slot = probe(instrument, length, h);
+        if (table[slot].id >= 0) return table[slot].id;
+
+        if (2 * (names.size() + 1) > table.size()) {
+            rehash(table.size() * 2);
+            slot = probe(instrument, length, h);
+        }
+        Entry& entry = table[slot];
+        entry.hash = h;
+        entry.id = static_cast<int>(names.size());
+        memset(entry.key, 0, KEY_SIZE);
+        memcpy(entry.key, instrument, length);
+        names.emplace_back(instrument, length);
+        return entry.id;
+    }
+
+    int intern(const std::string& instrument) { return intern(instrument.c_str()); }
+
+    /**
+     * @return dense id, -1 if not interned
+     */
+    int find(const char* instrument) const {
+        size_t length;
+        uint32_t h = hash(instrument, length);
+        return table[probe(instrument, length, h)].id;
+    }
+
+    int find(const std::string& instrument) const { return find(instrument.c_str()); }
+
+    const std::string& name(int id) const { return names[id]; }
+
+    size_t size() const { return names.size(); }
+
+    void clear() {
+        names.clear();
+        table.assign(64, Entry());
+        mask = table.size() - 1;
+    }
+
+private:
+    /**
+     * FNV-1a over chars before terminator, at most KEY_SIZE - 1 chars
+     */
+    static uint32_t hash(const char* s, size_t& length) {
+        uint32_t h = 2166136261u;
+        size_t i = 0;
+        for (; i < KEY_SIZE - 1 && s[i]; ++i) {
+            h ^= static_cast<uint8_t>(s[i]);
+            h *= 16777619u;
+        }
+        length = i;
+        return h;
+    }
+
+    /**
+     * slot holding instrument, or empty slot where it should go
+     */
+    size_t probe(const char* instrument, size_t length, uint32_t h) const {
+        size_t slot = h & mask;
+        while (true) {
+            const Entry& entry = table[slot];
+            if (entry.id < 0) return slot;
+            if (entry.hash == h && entry.key[length] == '\0' && memcmp(entry.key, instrument, length) == 0) {
+                return slot;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Entry> old;
+        old.swap(table);
+        table.resize(capacity);
+        mask = capacity - 1;
+        for (const Entry& entry : old) {
+            if (entry.id < 0) continue;
+            size_t length = strlen(entry.key);
+            table[probe(entry.key, length, entry.hash)] = entry;
+        }
+    }
+};
+
+#endif
@@ -29,7 +29,7 @@ TradeSession::TradeSession(const string& str) {
 
 int TradeSession::minute() const { return sessionMinute; }
 
-bool TradeSession::is_in_this_session(int intradayMinute) {
+bool TradeSession::is_in_this_session(int intradayMinute) const {
     if (to > from) {
         return fromIntradayMinute - sessionMinuteThreshold <= intradayMinute &&
                intradayMinute <= toIntradayMinute + sessionMinuteThreshold;
@@ -87,6 +87,13 @@ bool TradeSessions::update_session(int intradayMinute) {
     return false;
 }
 
+bool TradeSessions::is_in_session(int intradayMinute) const {
+    for (const auto& session : sessions) {
+        if (session.is_in_this_session(intradayMinute)) return true;
+    }
+    return false;
+}
+
 void TradeSessions::add_session(const TradeSession& session) {
     sessions.push_back(session);
     sessionCount += 1;
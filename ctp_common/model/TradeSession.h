@@ -20,7 +20,7 @@ public:
      */
     int minute() const;
 
-    bool is_in_this_session(int intradayMinute);
+    bool is_in_this_session(int intradayMinute) const;
 
     int adjust_within_session(int startIntradayMinute, int scale);
 };
@@ -41,6 +41,11 @@ public:
      */
     bool update_session(int intradayMinute);
 
+    /**
+     * same check as update_session without moving sessionIndex
+     */
+    bool is_in_session(int intradayMinute) const;
+
     void add_session(const TradeSession& session);
 
     int adjust_within_session(int startIntradayMinute, int scale);
@@ -1,8 +1,11 @@
 #ifndef MIDAS_BI_MA_STRATEGY_H
 #define MIDAS_BI_MA_STRATEGY_H
 
+#include <sstream>
 #include "StrategyBase.h"
+#include "model/CandleColumns.h"
 #include "utils/math/DescriptiveStatistics.h"
+#include "utils/math/RollingKernels.h"
 
 class BiMaStrategy : public StrategyBase {
 public:
@@ -10,8 +13,9 @@ public:
     int fastPeriod{10};
     vector<double> slowMa;
     vector<double> fastMa;
-    DescriptiveStatistics dsSlow;
-    DescriptiveStatistics dsFast;
+    midas::DescriptiveStatistics dsSlow;
+    midas::DescriptiveStatistics dsFast;
+    CandleColumns columns;
 
 public:
     BiMaStrategy(const Candles& candles_) : StrategyBase(candles_) {}
@@ -33,6 +37,45 @@ public:
         }
     }
 
+    /**
+     * columnar equivalent of calling calculate bin by bin, moving averages come from block restarted prefix sums
+     * over close column, within 1e-13 relative of exact window sums at any history length, bin by bin path rounds
+     * on its own and both agree within 1e-12 relative, a crossover is called differently only where fast and slow
+     * averages are that close
+     */
+    void calculate_all() override {
+        init();
+        int count = candles.currentBinIndex;
+        if (count <= 0) return;
+
+        columns.sync(candles, count);
+        size_t n = static_cast<size_t>(count);
+        const double* close = columns.close.data();
+        midas::rolling_mean(close, n, static_cast<size_t>(slowPeriod), slowMa.data());
+        midas::rolling_mean(close, n, static_cast<size_t>(fastPeriod), fastMa.data());
+        midas::cross_mask(fastMa.data(), slowMa.data(), n, signals.data());
+        fill(signals.begin(), signals.begin() + std::min<size_t>(n, 11), 0);
+
+        for (size_t i = n; i-- > 11;) {
+            if (signals[i] != 0) {
+                decision = (signals[i] > 0 ? StrategyDecision::longSignal : StrategyDecision::shortSignal);
+                break;
+            }
+        }
+
+        // keep window state so that later calculate(index) continues from here
+        for (size_t i = 0; i < n; ++i) {
+            if (i + slowPeriod >= n) dsSlow.add_value(close[i]);
+            if (i + fastPeriod >= n) dsFast.add_value(close[i]);
+        }
+    }
+
+    void apply_parameter(const StrategyParameter& parameter) override {
+        StrategyBase::apply_parameter(parameter);
+        slowPeriod = static_cast<int>(parameter.get("slowPeriod", slowPeriod));
+        fastPeriod = static_cast<int>(parameter.get("fastPeriod", fastPeriod));
+    }
+
     void init() override {
         size_t size = candles.data.size();
         dsSlow.clear();
@@ -1,6 +1,11 @@
 #ifndef MIDAS_STRATEGY_BASE_H
 #define MIDAS_STRATEGY_BASE_H
 
+#include <map>
+#include <string>
+#include "midas/Singleton.h"
+#include "midas/md/MdBook.h"
+#include "net/raw/MdProtocol.h"
 #include "model/CandleData.h"
 
 struct StrategyParameter {
@@ -10,6 +15,12 @@ struct StrategyParameter {
     int singleInt{1};
     double singleDouble{1.0};
     double tradeTaxRate{0.003};
+    std::map<std::string, double> values;  // named strategy specific parameters, used by parameter sweep
+
+    double get(const std::string& name, double defaultValue) const {
+        auto itr = values.find(name);
+        return itr == values.end() ? defaultValue : itr->second;
+    }
 
     static StrategyParameter& instance() { return midas::Singleton<StrategyParameter>::instance(); }
 };
@@ -38,19 +49,27 @@ public:
     virtual void init() = 0;
     virtual void calculate(size_t index) = 0;
 
-    void calculate_all() {
+    /**
+     * calculate all closed bins, strategy can override it with column based kernels
+     */
+    virtual void calculate_all() {
         init();
         for (int i = 0; i < candles.currentBinIndex; ++i) {
             calculate(i);
         }
     }
 
-    void apply_parameter(StrategyParameter parameter) {
+    /**
+     * called only when some book level changed, changed tells which levels
+     */
+    virtual void on_book_changed(const midas::MdBook& book, const midas::BookChanged& changed) {}
+
+    virtual void apply_parameter(const StrategyParameter& parameter) {
         singleDouble = parameter.singleDouble;
         singleInt = parameter.singleInt;
     }
 
-    bool is_valid_time() { return itr < candles.historicDataCount; }
+    bool is_valid_time() const { return itr < candles.historicDataCount; }
 
     const CandleData& current_candle() const { return candles.get(itr); }
 
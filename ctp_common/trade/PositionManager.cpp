@@ -7,16 +7,30 @@ void PositionManager::mark2market(const map<std::string, std::shared_ptr<CtpInst
     totalProfit = 0;
     for (auto order : holdingOrders) {
         const CtpInstrument& instrument = *instruments.find(order->instrumentId)->second;
-        double marketPrice = instrument.strategy->previous_candle().close;
-        if (instrument.strategy->is_valid_time()) {
-            marketPrice = instrument.strategy->current_candle().open;
-        }
-        order->mark2market(marketPrice, *instrument.info);
-        totalMargin += order->margin;
-        totalProfit += order->profit;
+        mark2market(*order, instrument, *instrument.strategy);
     }
 }
 
+void PositionManager::mark2market(const map<std::string, std::shared_ptr<CtpInstrument>>& instruments,
+                                  const map<std::string, StrategyBase*>& strategies) {
+    totalMargin = 0;
+    totalProfit = 0;
+    for (auto order : holdingOrders) {
+        const CtpInstrument& instrument = *instruments.find(order->instrumentId)->second;
+        mark2market(*order, instrument, *strategies.find(order->instrumentId)->second);
+    }
+}
+
+void PositionManager::mark2market(CtpOrder& order, const CtpInstrument& instrument, const StrategyBase& strategy) {
+    double marketPrice = strategy.previous_candle().close;
+    if (strategy.is_valid_time()) {
+        marketPrice = strategy.current_candle().open;
+    }
+    order.mark2market(marketPrice, *instrument.info);
+    totalMargin += order.margin;
+    totalProfit += order.profit;
+}
+
 void PositionManager::init4simulation() {
     capital = InitAsset;
     holdingOrders.clear();
@@ -24,9 +24,18 @@ public:
 
     void mark2market(const map<std::string, std::shared_ptr<CtpInstrument>>& instruments);
 
+    /**
+     * same as above but use strategies owned by caller instead of instrument's, for isolated simulation
+     */
+    void mark2market(const map<std::string, std::shared_ptr<CtpInstrument>>& instruments,
+                     const map<std::string, StrategyBase*>& strategies);
+
     void init4simulation();
 
     double get_cash() { return capital + totalProfit - totalMargin; }
+
+private:
+    void mark2market(CtpOrder& order, const CtpInstrument& instrument, const StrategyBase& strategy);
 };
 
 #endif
@@ -38,6 +38,13 @@ const TradeSessions& TradeStatusManager::get_session(const string& instrumentId)
         throw std::string("no trade session found for " + instrumentId);
 }
 
+bool TradeStatusManager::is_trading_hour(int intradayMinute) const {
+    for (const auto& item : product2sessions) {
+        if (item.second.is_in_session(intradayMinute)) return true;
+    }
+    return false;
+}
+
 ostream& operator<<(ostream& s, const TradeStatusManager& manager) {
     s << manager.product2sessions;
     return s;
@@ -14,6 +14,11 @@ public:
     void load_trade_session(const string& path);
 
     const TradeSessions& get_session(const string& instrumentId);
+
+    /**
+     * @return true if any product of trading hour map is in session at this minute
+     */
+    bool is_trading_hour(int intradayMinute) const;
 };
 
 ostream& operator<<(ostream& s, const TradeStatusManager& manager);
@@ -0,0 +1,279 @@
+#ifndef MIDAS_PARAMETER_SWEEP_H
+#define MIDAS_PARAMETER_SWEEP_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <vector>
+#include "Simulator.h"
+#include "TrainCommon.h"
+#include "process/MidasThreadPool.h"
+#include "utils/log/Log.h"
+
+/**
+ * one axis of parameter space, inclusive range
+ * singleInt and singleDouble map to StrategyParameter fields, other names go to StrategyParameter::values
+ */
+struct ParameterDimension {
+    string name;
+    double start{0};
+    double end{0};
+    double step{1};
+
+    vector<double> values() const {
+        vector<double> v;
+        if (step <= 0) {
+            v.push_back(start);
+            return v;
+        }
+        for (int i = 0;; ++i) {
+            double x = start + i * step;
+            if (x > end + step * 1e-9) break;
+            v.push_back(x);
+        }
+        return v;
+    }
+
+    /**
+     * parse name:start:end:step, step can be omitted for single value
+     */
+    static bool parse(const string& text, ParameterDimension& dimension) {
+        vector<string> fields;
+        std::stringstream ss(text);
+        string field;
+        while (std::getline(ss, field, ':')) fields.push_back(field);
+        if (fields.size() < 2 || fields.size() > 4 || fields[0].empty()) return false;
+
+        dimension.name = fields[0];
+        dimension.start = std::atof(fields[1].c_str());
+        dimension.end = fields.size() > 2 ? std::atof(fields[2].c_str()) : dimension.start;
+        dimension.step = fields.size() > 3 ? std::atof(fields[3].c_str()) : 0;
+        return dimension.end >= dimension.start;
+    }
+};
+
+enum class SweepType { Grid, Random, SuccessiveHalving, Unknown };
+
+inline SweepType string2sweep(const string& str) {
+    if (str == "grid")
+        return SweepType::Grid;
+    else if (str == "random")
+        return SweepType::Random;
+    else if (str == "halving")
+        return SweepType::SuccessiveHalving;
+    else
+        return SweepType::Unknown;
+}
+
+struct SweepTrial {
+    int id{0};
+    vector<double> point;  // one value per dimension
+    double budget{1.0};
+    double score{std::numeric_limits<double>::lowest()};
+    BacktestResult result;
+};
+
+/**
+ * search parameter space of a strategy, every trial runs an isolated Simulator on thread pool
+ * grid evaluates cartesian product, random samples randomTrials points,
+ * successive halving starts all grid/random candidates with small budget and keeps top 1/eta each round
+ */
+class ParameterSweep {
+public:
+    StrategyType strategyType{StrategyType::TBiMaStrategy};
+    SweepType sweepType{SweepType::Grid};
+    vector<ParameterDimension> dimensions;
+    StrategyParameter baseParameter;
+    int randomTrials{64};
+    int eta{3};
+    unsigned seed{42};
+    std::function<double(const BacktestResult&)> objective{[](const BacktestResult& r) { return r.sharpeRatio; }};
+
+    std::atomic<int> scheduledTrials{0};
+    std::atomic<int> finishedTrials{0};
+    std::atomic<int> round{0};
+    std::atomic<bool> isRunning{false};
+
+private:
+    std::atomic<bool> isStopped{false};
+    mutable std::mutex mtx;
+    vector<SweepTrial> finished;  // every evaluated trial, include partial budget ones
+
+public:
+    ParameterSweep(StrategyType type, SweepType sweep, const vector<ParameterDimension>& dims)
+        : strategyType(type), sweepType(sweep), dimensions(dims), baseParameter(StrategyParameter::instance()) {}
+
+    /**
+     * blocking run, return trials evaluated with full budget sorted by score
+     */
+    vector<SweepTrial> run(std::shared_ptr<CtpData> data, midas::ThreadPool& pool) {
+        isRunning = true;
+        isStopped = false;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            finished.clear();
+        }
+        scheduledTrials = 0;
+        finishedTrials = 0;
+        round = 0;
+
+        vector<SweepTrial> trials = candidates();
+        if (sweepType == SweepType::SuccessiveHalving) {
+            int rounds = 1;
+            for (size_t n = trials.size(); n > static_cast<size_t>(eta); n /= eta) ++rounds;
+            double budget = std::pow(static_cast<double>(eta), 1 - rounds);
+            for (int r = 0; r < rounds && !isStopped; ++r) {
+                round = r;
+                for (auto& trial : trials) trial.budget = std::min(1.0, budget);
+                evaluate(trials, data, pool);
+                sort_by_score(trials);
+                if (r + 1 < rounds) trials.resize(std::max<size_t>(1, trials.size() / eta));
+                budget *= eta;
+            }
+        } else {
+            evaluate(trials, data, pool);
+            sort_by_score(trials);
+        }
+
+        isRunning = false;
+        return trials;
+    }
+
+    void stop() { isStopped = true; }
+
+    StrategyParameter to_parameter(const vector<double>& point) const {
+        StrategyParameter parameter = baseParameter;
+        for (size_t i = 0; i < dimensions.size() && i < point.size(); ++i) {
+            const string& name = dimensions[i].name;
+            if (name == "singleInt")
+                parameter.singleInt = static_cast<int>(std::lround(point[i]));
+            else if (name == "singleDouble")
+                parameter.singleDouble = point[i];
+            else
+                parameter.values[name] = point[i];
+        }
+        return parameter;
+    }
+
+    string progress() const {
+        ostringstream oss;
+        oss << (isRunning ? "running" : "idle") << " round " << round << " trials " << finishedTrials << "/"
+            << scheduledTrials << '\n';
+        return oss.str();
+    }
+
+    /**
+     * best trials so far, full budget trials rank before partial ones
+     */
+    string report(size_t top = 10) const {
+        vector<SweepTrial> trials;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            trials = finished;
+        }
+        std::sort(trials.begin(), trials.end(), [](const SweepTrial& l, const SweepTrial& r) {
+            if (l.budget != r.budget) return l.budget > r.budget;
+            return l.score > r.score;
+        });
+
+        ostringstream oss;
+        oss << progress();
+        oss << "id,budget,score";
+        for (auto& dimension : dimensions) oss << ',' << dimension.name;
+        oss << ",sharpe,dayPerformance,stdDev\n";
+        for (size_t i = 0; i < trials.size() && i < top; ++i) {
+            const SweepTrial& trial = trials[i];
+            oss << trial.id << ',' << std::setprecision(3) << trial.budget << ',' << std::setprecision(6) << trial.score;
+            for (double v : trial.point) oss << ',' << v;
+            oss << ',' << trial.result.sharpeRatio << ',' << trial.result.dayPerformance << ',' << trial.result.stdDev
+                << '\n';
+        }
+        return oss.str();
+    }
+
+private:
+    vector<SweepTrial> candidates() {
+        vector<vector<double>> axes;
+        for (auto& dimension : dimensions) axes.push_back(dimension.values());
+
+        vector<SweepTrial> trials;
+        if (sweepType == SweepType::Random) {
+            std::mt19937 gen(seed);
+            for (int i = 0; i < randomTrials; ++i) {
+                SweepTrial trial;
+                trial.id = i;
+                for (auto& axis : axes) {
+                    std::uniform_int_distribution<size_t> pick(0, axis.size() - 1);
+                    trial.point.push_back(axis[pick(gen)]);
+                }
+                trials.push_back(trial);
+            }
+            return trials;
+        }
+
+        // cartesian product, last dimension changes fastest
+        size_t total = 1;
+        for (auto& axis : axes) total *= axis.size();
+        for (size_t i = 0; i < total; ++i) {
+            SweepTrial trial;
+            trial.id = static_cast<int>(i);
+            trial.point.resize(axes.size());
+            size_t k = i;
+            for (size_t d = axes.size(); d-- > 0;) {
+                trial.point[d] = axes[d][k % axes[d].size()];
+                k /= axes[d].size();
+            }
+            trials.push_back(trial);
+        }
+        return trials;
+    }
+
+    void evaluate(vector<SweepTrial>& trials, std::shared_ptr<CtpData> data, midas::ThreadPool& pool) {
+        vector<std::future<void>> futures;
+        for (auto& trial : trials) {
+            ++scheduledTrials;
+            SweepTrial* pTrial = &trial;
+            futures.push_back(pool.push([this, pTrial, data](int) { run_trial(*pTrial, data); }));
+        }
+        for (size_t i = 0; i < futures.size(); ++i) {
+            try {
+                futures[i].get();
+            } catch (const std::exception& e) {
+                MIDAS_LOG_ERROR("sweep trial " << trials[i].id << " failed: " << e.what());
+            } catch (...) {
+                MIDAS_LOG_ERROR("sweep trial " << trials[i].id << " failed");
+            }
+        }
+    }
+
+    void run_trial(SweepTrial& trial, std::shared_ptr<CtpData> data) {
+        if (isStopped) return;
+
+        StrategyParameter parameter = to_parameter(trial.point);
+        Simulator simulator(data, strategyType, parameter.scale);
+        simulator.budget = trial.budget;
+        simulator.apply(parameter);
+        trial.result = simulator.get_performance();
+        trial.result.parameter = trial.point.empty() ? 0 : trial.point[0];
+        trial.score = objective(trial.result);
+        if (!std::isfinite(trial.score)) trial.score = std::numeric_limits<double>::lowest();
+
+        ++finishedTrials;
+        std::lock_guard<std::mutex> lock(mtx);
+        finished.push_back(trial);
+    }
+
+    static void sort_by_score(vector<SweepTrial>& trials) {
+        std::stable_sort(trials.begin(), trials.end(),
+                         [](const SweepTrial& l, const SweepTrial& r) { return l.score > r.score; });
+    }
+};
+
+#endif
@@ -2,19 +2,22 @@
 #define MIDAS_PARAMETER_TRAINER_H
 
 #include <vector>
+#include "ParameterSweep.h"
 #include "TrainCommon.h"
 #include "strategy/StrategyBase.h"
 #include "utils/log/Log.h"
-#include "Simulator.h"
-
 
+/**
+ * one dimension grid sweep over singleInt or singleDouble, trials run in parallel on thread pool
+ */
 class ParameterTrainer {
 public:
     int singleIntStart, singleIntEnd, singleIntStep;
     double singleDoubleStart, singleDoubleEnd, singleDoubleStep;
     TrainType trainType;
     vector<BacktestResult> results;
-    std::unique_ptr<Simulator> simulator;
+    std::shared_ptr<CtpData> data;
+    StrategyType strategyType{StrategyType::TBiMaStrategy};
 
 public:
     ParameterTrainer(int start, int end, int step) {
@@ -31,33 +34,32 @@ public:
         trainType = TrainType::SingleDouble;
     }
 
-    void process() {
-        StrategyParameter parameter;
-        if(trainType == TrainType::SingleInt){
-            for (int i = singleIntStart; i <= singleIntEnd; i += singleIntStep) {
-                parameter.singleInt = i;
-                process(parameter, i);
-            }
-        } else if(trainType == TrainType::SingleDouble){
-            for (double i = singleDoubleStart; i <= singleDoubleEnd; i += singleDoubleStep) {
-                parameter.singleDouble = i;
-                process(parameter, i);
-            }
+    void process(midas::ThreadPool& pool) {
+        ParameterDimension dimension;
+        if (trainType == TrainType::SingleInt) {
+            dimension = ParameterDimension{"singleInt", static_cast<double>(singleIntStart),
+                                           static_cast<double>(singleIntEnd), static_cast<double>(singleIntStep)};
+        } else {
+            dimension = ParameterDimension{"singleDouble", singleDoubleStart, singleDoubleEnd, singleDoubleStep};
         }
-    }
 
-    void process(const StrategyParameter& parameter, double param) {
-        MIDAS_LOG_INFO("start training with parameter " << param);
-        simulator->apply(parameter);
-        BacktestResult result = simulator->get_performance();
-        result.parameter = param;
-        results.push_back(result);
-    }
+        MIDAS_LOG_INFO("start training " << dimension.name << " from " << dimension.start << " to " << dimension.end);
+        ParameterSweep sweep(strategyType, SweepType::Grid, {dimension});
+        vector<SweepTrial> trials = sweep.run(data, pool);
+        std::sort(trials.begin(), trials.end(),
+                  [](const SweepTrial& l, const SweepTrial& r) { return l.point[0] < r.point[0]; });
 
-    void init_simulator(std::shared_ptr<CtpData> data, const string& strategyName){
-        simulator = make_unique<Simulator>(data);
+        results.clear();
+        for (auto& trial : trials) {
+            results.push_back(trial.result);
+        }
     }
 
+    void init_simulator(std::shared_ptr<CtpData> data_, const string& strategyName) {
+        data = data_;
+        StrategyType type = string2strategy(strategyName);
+        if (type != StrategyType::TUnknown) strategyType = type;
+    }
 };
 
 #endif
@@ -1,26 +1,102 @@
 #ifndef MIDAS_SIMULATOR_H
 #define MIDAS_SIMULATOR_H
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <map>
 #include "TrainCommon.h"
 #include "model/CtpData.h"
 #include "model/CtpOrder.h"
+#include "strategy/StrategyFactory.h"
+#include "utils/math/DescriptiveStatistics.h"
 
+/**
+ * event driven backtest kernel, per instrument cursors are merged by time through a binary min heap
+ * all cursors sharing the earliest timestamp are popped as one batch, so each step costs O(batch * log instruments)
+ * instead of a full rescan of instruments
+ * former rescan also swept instruments later than the earliest one into a round, so a round could mix times
+ * a round now only holds bins of one time, equal times keep instrument order, results differ from the rescan
+ * whenever instruments have different bar times
+ * each instrument follows signal of its closed bin at open of current bin, one unit long or short
+ * returns are marked at bin open, averaged over instruments and summed per day to score the run
+ */
 class Simulator {
+private:
+    struct Cursor {
+        int64_t key;  // cob * 1000000 + hhmmss, cheap inline compare
+        int end;      // exclusive bin index under budget
+        StrategyBase* strategy;
+        std::shared_ptr<CtpInstrument> instrument;
+        int position{0};  // 1 long, -1 short, 0 flat
+        double markPrice{0};
+    };
+
 public:
     std::shared_ptr<CtpData> data;
+    PositionManager ownPositionManager;
     PositionManager& positionManager;
     std::vector<CtpOrder> orders;
     BacktestResult result;
-    std::vector<std::shared_ptr<CtpInstrument>> currentRound;
+    /**
+     * fraction of historic bins to simulate, successive halving runs cheap trials with small budget
+     */
+    double budget{1.0};
+    std::vector<std::unique_ptr<StrategyBase>> ownStrategies;
+    std::map<std::string, StrategyBase*> strategies;
+    std::vector<std::pair<std::shared_ptr<CtpInstrument>, StrategyBase*>> currentRound;
+
+private:
+    std::vector<Cursor> cursors;
+    std::vector<int> heap;          // cursor index ordered by key then index, ties keep instrument order
+    std::vector<int> currentBatch;  // cursor index of currentRound
+    midas::DescriptiveStatistics dailyReturns;
+    int currentCob{0};
+    double dayReturn{0};
+    bool isDayHeld{false};
 
 public:
-    Simulator(std::shared_ptr<CtpData> data_) : data(data_), positionManager(data_->positionManager) {}
+    /**
+     * simulate with strategies attached to instruments and shared position manager of data
+     */
+    Simulator(std::shared_ptr<CtpData> data_) : data(data_), positionManager(data_->positionManager) {
+        for (auto& item : data->instruments) {
+            if (item.second->strategy) strategies.insert({item.first, item.second->strategy.get()});
+        }
+    }
 
-    void apply(const StrategyParameter& parameter) {}
+    /**
+     * isolated simulation, strategies and position book are owned by this simulator
+     * candles of data are only read, so many simulators can run on same data concurrently
+     */
+    Simulator(std::shared_ptr<CtpData> data_, StrategyType type, CandleScale scale)
+        : data(data_), positionManager(ownPositionManager) {
+        for (auto& item : data->instruments) {
+            CtpInstrument& instrument = *item.second;
+            if (instrument.isMasterContract) {
+                ownStrategies.push_back(StrategyFactory::create_strategy(instrument.get_candle_reference(scale), type));
+                strategies.insert({item.first, ownStrategies.back().get()});
+            }
+        }
+    }
+
+    Simulator(const Simulator&) = delete;
+    Simulator& operator=(const Simulator&) = delete;
+
+    void apply(const StrategyParameter& parameter) {
+        for (auto& item : strategies) {
+            item.second->apply_parameter(parameter);
+        }
+    }
 
     BacktestResult get_performance() {
         init();
+        auto start = std::chrono::steady_clock::now();
         simulate();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        result.elapsedSeconds = elapsed.count();
+        result.eventsPerSecond = result.elapsedSeconds > 0 ? result.events / result.elapsedSeconds : 0;
         return result;
     }
 
@@ -31,7 +107,7 @@ private:
                 /**
                  * calculate market value, open new position, close old position
                  */
-                positionManager.mark2market(data->instruments);
+                positionManager.mark2market(data->instruments, strategies);
                 handle_existing_position();
                 handle_new_position();
 
@@ -40,57 +116,155 @@ private:
                 break;
             }
         }
+        close_day();
+        summarize();
     }
 
-    void handle_existing_position() {}
+    /**
+     * mark held positions of batch to open of current bin
+     */
+    void handle_existing_position() {
+        for (int index : currentBatch) {
+            Cursor& cursor = cursors[index];
+            const StrategyBase& strategy = *cursor.strategy;
+            roll_day(strategy.current_time().cob);
+            if (cursor.position == 0) continue;
+            double price = strategy.current_candle().open;
+            if (cursor.markPrice > 0) {
+                dayReturn += cursor.position * (price - cursor.markPrice) / cursor.markPrice / cursors.size();
+            }
+            cursor.markPrice = price;
+            isDayHeld = true;
+        }
+    }
 
-    void handle_new_position() {}
+    /**
+     * follow signal of closed bin, enter at open of current bin
+     */
+    void handle_new_position() {
+        for (int index : currentBatch) {
+            Cursor& cursor = cursors[index];
+            const StrategyBase& strategy = *cursor.strategy;
+            if (strategy.itr == 0 || strategy.itr > static_cast<int>(strategy.signals.size())) continue;
+            double signal = strategy.signals[strategy.itr - 1];
+            int target = signal > 0.5 ? 1 : (signal < -0.5 ? -1 : cursor.position);
+            if (target == cursor.position) continue;
+            cursor.position = target;
+            cursor.markPrice = strategy.current_candle().open;
+            ++result.cnt;
+        }
+    }
+
+    void roll_day(int cob) {
+        if (cob == currentCob) return;
+        close_day();
+        currentCob = cob;
+    }
+
+    void close_day() {
+        if (currentCob != 0) {
+            dailyReturns.add_value(dayReturn);
+            if (isDayHeld) result.holdingDays += 1;
+        }
+        dayReturn = 0;
+        isDayHeld = false;
+    }
+
+    /**
+     * sharpe is annualized with 252 days, kelly fraction is mean over variance of daily return
+     */
+    void summarize() {
+        result.dayPerformance = dailyReturns.get_mean();
+        result.stdDev = dailyReturns.get_standard_deviation();
+        if (result.stdDev > 0) {
+            result.sharpeRatio = result.dayPerformance / result.stdDev * std::sqrt(252.0);
+            result.kellyFraction = result.dayPerformance / (result.stdDev * result.stdDev);
+            result.kellyAnnualizedPerformance = 252 * result.kellyFraction * result.dayPerformance / 2;
+        }
+    }
+
+    int budget_end(const StrategyBase& strategy) const {
+        int count = strategy.candles.historicDataCount;
+        if (budget >= 1.0) return count;
+        return std::min(count, static_cast<int>(count * budget));
+    }
+
+    static int64_t time_key(const StrategyBase& strategy) {
+        const midas::Timestamp& now = strategy.current_time();
+        return static_cast<int64_t>(now.cob) * 1000000 + now.time;
+    }
+
+    bool is_later(int left, int right) const {
+        const Cursor& l = cursors[left];
+        const Cursor& r = cursors[right];
+        return l.key > r.key || (l.key == r.key && left > right);
+    }
+
+    void push_cursor(int index) {
+        Cursor& cursor = cursors[index];
+        if (cursor.strategy->itr >= cursor.end) return;
+        cursor.key = time_key(*cursor.strategy);
+        heap.push_back(index);
+        std::push_heap(heap.begin(), heap.end(), [this](int l, int r) { return is_later(l, r); });
+    }
+
+    int pop_cursor() {
+        std::pop_heap(heap.begin(), heap.end(), [this](int l, int r) { return is_later(l, r); });
+        int index = heap.back();
+        heap.pop_back();
+        return index;
+    }
 
     /**
-     * find available instruments with earliest time, calculate signal
+     * pop every cursor with earliest time, calculate signal
      * @return true means some instrument can simulate this time
      *         false means all instruments finish its simulation
      */
     bool get_available_instrument() {
         currentRound.clear();
-        Timestamp currentEarliest;
-        for (auto& item : data->instruments) {
-            CtpInstrument& instrument = *item.second;
-            if (instrument.strategy->is_valid_time()) {
-                const midas::Timestamp& now = instrument.strategy->current_time();
-                if (currentRound.empty()) {
-                    currentEarliest = now;
-                    currentRound.push_back(item.second);
-                } else if (now < currentEarliest) {
-                    currentEarliest = now;
-                    currentRound.clear();
-                    currentRound.push_back(item.second);
-                } else {
-                    currentRound.push_back(item.second);
-                }
-            }
-        }
+        currentBatch.clear();
+        if (heap.empty()) return false;
 
-        if (currentRound.empty()) return false;
+        int64_t earliest = cursors[heap.front()].key;
+        while (!heap.empty() && cursors[heap.front()].key == earliest) {
+            int index = pop_cursor();
+            currentBatch.push_back(index);
+            currentRound.push_back(std::make_pair(cursors[index].instrument, cursors[index].strategy));
+        }
 
-        for (auto& pInstrument : currentRound) {
-            pInstrument->strategy->calculate_previous_candle();
+        for (auto& entry : currentRound) {
+            entry.second->calculate_previous_candle();
         }
+        result.events += currentRound.size();
+        ++result.steps;
         return true;
     }
 
     void advance_timestamp() {
-        for (auto& pInstrument : currentRound) {
-            ++pInstrument->strategy->itr;
+        for (int index : currentBatch) {
+            ++cursors[index].strategy->itr;
+            push_cursor(index);
         }
     }
 
     void init() {
         memset(&result, 0, sizeof(BacktestResult));
         orders.clear();
-        for (auto& item : data->instruments) {
-            item.second->strategy->init();
+        cursors.clear();
+        heap.clear();
+        dailyReturns.clear();
+        currentCob = 0;
+        dayReturn = 0;
+        isDayHeld = false;
+        for (auto& item : strategies) {
+            item.second->itr = 0;
+            item.second->init();
+            auto it = data->instruments.find(item.first);
+            if (it == data->instruments.end()) continue;
+            cursors.push_back(Cursor{0, budget_end(*item.second), item.second, it->second, 0, 0});
         }
+        heap.reserve(cursors.size());
+        for (size_t i = 0; i < cursors.size(); ++i) push_cursor(static_cast<int>(i));
         positionManager.init4simulation();
     }
 };
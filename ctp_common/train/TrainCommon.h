@@ -11,6 +11,11 @@ public:
     long cnt;
     double parameter, dayPerformance, kellyAnnualizedPerformance, stdDev, kellyFraction;
     double sharpeRatio, holdingDays;
+    /**
+     * kernel throughput, events are candles consumed, steps are distinct timestamps merged
+     */
+    long events, steps;
+    double elapsedSeconds, eventsPerSecond;
 };
 
 #endif
@@ -0,0 +1,113 @@
+#include <net/shm/MpscRingQueue.h>
+#include <net/shm/MwsrQueue.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace midas;
+
+/**
+ * compare linked MwsrQueue against slot array MpscRingQueue
+ * usage: MpscRingQueueBench [writers] [messages per writer] [ring capacity]
+ */
+namespace {
+
+struct MyType {
+    uint64_t x = 0;
+    double y = 0.0;
+};
+
+uint64_t writers = 4;
+uint64_t messages = 1000000;
+uint64_t capacity = 1 << 16;
+
+template <typename F, typename R>
+double run(F write, R read) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (uint64_t i = 0; i < writers; i++) threads.emplace_back(write, i);
+    uint64_t checksum = read();
+    for (auto& t : threads) t.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    uint64_t expected = writers * (messages * (messages - 1) / 2);
+    if (checksum != expected) fprintf(stderr, "checksum mismatch %lu != %lu\n", checksum, expected);
+    return elapsed.count();
+}
+
+void report(const char* name, double seconds) {
+    uint64_t total = writers * messages;
+    printf("%-16s %10.3f ms %12.0f msg/s %8.1f ns/msg\n", name, seconds * 1e3, total / seconds, seconds * 1e9 / total);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc > 1) writers = strtoull(argv[1], nullptr, 10);
+    if (argc > 2) messages = strtoull(argv[2], nullptr, 10);
+    if (argc > 3) capacity = strtoull(argv[3], nullptr, 10);
+    printf("writers %lu, messages per writer %lu, ring capacity %lu\n", writers, messages, capacity);
+
+    {
+        MwsrQueue<MyType> q;
+        double seconds = run(
+            [&q](uint64_t) {
+                for (uint64_t i = 0; i < messages; i++) q.put(MyType{i, static_cast<double>(i)});
+            },
+            [&q]() {
+                uint64_t cnt = 0, sum = 0;
+                MyType t;
+                while (cnt < writers * messages) {
+                    if (q.get(t)) {
+                        sum += t.x;
+                        cnt++;
+                    }
+                }
+                return sum;
+            });
+        report("MwsrQueue", seconds);
+    }
+
+    {
+        MpscRingQueue<MyType> q(capacity);
+        double seconds = run(
+            [&q](uint64_t) {
+                for (uint64_t i = 0; i < messages; i++) q.put(MyType{i, static_cast<double>(i)});
+            },
+            [&q]() {
+                uint64_t cnt = 0, sum = 0;
+                MyType t;
+                while (cnt < writers * messages) {
+                    if (q.get(t)) {
+                        sum += t.x;
+                        cnt++;
+                    }
+                }
+                return sum;
+            });
+        report("MpscRing get", seconds);
+    }
+
+    {
+        MpscRingQueue<MyType> q(capacity);
+        double seconds = run(
+            [&q](uint64_t) {
+                for (uint64_t i = 0; i < messages; i++) q.put(MyType{i, static_cast<double>(i)});
+            },
+            [&q]() {
+                uint64_t cnt = 0, sum = 0;
+                while (cnt < writers * messages) {
+                    cnt += q.drain([&sum](MyType& t) { sum += t.x; }, 256);
+                }
+                return sum;
+            });
+        report("MpscRing drain", seconds);
+    }
+
+    return 0;
+}
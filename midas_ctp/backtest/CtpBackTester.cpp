@@ -9,7 +9,10 @@ CtpBackTester::CtpBackTester(int argc, char** argv) : MidasProcessBase(argc, arg
     init_admin();
 }
 
-CtpBackTester::~CtpBackTester() {}
+CtpBackTester::~CtpBackTester() {
+    if (sweep) sweep->stop();
+    if (sweepThread.joinable()) sweepThread.join();
+}
 
 void CtpBackTester::app_start() {
     if (!configure()) {
@@ -29,15 +32,18 @@ void CtpBackTester::app_start() {
 
 void CtpBackTester::load_test_data(const string& dataPath) {
     DataLoader dataLoader;
+    dataLoader.storeDirectory = candleStoreDirectory;
     dataLoader.load(dataPath);
 
-    for (auto& item : dataLoader.instrument2candle) {
+    for (auto& item : dataLoader.instrument2columns) {
         const TradeSessions& pts = data->tradeStatusManager.get_session(item.first);
         std::shared_ptr<CtpInstrument> instrument = make_shared<CtpInstrument>(item.first, pts);
-        instrument->load_historic_candle(item.second, CandleScale::Minute1);
+        vector<CandleData> candles = item.second.to_candles();
+        instrument->load_historic_candle(candles, CandleScale::Minute1);
         set_master_contract(*instrument);
         data->instruments.insert({item.first, instrument});
     }
+    data->build_instrument_index();
 
     auto loadedProducts = dataLoader.load_products(productCfgFile);
     data->products.swap(loadedProducts);
@@ -46,7 +52,21 @@ void CtpBackTester::load_test_data(const string& dataPath) {
 BacktestResult CtpBackTester::calculate(StrategyType type) {
     StrategyFactory::set_strategy(data->instruments, type);
     std::unique_ptr<Simulator> simulator = make_unique<Simulator>(data);
-    return simulator->get_performance();
+    BacktestResult result = simulator->get_performance();
+    MIDAS_LOG_INFO("backtest " << data->instruments.size() << " instruments, " << result.events << " events in "
+                               << result.steps << " steps, " << result.elapsedSeconds << "s, "
+                               << result.eventsPerSecond << " events/sec, "
+                               << (result.events > 0 ? 1e9 * result.elapsedSeconds / result.events : 0)
+                               << " ns/event");
+    return result;
+}
+
+midas::ThreadPool& CtpBackTester::get_sweep_pool() {
+    if (!sweepPool) {
+        int n = sweepThreads > 0 ? sweepThreads : static_cast<int>(std::thread::hardware_concurrency());
+        sweepPool = make_unique<midas::ThreadPool>(std::max(n, 1));
+    }
+    return *sweepPool;
 }
 
 void CtpBackTester::fake_instrument_info_from_product() {
@@ -2,11 +2,13 @@
 #define MIDAS_CTP_BACK_TESTER_H
 
 #include <memory>
+#include <thread>
 #include "model/CtpData.h"
 #include "net/channel/Channel.h"
 #include "net/tcp/TcpReceiver.h"
 #include "process/MidasProcessBase.h"
 #include "strategy/StrategyFactory.h"
+#include "train/ParameterSweep.h"
 #include "train/Simulator.h"
 
 using namespace std;
@@ -17,9 +19,14 @@ public:
     string dataDirectory;
     string productCfgFile;
     string resultDirectory{"/tmp"};
+    string candleStoreDirectory;  // empty means data files are parsed on every start
     CandleScale candleScale{CandleScale::Minute1};
+    int sweepThreads{0};  // 0 means one per core
 
     std::shared_ptr<CtpData> data;
+    std::unique_ptr<midas::ThreadPool> sweepPool;
+    std::shared_ptr<ParameterSweep> sweep;
+    std::thread sweepThread;
 
 public:
     CtpBackTester() = delete;
@@ -42,6 +49,8 @@ private:
 
     BacktestResult calculate(StrategyType type);
 
+    midas::ThreadPool& get_sweep_pool();
+
 private:
     // admin section
     string admin_meters(const string& cmd, const TAdminCallbackArgs& args) const;
@@ -49,6 +58,7 @@ private:
     string admin_csv_dump(const string& cmd, const TAdminCallbackArgs& args);
     string admin_train(const string& cmd, const TAdminCallbackArgs& args);
     string admin_calculate(const string& cmd, const TAdminCallbackArgs& args);
+    string admin_sweep(const string& cmd, const TAdminCallbackArgs& args);
 };
 
 #endif
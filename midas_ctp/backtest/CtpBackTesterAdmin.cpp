@@ -14,6 +14,10 @@ void CtpBackTester::init_admin() {
                                       "train strategy (1 10 1 | 0.8 1.2 0.1)", "train strategy");
     admin_handler().register_callback("calculate", boost::bind(&CtpBackTester::admin_calculate, this, _1, _2),
                                       "calculate strategy", "calculate strategy");
+    admin_handler().register_callback(
+        "sweep", boost::bind(&CtpBackTester::admin_sweep, this, _1, _2),
+        "sweep (grid|random|halving) strategy name:start:end:step ... | sweep status [top] | sweep stop",
+        "search strategy parameter space in background");
 }
 
 string CtpBackTester::admin_csv_dump(const string& cmd, const TAdminCallbackArgs& args) {
@@ -95,7 +99,15 @@ string CtpBackTester::admin_train(const string& cmd, const TAdminCallbackArgs& a
         }
 
         trainer->init_simulator(data, strategyName);
-        trainer->process();
+        trainer->process(get_sweep_pool());
+
+        ostringstream oss;
+        oss << "parameter,sharpe,dayPerformance,stdDev\n";
+        for (const auto& result : trainer->results) {
+            oss << result.parameter << ',' << result.sharpeRatio << ',' << result.dayPerformance << ','
+                << result.stdDev << '\n';
+        }
+        return oss.str();
     }
     return "invalid parameter!";
 }
@@ -103,7 +115,57 @@ string CtpBackTester::admin_train(const string& cmd, const TAdminCallbackArgs& a
 string CtpBackTester::admin_calculate(const string& cmd, const TAdminCallbackArgs& args) {
     if (args.size() == 1) {
         string strategyName = args[0];
-        calculate(string2strategy(strategyName));
+        BacktestResult result = calculate(string2strategy(strategyName));
+        ostringstream oss;
+        oss << "sharpe " << result.sharpeRatio << " dayPerformance " << result.dayPerformance << '\n'
+            << "events " << result.events << " steps " << result.steps << " elapsed " << result.elapsedSeconds
+            << "s events/sec " << result.eventsPerSecond << '\n';
+        return oss.str();
     }
     return "invalid parameter!";
 }
+
+/**
+ * sweep grid TBiMaStrategy slowPeriod:20:120:10 fastPeriod:5:30:5
+ * sweep status 20
+ * sweep stop
+ */
+string CtpBackTester::admin_sweep(const string& cmd, const TAdminCallbackArgs& args) {
+    if (args.empty()) return "invalid parameter!";
+
+    if (args[0] == "status") {
+        if (!sweep) return "no sweep started";
+        size_t top = args.size() > 1 ? static_cast<size_t>(std::atoi(args[1].c_str())) : 10;
+        return sweep->report(top);
+    } else if (args[0] == "stop") {
+        if (!sweep) return "no sweep started";
+        sweep->stop();
+        return "sweep stopping";
+    }
+
+    if (sweep && sweep->isRunning) return "sweep already running, stop it first";
+    if (args.size() < 3) return "invalid parameter!";
+
+    SweepType sweepType = string2sweep(args[0]);
+    StrategyType strategyType = string2strategy(args[1]);
+    if (sweepType == SweepType::Unknown) return "unknown sweep type " + args[0];
+    if (strategyType == StrategyType::TUnknown) return "unknown strategy " + args[1];
+
+    vector<ParameterDimension> dimensions;
+    for (size_t i = 2; i < args.size(); ++i) {
+        ParameterDimension dimension;
+        if (!ParameterDimension::parse(args[i], dimension)) return "invalid dimension " + args[i];
+        dimensions.push_back(dimension);
+    }
+
+    if (sweepThread.joinable()) sweepThread.join();
+    sweep = make_shared<ParameterSweep>(strategyType, sweepType, dimensions);
+    midas::ThreadPool& pool = get_sweep_pool();
+    std::shared_ptr<ParameterSweep> current = sweep;
+    sweepThread = std::thread([this, current, &pool] {
+        ThreadPlacement::instance().place("sweep", "sweep");
+        current->run(data, pool);
+        MIDAS_LOG_INFO("sweep finished\n" << current->report());
+    });
+    return "sweep started on " + std::to_string(pool.size()) + " threads, check with sweep status";
+}
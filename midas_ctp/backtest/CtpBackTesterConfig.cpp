@@ -29,6 +29,8 @@ bool CtpBackTester::configure() {
     dataDirectory = get_cfg_value<string>(root, "dataDirectory", "");
     productCfgFile = get_cfg_value<string>(root, "productCfgPath", "");
     candleScale = CandleScale(get_cfg_value<int>(root, "candleScale", 1));
+    sweepThreads = Config::instance().get<int>("backtest.sweepThreads", 0);
+    candleStoreDirectory = Config::instance().get<string>("backtest.candleStoreDirectory", "");
 
     if (dataDirectory.empty()) {
         MIDAS_LOG_WARNING("data path not provided.");
@@ -55,6 +57,7 @@ bool CtpBackTester::configure() {
 
     MIDAS_LOG_INFO("using config" << '\n'
                                   << "dataDirectory: " << dataDirectory << '\n'
-                                  << "candleScale: " << candleScale << '\n');
+                                  << "candleScale: " << candleScale << '\n'
+                                  << "candleStoreDirectory: " << candleStoreDirectory << '\n');
     return true;
 }
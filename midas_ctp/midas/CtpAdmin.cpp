@@ -1,6 +1,7 @@
 #include <utils/FileUtils.h>
 #include "CtpProcess.h"
 #include "helper/CtpVisualHelper.h"
+#include "model/CtpLatency.h"
 #include "utils/CollectionUtils.h"
 
 void CtpProcess::init_admin() {
@@ -24,6 +25,9 @@ void CtpProcess::init_admin() {
                                       "flush log to disk");
     admin_handler().register_callback("save2db", boost::bind(&CtpProcess::admin_save2db, this, _1, _2),
                                       "save2db (instrument|candle)", "save data into mysql");
+    admin_handler().register_callback("latency", boost::bind(&CtpProcess::admin_latency, this, _1, _2),
+                                      "latency [reset|on|off]",
+                                      "per stage tick latency in ns, reset starts a new interval");
 }
 
 string CtpProcess::admin_request(const string& cmd, const TAdminCallbackArgs& args) {
@@ -157,6 +161,26 @@ string CtpProcess::admin_meters(const string& cmd, const TAdminCallbackArgs& arg
         << ntime2string(data->tradeLogInTime) << setw(24) << ntime2string(data->tradeLogOutTime) << "\n";
     if (disruptorPtr) disruptorPtr->stats(oss);
     if (consumerPtr) consumerPtr->stats(oss);
+    if (mdSpi && mdSpi->bus) mdSpi->bus->stats(oss);
+    if (mdSpi) oss << "md unknown instrument = " << mdSpi->ingest->unknownInstrumentCount << '\n';
+    return oss.str();
+}
+
+string CtpProcess::admin_latency(const string& cmd, const TAdminCallbackArgs& args) {
+    CtpLatency& latency = CtpLatency::instance();
+    string param = args.empty() ? "" : args[0];
+    if (param == "on") {
+        latency.isEnabled = true;
+        return "latency recording on";
+    } else if (param == "off") {
+        latency.isEnabled = false;
+        return "latency recording off";
+    } else if (!param.empty() && param != "reset") {
+        return "unrecognized parameter for latency";
+    }
+
+    ostringstream oss;
+    latency.report(oss, param == "reset");
     return oss.str();
 }
 
@@ -171,10 +195,16 @@ string CtpProcess::admin_save2db(const string& cmd, const TAdminCallbackArgs& ar
     if (args.empty())
         oss << "missing parameter: save2db (instrument|candle)";
     else if (args[0] == "instrument") {
-        std::thread([this] { save_instruments(); }).detach();
+        std::thread([this] {
+            ThreadPlacement::instance().place("save_instrument", "save2db");
+            save_instruments();
+        }).detach();
         oss << "save instrument job submitted\n";
     } else if (args[0] == "candle") {
-        std::thread([this] { save_candles(); }).detach();
+        std::thread([this] {
+            ThreadPlacement::instance().place("save_candle", "save2db");
+            save_candles();
+        }).detach();
         oss << "save candle job submitted\n";
     } else {
         oss << "unrecognized parameter for save2db\n";
@@ -35,6 +35,7 @@ bool CtpProcess::configure() {
     data->dataDirectory = get_cfg_value<string>(root, "dataDirectory");
     data->tradeFlowPath = data->dataDirectory + "/tradeFlowPath/";
     data->marketFlowPath = data->dataDirectory + "/marketFlowPath/";
+    data->candleStoreDirectory = Config::instance().get<string>(root + ".candleStoreDirectory", "");
     string tradingHourCfgPath = get_cfg_value<string>(root, "tradingHourCfgPath");
 
     if (!check_file_exists(tradingHourCfgPath.c_str())) {
@@ -87,6 +88,7 @@ bool CtpProcess::configure() {
                                   << "brokerId: " << data->brokerId << '\n'
                                   << "investorId: " << data->investorId << '\n'
                                   << "tradeFront: " << data->tradeFront << '\n'
-                                  << "marketFront: " << data->marketFront << '\n');
+                                  << "marketFront: " << data->marketFront << '\n'
+                                  << "candleStoreDirectory: " << data->candleStoreDirectory << '\n');
     return true;
 }
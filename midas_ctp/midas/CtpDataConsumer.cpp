@@ -1,26 +1,44 @@
 #include "CtpDataConsumer.h"
-#include "helper/CtpVisualHelper.h"
+#include "model/CtpLatency.h"
 
 CtpDataConsumer::CtpDataConsumer(std::shared_ptr<CtpData> data) : data(data) {
     logRawData = Config::instance().get<bool>("ctp.logRawData", false);
     if (logRawData) {
-        manager = make_shared<JournalManager>(data->dataDirectory + "/raw_msg_log", true);
+        bool isZip = Config::instance().get<bool>("ctp.rawMsgLog.compress", true);
+        uint64_t segmentRecords = Config::instance().get<uint64_t>("ctp.rawMsgLog.segmentRecords", 1 << 20);
+        manager = make_shared<BinaryJournalManager<CThostFtdcDepthMarketDataField>>(
+            data->dataDirectory + "/raw_msg_log", isZip, segmentRecords);
     }
 }
 
-void CtpDataConsumer::data_callback1(MktDataPayload& payload) {
-    ++receivedMsgCount;
-    data->update(payload);
+void CtpDataConsumer::data_callback1(MktDataPayload& payload) { update(payload); }
 
-    if (logRawData) {
-        ostringstream oss;
-        oss << payload << '\n';
-        manager->record(oss.str());
+void CtpDataConsumer::update(MktDataPayload& payload) {
+    ++receivedMsgCount;
+    CtpLatency& latency = CtpLatency::instance();
+    bool isTimed = latency.isEnabled.load(std::memory_order_relaxed);
+    uint64_t start = 0;
+    if (isTimed) {
+        start = ntime();
+        if (start > payload.get_rcvt()) latency.record(LatencyDequeue, start - payload.get_rcvt());
     }
+
+    data->update(payload, ingest ? ingest->depth(payload.get_sequence_value()) : nullptr);
+    if (isTimed) latency.record(LatencyUpdate, ntime() - start);
+}
+
+void CtpDataConsumer::journal(MktDataPayload& payload) {
+    if (!logRawData || !ingest || ingest->raws.empty()) return;
+    CtpLatency& latency = CtpLatency::instance();
+    bool isTimed = latency.isEnabled.load(std::memory_order_relaxed);
+    uint64_t start = isTimed ? ntime() : 0;
+    manager->record(ingest->raw(payload.get_sequence_value()), payload.get_rcvt(), payload.get_id());
+    if (isTimed) latency.record(LatencyJournal, ntime() - start);
 }
 
 void CtpDataConsumer::stats(ostream& os) {
     os << "CtpDataConsumer stats:" << '\n' << "msgs recv        = " << receivedMsgCount << '\n';
+    if (logRawData) manager->stats(os);
 }
 
 void CtpDataConsumer::flush() {
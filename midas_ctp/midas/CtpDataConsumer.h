@@ -2,8 +2,9 @@
 #define MIDAS_CTP_DATA_CONSUMER_H
 
 #include <ctp/ThostFtdcUserApiStruct.h>
-#include <io/JournalManager.h>
+#include <io/BinaryJournalManager.h>
 #include "model/CtpData.h"
+#include "model/CtpTickIngest.h"
 
 class CtpDataConsumer {
 public:
@@ -15,13 +16,28 @@ public:
 
     std::shared_ptr<CtpData> data;
 
-    std::shared_ptr<JournalManager> manager;
+    std::shared_ptr<BinaryJournalManager<CThostFtdcDepthMarketDataField>> manager;
+
+    /**
+     * depth and raw field of each entry ride along in side rings of ingest, as payload only carries compact tick
+     */
+    std::shared_ptr<CtpTickIngest> ingest;
 
 public:
     CtpDataConsumer(std::shared_ptr<CtpData> data);
 
     void data_callback1(MktDataPayload& payload);
 
+    /**
+     * market state update and strategy, run as its own disruptor consumer
+     */
+    void update(MktDataPayload& payload);
+
+    /**
+     * raw message journaling, run as consumer parallel to update so io stays off strategy path
+     */
+    void journal(MktDataPayload& payload);
+
     void stats(ostream& os);
 
     void flush();
@@ -1,4 +1,6 @@
 #include "CtpProcess.h"
+#include "helper/CandleStore.h"
+#include "model/CtpLatency.h"
 
 CtpProcess::CtpProcess(int argc, char** argv) : MidasProcessBase(argc, argv) {
     data = make_shared<CtpData>();
@@ -21,6 +23,8 @@ CtpProcess::~CtpProcess() {
 }
 
 void CtpProcess::trade_thread() {
+    // threads created by ctp api inherit placement of this thread
+    ThreadPlacement::instance().place("ctp_trade", "trade");
     MIDAS_LOG_INFO("start trade data thread " << data->tradeFlowPath);
     traderApi = CThostFtdcTraderApi::CreateFtdcTraderApi(data->tradeFlowPath.c_str());
     manager->register_trader_api(traderApi);
@@ -34,6 +38,7 @@ void CtpProcess::trade_thread() {
 }
 
 void CtpProcess::market_thread() {
+    ThreadPlacement::instance().place("ctp_market", "market");
     MIDAS_LOG_INFO("start market data thread " << data->marketFlowPath);
     mdApi = CThostFtdcMdApi::CreateFtdcMdApi(data->marketFlowPath.c_str());
     manager->register_md_api(mdApi);
@@ -43,6 +48,20 @@ void CtpProcess::market_thread() {
     mdApi->Join();
 }
 
+void CtpProcess::session_thread() {
+    ThreadPlacement::instance().place("ctp_session", "session");
+    const int interval = Config::instance().get<int>("ctp.mktdata_disruptor.adaptive.session_check_s", 30);
+    std::unique_lock<std::mutex> lk(sessionMutex);
+    while (isSessionWatching) {
+        time_t now = time(nullptr);
+        struct tm local;
+        localtime_r(&now, &local);
+        AdaptiveWaitStrategy::set_session_open(
+            data->tradeStatusManager.is_trading_hour(local.tm_hour * 60 + local.tm_min));
+        sessionCv.wait_for(lk, std::chrono::seconds(interval), [this] { return !isSessionWatching; });
+    }
+}
+
 void CtpProcess::app_start() {
     if (!configure()) {
         MIDAS_LOG_ERROR("failed to configure");
@@ -50,13 +69,33 @@ void CtpProcess::app_start() {
         throw MidasException();
     }
 
+    CtpLatency::instance().isEnabled = Config::instance().get<bool>("ctp.latency.enable", false);
     mdSpi = make_shared<CtpMdSpi>(manager, data);
+    if (Config::instance().get<bool>("ctp.mdBus.enable", false)) {
+        string busName = Config::instance().get<string>("ctp.mdBus.name", "/midas_md");
+        uint32_t ringSize = Config::instance().get<uint32_t>("ctp.mdBus.ringSize", 1 << 16);
+        uint32_t slotCount = Config::instance().get<uint32_t>("ctp.mdBus.slotCount", 4096);
+        mdSpi->bus = make_shared<MarketDataBusWriter<CThostFtdcDepthMarketDataField>>(busName, ringSize, slotCount);
+        MIDAS_LOG_INFO("publish market data to shared memory " << busName << " ring " << ringSize << " slots "
+                                                               << slotCount);
+    }
 
     std::vector<CtpMdSpi::SharedPtr> producerStore;
     producerStore.push_back(mdSpi);
     consumerPtr = std::make_shared<DataConsumer>(data);
-    disruptorPtr = boost::make_shared<TMktDataDisruptor>("mktdata_disruptor", "ctp.mktdata_disruptor", producerStore,
-                                                         boost::ref(*consumerPtr));
+    disruptorPtr = boost::make_shared<TMktDataDisruptor>("mktdata_disruptor", "ctp.mktdata_disruptor", producerStore);
+    DataConsumer* consumer = consumerPtr.get();
+    mdSpi->ingest->attach(disruptorPtr->ring_size(), consumer->logRawData);
+    consumer->ingest = mdSpi->ingest;
+    disruptorPtr->add_consumer("update", [consumer](MktDataPayload& payload) { consumer->update(payload); });
+    if (consumer->logRawData) {
+        disruptorPtr->add_consumer("journal", [consumer](MktDataPayload& payload) { consumer->journal(payload); });
+    }
+    disruptorPtr->start();
+    if (disruptorPtr->wait_strategy() == TMktDataDisruptor::AdaptiveTag) {
+        isSessionWatching = true;
+        sessionThread = std::thread([this] { session_thread(); });
+    }
 
     marketDataThread = std::thread([this] { market_thread(); });
     tradeDataThread = std::thread([this] { trade_thread(); });
@@ -76,6 +115,14 @@ void CtpProcess::app_start() {
 }
 
 void CtpProcess::app_stop() {
+    {
+        std::lock_guard<std::mutex> lk(sessionMutex);
+        isSessionWatching = false;
+    }
+    sessionCv.notify_all();
+    if (sessionThread.joinable()) {
+        sessionThread.join();
+    }
     if (marketDataThread.joinable()) {
         marketDataThread.join();
     }
@@ -85,13 +132,73 @@ void CtpProcess::app_stop() {
 }
 
 void CtpProcess::load_historic_candle_data() {
-    unordered_map<string, vector<CandleData>> historicCandle15;
-    DaoManager::instance().candleDao->get_all_candles(historicCandle15);
+    if (data->candleStoreDirectory.empty()) {
+        unordered_map<string, vector<CandleData>> historicCandle15;
+        DaoManager::instance().candleDao->get_all_candles(historicCandle15);
+
+        for (auto& item : data->instruments) {
+            if (historicCandle15.find(item.first) != historicCandle15.end()) {
+                item.second->load_historic_candle(historicCandle15[item.first]);
+            }
+        }
+        MIDAS_LOG_INFO("load_historic_candle_data finish");
+        return;
+    }
+
+    // only candles saved to mysql since last start are queried, the rest is mapped from candle store
+    const string source{"mysql"};
+    CandleStore store(data->candleStoreDirectory);
+    ostringstream err;
+    int syncCob = 0, syncTime = 0;
+    store.get_sync_point(source, syncCob, syncTime);
+    const bool isFullHistory = syncCob == 0;
+    unordered_map<string, CandleColumns> update;
+    const bool isUpdated = DaoManager::instance().candleDao->get_candles_after(syncCob, syncTime, update);
+    if (isUpdated) {
+        long merged = 0;
+        for (const auto& item : update) {
+            merged += std::max(store.merge(item.first, item.second, err, isFullHistory), 0L);
+        }
+        MIDAS_LOG_INFO("candle store merged " << merged << " candles of " << update.size() << " instruments");
+    }
+
+    // missing, corrupted or old version file would only get rows after sync point, so rebuild it from full history
+    vector<string> instruments, rebuilds;
+    for (auto& item : data->instruments) {
+        instruments.push_back(item.first);
+        if (!store.is_readable(item.first, CandleScale::Minute15)) rebuilds.push_back(item.first);
+    }
+    if (!rebuilds.empty()) {
+        unordered_map<string, CandleColumns> history;
+        if (isFullHistory && isUpdated) {
+            history.swap(update);
+        } else if (!DaoManager::instance().candleDao->get_candles_after(0, 0, history)) {
+            rebuilds.clear();
+        }
+        for (const auto& instrument : rebuilds) {
+            CandleColumns& columns = history[instrument];
+            columns.scale = CandleScale::Minute15;
+            store.save(instrument, columns, err);  // saved even without rows so that it is not rebuilt again
+        }
+        MIDAS_LOG_INFO("candle store rebuilt " << rebuilds.size() << " instruments from full history");
+    }
+
+    // instruments stop at different times, so next start queries from the one furthest behind, a row of it saved
+    // after a later row of another instrument is still found, merge skips rows other instruments already have
+    if (isUpdated && store.earliest_last_row(instruments, CandleScale::Minute15, syncCob, syncTime)) {
+        store.set_sync_point(source, syncCob, syncTime, err);
+        MIDAS_LOG_INFO("candle store synced to " << syncCob << " " << syncTime);
+    }
 
+    int loaded = 0;
     for (auto& item : data->instruments) {
-        if (historicCandle15.find(item.first) != historicCandle15.end()) {
-            item.second->load_historic_candle(historicCandle15[item.first]);
+        CandleStoreFile file;
+        if (file.open(store.file_path(item.first, CandleScale::Minute15), err) && file.size() > 0) {
+            vector<CandleData> candles = file.to_candles();
+            item.second->load_historic_candle(candles);
+            ++loaded;
         }
     }
-    MIDAS_LOG_INFO("load_historic_candle_data finish");
+    if (!err.str().empty()) MIDAS_LOG_ERROR(err.str());
+    MIDAS_LOG_INFO("load_historic_candle_data finish, " << loaded << " instruments from " << store.directory);
 }
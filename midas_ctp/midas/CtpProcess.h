@@ -3,8 +3,11 @@
 
 #include <ctp/ThostFtdcMdApi.h>
 #include <ctp/ThostFtdcTraderApi.h>
-#include <net/disruptor/Disruptor.h>
+#include <net/disruptor/DisruptorGraph.h>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include "CtpDataConsumer.h"
 #include "MdSpi.h"
 #include "TradeSpi.h"
@@ -23,7 +26,7 @@ class CtpProcess : public MidasProcessBase {
 public:
     typedef CtpDataConsumer DataConsumer;
     //    typedef CtpDataLogConsumer DataConsumer;
-    typedef midas::Disruptor<CtpMdSpi, DataConsumer, MktDataPayload, midas::ConsumerStages::OneStage> TMktDataDisruptor;
+    typedef midas::DisruptorGraph<CtpMdSpi, MktDataPayload> TMktDataDisruptor;
 
     std::shared_ptr<CtpData> data;
 
@@ -35,6 +38,10 @@ public:
 
     std::thread marketDataThread;
     std::thread tradeDataThread;
+    std::thread sessionThread;
+    std::atomic<bool> isSessionWatching{false};
+    std::mutex sessionMutex;
+    std::condition_variable sessionCv;
     typename DataConsumer::SharedPtr consumerPtr;
     typename TMktDataDisruptor::SharedPtr disruptorPtr;
 
@@ -54,6 +61,10 @@ private:
     // ctp section
     void trade_thread();
     void market_thread();
+    /**
+     * switch adaptive wait strategy between spinning and parking by trading hour map
+     */
+    void session_thread();
 
 private:
     // admin section
@@ -73,6 +84,10 @@ private:
     string admin_close(const string& cmd, const TAdminCallbackArgs& args) const;
 
     string admin_flush(const string& cmd, const TAdminCallbackArgs& args);
+    /**
+     * p50/p99/p99.9/max of each tick pipeline stage since last reset
+     */
+    string admin_latency(const string& cmd, const TAdminCallbackArgs& args);
     string admin_save2db(const string& cmd, const TAdminCallbackArgs& args);
 
 private:
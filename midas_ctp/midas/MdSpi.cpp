@@ -1,5 +1,6 @@
 #include "MdSpi.h"
 #include "helper/CtpVisualHelper.h"
+#include "model/CtpLatency.h"
 
 using namespace std;
 
@@ -39,7 +40,16 @@ void CtpMdSpi::OnRspSubMarketData(CThostFtdcSpecificInstrumentField *pSpecificIn
 }
 
 void CtpMdSpi::OnRtnDepthMarketData(CThostFtdcDepthMarketDataField *pDepthMarketData) {
-    dataCallback(*pDepthMarketData, ntime(), 1);
+    uint64_t rcvt = ntime();
+    receiveTime = rcvt;
+    dataCallback(pDepthMarketData, 1, rcvt, 1);
+
+    CtpLatency& latency = CtpLatency::instance();
+    if (latency.isEnabled.load(std::memory_order_relaxed)) {
+        uint64_t exchange = CtpLatency::exchange_latency(*pDepthMarketData, rcvt);
+        if (exchange) latency.record(LatencyExchange, exchange);
+        latency.record(LatencyPublish, ntime() - rcvt);
+    }
 }
 
 bool CtpMdSpi::IsErrorRspInfo(CThostFtdcRspInfoField *pRspInfo) {
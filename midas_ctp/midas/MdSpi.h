@@ -2,7 +2,9 @@
 #define MIDAS_MD_SPI_H
 
 #include <ctp/ThostFtdcMdApi.h>
+#include <net/shm/MarketDataBus.h>
 #include <string>
+#include "model/CtpTickIngest.h"
 #include "trade/TradeManager.h"
 
 using namespace std;
@@ -10,18 +12,39 @@ using namespace std;
 class CtpMdSpi : public CThostFtdcMdSpi {
 public:
     typedef std::shared_ptr<CtpMdSpi> SharedPtr;
-    typedef std::function<size_t(const CThostFtdcDepthMarketDataField &, uint64_t /*rcvt*/, int64_t /*id*/)> TCallback;
+    /**
+     * raw field is handed to disruptor, which normalizes it by fill straight into the ring slot
+     */
+    typedef CThostFtdcDepthMarketDataField SourceType;
+    typedef std::function<size_t(const SourceType *, size_t /*count*/, uint64_t /*rcvt*/, int64_t /*id*/)> TCallback;
 
     shared_ptr<TradeManager> manager;
     shared_ptr<CtpData> data;
     TCallback dataCallback;
+    /**
+     * optional shared memory broadcast to strategy processes on same host
+     */
+    std::shared_ptr<midas::MarketDataBusWriter<CThostFtdcDepthMarketDataField>> bus;
+    std::shared_ptr<CtpTickIngest> ingest;  // also read by consumers for data riding along the slot
+    uint64_t receiveTime{0};                // of tick being handed to disruptor, md thread only
 
 public:
-    CtpMdSpi(shared_ptr<TradeManager> manager_, shared_ptr<CtpData> d) : manager(manager_), data(d) {}
+    CtpMdSpi(shared_ptr<TradeManager> manager_, shared_ptr<CtpData> d)
+        : manager(manager_), data(d), ingest(make_shared<CtpTickIngest>(d->normalizer)) {}
     virtual ~CtpMdSpi() {}
 
     void register_data_callback(const TCallback &cb) { dataCallback = cb; }
 
+    /**
+     * called on md thread for the claimed slot, bus slot of instrument is keyed by its dense id found here
+     * @return false if instrument is unknown, slot is then published as invalid
+     */
+    bool fill(const SourceType &raw, CtpCompactTick &tick, long sequence) {
+        const bool isKnown = ingest->fill(raw, tick, sequence);
+        if (bus) bus->publish(raw, isKnown ? tick.instrumentId : -1, raw.InstrumentID, receiveTime);
+        return isKnown;
+    }
+
 public:
     ///错误应答
     virtual void OnRspError(CThostFtdcRspInfoField *pRspInfo, int nRequestID, bool bIsLast);
@@ -0,0 +1,117 @@
+#include <boost/filesystem.hpp>
+#include <thread>
+#include "catch.hpp"
+#include "io/BinaryJournalManager.h"
+
+using namespace midas;
+
+namespace {
+struct TestTick {
+    char instrument[8];
+    double price;
+    int volume;
+};
+
+vector<string> list_segments(const string& dir, const string& extension) {
+    vector<string> files;
+    boost::filesystem::directory_iterator end;
+    for (boost::filesystem::directory_iterator i(dir); i != end; ++i) {
+        if (i->path().extension().string() == extension) files.push_back(i->path().string());
+    }
+    sort(files.begin(), files.end());
+    return files;
+}
+}
+
+TEST_CASE("BinaryJournal segment and reader", "[BinaryJournal]") {
+    string dir = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    boost::filesystem::create_directories(dir);
+    string path = dir + "/test.mdj";
+
+    {
+        BinaryJournalSegment<TestTick> segment(path, 100, 8, cerr);
+        REQUIRE(!segment.bad());
+        for (int i = 0; i < 50; ++i) {
+            TestTick tick{"cu1801", 100.0 + i, i};
+            segment.append(tick, 1000 + i * 10, i);
+        }
+        REQUIRE(segment.count() == 50);
+        REQUIRE(!segment.full());
+        segment.close_segment();
+    }
+
+    BinaryJournalReader<TestTick> reader(path, cerr);
+    REQUIRE(!reader.bad());
+    REQUIRE(reader.count() == 50);
+    REQUIRE(reader.first_rcvt() == 1000);
+    REQUIRE(reader.last_rcvt() == 1490);
+    REQUIRE(reader.get(7).data.volume == 7);
+    REQUIRE(reader.get(7).data.price == 107.0);
+    REQUIRE(string(reader.get(7).data.instrument) == "cu1801");
+
+    REQUIRE(reader.lower_bound(0) == 0);
+    REQUIRE(reader.lower_bound(1000) == 0);
+    REQUIRE(reader.lower_bound(1001) == 1);
+    REQUIRE(reader.lower_bound(1080) == 8);
+    REQUIRE(reader.lower_bound(1085) == 9);
+    REQUIRE(reader.lower_bound(1490) == 49);
+    REQUIRE(reader.lower_bound(2000) == 50);
+
+    boost::filesystem::remove_all(dir);
+}
+
+TEST_CASE("BinaryJournalManager rollover", "[BinaryJournal]") {
+    string dir = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+
+    uint64_t now = static_cast<uint64_t>(time(nullptr)) * 1000000000;
+    {
+        BinaryJournalManager<TestTick> manager(dir, false, 16);
+        for (int i = 0; i < 40; ++i) {
+            // rollover takes prefaulted spare of seal thread
+            while (i % 16 == 0 && !manager.is_spare_ready()) std::this_thread::yield();
+            TestTick tick{"rb1805", 3000.0 + i, i};
+            manager.record(tick, now + i, i);
+        }
+        REQUIRE(manager.totalMsgs == 40);
+        REQUIRE(manager.droppedMsgs == 0);
+        REQUIRE(manager.spareMisses == 0);
+    }
+
+    vector<string> files = list_segments(dir, ".mdj");
+    REQUIRE(files.size() == 3);
+
+    int expected = 0;
+    for (const string& file : files) {
+        BinaryJournalReader<TestTick> reader(file, cerr);
+        REQUIRE(!reader.bad());
+        for (uint64_t i = 0; i < reader.count(); ++i) {
+            REQUIRE(reader.get(i).data.volume == expected);
+            REQUIRE(reader.get(i).rcvt == now + expected);
+            ++expected;
+        }
+    }
+    REQUIRE(expected == 40);
+
+    boost::filesystem::remove_all(dir);
+}
+
+TEST_CASE("BinaryJournalManager compress", "[BinaryJournal]") {
+    string dir = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+
+    uint64_t now = static_cast<uint64_t>(time(nullptr)) * 1000000000;
+    {
+        BinaryJournalManager<TestTick> manager(dir, true, 16);
+        for (int i = 0; i < 20; ++i) {
+            TestTick tick{"rb1805", 3000.0 + i, i};
+            manager.record(tick, now + i, i);
+        }
+        manager.flush();
+        TestTick tick{"rb1805", 0, 0};
+        manager.record(tick, now + 100, 100);
+    }
+
+    REQUIRE(list_segments(dir, ".mdj").empty());
+    REQUIRE(list_segments(dir, ".gz").size() == 3);
+
+    boost::filesystem::remove_all(dir);
+}
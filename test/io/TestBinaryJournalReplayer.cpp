@@ -0,0 +1,154 @@
+#include <sched.h>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <cfloat>
+#include <cstring>
+#include <sstream>
+#include "catch.hpp"
+#include "io/BinaryJournalManager.h"
+#include "io/BinaryJournalReplayer.h"
+#include "model/CtpTickIngest.h"
+#include "net/disruptor/DisruptorGraph.h"
+
+using namespace midas;
+
+namespace {
+struct ReplayTick {
+    char instrument[8];
+    double price;
+    int volume;
+};
+
+const uint64_t Base = 1500000000000000000UL;
+
+string record_ticks(bool isZip, int n, uint64_t step) {
+    string dir = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    BinaryJournalManager<ReplayTick> manager(dir, isZip, 64);
+    manager.indexInterval = 8;
+    for (int i = 0; i < n; ++i) {
+        ReplayTick tick{"cu1801", 100.0 + i, i};
+        manager.record(tick, Base + i * step, i);
+    }
+    return dir;
+}
+}
+
+TEST_CASE("BinaryJournalReplayer time window", "[BinaryJournalReplayer]") {
+    for (bool isZip : {false, true}) {
+        string dir = record_ticks(isZip, 200, 1000);
+
+        BinaryJournalReplayer<ReplayTick> replayer;
+        REQUIRE(replayer.load(dir, cerr));
+        REQUIRE(replayer.segments.size() == 4);
+        REQUIRE(replayer.segments[0].isZip == isZip);
+        REQUIRE(replayer.first_rcvt() == Base);
+        REQUIRE(replayer.last_rcvt() == Base + 199 * 1000);
+
+        vector<int> volumes;
+        auto cb = [&volumes](const ReplayTick& tick, uint64_t rcvt, int64_t id) -> size_t {
+            REQUIRE(rcvt == Base + tick.volume * 1000);
+            REQUIRE(id == tick.volume);
+            volumes.push_back(tick.volume);
+            return 0;
+        };
+
+        REQUIRE(replayer.play(0, 0, cb, cerr) == 200);
+        REQUIRE(volumes.size() == 200);
+        REQUIRE(std::is_sorted(volumes.begin(), volumes.end()));
+        REQUIRE(replayer.skippedMsgs == 0);
+
+        // every record outside window is counted, whether index search passed over it or it was read
+        volumes.clear();
+        REQUIRE(replayer.play(Base + 70 * 1000 - 1, Base + 149 * 1000, cb, cerr) == 80);
+        REQUIRE(volumes.front() == 70);
+        REQUIRE(volumes.back() == 149);
+        REQUIRE(replayer.skippedMsgs == 120);
+
+        volumes.clear();
+        REQUIRE(replayer.play(Base + 300 * 1000, 0, cb, cerr) == 0);
+        REQUIRE(volumes.empty());
+        REQUIRE(replayer.skippedMsgs == 320);
+        REQUIRE(replayer.failedMsgs == 0);
+
+        // segment gone after load is reported as failed
+        boost::filesystem::remove(replayer.segments[1].path);
+        ostringstream err;
+        REQUIRE(replayer.play(0, 0, cb, err) == 136);
+        REQUIRE(replayer.failedMsgs == 64);
+        REQUIRE(!err.str().empty());
+
+        boost::filesystem::remove_all(dir);
+    }
+}
+
+TEST_CASE("BinaryJournalReplayer speed", "[BinaryJournalReplayer]") {
+    string dir = record_ticks(false, 21, 1000000);  // 20ms recorded
+
+    BinaryJournalReplayer<ReplayTick> replayer(2);
+    REQUIRE(replayer.load(dir, cerr));
+
+    auto start = std::chrono::steady_clock::now();
+    REQUIRE(replayer.play(0, 0, [](const ReplayTick&, uint64_t, int64_t) -> size_t { return 0; }, cerr) == 21);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    REQUIRE(elapsed >= std::chrono::milliseconds(10));
+
+    boost::filesystem::remove_all(dir);
+}
+
+TEST_CASE("BinaryJournalReplayProducer fills ring through live ingest", "[BinaryJournalReplayer]") {
+    typedef BinaryJournalReplayProducer<CThostFtdcDepthMarketDataField, CtpTickIngest> TProducer;
+    typedef PayloadObject<CtpCompactTick> TPayload;
+
+    string dir = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    {
+        BinaryJournalManager<CThostFtdcDepthMarketDataField> manager(dir, true, 64);
+        for (int i = 0; i < 100; ++i) {
+            CThostFtdcDepthMarketDataField field;
+            memset(&field, 0, sizeof(field));
+            strcpy(field.InstrumentID, i % 10 == 9 ? "zn1801" : "cu1801");  // zn1801 is not subscribed
+            strcpy(field.TradingDay, "20171218");
+            strcpy(field.ActionDay, "20171218");
+            strcpy(field.UpdateTime, "10:00:00");
+            field.LastPrice = 50000 + i * 10;
+            field.Volume = i;
+            field.BidPrice1 = field.AskPrice1 = field.BidPrice2 = DBL_MAX;
+            manager.record(field, Base + i, i);
+        }
+    }
+
+    InstrumentIndex index;
+    index.intern("cu1801");
+    CtpTickNormalizer normalizer;
+    normalizer.init(index);
+    normalizer.set_price_tick(0, 10);
+    std::shared_ptr<CtpTickIngest> ingest = std::make_shared<CtpTickIngest>(normalizer);
+    std::shared_ptr<TProducer> producer = std::make_shared<TProducer>(dir, 0, ingest, cerr);
+    REQUIRE(producer->play(0, 0, cerr) == 0);
+
+    const string cfgPath = "test.journal_replay";
+    Config::instance().put(cfgPath + ".wait_strategy", "yield");
+    Config::instance().put(cfgPath + ".ring_size_exponent", 4);
+    vector<std::shared_ptr<TProducer>> producers{producer};
+    DisruptorGraph<TProducer, TPayload> graph("journal_replay", cfgPath, producers);
+    ingest->attach(graph.ring_size(), false);
+    std::atomic<long> received{0}, volumes{0}, mismatch{0};
+    graph.add_consumer("tick", [&](TPayload& p) {
+        const CtpCompactTick& tick = p.get_data();
+        const CtpTickDepth* depth = ingest->depth(p.get_sequence_value());
+        if (tick.instrumentId != 0 || tick.lastPrice != 50000 + tick.volume * 10 || depth->bidVolume[0] != 0 ||
+            p.get_rcvt() != Base + tick.volume) {
+            ++mismatch;
+        }
+        volumes += tick.volume;
+        ++received;
+    });
+    graph.start();
+    REQUIRE(producer->play(0, 0, cerr) == 100);
+    while (received.load() < 90) sched_yield();
+    graph.stop();
+
+    REQUIRE(mismatch.load() == 0);
+    REQUIRE(volumes.load() == 99 * 100 / 2 - (9 + 99) * 10 / 2);
+    REQUIRE(ingest->unknownInstrumentCount == 10);
+    boost::filesystem::remove_all(dir);
+}
@@ -0,0 +1,202 @@
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <sstream>
+#include "catch.hpp"
+#include "helper/CandleStore.h"
+#include "helper/DataLoader.h"
+
+namespace {
+CandleColumns make_columns(int days, int barsPerDay, int firstCob = 20170103) {
+    CandleColumns columns;
+    columns.scale = CandleScale::Minute15;
+    for (int d = 0; d < days; ++d) {
+        for (int b = 0; b < barsPerDay; ++b) {
+            double price = 3000 + d * 10 + b;
+            columns.append(firstCob + d, 90000 + b * 1500, price, price + 2, price - 2, price + 1, 100 + b);
+        }
+    }
+    return columns;
+}
+}
+
+TEST_CASE("CandleStore save load and date index", "[CandleStore]") {
+    string dir = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    CandleStore store(dir);
+    ostringstream err;
+    CandleColumns columns = make_columns(5, 4);
+    columns.tickCount[3] = 42;
+    REQUIRE(store.save("rb1801", columns, err));
+
+    CandleStoreFile file;
+    REQUIRE(file.open(store.file_path("rb1801", CandleScale::Minute15), err));
+    REQUIRE(file.size() == 20);
+    REQUIRE(file.scale() == CandleScale::Minute15);
+    REQUIRE(reinterpret_cast<uintptr_t>(file.close()) % CandleStoreAlignment == 0);
+    REQUIRE(file.close()[5] == columns.close[5]);
+
+    CandleColumns loaded;
+    REQUIRE(store.load("rb1801", CandleScale::Minute15, loaded, err));
+    REQUIRE(loaded.size() == 20);
+    REQUIRE(loaded.cob == columns.cob);
+    REQUIRE(loaded.time == columns.time);
+    REQUIRE(loaded.tickCount[3] == 42);
+    REQUIRE(loaded.volume == columns.volume);
+
+    REQUIRE(store.load("rb1801", CandleScale::Minute15, loaded, err, 20170104, 20170105));
+    REQUIRE(loaded.size() == 8);
+    REQUIRE(loaded.cob.front() == 20170104);
+    REQUIRE(loaded.cob.back() == 20170105);
+    REQUIRE(store.load("rb1801", CandleScale::Minute15, loaded, err, 20170106));
+    REQUIRE(loaded.size() == 8);
+    REQUIRE(store.load("rb1801", CandleScale::Minute15, loaded, err, 20170201));
+    REQUIRE(loaded.size() == 0);
+    REQUIRE(err.str().empty());
+
+    // other schema version is rejected
+    {
+        fstream fs(store.file_path("rb1801", CandleScale::Minute15), ios::in | ios::out | ios::binary);
+        fs.seekp(offsetof(CandleStoreHeader, schemaVersion));
+        uint32_t version = CandleStoreSchemaVersion + 1;
+        fs.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    }
+    REQUIRE(!store.load("rb1801", CandleScale::Minute15, loaded, err));
+    REQUIRE(err.str().find("schema version") != string::npos);
+    boost::filesystem::remove_all(dir);
+}
+
+TEST_CASE("CandleStore incremental merge and sync point", "[CandleStore]") {
+    string dir = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    CandleStore store(dir);
+    ostringstream err;
+    int cob = -1, time = -1;
+    store.get_sync_point("mysql", cob, time);
+    REQUIRE(cob == 0);
+    REQUIRE(time == 0);
+
+    CandleColumns all = make_columns(6, 3);
+    CandleColumns first, second;
+    first.scale = second.scale = CandleScale::Minute15;
+    first.append(all, 0, 10);
+    second.append(all, 7, all.size());  // overlaps first, overlapped rows are skipped
+
+    // no file yet, rows before an incremental update would be lost
+    REQUIRE(store.merge("cu1801", second, err) == CandleStoreRebuild);
+    REQUIRE(!store.is_readable("cu1801", CandleScale::Minute15));
+    REQUIRE(store.merge("cu1801", first, err, true) == 10);
+    REQUIRE(store.is_readable("cu1801", CandleScale::Minute15));
+    REQUIRE(store.merge("cu1801", second, err) == 8);
+    REQUIRE(store.merge("cu1801", second, err) == 0);
+    REQUIRE(store.merge("au1806", first, err, true) == 10);
+
+    map<string, CandleColumns> loaded = store.load_all(CandleScale::Minute15, err);
+    REQUIRE(loaded.size() == 2);
+    REQUIRE(loaded["cu1801"].close == all.close);
+    REQUIRE(loaded["au1806"].size() == 10);
+    REQUIRE(store.load_all(CandleScale::Minute1, err).empty());
+
+    REQUIRE(store.set_sync_point("mysql", all.cob.back(), all.time.back(), err));
+    store.get_sync_point("mysql", cob, time);
+    REQUIRE(cob == all.cob.back());
+    REQUIRE(time == all.time.back());
+    REQUIRE(err.str().empty());
+
+    // corrupted file is not rebuilt from incremental rows
+    {
+        ofstream ofs(store.file_path("au1806", CandleScale::Minute15), ofstream::binary | ofstream::trunc);
+        ofs << "garbage";
+    }
+    REQUIRE(store.merge("au1806", second, err) == CandleStoreRebuild);
+    REQUIRE(err.str().find("not a candle store file") != string::npos);
+    REQUIRE(store.merge("au1806", all, err, true) == static_cast<long>(all.size()));
+
+    CandleStoreFile file;
+    REQUIRE(file.open(store.file_path("au1806", CandleScale::Minute15), err));
+    vector<CandleData> candles = file.to_candles();
+    REQUIRE(candles.size() == all.size());
+    REQUIRE(candles[4].timestamp.cob == all.cob[4]);
+    REQUIRE(candles[4].high == all.high[4]);
+    boost::filesystem::remove_all(dir);
+}
+
+TEST_CASE("CandleStore sync point of instruments with different last rows", "[CandleStore]") {
+    string dir = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    CandleStore store(dir);
+    ostringstream err;
+    int cob = -1, time = -1;
+    REQUIRE(!store.earliest_last_row({"rb1801", "ag1806"}, CandleScale::Minute15, cob, time));
+
+    // ag1806 trades in night session and is ahead of rb1801 when process stops
+    CandleColumns all = make_columns(6, 3);
+    CandleColumns rb, ag;
+    rb.scale = ag.scale = CandleScale::Minute15;
+    rb.append(all, 0, 10);
+    ag.append(all, 0, 16);
+    REQUIRE(store.merge("rb1801", rb, err, true) == 10);
+    REQUIRE(store.merge("ag1806", ag, err, true) == 16);
+    REQUIRE(store.earliest_last_row({"rb1801", "ag1806", "cu1801"}, CandleScale::Minute15, cob, time));
+    REQUIRE(cob == all.cob[9]);
+    REQUIRE(time == all.time[9]);
+
+    // rows of rb1801 saved afterwards are earlier than last row of ag1806, query after earliest row gets them
+    map<string, CandleColumns> source{{"rb1801", all}, {"ag1806", all}};
+    for (const auto& item : source) {
+        CandleColumns after;
+        after.scale = CandleScale::Minute15;
+        size_t from = 0;
+        while (from < all.size() && (all.cob[from] < cob || (all.cob[from] == cob && all.time[from] <= time))) ++from;
+        after.append(item.second, from, item.second.size());
+        store.merge(item.first, after, err);
+    }
+    map<string, CandleColumns> loaded = store.load_all(CandleScale::Minute15, err);
+    REQUIRE(loaded["rb1801"].time == all.time);
+    REQUIRE(loaded["ag1806"].time == all.time);
+    REQUIRE(store.earliest_last_row({"rb1801", "ag1806"}, CandleScale::Minute15, cob, time));
+    REQUIRE(cob == all.cob.back());
+    REQUIRE(time == all.time.back());
+
+    // file saved without rows does not hold sync point back
+    CandleColumns empty;
+    empty.scale = CandleScale::Minute15;
+    REQUIRE(store.save("cu1801", empty, err));
+    REQUIRE(store.earliest_last_row({"rb1801", "cu1801"}, CandleScale::Minute15, cob, time));
+    REQUIRE(cob == all.cob.back());
+    REQUIRE(err.str().empty());
+    boost::filesystem::remove_all(dir);
+}
+
+TEST_CASE("DataLoader uses candle store while data file unchanged", "[CandleStore]") {
+    string dir = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    string dataDir = dir + "/data", storeDir = dir + "/store";
+    boost::filesystem::create_directories(dataDir);
+    string csv = dataDir + "/rb1801.csv";
+    {
+        ofstream ofs(csv);
+        ofs << "2017-01-03,09:01:00,3000,3010,2990,3005,120\n2017-01-03,09:02:00,3005,3006,3001,3002,80\n";
+    }
+    boost::filesystem::last_write_time(csv, std::time(nullptr) - 60);
+
+    DataLoader loader;
+    loader.storeDirectory = storeDir;
+    loader.load(dataDir);
+    CandleStore store(storeDir);
+    REQUIRE(store.is_fresh("rb1801", CandleScale::Minute1, csv));
+
+    // store content wins while data file is older, proves file was not parsed again
+    CandleColumns columns = loader.instrument2columns["rb1801"];
+    columns.close[1] = 1;
+    ostringstream err;
+    REQUIRE(store.save("rb1801", columns, err));
+    DataLoader cached;
+    cached.storeDirectory = storeDir;
+    cached.load(dataDir);
+    REQUIRE(cached.instrument2columns["rb1801"].close[1] == 1);
+
+    // touched data file is parsed and store rewritten
+    boost::filesystem::last_write_time(csv, std::time(nullptr) + 60);
+    DataLoader refreshed;
+    refreshed.storeDirectory = storeDir;
+    refreshed.load(dataDir);
+    REQUIRE(refreshed.instrument2columns["rb1801"].close[1] == 3002);
+    REQUIRE(refreshed.instrument2columns["rb1801"].scale == CandleScale::Minute1);
+    boost::filesystem::remove_all(dir);
+}
@@ -0,0 +1,124 @@
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <sstream>
+#include "catch.hpp"
+#include "helper/DataLoader.h"
+#include "io/CsvParser.h"
+#include "utils/convert/NumberParser.h"
+#include "utils/convert/TimeHelper.h"
+
+using namespace midas;
+
+namespace {
+string make_temp_dir() {
+    string dir = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    boost::filesystem::create_directories(dir);
+    return dir;
+}
+
+void write_file(const string& path, const string& content) {
+    ofstream ofs(path, ofstream::binary);
+    ofs << content;
+}
+}
+
+TEST_CASE("NumberParser", "[DataLoader]") {
+    string s{"-12345"};
+    REQUIRE(parse_int64(s.data(), s.data() + s.size()) == -12345);
+    s = "3512.5";
+    REQUIRE(parse_double(s.data(), s.data() + s.size()) == 3512.5);
+    s = "-0.001";
+    REQUIRE(parse_double(s.data(), s.data() + s.size()) == -0.001);
+    s = "4.3358e+09";
+    REQUIRE(parse_double(s.data(), s.data() + s.size()) == 4.3358e+09);
+    s = "1234567890.1234567";  // too many digits for fast path
+    REQUIRE(parse_double(s.data(), s.data() + s.size()) == 1234567890.1234567);
+}
+
+TEST_CASE("DataLoader type1 and type2 files", "[DataLoader]") {
+    string dir = make_temp_dir();
+    string type1 = dir + "/rb1801.csv", type2 = dir + "/cu1801.csv";
+    write_file(type1,
+               "\"Date\",\"Time\",\"Open\",\"High\",\"Low\",\"Close\",\"TotalVolume\"\r\n"
+               "2017-01-03,09:01:00,3000,3010.5,2990,3005,120\r\n"
+               "2017-01-03,09:02\r\n"
+               "\r\n"
+               "2017-01-03,09:02:00,3005,3006,3001,3002,80");
+    write_file(type2,
+               "2017-01-03 21:01:00,45000,45100,44900,45050,10\n"
+               "2017-01-03 21:02:00,45050,45060,45000,45010,12\n");
+
+    CandleColumns columns;
+    ostringstream err;
+    REQUIRE(DataLoader::load_file(type1, columns, err));
+    REQUIRE(columns.size() == 2);
+    REQUIRE(columns.scale == CandleScale::Minute1);
+    REQUIRE(columns.cob[0] == 20170103);
+    REQUIRE(columns.time[0] == intraday_time_HMS("09:01:00"));
+    REQUIRE(columns.high[0] == 3010.5);
+    REQUIRE(columns.close[1] == 3002);
+    REQUIRE(columns.volume[1] == 80);
+
+    REQUIRE(DataLoader::load_file(type2, columns, err));
+    REQUIRE(columns.size() == 2);
+    REQUIRE(columns.time[1] == intraday_time_HMS("21:02:00"));
+    REQUIRE(columns.open[1] == 45050);
+    REQUIRE(columns.volume[1] == 12);
+
+    vector<CandleData> candles = columns.to_candles();
+    REQUIRE(candles.size() == 2);
+    REQUIRE(candles[1].close == 45010);
+    REQUIRE(candles[1].timestamp.cob == 20170103);
+    REQUIRE(err.str().empty());
+
+    REQUIRE(!DataLoader::load_file(dir + "/missing.csv", columns, err));
+    REQUIRE(!err.str().empty());
+    boost::filesystem::remove_all(dir);
+}
+
+TEST_CASE("DataLoader loads directory in parallel", "[DataLoader]") {
+    string dir = make_temp_dir();
+    const int fileCount = 6, rowCount = 500;
+    for (int f = 0; f < fileCount; ++f) {
+        ostringstream os;
+        os << "Date,Time,Open,High,Low,Close,TotalVolume\n";
+        for (int r = 0; r < rowCount; ++r) {
+            os << "2017-01-03,09:" << (r / 60 % 60 < 10 ? "0" : "") << r / 60 % 60 << ':' << (r % 60 < 10 ? "0" : "")
+               << r % 60 << ',' << f << ',' << f + 1 << ',' << f - 1 << ',' << f * 1000 + r << ',' << r << '\n';
+        }
+        write_file(dir + "/inst" + to_string(f) + ".csv", os.str());
+    }
+    write_file(dir + "/broken.csv", "a,b\n1,2\n");
+
+    DataLoader loader;
+    loader.threadCount = 3;
+    loader.load(dir);
+    REQUIRE(loader.instrument2columns.size() == fileCount);
+    for (int f = 0; f < fileCount; ++f) {
+        const CandleColumns& columns = loader.instrument2columns["inst" + to_string(f)];
+        REQUIRE(columns.size() == rowCount);
+        REQUIRE(columns.close.front() == f * 1000);
+        REQUIRE(columns.close.back() == f * 1000 + rowCount - 1);
+    }
+    boost::filesystem::remove_all(dir);
+}
+
+TEST_CASE("CsvParser", "[DataLoader]") {
+    string dir = make_temp_dir();
+    string path = dir + "/test.csv";
+    write_file(path, "name,price,qty\nrb1801,3512.5,3\n\ncu1801,45000\n");
+
+    CsvParser parser;
+    parser.parse(path);
+    REQUIRE(parser.row_count() == 2);
+    REQUIRE(parser.index_of("price") == 1);
+    REQUIRE(parser.get(1, 0) == "cu1801");
+    REQUIRE(parser.get(1, 2) == "null");
+    REQUIRE(parser.get_int(0, 2) == 3);
+    REQUIRE(parser.column_doubles("price") == vector<double>({3512.5, 45000}));
+
+    write_file(path, "1,2\n3,4,5\n");
+    parser.hasHeader = false;
+    REQUIRE_THROWS(parser.parse(path));
+    boost::filesystem::remove_all(dir);
+}
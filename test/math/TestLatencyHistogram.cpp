@@ -0,0 +1,70 @@
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+#include "utils/math/LatencyHistogram.h"
+
+using namespace std;
+using namespace midas;
+
+TEST_CASE("LatencyHistogram buckets", "[LatencyHistogram]") {
+    const size_t bucketCount = LatencyHistogram::BUCKET_COUNT;
+    const uint64_t maxValue = LatencyHistogram::MAX_VALUE;
+    for (uint64_t v : {0ul, 1ul, 63ul, 64ul, 65ul, 127ul, 128ul, 1000ul, 123456789ul, maxValue}) {
+        size_t index = LatencyHistogram::bucket_index(v);
+        REQUIRE(index < bucketCount);
+        REQUIRE(LatencyHistogram::bucket_upper(index) >= v);
+        if (index > 0) REQUIRE(LatencyHistogram::bucket_upper(index - 1) < v);
+    }
+    REQUIRE(LatencyHistogram::bucket_index(maxValue) == bucketCount - 1);
+}
+
+TEST_CASE("LatencyHistogram percentile", "[LatencyHistogram]") {
+    LatencyHistogram histogram;
+    std::mt19937 gen(42);
+    std::lognormal_distribution<double> dist(8, 1.5);
+    vector<uint64_t> values;
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t v = static_cast<uint64_t>(dist(gen));
+        values.push_back(v);
+        histogram.record(v);
+    }
+    sort(values.begin(), values.end());
+
+    LatencyHistogram::Snapshot s = histogram.snapshot();
+    REQUIRE(s.count == values.size());
+    REQUIRE(s.min == values.front());
+    REQUIRE(s.max == values.back());
+    for (double p : {50.0, 90.0, 99.0, 99.9}) {
+        uint64_t exact = values[static_cast<size_t>(p * 0.01 * values.size() + 0.5) - 1];
+        REQUIRE(s.percentile(p) >= exact);
+        REQUIRE(s.percentile(p) <= exact + exact / 32 + 1);
+    }
+    REQUIRE(s.percentile(100) == values.back());
+
+    s = histogram.snapshot(true);
+    REQUIRE(s.count == values.size());
+    s = histogram.snapshot();
+    REQUIRE(s.count == 0);
+    REQUIRE(s.percentile(99) == 0);
+}
+
+TEST_CASE("LatencyRecorder concurrent record", "[LatencyHistogram]") {
+    LatencyRecorder recorder({"a", "b"});
+    vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&recorder, t]() {
+            for (uint64_t i = 1; i <= 10000; ++i) recorder.record(t % 2, i);
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    REQUIRE(recorder.get(0).get_count() == 20000);
+    REQUIRE(recorder.get(1).snapshot().max == 10000);
+
+    ostringstream oss;
+    recorder.report(oss, true);
+    REQUIRE(oss.str().find("p99.9") != string::npos);
+    REQUIRE(recorder.get(0).snapshot().count == 0);
+}
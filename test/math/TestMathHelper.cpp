@@ -89,3 +89,63 @@ TEST_CASE("DescriptiveStatistics", "[DescriptiveStatistics]") {
     REQUIRE(ds.get_percentile(60) == 7.0);
     REQUIRE(ds.get_percentile(90) == 9.0);
 }
+
+TEST_CASE("DescriptiveStatistics rolling window", "[DescriptiveStatistics]") {
+    const size_t window = 50;
+    DescriptiveStatistics ds(window);
+    std::vector<double> all;
+    double x = 3000;
+    for (int i = 0; i < 200000; ++i) {
+        x += ((i * 7919) % 13) - 6 + 0.01 * (i % 7);
+        all.push_back(x);
+        ds.add_value(x);
+
+        if (i % 9973 != 0 && i != 199999) continue;
+
+        std::vector<double> w(all.end() - std::min(all.size(), window), all.end());
+        double n = w.size(), mean = 0;
+        for (double v : w) mean += v;
+        mean /= n;
+        double m2 = 0, m3 = 0, m4 = 0;
+        for (double v : w) {
+            double d = v - mean;
+            m2 += d * d;
+            m3 += d * d * d;
+            m4 += d * d * d * d;
+        }
+        double variance = n > 1 ? m2 / (n - 1) : 0;
+
+        REQUIRE(ds.size() == w.size());
+        REQUIRE(ds.get_mean() == Approx(mean).epsilon(1e-12));
+        REQUIRE(ds.get_variance() == Approx(variance).epsilon(1e-8));
+        REQUIRE(ds.get_max() == *std::max_element(w.begin(), w.end()));
+        REQUIRE(ds.get_min() == *std::min_element(w.begin(), w.end()));
+        if (n > 3) {
+            double skew = n / ((n - 1) * (n - 2)) * m3 / (variance * std::sqrt(variance));
+            double kurt = n * (n + 1) / ((n - 1) * (n - 2) * (n - 3)) * m4 / (variance * variance) -
+                          3 * (n - 1) * (n - 1) / ((n - 2) * (n - 3));
+            REQUIRE(ds.get_skewness() == Approx(skew).margin(1e-6));
+            REQUIRE(ds.get_kurtosis() == Approx(kurt).margin(1e-6));
+        }
+    }
+
+    ds.clear();
+    ds.set_window_size(3);
+    for (double v : {5.0, 1.0, 4.0, 2.0}) ds.add_value(v);
+    REQUIRE(ds.get_max() == 4.0);
+    REQUIRE(ds.get_min() == 1.0);
+    REQUIRE(ds.replace_most_recent_value(9.0) == 2.0);
+    REQUIRE(ds.get_max() == 9.0);
+    REQUIRE(ds.get_sum() == 14.0);
+    ds.remove_most_recent_value();
+    REQUIRE(ds.get_max() == 4.0);
+    REQUIRE(ds.get_mean() == 2.5);
+    ds.add_value_and_sort(3.0);
+    REQUIRE(ds.get_element(0) == 1.0);
+    REQUIRE(ds.get_element(1) == 3.0);
+    REQUIRE(ds.get_element(2) == 4.0);
+    ds.add_value(0.5);
+    REQUIRE(ds.get_min() == 0.5);
+    REQUIRE(ds.get_max() == 4.0);
+    REQUIRE(ds.get_sum() == 7.5);
+}
@@ -0,0 +1,155 @@
+#include <cmath>
+#include <numeric>
+#include <random>
+#include "catch.hpp"
+#include "strategy/BiMaStrategy.h"
+#include "utils/math/DescriptiveStatistics.h"
+#include "utils/math/RollingKernels.h"
+
+using namespace midas;
+
+namespace {
+vector<double> random_walk(size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<double> step(0, 5);
+    vector<double> v(n);
+    double x = 3000;
+    for (auto& e : v) {
+        x += step(gen);
+        e = x;
+    }
+    return v;
+}
+}
+
+TEST_CASE("rolling mean std min max", "[RollingKernels]") {
+    const size_t n = 1003;
+    vector<double> x = random_walk(n, 42);
+
+    for (size_t window : {1, 3, 4, 17, 60, 2000}) {
+        vector<double> mean(n), stddev(n), maxv(n), minv(n);
+        rolling_mean(x.data(), n, window, mean.data());
+        rolling_std(x.data(), n, window, stddev.data());
+        rolling_max(x.data(), n, window, maxv.data());
+        rolling_min(x.data(), n, window, minv.data());
+
+        DescriptiveStatistics ds(window);
+        for (size_t i = 0; i < n; ++i) {
+            ds.add_value(x[i]);
+            REQUIRE(mean[i] == Approx(ds.get_mean()).epsilon(1e-12));
+            REQUIRE(stddev[i] == Approx(ds.get_standard_deviation()).margin(1e-6));
+            REQUIRE(maxv[i] == ds.get_max());
+            REQUIRE(minv[i] == ds.get_min());
+        }
+    }
+}
+
+TEST_CASE("rolling mean std over long history", "[RollingKernels]") {
+    // geometric walk of 0.2% per bar, level drifts far from first value as bars of years do
+    const size_t n = (1 << 20) + 1234;
+    std::mt19937 gen(5);
+    std::normal_distribution<double> step(0, 0.002);
+    vector<double> x(n);
+    double price = 3000;
+    for (auto& e : x) {
+        price *= std::exp(step(gen));
+        e = price;
+    }
+
+    for (size_t window : {20, 60}) {
+        vector<double> mean(n), stddev(n);
+        rolling_mean(x.data(), n, window, mean.data());
+        rolling_std(x.data(), n, window, stddev.data());
+
+        // naive sums over each window, error of kernel must not grow with history
+        double meanError = 0, stdError = 0;
+        for (size_t i = window - 1; i < n; ++i) {
+            double sum = 0, sumSq = 0;
+            for (size_t j = i + 1 - window; j <= i; ++j) sum += x[j];
+            double mu = sum / window;
+            for (size_t j = i + 1 - window; j <= i; ++j) sumSq += (x[j] - mu) * (x[j] - mu);
+            double sd = std::sqrt(sumSq / (window - 1));
+            meanError = std::max(meanError, std::fabs(mean[i] - mu) / mu);
+            stdError = std::max(stdError, std::fabs(stddev[i] - sd) / sd);
+        }
+        REQUIRE(meanError < 1e-13);
+        REQUIRE(stdError < 1e-9);
+    }
+}
+
+TEST_CASE("ema atr cross", "[RollingKernels]") {
+    const size_t n = 37;
+    vector<double> close = random_walk(n, 7);
+    vector<double> high(n), low(n);
+    for (size_t i = 0; i < n; ++i) {
+        high[i] = close[i] + 2 + i % 3;
+        low[i] = close[i] - 1 - i % 4;
+    }
+
+    vector<double> e(n);
+    ema(close.data(), n, 9, e.data());
+    double expected = close[0];
+    for (size_t i = 0; i < n; ++i) {
+        if (i > 0) expected += 0.2 * (close[i] - expected);
+        REQUIRE(e[i] == Approx(expected));
+    }
+
+    vector<double> tr(n), a(n);
+    true_range(high.data(), low.data(), close.data(), n, tr.data());
+    atr(high.data(), low.data(), close.data(), n, 14, a.data());
+    REQUIRE(tr[0] == Approx(3));
+    double avg = tr[0];
+    for (size_t i = 1; i < n; ++i) {
+        double t = std::max(high[i] - low[i], std::max(std::abs(high[i] - close[i - 1]), std::abs(low[i] - close[i - 1])));
+        REQUIRE(tr[i] == Approx(t));
+        avg += (t - avg) / 14;
+        REQUIRE(a[i] == Approx(avg));
+    }
+
+    vector<double> fast{1, 2, 3, 2, 1, 1, 3, 3, 1, 2, 3};
+    vector<double> slow{2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2};
+    vector<double> mask(fast.size());
+    cross_mask(fast.data(), slow.data(), fast.size(), mask.data());
+    vector<double> expectedMask{0, 0, 0, 0, 0, 0, 1, 0, -1, 0, 0};
+    REQUIRE(mask == expectedMask);
+}
+
+TEST_CASE("BiMaStrategy calculate_all matches bin by bin", "[RollingKernels]") {
+    // prefix sum and running window sum round differently, averages agree within this relative tolerance
+    const double tolerance = 1e-12;
+    for (unsigned seed : {3u, 7u, 11u}) {
+        vector<double> close = random_walk(500, seed);
+        vector<CandleData> history;
+        for (size_t i = 0; i < close.size(); ++i) {
+            history.emplace_back(20180102, 90000, close[i], close[i] + 1, close[i] - 1, close[i], 10);
+        }
+        Candles candles;
+        candles.init(history);
+
+        BiMaStrategy columnar(candles), binByBin(candles);
+        StrategyParameter parameter;
+        parameter.values["slowPeriod"] = 30 + seed;
+        parameter.values["fastPeriod"] = 5 + seed;
+        columnar.apply_parameter(parameter);
+        binByBin.apply_parameter(parameter);
+        columnar.calculate_all();
+        binByBin.init();
+        for (int i = 0; i < candles.currentBinIndex; ++i) binByBin.calculate(i);
+
+        int crossings = 0;
+        for (int i = 0; i < candles.currentBinIndex; ++i) {
+            REQUIRE(columnar.slowMa[i] == Approx(binByBin.slowMa[i]).epsilon(tolerance));
+            REQUIRE(columnar.fastMa[i] == Approx(binByBin.fastMa[i]).epsilon(tolerance));
+            // signal may only differ where averages are within rounding of each other
+            bool isTie = std::fabs(binByBin.fastMa[i] - binByBin.slowMa[i]) <= tolerance * binByBin.slowMa[i] ||
+                         (i > 0 && std::fabs(binByBin.fastMa[i - 1] - binByBin.slowMa[i - 1]) <=
+                                       tolerance * binByBin.slowMa[i - 1]);
+            if (!isTie) REQUIRE(columnar.signals[i] == binByBin.signals[i]);
+            if (binByBin.signals[i] != 0) ++crossings;
+        }
+        REQUIRE(crossings > 0);
+        REQUIRE(columnar.decision == binByBin.decision);
+        REQUIRE(columnar.dsSlow.get_mean() == Approx(binByBin.dsSlow.get_mean()).epsilon(tolerance));
+        REQUIRE(columnar.dsFast.size() == binByBin.dsFast.size());
+    }
+}
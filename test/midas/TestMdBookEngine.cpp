@@ -0,0 +1,182 @@
+#include <cfloat>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "catch.hpp"
+#include "midas/md/MdBookEngine.h"
+#include "model/CtpBook.h"
+#include "model/CtpInstrument.h"
+
+using namespace std;
+using namespace midas;
+
+namespace {
+struct Delta {
+    string symbol;
+    uint16_t exchange;
+    BookChanged changed;
+};
+
+void on_book_changed(char const* symbol, uint16_t exch, BookChanged const* changed, void* userData) {
+    static_cast<vector<Delta>*>(userData)->push_back({symbol, exch, *changed});
+}
+
+BookSnapshot make_snapshot(uint16_t depth) {
+    BookSnapshot snapshot;
+    snapshot.bidDepth = snapshot.askDepth = depth;
+    for (uint16_t i = 0; i < depth; ++i) {
+        snapshot.bidPrice[i] = 1000 - i;
+        snapshot.bidShares[i] = 10 + i;
+        snapshot.askPrice[i] = 1001 + i;
+        snapshot.askShares[i] = 20 + i;
+    }
+    return snapshot;
+}
+
+CThostFtdcDepthMarketDataField make_tick() {
+    CThostFtdcDepthMarketDataField tick;
+    memset(&tick, 0, sizeof(tick));
+    strcpy(tick.InstrumentID, "rb1801");
+    tick.BidPrice1 = 3511;
+    tick.BidVolume1 = 12;
+    tick.AskPrice1 = 3512.5;
+    tick.AskVolume1 = 7;
+    tick.LastPrice = tick.HighestPrice = tick.LowestPrice = DBL_MAX;
+    return tick;
+}
+}
+
+TEST_CASE("MdBook level arrays", "[MdBookEngine]") {
+    MdBook book;
+    book.allocate(5);
+    REQUIRE(book.numBidLevels == 5);
+    REQUIRE(book.numAskLevels == 5);
+    REQUIRE(reinterpret_cast<uintptr_t>(book.bidLevels) % 64 == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(book.askLevels) % 64 == 0);
+    REQUIRE(book.bidLevels[4].price == PriceBlank);
+    REQUIRE(book.askLevels[0].shares == 0);
+}
+
+TEST_CASE("apply book snapshot reports changed levels only", "[MdBookEngine]") {
+    MdBook book;
+    book.allocate(5);
+    BookChanged changed;
+
+    BookSnapshot snapshot = make_snapshot(3);
+    REQUIRE(apply_book_snapshot(book, snapshot, 1, 100, changed));
+    REQUIRE(changed.side == BookChanged::ChangedSide::both);
+    REQUIRE(changed.bidLevels == 0x7);
+    REQUIRE(changed.askLevels == 0x7);
+    REQUIRE(book.bidLevels[2].price == 998);
+    REQUIRE(book.askLevels[1].shares == 21);
+    REQUIRE(book.bidLevels[2].sequence == 1);
+    REQUIRE(book.bidLevels[3].price == PriceBlank);
+
+    REQUIRE(!apply_book_snapshot(book, snapshot, 2, 200, changed));
+    REQUIRE(changed.side == BookChanged::ChangedSide::none);
+    REQUIRE(book.bidLevels[0].sequence == 1);
+
+    snapshot.askShares[1] = 5;
+    REQUIRE(apply_book_snapshot(book, snapshot, 3, 300, changed));
+    REQUIRE(changed.side == BookChanged::ChangedSide::ask);
+    REQUIRE(changed.bidLevels == 0);
+    REQUIRE(changed.askLevels == 0x2);
+    REQUIRE(book.askLevels[1].sequence == 3);
+    REQUIRE(book.askLevels[1].updateTS == 300);
+    REQUIRE(book.askLevels[0].sequence == 1);
+
+    // level beyond new depth is cleared
+    snapshot.bidDepth = 1;
+    REQUIRE(apply_book_snapshot(book, snapshot, 4, 400, changed));
+    REQUIRE(changed.side == BookChanged::ChangedSide::bid);
+    REQUIRE(changed.bidLevels == 0x6);
+    REQUIRE(book.bidLevels[1].price == PriceBlank);
+    REQUIRE(book.bidLevels[1].shares == 0);
+}
+
+TEST_CASE("MdBookEngine dispatches ctp book deltas", "[MdBookEngine]") {
+    vector<Delta> deltas;
+    MdBookEngine engine;
+    engine.callbacks.cbBookChanged = on_book_changed;
+    engine.userData = &deltas;
+
+    CtpInstrument instrument("rb1801", TradeSessions());
+    instrument.bookEngine = &engine;
+    instrument.info = make_shared<CThostFtdcInstrumentField>();
+    strcpy(instrument.info->ExchangeID, "SHFE");
+    InstrumentIndex index;
+    index.intern("rb1801");
+    CtpTickNormalizer normalizer;
+    normalizer.init(index);
+    normalizer.set_price_tick(0, 0.5);
+
+    CThostFtdcDepthMarketDataField tick = make_tick();
+    CtpCompactTick compact;
+    CtpTickDepth depth;
+    MktDataPayload payload;
+    REQUIRE(normalizer.normalize(tick, compact));
+    normalizer.normalize_depth(tick, compact, depth);
+    payload.set_value(compact, 123, 1);
+
+    instrument.update_tick(payload, &depth);
+    REQUIRE(deltas.size() == 1);
+    REQUIRE(deltas[0].symbol == "rb1801");
+    REQUIRE(deltas[0].exchange == ExchangeSHFE);
+    REQUIRE(deltas[0].changed.bidLevels == 0x1);
+    REQUIRE(deltas[0].changed.askLevels == 0x1);
+    REQUIRE(deltas[0].changed.timestamps.producerReceive == 123);
+    REQUIRE(instrument.book.askLevels[0].price == 35125000);
+    REQUIRE(instrument.book.numBidLevels == 5);
+    REQUIRE(instrument.book.bidLevels[1].price == PriceBlank);
+
+    // only trade fields moved
+    tick.LastPrice = 3512;
+    tick.Volume = 10;
+    normalizer.normalize(tick, compact);
+    normalizer.normalize_depth(tick, compact, depth);
+    payload.set_value(compact, 124, 2);
+    instrument.update_tick(payload, &depth);
+    REQUIRE(deltas.size() == 1);
+    // tick without exchange time leaves candles alone
+    REQUIRE(instrument.candles15.updateCount == 0);
+
+    tick.BidVolume1 = 13;
+    normalizer.normalize(tick, compact);
+    normalizer.normalize_depth(tick, compact, depth);
+    payload.set_value(compact, 125, 3);
+    instrument.update_tick(payload, &depth);
+    REQUIRE(deltas.size() == 2);
+    REQUIRE(deltas[1].changed.side == BookChanged::ChangedSide::bid);
+    REQUIRE(instrument.book.bidLevels[0].shares == 13);
+
+    // level 3 comes from side record
+    tick.AskPrice3 = 3514;
+    tick.AskVolume3 = 4;
+    normalizer.normalize(tick, compact);
+    normalizer.normalize_depth(tick, compact, depth);
+    payload.set_value(compact, 126, 4);
+    instrument.update_tick(payload, &depth);
+    REQUIRE(deltas.size() == 3);
+    REQUIRE(deltas[2].changed.side == BookChanged::ChangedSide::ask);
+    REQUIRE(deltas[2].changed.askLevels == 0x4);
+    REQUIRE(instrument.book.askLevels[2].price == 35140000);
+    REQUIRE(instrument.book.askLevels[2].shares == 4);
+    REQUIRE(engine.snapshotCount == 4);
+    REQUIRE(engine.changedCount == 3);
+
+    tick.OpenInterest = 2345;
+    tick.PreSettlementPrice = 3500;
+    normalizer.normalize(tick, compact);
+    normalizer.normalize_depth(tick, compact, depth);
+    payload.set_value(compact, 127, 5);
+    instrument.update_tick(payload, &depth);
+    REQUIRE(instrument.stats.openInterest == 2345);
+    ostringstream os;
+    instrument.image_stream(os);
+    const string image = os.str();
+    const size_t ois = image.find("\nois "), lsp = image.find("\nlsp ");
+    REQUIRE(ois != string::npos);
+    REQUIRE(image.find("2345", ois) < image.find('\n', ois + 1));
+    REQUIRE(image.find("3500", lsp) < image.find('\n', lsp + 1));
+}
@@ -0,0 +1,143 @@
+#include <sstream>
+#include <string>
+#include "catch.hpp"
+#include "helper/CtpVisualHelper.h"
+#include "midas/MidasTick.h"
+#include "midas/TickCodec.h"
+#include "model/CtpTickSchema.h"
+
+using namespace std;
+using namespace midas;
+
+namespace {
+struct SmallTick {
+    char id[8];
+    int a;
+    short s;
+    double c;
+    float d;
+    long t;
+};
+
+struct SmallSchema {
+    typedef SmallTick TPod;
+
+    static constexpr uint16_t version() { return 3; }
+
+    static constexpr TickFieldTable<6> fields() {
+        return {{MIDAS_TICK_FIELD(SmallTick, "id", id), MIDAS_TICK_FIELD(SmallTick, "a", a),
+                 MIDAS_TICK_FIELD(SmallTick, "s", s), MIDAS_TICK_FIELD(SmallTick, "c", c),
+                 MIDAS_TICK_FIELD(SmallTick, "d", d), MIDAS_TICK_FIELD(SmallTick, "t", t)}};
+    }
+};
+
+typedef TickCodec<SmallSchema> SmallCodec;
+}
+
+TEST_CASE("tick codec layout is resolved at compile time", "[TickCodec]") {
+    static_assert(SmallCodec::field_count() == 6, "field count");
+    static_assert(SmallCodec::wire_offset(3) == 8 + 4 + 2, "packed wire offset");
+    static_assert(SmallCodec::wire_size() == 4 + 8 + 4 + 2 + 8 + 4 + 8, "wire size");
+    static_assert(SmallSchema::fields()[1].type == TickFieldType::Integer, "int field");
+    static_assert(SmallSchema::fields()[0].type == TickFieldType::Chars, "char array field");
+    static_assert(SmallSchema::fields()[4].type == TickFieldType::Real, "float field");
+    REQUIRE(SmallCodec::field_index("c") == 3);
+    REQUIRE(SmallCodec::field_index("x") == -1);
+}
+
+TEST_CASE("tick codec binary round trip", "[TickCodec]") {
+    SmallTick in{"rb1801", -42, 7, 3512.5, 0.25f, 1234567890123L};
+    char buffer[64];
+    REQUIRE(SmallCodec::encode(in, buffer, 10) == 0);
+    size_t n = SmallCodec::encode(in, buffer, sizeof(buffer));
+    REQUIRE(n == SmallCodec::wire_size());
+
+    SmallTick out;
+    memset(&out, 0, sizeof(out));
+    REQUIRE(SmallCodec::decode(buffer, n, out));
+    REQUIRE(string(out.id) == "rb1801");
+    REQUIRE(out.a == -42);
+    REQUIRE(out.s == 7);
+    REQUIRE(out.c == 3512.5);
+    REQUIRE(out.d == 0.25f);
+    REQUIRE(out.t == 1234567890123L);
+
+    REQUIRE(!SmallCodec::decode(buffer, n - 1, out));
+    buffer[0] = 9;  // other schema version
+    REQUIRE(!SmallCodec::decode(buffer, n, out));
+}
+
+TEST_CASE("tick codec text parse", "[TickCodec]") {
+    SmallTick tick;
+    memset(&tick, 0, sizeof(tick));
+    const string msg{"id abcdefghijk ,x skipped ,a 42 ,c -1.345 ,d 21.1 ,s -3 ,t 1e3 ,;"};
+    REQUIRE(SmallCodec::parse_text(msg.data(), msg.size(), tick) == 6);
+    REQUIRE(string(tick.id) == "abcdefg");  // truncated to array, always terminated
+    REQUIRE(tick.a == 42);
+    REQUIRE(tick.s == -3);
+    REQUIRE(tick.c == -1.345);
+    REQUIRE(tick.d == 21.1f);
+    REQUIRE(tick.t == 1);  // integer field stops at first non digit
+
+    // same as TMidasTick, message without terminating comma yields nothing
+    REQUIRE(SmallCodec::parse_text("a 1", 3, tick) == 0);
+
+    // long message crosses many simd blocks
+    string longMsg;
+    for (int i = 0; i < 50; ++i) longMsg += "x " + to_string(i) + " ,";
+    longMsg += "a 7 ,;";
+    REQUIRE(SmallCodec::parse_text(longMsg.data(), longMsg.size(), tick) == 1);
+    REQUIRE(tick.a == 7);
+}
+
+TEST_CASE("ctp tick codec matches MidasTick", "[TickCodec]") {
+    CThostFtdcDepthMarketDataField field;
+    memset(&field, 0, sizeof(field));
+    strcpy(field.ExchangeID, "SHFE");
+    strcpy(field.InstrumentID, "rb1801");
+    field.LastPrice = 3512;
+    field.PreSettlementPrice = 3490.5;
+    field.Volume = 123456;
+    field.Turnover = 4.3358e+09;
+    field.OpenInterest = 2345678;
+    field.UpperLimitPrice = 1.79769e+308;
+    strcpy(field.UpdateTime, "21:00:01");
+    field.UpdateMillisec = 500;
+    field.BidPrice1 = 3511;
+    field.BidVolume1 = 12;
+    field.AskPrice1 = 3513;
+    field.AskVolume1 = 7;
+    strcpy(field.TradingDay, "20171010");
+    strcpy(field.ActionDay, "20171009");
+
+    ostringstream os;
+    os << field;
+    string line = os.str();
+    line.insert(line.size() - 1, "rcvt 1507554001500000000 ,");
+
+    CtpTick tick;
+    memset(&tick, 0, sizeof(tick));
+    REQUIRE(CtpTickCodec::parse_text(line.data(), line.size(), tick) == 28);
+
+    MidasTick legacy(line);
+    REQUIRE(string(tick.data.ExchangeID) == legacy["e"].value_string());
+    REQUIRE(string(tick.data.InstrumentID) == legacy["id"].value_string());
+    REQUIRE(tick.data.LastPrice == (double)legacy["tp"]);
+    REQUIRE(tick.data.PreSettlementPrice == (double)legacy["lsp"]);
+    REQUIRE(tick.data.Volume == (int)legacy["ts"]);
+    REQUIRE(tick.data.Turnover == (double)legacy["to"]);
+    REQUIRE(tick.data.OpenInterest == (double)legacy["ois"]);
+    REQUIRE(tick.data.UpperLimitPrice == (double)legacy["ulp"]);
+    REQUIRE(string(tick.data.UpdateTime) == "21:00:01");
+    REQUIRE(tick.data.UpdateMillisec == 500);
+    REQUIRE(tick.data.AskVolume1 == 7);
+    REQUIRE(string(tick.data.ActionDay) == "20171009");
+    REQUIRE(tick.rcvt == 1507554001500000000ULL);
+
+    char buffer[CtpTickCodec::wire_size()];
+    REQUIRE(CtpTickCodec::encode(tick, buffer, sizeof(buffer)) == sizeof(buffer));
+    CtpTick decoded;
+    memset(&decoded, 0, sizeof(decoded));
+    REQUIRE(CtpTickCodec::decode(buffer, sizeof(buffer), decoded));
+    REQUIRE(memcmp(&decoded, &tick, sizeof(tick)) == 0);
+}
@@ -0,0 +1,183 @@
+#include <cfloat>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include "catch.hpp"
+#include "model/CtpCompactTick.h"
+#include "model/CtpLatency.h"
+#include "model/CtpTickIngest.h"
+
+using namespace std;
+
+namespace {
+CThostFtdcDepthMarketDataField make_field(const char* instrument) {
+    CThostFtdcDepthMarketDataField field;
+    memset(&field, 0, sizeof(field));
+    strcpy(field.InstrumentID, instrument);
+    strcpy(field.TradingDay, "20171218");
+    strcpy(field.ActionDay, "20171215");
+    strcpy(field.UpdateTime, "21:05:03");
+    field.UpdateMillisec = 500;
+    field.LastPrice = 3512;
+    field.HighestPrice = 3530;
+    field.LowestPrice = 3490;
+    field.Volume = 1200;
+    field.BidPrice1 = 3511;
+    field.BidVolume1 = 12;
+    field.AskPrice1 = DBL_MAX;
+    field.AskVolume1 = 0;
+    return field;
+}
+}
+
+TEST_CASE("CtpCompactTick layout and price scale", "[CtpCompactTick]") {
+    REQUIRE(sizeof(CtpCompactTick) == 64);
+    REQUIRE(CtpTickNormalizer::price_scale(1) == 0);
+    REQUIRE(CtpTickNormalizer::price_scale(0.5) == 1);
+    REQUIRE(CtpTickNormalizer::price_scale(0.2) == 1);
+    REQUIRE(CtpTickNormalizer::price_scale(0.01) == 2);
+    REQUIRE(CtpTickNormalizer::price_scale(0.005) == 3);
+    REQUIRE(CtpTickNormalizer::price_scale(0) == midas::DefaultPriceScale);
+    REQUIRE(CtpTickNormalizer::price_scale(DBL_MAX) == midas::DefaultPriceScale);
+    REQUIRE(CtpTickNormalizer::to_fixed(3512.2, 1) == 35122);
+}
+
+TEST_CASE("CtpTickNormalizer normalize depth market data", "[CtpCompactTick]") {
+    InstrumentIndex index;
+    index.intern("rb1801");
+    index.intern("au1806");
+    CtpTickNormalizer normalizer;
+    normalizer.init(index);
+    normalizer.set_price_tick(index.find("au1806"), 0.05);
+
+    CThostFtdcDepthMarketDataField field = make_field("rb1801");
+    CtpCompactTick tick;
+    REQUIRE(normalizer.normalize(field, tick));
+    REQUIRE(tick.instrumentId == index.find("rb1801"));
+    REQUIRE(tick.priceScale == midas::DefaultPriceScale);
+    REQUIRE(tick.lastPrice == 35120000);
+    REQUIRE(tick.price(tick.highPrice) == 3530);
+    REQUIRE(tick.volume == 1200);
+    REQUIRE(tick.is_valid(TickValidLast));
+    REQUIRE(tick.is_valid(TickValidBid));
+    REQUIRE(!tick.is_valid(TickValidAsk));
+    REQUIRE(tick.askPrice == 0);
+
+    // exchange time is UTC+8
+    REQUIRE(tick.is_valid(TickValidTime));
+    REQUIRE(tick.exchangeTime == 1513343103500000000LL);
+    REQUIRE(tick.cob() == 20171215);
+    REQUIRE(tick.hms() == 210503);
+    REQUIRE(tick.millisecond() == 500);
+
+    // empty action day falls back to trading day
+    field.ActionDay[0] = '\0';
+    REQUIRE(normalizer.normalize(field, tick));
+    REQUIRE(tick.cob() == 20171218);
+
+    field.UpdateTime[0] = '\0';
+    REQUIRE(normalizer.normalize(field, tick));
+    REQUIRE(!tick.is_valid(TickValidTime));
+
+    CThostFtdcDepthMarketDataField gold = make_field("au1806");
+    gold.LastPrice = 278.35;
+    gold.AskPrice1 = 278.4;
+    gold.AskVolume1 = 3;
+    REQUIRE(normalizer.normalize(gold, tick));
+    REQUIRE(tick.priceScale == 2);
+    REQUIRE(tick.lastPrice == 27835);
+    REQUIRE(tick.askPrice == 27840);
+    REQUIRE(tick.is_valid(TickValidAsk));
+
+    REQUIRE(!normalizer.normalize(make_field("cu1801"), tick));
+}
+
+TEST_CASE("CtpTickNormalizer fills depth side record", "[CtpCompactTick]") {
+    InstrumentIndex index;
+    index.intern("au1806");
+    CtpTickNormalizer normalizer;
+    normalizer.init(index);
+    normalizer.set_price_tick(0, 0.05);
+
+    CThostFtdcDepthMarketDataField field = make_field("au1806");
+    field.BidPrice2 = 278.3;
+    field.BidVolume2 = 4;
+    field.BidPrice3 = DBL_MAX;
+    field.BidVolume3 = 0;
+    field.AskPrice5 = 279.1;
+    field.AskVolume5 = 9;
+    field.PreSettlementPrice = 277.95;
+    field.UpperLimitPrice = 300.2;
+    field.SettlementPrice = DBL_MAX;
+    field.OpenInterest = 123456;
+    field.Turnover = 3.5e9;
+    field.AveragePrice = 278312.5;
+    field.CurrDelta = DBL_MAX;
+
+    CtpCompactTick tick;
+    CtpTickDepth depth;
+    REQUIRE(normalizer.normalize(field, tick));
+    CtpTickNormalizer::normalize_depth(field, tick, depth);
+    REQUIRE(depth.bidPrice[0] == 27830);
+    REQUIRE(depth.bidVolume[0] == 4);
+    REQUIRE(depth.bidPrice[1] == 0);
+    REQUIRE(depth.bidVolume[1] == 0);
+    REQUIRE(depth.askPrice[3] == 27910);
+    REQUIRE(depth.askVolume[3] == 9);
+    REQUIRE(depth.stats.preSettlementPrice == 27795);
+    REQUIRE(depth.stats.upperLimitPrice == 30020);
+    REQUIRE(depth.stats.settlementPrice == 0);
+    REQUIRE(depth.stats.openInterest == 123456);
+    REQUIRE(depth.stats.turnover == 3.5e9);
+    REQUIRE(depth.stats.averagePrice == 278312.5);
+    REQUIRE(depth.stats.currDelta == 0);
+}
+
+TEST_CASE("CtpTickIngest fills side rings by sequence", "[CtpCompactTick]") {
+    InstrumentIndex index;
+    index.intern("rb1801");
+    CtpTickNormalizer normalizer;
+    normalizer.init(index);
+    CtpTickIngest ingest(normalizer);
+
+    CThostFtdcDepthMarketDataField field = make_field("rb1801");
+    field.AskPrice2 = 3514;
+    field.AskVolume2 = 6;
+    CtpCompactTick tick;
+    REQUIRE(ingest.fill(field, tick, 0));
+    REQUIRE(ingest.depth(0) == nullptr);
+
+    ingest.attach(8, false);
+    REQUIRE(ingest.raws.empty());
+    REQUIRE(ingest.fill(field, tick, 11));
+    REQUIRE(ingest.depth(3)->askPrice[0] == 35140000);
+
+    ingest.attach(8, true);
+    field.Volume = 1300;
+    REQUIRE(ingest.fill(field, tick, 12));
+    REQUIRE(ingest.raw(4).Volume == 1300);
+    REQUIRE(ingest.depth(12)->askVolume[0] == 6);
+
+    REQUIRE(!ingest.fill(make_field("cu1801"), tick, 13));
+    REQUIRE(ingest.unknownInstrumentCount == 1);
+}
+
+TEST_CASE("CtpLatency exchange latency in exchange time zone", "[CtpCompactTick]") {
+    REQUIRE(!CtpLatency().isEnabled);
+
+    // host zone must not matter
+    setenv("TZ", "America/New_York", 1);
+    tzset();
+    CThostFtdcDepthMarketDataField field = make_field("rb1801");
+    uint64_t exchangeTime = CtpTickNormalizer::exchange_time(field.ActionDay, field.UpdateTime, field.UpdateMillisec);
+    REQUIRE(CtpLatency::exchange_latency(field, exchangeTime + 1500000) == 1500000);
+    REQUIRE(CtpLatency::exchange_latency(field, exchangeTime - 1000000) == 0);
+
+    // stamped before midnight, received after
+    strcpy(field.UpdateTime, "23:59:59");
+    field.UpdateMillisec = 999;
+    exchangeTime = CtpTickNormalizer::exchange_time(field.ActionDay, field.UpdateTime, field.UpdateMillisec);
+    REQUIRE(CtpLatency::exchange_latency(field, exchangeTime + 2000000) == 2000000);
+    unsetenv("TZ");
+    tzset();
+}
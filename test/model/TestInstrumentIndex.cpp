@@ -0,0 +1,78 @@
+#include <string>
+#include <vector>
+#include "catch.hpp"
+#include "helper/CtpHelper.h"
+#include "model/CtpData.h"
+#include "model/InstrumentIndex.h"
+
+using namespace std;
+
+TEST_CASE("InstrumentIndex intern and find", "[InstrumentIndex]") {
+    InstrumentIndex index;
+    vector<string> ids;
+    for (int i = 0; i < 1000; ++i) ids.push_back("cu" + to_string(1801 + i));
+
+    for (size_t i = 0; i < ids.size(); ++i) REQUIRE(index.intern(ids[i]) == static_cast<int>(i));
+    REQUIRE(index.size() == ids.size());
+    REQUIRE(index.intern("cu1801") == 0);
+
+    for (size_t i = 0; i < ids.size(); ++i) {
+        REQUIRE(index.find(ids[i]) == static_cast<int>(i));
+        REQUIRE(index.name(static_cast<int>(i)) == ids[i]);
+    }
+
+    // chars after terminator of fixed width field are ignored
+    TThostFtdcInstrumentIDType field;
+    memset(field, 'x', sizeof(field));
+    strcpy(field, "cu1802");
+    REQUIRE(index.find(field) == 1);
+
+    REQUIRE(index.find("cu180") == -1);
+    REQUIRE(index.find("cu18011") == -1);
+    REQUIRE(index.find("") == -1);
+    REQUIRE(index.intern("") == -1);
+
+    index.clear();
+    REQUIRE(index.find("cu1801") == -1);
+}
+
+TEST_CASE("CtpData update by dense instrument id", "[InstrumentIndex]") {
+    CtpData data;
+    for (string id : {"rb1801", "cu1801", "zn1801"}) {
+        data.instrumentInfo[id] = make_shared<CThostFtdcInstrumentField>();
+        data.tradeStatusManager.product2sessions[get_product_name(id)] = TradeSessions();
+    }
+    data.init_all_instruments();
+    REQUIRE(data.instruments.size() == 3);
+    REQUIRE(data.denseInstruments.size() == 3);
+
+    // laid out contiguously in map order
+    for (size_t i = 0; i < data.denseInstruments.size(); ++i) {
+        REQUIRE(data.denseInstruments[i] == data.denseInstruments[0] + i);
+        REQUIRE(data.denseInstruments[i]->id == data.instrumentIndex.name(static_cast<int>(i)));
+    }
+
+    CThostFtdcDepthMarketDataField tick;
+    memset(&tick, 0, sizeof(tick));
+    strcpy(tick.InstrumentID, "cu1801");
+    tick.LastPrice = 50000;
+    CtpCompactTick compact;
+    REQUIRE(data.normalizer.normalize(tick, compact));
+    MktDataPayload payload;
+    payload.set_value(compact, 1, 1);
+    REQUIRE(data.update(payload));
+    REQUIRE(data.instruments["cu1801"]->updateCount == 1);
+    REQUIRE(data.instruments["cu1801"]->image.price(data.instruments["cu1801"]->image.lastPrice) == 50000);
+
+    strcpy(tick.InstrumentID, "ag1801");
+    REQUIRE(!data.normalizer.normalize(tick, compact));
+    compact.instrumentId = 3;
+    MktDataPayload unknown;
+    unknown.set_value(compact, 1, 1);
+    REQUIRE(!data.update(unknown));
+
+    std::shared_ptr<CtpInstrument> keep = data.instruments["zn1801"];
+    data.instruments.clear();
+    data.instrumentArena.reset();
+    REQUIRE(keep->id == "zn1801");
+}
@@ -0,0 +1,101 @@
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/strand.hpp>
+#include "catch.hpp"
+#include "net/common/Coalescer.h"
+#include "utils/convert/TimeHelper.h"
+
+using namespace std;
+using namespace midas;
+
+namespace {
+/**
+ * mimics publisher: pending bytes and batches sent, handlers run on strand
+ */
+struct Sender {
+    boost::asio::io_service iosvc;
+    boost::asio::io_service::strand strand{iosvc};
+    Coalescer coalescer;
+    long pendingBytes{0};
+    int batches{0};
+    uint64_t sentTime{0};
+
+    explicit Sender(const string& cfg) : coalescer(cfg, iosvc) {}
+
+    void deliver(long bytes) {
+        pendingBytes += bytes;
+        if (coalescer.hold(pendingBytes, strand.wrap([this](const boost::system::error_code& ec) {
+                if (coalescer.expire(ec)) send();
+            }))) {
+            send();
+        }
+    }
+
+    void send() {
+        ++batches;
+        pendingBytes = 0;
+        sentTime = ntime();
+    }
+};
+}
+
+TEST_CASE("Coalescer flushes on byte budget", "[Coalescer]") {
+    Config::instance().put("test.coalescer.budget.coalesce_window", boost::posix_time::seconds(10));
+    Config::instance().put("test.coalescer.budget.coalesce_bytes", 100);
+    Sender sender("test.coalescer.budget");
+    REQUIRE(sender.coalescer.enabled());
+
+    sender.deliver(150);
+    REQUIRE(sender.batches == 1);
+    REQUIRE(!sender.coalescer.armed());
+
+    // budget reached while window timer is held, timer is cancelled
+    sender.deliver(60);
+    REQUIRE(sender.coalescer.armed());
+    REQUIRE(!sender.coalescer.budget_crossed(60, 60));
+    REQUIRE(sender.coalescer.budget_crossed(120, 60));
+    REQUIRE(!sender.coalescer.budget_crossed(180, 60));
+    sender.pendingBytes += 60;
+    REQUIRE(sender.coalescer.release(sender.pendingBytes));
+    sender.send();
+    REQUIRE(!sender.coalescer.armed());
+
+    uint64_t start = ntime();
+    sender.iosvc.run();
+    REQUIRE(ntime() - start < 1000000000L);  // cancelled timer does not wait for window
+    REQUIRE(sender.batches == 2);
+    REQUIRE(sender.coalescer.budgetFlushes == 2);
+    REQUIRE(sender.coalescer.windowFlushes == 0);
+}
+
+TEST_CASE("Coalescer flushes when window timer fires", "[Coalescer]") {
+    Config::instance().put("test.coalescer.window.coalesce_window", boost::posix_time::milliseconds(20));
+    Config::instance().put("test.coalescer.window.coalesce_bytes", 1000);
+    Sender sender("test.coalescer.window");
+
+    uint64_t start = ntime();
+    sender.deliver(10);
+    sender.deliver(10);  // joins held batch, timer is not armed again
+    REQUIRE(sender.batches == 0);
+    REQUIRE(sender.coalescer.armed());
+    sender.iosvc.run();
+    REQUIRE(sender.batches == 1);
+    REQUIRE(sender.sentTime - start >= 20000000L);
+    REQUIRE(sender.coalescer.windowFlushes == 1);
+    REQUIRE(sender.coalescer.budgetFlushes == 0);
+
+    // handler of window cancelled by budget is stale, next window still flushes
+    sender.iosvc.reset();
+    sender.deliver(10);
+    sender.pendingBytes += 2000;
+    REQUIRE(sender.coalescer.release(sender.pendingBytes));
+    sender.send();
+    sender.deliver(10);
+    sender.iosvc.run();
+    REQUIRE(sender.batches == 3);
+    REQUIRE(sender.pendingBytes == 0);
+    REQUIRE(sender.coalescer.windowFlushes == 2);
+    REQUIRE(sender.coalescer.budgetFlushes == 1);
+
+    Config::instance().put("test.coalescer.off.coalesce_window", boost::posix_time::microseconds(0));
+    REQUIRE(!Coalescer("test.coalescer.off", sender.iosvc).enabled());
+}
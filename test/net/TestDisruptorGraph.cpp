@@ -0,0 +1,257 @@
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include "catch.hpp"
+#include "net/disruptor/DisruptorGraph.h"
+#include "net/disruptor/SideRing.h"
+
+using namespace std;
+using namespace midas;
+
+namespace {
+typedef PayloadObject<long> TestPayload;
+
+class TestProducer {
+public:
+    typedef std::shared_ptr<TestProducer> SharedPtr;
+    std::function<size_t(const long&, uint64_t, int64_t)> callback;
+
+    template <typename F>
+    void register_data_callback(F f) {
+        callback = f;
+    }
+
+    void publish(long value) { callback(value, 0, value); }
+};
+
+/**
+ * counts copies of element, ring construction copies are reset before publishing
+ */
+struct CountedTick {
+    static std::atomic<long> copies;
+    long value{0};
+
+    CountedTick() {}
+    CountedTick(const CountedTick& other) : value(other.value) { ++copies; }
+    CountedTick& operator=(const CountedTick& other) {
+        value = other.value;
+        ++copies;
+        return *this;
+    }
+};
+
+std::atomic<long> CountedTick::copies{0};
+typedef PayloadObject<CountedTick> CountedPayload;
+
+class CopyProducer {
+public:
+    typedef std::shared_ptr<CopyProducer> SharedPtr;
+    std::function<size_t(const CountedTick&, uint64_t, int64_t)> callback;
+
+    template <typename F>
+    void register_data_callback(F f) {
+        callback = f;
+    }
+};
+
+class FillProducer {
+public:
+    typedef std::shared_ptr<FillProducer> SharedPtr;
+    typedef long SourceType;
+    std::function<size_t(const long*, size_t, uint64_t, int64_t)> callback;
+    SideRing<long> sources;  // source of every entry, rides along by sequence
+
+    template <typename F>
+    void register_data_callback(F f) {
+        callback = f;
+    }
+
+    /**
+     * negative source is rejected
+     */
+    bool fill(const long& source, CountedTick& tick, long sequence) {
+        if (!sources.empty()) sources.at(sequence) = source;
+        tick.value = source * 10;
+        return source >= 0;
+    }
+};
+
+string run_diamond(const string& waitStrategy) {
+    const string cfgPath = "test.disruptor_graph." + waitStrategy;
+    Config::instance().put(cfgPath + ".wait_strategy", waitStrategy);
+    Config::instance().put(cfgPath + ".ring_size_exponent", 6);
+
+    const long count = 20000;
+    vector<long> left(count, 0), right(count, 0);
+    std::atomic<long> joined{0}, journaled{0}, mismatch{0};
+    std::atomic<int> posted{0};
+
+    vector<TestProducer::SharedPtr> producers{std::make_shared<TestProducer>()};
+    DisruptorGraph<TestProducer, TestPayload> graph("graph_" + waitStrategy, cfgPath, producers);
+
+    // left and right run in parallel, join sees both results of every entry
+    int l = graph.add_consumer("left", [&](TestPayload& p) { left[p.get_data()] = p.get_data() * 2; });
+    int r = graph.add_consumer("right", [&](TestPayload& p) { right[p.get_data()] = p.get_data() * 3; });
+    graph.add_consumer("join",
+                       [&](TestPayload& p) {
+                           long v = p.get_data();
+                           if (left[v] != v * 2 || right[v] != v * 3) ++mismatch;
+                           ++joined;
+                       },
+                       {l, r});
+    graph.add_consumer("journal", [&](TestPayload& p) { ++journaled; });
+    REQUIRE_THROWS(graph.add_consumer("bad", [](TestPayload&) {}, {7}));
+    graph.start();
+    REQUIRE_THROWS(graph.add_consumer("late", [](TestPayload&) {}));
+
+    for (long i = 0; i < count; ++i) {
+        producers[0]->publish(i);
+        if (i == count / 2) graph.post([&posted]() { ++posted; });
+    }
+    while (joined.load() < count || journaled.load() < count) sched_yield();
+
+    REQUIRE(mismatch.load() == 0);
+    REQUIRE(posted.load() == 1);
+
+    ostringstream os;
+    graph.stats(os);
+    REQUIRE(os.str().find("msgs recv        = 20000") != string::npos);
+    REQUIRE(os.str().find("consumer join msgs 20000 lag 0 after left right") != string::npos);
+    REQUIRE(os.str().find("consumer journal msgs 20000 lag 0 after producer") != string::npos);
+    graph.stop();
+    return os.str();
+}
+}
+
+TEST_CASE("DisruptorGraph diamond", "[DisruptorGraph]") {
+    SECTION("yield") { run_diamond("yield"); }
+    SECTION("block") { run_diamond("block"); }
+    SECTION("adaptive") {
+        string stats = run_diamond("adaptive");
+        REQUIRE(stats.find("wait spin/yield/park = ") != string::npos);
+        REQUIRE(stats.find("session open") != string::npos);
+    }
+}
+
+TEST_CASE("AdaptiveWaitStrategy parks out of session", "[DisruptorGraph]") {
+    REQUIRE(AdaptiveWaitStrategy::pause_ns() >= 1.0);
+
+    AdaptiveWaitStrategy::set_session_open(false);
+    string stats = run_diamond("adaptive");
+    AdaptiveWaitStrategy::set_session_open(true);
+
+    // every wait that found no data went straight to futex
+    REQUIRE(stats.find("wait spin/yield/park = 0/0/") != string::npos);
+    REQUIRE(stats.find("session closed") != string::npos);
+    size_t pos = stats.find("wait ns count ");
+    REQUIRE(pos != string::npos);
+    REQUIRE(stoull(stats.substr(pos + 14)) > 0);
+    REQUIRE(stats.find("wakeup ns count ") != string::npos);
+}
+
+TEST_CASE("DisruptorGraph producer fills entry in place", "[DisruptorGraph]") {
+    const string cfgPath = "test.disruptor_graph.fill";
+    Config::instance().put(cfgPath + ".wait_strategy", "yield");
+    Config::instance().put(cfgPath + ".ring_size_exponent", 4);
+    std::atomic<long> received{0}, sum{0};
+    auto consume = [&](CountedPayload& p) {
+        sum += p.get_data().value;
+        ++received;
+    };
+
+    // copy path, element is built by producer then copied into slot
+    vector<CopyProducer::SharedPtr> copyProducers{std::make_shared<CopyProducer>()};
+    DisruptorGraph<CopyProducer, CountedPayload> copyGraph("graph_copy", cfgPath, copyProducers);
+    copyGraph.add_consumer("sum", consume);
+    copyGraph.start();
+    CountedTick::copies = 0;
+    for (long i = 0; i < 100; ++i) {
+        CountedTick tick;
+        tick.value = i;
+        copyProducers[0]->callback(tick, 0, i);
+    }
+    while (received.load() < 100) sched_yield();
+    REQUIRE(CountedTick::copies.load() == 100);
+    copyGraph.stop();
+
+    received = 0;
+    sum = 0;
+    std::atomic<long> sideMismatch{0}, sideSeen{0};
+    vector<FillProducer::SharedPtr> fillProducers{std::make_shared<FillProducer>()};
+    DisruptorGraph<FillProducer, CountedPayload> fillGraph("graph_fill", cfgPath, fillProducers);
+    REQUIRE(fillGraph.ring_size() == 16);
+    fillProducers[0]->sources = SideRing<long>(fillGraph.ring_size());
+    fillGraph.add_consumer("sum", consume);
+    fillGraph.add_consumer("side", [&](CountedPayload& p) {
+        if (fillProducers[0]->sources.at(p.get_sequence_value()) * 10 != p.get_data().value) ++sideMismatch;
+        ++sideSeen;
+    });
+    fillGraph.start();
+    CountedTick::copies = 0;
+    long expected = 0;
+    for (long i = 0; i < 100; ++i) {
+        REQUIRE(fillProducers[0]->callback(&i, 1, 0, i) == 1);
+        expected += i * 10;
+    }
+    // burst larger than half of ring is claimed as one batch, rejected source is skipped by consumer
+    vector<long> burst{1, 2, -3, 4, 5, 6, 7, 8, 9, 10, 11};
+    REQUIRE(fillProducers[0]->callback(burst.data(), burst.size(), 0, 0) == burst.size());
+    expected += 630;
+    while (received.load() < 110 || sideSeen.load() < 110) sched_yield();
+    REQUIRE(sum.load() == expected);
+    REQUIRE(CountedTick::copies.load() == 0);
+    REQUIRE(sideMismatch.load() == 0);
+    REQUIRE_THROWS(SideRing<long>(12));
+
+    ostringstream os;
+    fillGraph.stats(os);
+    REQUIRE(os.str().find("msgs recv        = 111") != string::npos);
+    fillGraph.stop();
+}
+
+TEST_CASE("RingBuffer batch claim and view across ring end", "[DisruptorGraph]") {
+    typedef SequentialConsumerStrategy<> TConsumer;
+    typedef PayloadObject<long> TPayload;
+    typedef RingBuffer<TPayload, SingleThreadedStrategy, YieldWaitStrategy, TConsumer> TRing;
+    TRing ring(0, 8, "batch_ring");
+    TConsumer::TPostQueue postQueue;
+    boost::shared_ptr<TConsumer> consumer = boost::make_shared<TConsumer>(postQueue, true, "batch_ring");
+    TRing::TProducerBarrier::SharedPtr producer = ring.create_producer_barrier(false, consumer);
+    TRing::TConsumerBarrier::SharedPtr reader = ring.create_consumer_barrier(consumer.get());
+
+    long last = producer->claim_batch(5);
+    REQUIRE(last == 4);
+    for (long sequence = 0; sequence <= last; ++sequence) producer->entry_at(sequence).claim_data(0, 0) = sequence;
+    REQUIRE(ring.get_cursor() == -1);
+    producer->publish_batch(0, last);
+    REQUIRE(ring.get_cursor() == 4);
+
+    consumer->consumedTo = 4;
+    last = producer->claim_batch(6);
+    REQUIRE(last == 10);
+    for (long sequence = 5; sequence <= last; ++sequence) producer->entry_at(sequence).claim_data(0, 0) = sequence;
+    producer->publish_batch(5, last);
+
+    RingView<TPayload> view = reader->get_view(5, 10);
+    REQUIRE(view.size() == 6);
+    REQUIRE(view.firstCount == 3);
+    REQUIRE(view.secondCount == 3);
+    REQUIRE(view.second == &reader->get_entry(8));
+    for (size_t i = 0; i < view.size(); ++i) {
+        REQUIRE(view[i].get_data() == static_cast<long>(5 + i));
+        REQUIRE(view[i].get_sequence_value() == static_cast<long>(5 + i));
+        REQUIRE(view[i].is_valid());
+    }
+    REQUIRE(reader->get_view(2, 4).secondCount == 0);
+
+    consumer->consumedTo = 10;
+    REQUIRE(!producer->claim_and_publish([](TPayload& entry) {
+        entry.claim_data(0, 0) = -1;
+        return false;
+    }));
+    REQUIRE(ring.get_cursor() == 11);
+    REQUIRE(!reader->get_entry(11).is_valid());
+    REQUIRE_THROWS(producer->claim_batch(9));
+}
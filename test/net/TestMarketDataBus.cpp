@@ -0,0 +1,132 @@
+#include <sys/wait.h>
+#include <unistd.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+#include "net/shm/MarketDataBus.h"
+
+using namespace std;
+using namespace midas;
+
+namespace {
+struct Tick {
+    char instrument[16];
+    uint64_t seq;
+    double price;
+};
+
+Tick make_tick(const char* instrument, uint64_t seq) {
+    Tick tick;
+    memset(&tick, 0, sizeof(tick));
+    strncpy(tick.instrument, instrument, sizeof(tick.instrument) - 1);
+    tick.seq = seq;
+    tick.price = 100.0 + seq;
+    return tick;
+}
+}
+
+TEST_CASE("MarketDataBus broadcast", "[MarketDataBus]") {
+    string name = "/midas_test_bus_" + to_string(getpid());
+    MarketDataBusWriter<Tick> writer(name, 16, 2);
+
+    writer.publish(make_tick("cu1801", 0), 0, "cu1801", 10);
+    MarketDataBusReader<Tick> live(name);
+    MarketDataBusReader<Tick> oldest(name, true);
+
+    const char* instruments[] = {"cu1801", "rb1801", "zn1801"};
+    for (uint64_t i = 1; i < 10; ++i) {
+        writer.publish(make_tick(instruments[i % 3], i), static_cast<int>(i % 3), instruments[i % 3], 10 + i);
+    }
+
+    vector<uint64_t> seen;
+    auto collect = [&seen](const Tick& tick, uint64_t rcvt, uint64_t sequence) {
+        REQUIRE(tick.seq == sequence);
+        REQUIRE(rcvt == 10 + sequence);
+        seen.push_back(sequence);
+    };
+    REQUIRE(live.poll(collect) == 9);
+    REQUIRE(seen.front() == 1);
+    seen.clear();
+    REQUIRE(oldest.poll(collect) == 10);
+    REQUIRE(oldest.poll(collect) == 0);
+
+    // only two slots, zn1801 has no last value
+    vector<string> keys;
+    REQUIRE(live.snapshot([&keys](const char* key, const Tick& tick, uint64_t) {
+        keys.push_back(key);
+        REQUIRE(string(tick.instrument) == key);
+    }) == 2);
+    REQUIRE(keys == vector<string>{"cu1801", "rb1801"});
+    REQUIRE(writer.slotMisses == 3);
+
+    // reader left behind more than capacity is overrun, then resumes in order
+    for (uint64_t i = 10; i < 50; ++i) writer.publish(make_tick("cu1801", i), 0, "cu1801", 10 + i);
+    seen.clear();
+    size_t n = live.poll(collect);
+    REQUIRE(live.gaps == 1);
+    REQUIRE(live.lost + n == 40);
+    REQUIRE(seen.back() == 49);
+    REQUIRE(live.lag() == 0);
+}
+
+TEST_CASE("MarketDataBus concurrent reader", "[MarketDataBus]") {
+    string name = "/midas_test_bus_mt_" + to_string(getpid());
+    MarketDataBusWriter<Tick> writer(name, 1024, 16);
+    MarketDataBusReader<Tick> reader(name);
+
+    const uint64_t total = 200000;
+    bool isConsistent = true;
+    uint64_t last = 0;
+    std::thread t([&]() {
+        while (reader.received + reader.lost < total) {
+            reader.poll([&](const Tick& tick, uint64_t, uint64_t sequence) {
+                if (tick.seq != sequence || tick.price != 100.0 + sequence || sequence < last) isConsistent = false;
+                last = sequence;
+            });
+        }
+    });
+    for (uint64_t i = 0; i < total; ++i) writer.publish(make_tick("cu1801", i), 0, "cu1801", i);
+    t.join();
+
+    REQUIRE(isConsistent);
+    REQUIRE(reader.received + reader.lost == total);
+}
+
+TEST_CASE("MarketDataBus writer takes over segment of crashed writer", "[MarketDataBus]") {
+    string name = "/midas_test_bus_crash_" + to_string(getpid());
+    pid_t child = fork();
+    if (child == 0) {
+        MarketDataBusWriter<Tick> writer(name, 16, 4);
+        for (uint64_t i = 0; i < 5; ++i) writer.publish(make_tick("cu1801", i), 0, "cu1801", i);
+        _exit(0);  // segment is left behind as by a crash
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    REQUIRE(WIFEXITED(status));
+
+    MarketDataBusReader<Tick> reader(name, true);
+    REQUIRE_THROWS(MarketDataBusWriter<Tick>(name, 16, 8));  // other layout
+    MarketDataBusWriter<Tick> writer(name, 16, 4);
+    REQUIRE(writer.isReclaimed);
+    REQUIRE_THROWS(MarketDataBusWriter<Tick>(name, 16, 4));  // writer is running
+
+    // sequence goes on for attached reader, slots are keyed again by ids of this process
+    writer.publish(make_tick("rb1801", 5), 3, "rb1801", 5);
+    writer.publish(make_tick("au1806", 6), -1, "au1806", 6);
+    writer.publish(make_tick("rb1801", 7), 3, "rb1801", 7);
+    vector<uint64_t> seen;
+    REQUIRE(reader.poll([&seen](const Tick& tick, uint64_t, uint64_t sequence) {
+        REQUIRE(tick.seq == sequence);
+        seen.push_back(sequence);
+    }) == 8);
+    REQUIRE(seen.back() == 7);
+
+    vector<string> keys;
+    REQUIRE(reader.snapshot([&keys](const char* key, const Tick& tick, uint64_t rcvt) {
+        keys.push_back(key);
+        REQUIRE(rcvt == 7);
+        REQUIRE(tick.seq == 7);
+    }) == 1);
+    REQUIRE(keys == vector<string>{"rb1801"});
+}
@@ -0,0 +1,58 @@
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+#include "net/shm/MpscRingQueue.h"
+
+using namespace std;
+using namespace midas;
+
+TEST_CASE("MpscRingQueue single thread", "[MpscRingQueue]") {
+    MpscRingQueue<int> q(5);
+    REQUIRE(q.get_capacity() == 8);
+    REQUIRE(q.empty());
+
+    for (int i = 0; i < 8; ++i) REQUIRE(q.try_put(i));
+    REQUIRE(!q.try_put(8));
+    REQUIRE(q.size() == 8);
+
+    int v = -1;
+    REQUIRE(q.get(v));
+    REQUIRE(v == 0);
+    REQUIRE(q.try_put(8));
+
+    vector<int> drained;
+    REQUIRE(q.drain([&drained](int& e) { drained.push_back(e); }, 3) == 3);
+    REQUIRE(drained == vector<int>{1, 2, 3});
+    REQUIRE(q.drain([&drained](int& e) { drained.push_back(e); }) == 5);
+    REQUIRE(drained.back() == 8);
+    REQUIRE(!q.get(v));
+    REQUIRE(q.empty());
+}
+
+TEST_CASE("MpscRingQueue multiple writers", "[MpscRingQueue]") {
+    const int writers = 4;
+    const int perWriter = 100000;
+    MpscRingQueue<std::pair<int, int>> q(64);
+
+    vector<std::thread> threads;
+    for (int w = 0; w < writers; ++w) {
+        threads.emplace_back([&q, w]() {
+            for (int i = 0; i < perWriter; ++i) q.put(w, i);
+        });
+    }
+
+    vector<int> next(writers, 0);
+    int total = 0;
+    bool isOrdered = true;
+    while (total < writers * perWriter) {
+        total += q.drain([&](std::pair<int, int>& e) {
+            if (e.second != next[e.first]) isOrdered = false;
+            ++next[e.first];
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    REQUIRE(isOrdered);
+    REQUIRE(next == vector<int>(writers, perWriter));
+    REQUIRE(q.empty());
+}
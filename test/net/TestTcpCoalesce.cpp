@@ -0,0 +1,177 @@
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "catch.hpp"
+#include "net/channel/Channel.h"
+#include "net/tcp/TcpAcceptor.h"
+#include "net/tcp/TcpPublisherAsync.h"
+#include "net/tcp/TcpReceiver.h"
+#include "utils/convert/TimeHelper.h"
+
+using namespace std;
+using namespace midas;
+
+namespace {
+struct CoalesceOut {};
+struct CoalesceIn {};
+typedef TcpPublisherAsync<CoalesceOut> TCoalescePublisher;
+typedef TcpAcceptor<TCoalescePublisher> TCoalesceAcceptor;
+typedef TcpReceiver<CoalesceIn, 4096, HeapAllocator> TCoalesceReceiver;
+
+const string coalesceCfg{"test_tcp_coalesce"};
+const int coalescePort = 18033;
+const uint64_t WindowNs = 200000000L;
+
+/**
+ * collects tcp stream as received, msgs have no framing so only byte order is checked
+ */
+struct StreamSink {
+    std::mutex mutex;
+    string data;
+    std::atomic<size_t> bytes{0};
+
+    size_t on_data(const ConstBuffer& b) {
+        std::lock_guard<std::mutex> lock(mutex);
+        data.append(b.data(), b.size());
+        bytes += b.size();
+        return b.size();
+    }
+
+    /**
+     * @return time when stream reached given size
+     */
+    uint64_t wait_bytes(size_t n) {
+        uint64_t start = ntime();
+        while (bytes < n && ntime() - start < 5000000000L) std::this_thread::yield();
+        return ntime();
+    }
+};
+
+// ConstBuffer of a string does not copy it, msgs are kept until they are sent
+vector<string> make_msgs(const string& prefix, size_t count, size_t size) {
+    vector<string> msgs;
+    for (size_t i = 0; i < count; ++i) {
+        string msg = prefix + to_string(i);
+        msg.resize(size, '.');
+        msgs.push_back(msg);
+    }
+    return msgs;
+}
+}
+
+TEST_CASE("TcpPublisherAsync coalesces msgs within window", "[TcpCoalesce]") {
+    Config::instance().put(coalesceCfg + ".coalesce_window", boost::posix_time::microseconds(WindowNs / 1000));
+    Config::instance().put(coalesceCfg + ".coalesce_bytes", 1000);
+    Config::instance().put(coalesceCfg + ".poll_time", boost::posix_time::microseconds(0));
+
+    CChannel outChannel("tcp_coalesce_out");
+    CChannel inChannel("tcp_coalesce_in");
+    outChannel.work();
+    inChannel.work();
+
+    TCoalescePublisher::SharedPtr publisher;
+    std::atomic<bool> isAccepted{false}, isConnected{false};
+    TCoalesceAcceptor::SharedPtr acceptor(
+        TCoalesceAcceptor::new_instance(coalescePort, outChannel, false, coalesceCfg));
+    REQUIRE(acceptor);
+    acceptor->accept_callback(
+        [&](TCoalescePublisher::SharedPtr p) {
+            publisher = p;
+            isAccepted = true;
+            return true;
+        },
+        CustomCallbackTag());
+    acceptor->start();
+
+    StreamSink sink;
+    TCoalesceReceiver::SharedPtr receiver(
+        TCoalesceReceiver::new_instance("localhost", to_string(coalescePort), inChannel, false));
+    receiver->data_callback([&sink](const ConstBuffer& b, TCoalesceReceiver::SharedPtr) { return sink.on_data(b); },
+                            CustomCallbackTag());
+    receiver->connect_callback(
+        [&isConnected](TCoalesceReceiver::SharedPtr) {
+            isConnected = true;
+            return true;
+        },
+        CustomCallbackTag());
+    receiver->start();
+
+    uint64_t start = ntime();
+    while (!(isAccepted && isConnected) && ntime() - start < 5000000000L) std::this_thread::yield();
+    REQUIRE(isAccepted);
+    REQUIRE(isConnected);
+    usleep(100000);  // let publisher finish start on its strand
+    Coalescer& coalescer = publisher->coalescer;
+
+    // below byte budget, msgs are held until window fires and go by one write
+    vector<string> small = make_msgs("window ", 10, 20);
+    string expected;
+    start = ntime();
+    for (const auto& msg : small) {
+        publisher->deliver(ConstBuffer(msg));
+        expected += msg;
+    }
+    uint64_t received = sink.wait_bytes(expected.size());
+    REQUIRE(sink.data == expected);
+    REQUIRE(received - start >= WindowNs);
+    REQUIRE(coalescer.windowFlushes == 1);
+    REQUIRE(coalescer.batches == 1);
+    REQUIRE(coalescer.writes == 1);
+    REQUIRE(coalescer.msgs == 10);
+
+    // msg crossing byte budget releases held batch before window
+    vector<string> large = make_msgs("budget ", 10, 100);
+    start = ntime();
+    for (const auto& msg : large) {
+        publisher->deliver(ConstBuffer(msg));
+        expected += msg;
+    }
+    received = sink.wait_bytes(expected.size());
+    REQUIRE(sink.data == expected);
+    REQUIRE(received - start < WindowNs);
+    REQUIRE(coalescer.budgetFlushes == 1);
+    REQUIRE(coalescer.batches == 2);
+    REQUIRE(coalescer.msgs == 20);
+
+    // without poll time send flag is released after every write, so paced producers race deliver against on_write,
+    // whoever takes flag back, every batch goes through budget or window
+    const size_t ProducerCount = 4, MsgCount = 2000, MsgSize = 16;
+    vector<vector<string>> produced;
+    for (size_t p = 0; p < ProducerCount; ++p) produced.push_back(make_msgs(to_string(p) + " ", MsgCount, MsgSize));
+    size_t total = expected.size() + ProducerCount * MsgCount * MsgSize;
+    vector<std::thread> producers;
+    for (size_t p = 0; p < ProducerCount; ++p) {
+        producers.emplace_back([&publisher, &produced, p] {
+            for (const auto& msg : produced[p]) {
+                publisher->deliver(ConstBuffer(msg));
+                uint64_t pause = ntime();
+                while (ntime() - pause < 2000) std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& t : producers) t.join();
+    sink.wait_bytes(total);
+    REQUIRE(sink.bytes == total);
+    REQUIRE(coalescer.msgs == 20 + ProducerCount * MsgCount);
+    REQUIRE(coalescer.batches == coalescer.budgetFlushes + coalescer.windowFlushes);
+
+    // every producer's msgs arrive whole and in order
+    vector<size_t> next(ProducerCount, 0);
+    {
+        std::lock_guard<std::mutex> lock(sink.mutex);
+        for (size_t pos = expected.size(); pos + MsgSize <= sink.data.size(); pos += MsgSize) {
+            size_t p = static_cast<size_t>(sink.data[pos] - '0');
+            REQUIRE(p < ProducerCount);
+            REQUIRE(sink.data.compare(pos, MsgSize, produced[p][next[p]]) == 0);
+            ++next[p];
+        }
+    }
+    REQUIRE(next == vector<size_t>(ProducerCount, MsgCount));
+
+    receiver->stop();
+    outChannel.stop();
+    inChannel.stop();
+}
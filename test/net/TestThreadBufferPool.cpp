@@ -0,0 +1,100 @@
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+#include "net/buffer/ConstBuffer.h"
+#include "net/buffer/MutableBuffer.h"
+#include "net/buffer/ThreadBufferPool.h"
+
+using namespace std;
+using namespace midas;
+
+namespace {
+struct PoolTestTag {};
+struct CrossThreadTag {};
+typedef ThreadPoolAllocator<1000, PoolTestTag, 4> TestAllocator;
+}
+
+TEST_CASE("ThreadBufferPool reuse on same thread", "[ThreadBufferPool]") {
+    const char* first = nullptr;
+    {
+        MutableBuffer buffer(100, TestAllocator());
+        REQUIRE(buffer.capacity() == 1000);  // slot size, not requested size
+        REQUIRE(buffer.size() == 0);
+        buffer.store("abc", 3);
+        buffer.time(7);
+        first = buffer.data();
+    }
+
+    // freed buffer is on top of local list
+    MutableBuffer buffer(200, TestAllocator());
+    REQUIRE(buffer.data() == first);
+    REQUIRE(buffer.size() == 0);
+    REQUIRE(buffer.time() == 0);
+    REQUIRE(buffer.capacity() == 1000);  // recycled slot reports same capacity as carved one
+    REQUIRE_THROWS_AS(MutableBuffer(1001, TestAllocator()), MidasException);
+    REQUIRE(sizeof(BufferPrefix) == 64);
+
+    // more than one chunk
+    vector<MutableBuffer> buffers;
+    for (int i = 0; i < 10; ++i) buffers.emplace_back(1000, TestAllocator());
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        for (size_t j = i + 1; j < buffers.size(); ++j) REQUIRE(buffers[i].data() != buffers[j].data());
+    }
+
+    ostringstream os;
+    ThreadBufferPool<1000, PoolTestTag, 4>::stats(os);
+    REQUIRE(os.str().find("buffer pool 1000 threads 1") == 0);
+    REQUIRE(os.str().find("outstanding 11 ") != string::npos);
+}
+
+TEST_CASE("ThreadBufferPool cross thread return", "[ThreadBufferPool]") {
+    typedef ThreadPoolAllocator<256, CrossThreadTag, 8> Alloc;
+    const int count = 1000;
+
+    vector<ConstBuffer> produced;
+    for (int i = 0; i < count; ++i) {
+        MutableBuffer b(256, Alloc());
+        b.store(&i, sizeof(i));
+        produced.push_back(ConstBuffer(b));
+    }
+
+    // consumer thread releases last reference, buffers go back to owner's return stack
+    std::thread consumer([&produced]() {
+        int sum = 0;
+        for (auto& b : produced) sum += *reinterpret_cast<const int*>(b.data());
+        produced.clear();
+        REQUIRE(sum == count * (count - 1) / 2);
+    });
+    consumer.join();
+
+    ostringstream os;
+    ThreadBufferPool<256, CrossThreadTag, 8>::stats(os);
+    REQUIRE(os.str().find("remote frees 1000 outstanding 0 ") != string::npos);
+
+    // owner reuses returned buffers without carving new chunk
+    string before = os.str();
+    size_t missPos = before.find("misses ");
+    uint64_t misses = stoull(before.substr(missPos + 7));
+    for (int i = 0; i < count; ++i) MutableBuffer b(256, Alloc());
+    os.str("");
+    ThreadBufferPool<256, CrossThreadTag, 8>::stats(os);
+    REQUIRE(stoull(os.str().substr(os.str().find("misses ") + 7)) == misses);
+
+    ostringstream all;
+    BufferPoolRegistry::instance().report(all);
+    REQUIRE(all.str().find("buffer pool 256 ") != string::npos);
+}
+
+TEST_CASE("ThreadBufferPool size classes", "[ThreadBufferPool]") {
+    MutableBuffer buffer(8, TestAllocator());
+    string payload(3000, 'x');
+    buffer.store(payload.data(), payload.size());
+    REQUIRE(buffer.size() == 3000);
+    REQUIRE(buffer.capacity() >= 3000);
+    REQUIRE(buffer.bdp->prefix().deleter == &ThreadBufferPool<8192>::free);
+
+    BufferData* big = reinterpret_cast<BufferData*>(thread_pool_allocator(100000));
+    REQUIRE(big->prefix().deleter == &heap_deleter);
+    big->prefix().deleter(big);
+}
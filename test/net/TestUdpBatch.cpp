@@ -0,0 +1,130 @@
+#ifndef MIDAS_ENABLE_RECVMMSG
+#define MIDAS_ENABLE_RECVMMSG
+#endif
+
+#include <atomic>
+#include <set>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "catch.hpp"
+#include "net/channel/Channel.h"
+#include "net/udp/UdpReceiver.h"
+#include "utils/convert/TimeHelper.h"
+
+using namespace std;
+using namespace midas;
+
+namespace {
+struct UdpBatchTag {};
+typedef UdpReceiver<UdpBatchTag, 1024, HeapAllocator> TBatchReceiver;
+
+const string batchCfg{"test_udp_batch"};
+const size_t BatchSize = 8;
+
+/**
+ * records every dispatched datagram, data address tells whether a slot buffer was reused
+ */
+struct BatchSink {
+    std::atomic<size_t> msgCount{0};
+    vector<size_t> batchSizes;
+    vector<uint64_t> times;
+    vector<string> payloads;
+    set<const char*> addresses;
+    ConstBuffer kept;
+    bool isKeeping{false};
+
+    size_t on_batch(const ConstBufferSequence& sequence, TBatchReceiver::SharedPtr) {
+        batchSizes.push_back(sequence.size());
+        for (auto& b : sequence) {
+            times.push_back(b.time());
+            payloads.push_back(string(b.data(), b.size()));
+            addresses.insert(b.data());
+        }
+        if (isKeeping) {
+            kept = *sequence.begin();
+            isKeeping = false;
+        }
+        msgCount += sequence.size();
+        return sequence.byteSize;
+    }
+};
+
+/**
+ * hold channel thread while a round of datagrams queues up, so one recvmmsg picks all of them
+ * @return time just before channel thread is released, kernel time of every datagram is before it
+ */
+uint64_t send_round(CChannel& channel, TBatchReceiver& receiver, BatchSink& sink, int round) {
+    std::atomic<bool> isHolding{false}, isHeld{true};
+    channel.iosvc.post([&] {
+        isHolding = true;
+        while (isHeld) std::this_thread::yield();
+    });
+    while (!isHolding) std::this_thread::yield();
+
+    size_t expected = sink.msgCount + BatchSize;
+    for (size_t i = 0; i < BatchSize; ++i) {
+        string msg = "round " + to_string(round) + " msg " + to_string(i);
+        receiver.deliver(ConstBuffer(msg));
+    }
+    usleep(10000);  // loopback delivery is synchronous, this only guards against a slow softirq
+    uint64_t releaseTime = ntime();
+    isHeld = false;
+
+    uint64_t start = ntime();
+    while (sink.msgCount < expected && ntime() - start < 2000000000L) std::this_thread::yield();
+    return releaseTime;
+}
+}
+
+TEST_CASE("UdpReceiver recvmmsg batch with kernel time", "[UdpBatch]") {
+    Config::instance().put(batchCfg + ".non_block_io", true);
+    Config::instance().put(batchCfg + ".polling_time", boost::posix_time::microseconds(0));
+    Config::instance().put(batchCfg + ".recvmmsg_batch", BatchSize);
+
+    CChannel channel("udp_batch_channel");
+    BatchSink sink;
+    // unicast receiver bound to its own address, deliver sends datagrams back to itself
+    TBatchReceiver::SharedPtr receiver(
+        TBatchReceiver::new_instance("127.0.0.1", "18031", "127.0.0.1:0", batchCfg, channel, false));
+    receiver->data_sequence_callback(
+        [&sink](const ConstBufferSequence& s, TBatchReceiver::SharedPtr r) { return sink.on_batch(s, r); },
+        CustomCallbackTag());
+    receiver->start();
+    REQUIRE(receiver->batchSize == BatchSize);
+
+    uint64_t sendTime = ntime();
+    uint64_t releaseTime = send_round(channel, *receiver, sink, 0);
+    REQUIRE(sink.msgCount == BatchSize);
+    REQUIRE(sink.batchSizes == vector<size_t>{BatchSize});
+    REQUIRE(receiver->batchCount == 1);
+    REQUIRE(receiver->batchMsgCount == BatchSize);
+    REQUIRE(receiver->maxBatch == BatchSize);
+    REQUIRE(receiver->fullBatchCount == 1);
+    REQUIRE(receiver->truncatedCount == 0);
+    for (size_t i = 0; i < BatchSize; ++i) {
+        REQUIRE(sink.payloads[i] == "round 0 msg " + to_string(i));
+        // recvmmsg returned after release, so only kernel time stamp can be earlier
+        REQUIRE(sink.times[i] >= sendTime);
+        REQUIRE(sink.times[i] < releaseTime);
+    }
+
+    // slot buffers and spares are recycled once dispatched, no datagram allocates
+    for (int round = 1; round < 4; ++round) send_round(channel, *receiver, sink, round);
+    REQUIRE(sink.msgCount == 4 * BatchSize);
+    REQUIRE(receiver->batchCount == 4);
+    REQUIRE(sink.addresses.size() <= 2 * BatchSize);
+    REQUIRE(receiver->batchAllocCount == 0);
+
+    // buffer kept by client is left alone, its slot takes a new buffer
+    sink.isKeeping = true;
+    send_round(channel, *receiver, sink, 4);
+    send_round(channel, *receiver, sink, 5);
+    REQUIRE(sink.msgCount == 6 * BatchSize);
+    REQUIRE(string(sink.kept.data(), sink.kept.size()) == "round 4 msg 0");
+    REQUIRE(receiver->batchAllocCount == 1);
+
+    receiver->stop();
+    channel.stop();
+}
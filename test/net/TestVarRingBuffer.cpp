@@ -0,0 +1,155 @@
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+#include "net/disruptor/DisruptorGraph.h"
+#include "net/disruptor/VarRingBuffer.h"
+
+using namespace std;
+using namespace midas;
+
+namespace {
+class BytesProducer {
+public:
+    typedef std::shared_ptr<BytesProducer> SharedPtr;
+    std::function<size_t(const char*, size_t, uint64_t, int64_t)> callback;
+
+    template <typename F>
+    void register_data_callback(F f) {
+        callback = f;
+    }
+
+    /**
+     * message of seq % 200 bytes, every byte is low byte of seq so consumer can check content
+     */
+    void publish(long seq, int64_t producerId) {
+        char buffer[256];
+        size_t size = static_cast<size_t>(seq % 200);
+        memset(buffer, static_cast<char>(seq), size);
+        callback(buffer, size, static_cast<uint64_t>(seq), producerId);
+    }
+};
+
+typedef SequentialConsumerStrategy<> TConsumer;
+typedef VarRingBuffer<SingleThreadedStrategy, YieldWaitStrategy, TConsumer> TVarRing;
+
+bool is_intact(const VarRecord& record) {
+    const long seq = static_cast<long>(record.get_rcvt());
+    if (record.get_size() != static_cast<uint32_t>(seq % 200)) return false;
+    for (uint32_t i = 0; i < record.get_size(); ++i) {
+        if (record.data()[i] != static_cast<char>(seq)) return false;
+    }
+    return true;
+}
+}
+
+TEST_CASE("VarRingBuffer packs records by alignment", "[VarRingBuffer]") {
+    Config::instance().put("test.var_ring.packed.arena_size_exponent", 10);
+    TVarRing ring(200, 16, "var_ring_packed", "test.var_ring.packed");
+    REQUIRE(ring.arenaSize == 1024);
+    REQUIRE(ring.record_bytes(0) == 32);
+    REQUIRE(ring.record_bytes(1) == 40);
+    REQUIRE(ring.record_bytes(13) == 48);
+
+    TConsumer::TPostQueue postQueue;
+    boost::shared_ptr<TConsumer> consumer = boost::make_shared<TConsumer>(postQueue, true, "var_ring_packed");
+    TVarRing::TProducerBarrier::SharedPtr producer = ring.create_producer_barrier(false, consumer);
+    TVarRing::TConsumerBarrier::SharedPtr reader = ring.create_consumer_barrier(consumer.get());
+
+    const size_t sizes[] = {1, 13, 100, 0};
+    for (size_t size : sizes) {
+        VarRecord& record = producer->claim(size);
+        memset(record.data(), 'x', size);
+        producer->publish_entry(record);
+    }
+    REQUIRE(ring.get_cursor() == 3);
+    REQUIRE(ring.starts[1] == 40);
+    REQUIRE(ring.starts[2] == 88);
+    REQUIRE(ring.starts[3] == 224);
+    REQUIRE(reader->get_entry(2).get_size() == 100);
+    REQUIRE(reader->get_entry(2).data() == ring.arena + 88 + sizeof(VarRecord));
+    REQUIRE(reader->get_entry(3).is_valid());
+
+    // record not fitting before arena end starts over at arena begin once those bytes are consumed
+    consumer->consumedTo = 3;
+    for (int i = 0; i < 4; ++i) producer->publish_entry(producer->claim(200));
+    REQUIRE(ring.starts[6] == 720);
+    REQUIRE(ring.starts[7] == 1024);
+    REQUIRE(reinterpret_cast<char*>(&reader->get_entry(7)) == ring.arena);
+    REQUIRE_THROWS(producer->claim(201));
+
+    Config::instance().put("test.var_ring.aligned.record_alignment", 64);
+    TVarRing aligned(200, 16, "var_ring_aligned", "test.var_ring.aligned");
+    REQUIRE(aligned.record_bytes(1) == 64);
+    REQUIRE(aligned.record_bytes(33) == 128);
+    Config::instance().put("test.var_ring.bad.record_alignment", 16);
+    REQUIRE_THROWS(TVarRing(200, 16, "var_ring_bad", "test.var_ring.bad"));
+}
+
+TEST_CASE("DisruptorGraph over variable length records", "[VarRingBuffer]") {
+    const string cfgPath = "test.var_ring.graph";
+    Config::instance().put(cfgPath + ".wait_strategy", "yield");
+    Config::instance().put(cfgPath + ".ring_size_exponent", 6);
+    Config::instance().put(cfgPath + ".max_msg_size", 256);
+    Config::instance().put(cfgPath + ".arena_size_exponent", 11);  // a few records only, arena wraps often
+
+    const long count = 20000;
+    std::atomic<long> checked{0}, joined{0}, broken{0};
+    vector<BytesProducer::SharedPtr> producers{std::make_shared<BytesProducer>()};
+    DisruptorGraph<BytesProducer, VarRecord> graph("var_graph", cfgPath, producers);
+    int check = graph.add_consumer("check", [&](VarRecord& r) {
+        if (!is_intact(r)) ++broken;
+        ++checked;
+    });
+    graph.add_consumer("join", [&](VarRecord& r) { ++joined; }, {check});
+    graph.start();
+
+    for (long i = 0; i < count; ++i) producers[0]->publish(i, 0);
+    while (joined.load() < count) sched_yield();
+    REQUIRE(broken.load() == 0);
+    REQUIRE(checked.load() == count);
+
+    ostringstream os;
+    graph.stats(os);
+    REQUIRE(os.str().find("consumer join msgs 20000 lag 0 after check") != string::npos);
+    graph.stop();
+}
+
+TEST_CASE("DisruptorGraph variable length records from several producers", "[VarRingBuffer]") {
+    const string cfgPath = "test.var_ring.multi";
+    Config::instance().put(cfgPath + ".wait_strategy", "yield");
+    Config::instance().put(cfgPath + ".ring_size_exponent", 5);
+    Config::instance().put(cfgPath + ".max_msg_size", 256);
+    Config::instance().put(cfgPath + ".arena_size_exponent", 12);
+
+    const long perProducer = 5000;
+    std::atomic<long> received{0}, broken{0};
+    vector<long> last(2, -1);
+    std::atomic<long> outOfOrder{0};
+    vector<BytesProducer::SharedPtr> producers{std::make_shared<BytesProducer>(), std::make_shared<BytesProducer>()};
+    DisruptorGraph<BytesProducer, VarRecord> graph("var_multi", cfgPath, producers);
+    graph.add_consumer("check", [&](VarRecord& r) {
+        if (!is_intact(r)) ++broken;
+        long seq = static_cast<long>(r.get_rcvt());
+        if (seq <= last[r.get_id()]) ++outOfOrder;
+        last[r.get_id()] = seq;
+        ++received;
+    });
+    graph.start();
+
+    vector<std::thread> threads;
+    for (int p = 0; p < 2; ++p) {
+        threads.emplace_back([&, p]() {
+            for (long i = 0; i < perProducer; ++i) producers[p]->publish(i, p);
+        });
+    }
+    for (auto& t : threads) t.join();
+    while (received.load() < 2 * perProducer) sched_yield();
+    REQUIRE(broken.load() == 0);
+    REQUIRE(outOfOrder.load() == 0);
+    graph.stop();
+}
@@ -0,0 +1,56 @@
+#include <pthread.h>
+#include <sstream>
+#include <thread>
+#include "catch.hpp"
+#include "process/ThreadPlacement.h"
+
+using namespace std;
+using namespace midas;
+
+TEST_CASE("ThreadPlacement cpu list", "[ThreadPlacement]") {
+    REQUIRE(ThreadPlacement::parse_cpu_list("") == vector<int>{});
+    REQUIRE(ThreadPlacement::parse_cpu_list("3") == vector<int>{3});
+    REQUIRE(ThreadPlacement::parse_cpu_list("6-8,2,4,2") == (vector<int>{2, 4, 6, 7, 8}));
+    REQUIRE(ThreadPlacement::parse_cpu_list("0-1,\n") == (vector<int>{0, 1}));
+
+    REQUIRE(ThreadPlacement::to_cpu_list({}) == "");
+    REQUIRE(ThreadPlacement::to_cpu_list({5}) == "5");
+    REQUIRE(ThreadPlacement::to_cpu_list({0, 1, 2, 4, 6, 7}) == "0-2,4,6-7");
+}
+
+TEST_CASE("ThreadPlacement place and report", "[ThreadPlacement]") {
+    ThreadPlacement& placement = ThreadPlacement::instance();
+    vector<int> housekeeping = placement.housekeeping_cpus();
+    REQUIRE(!housekeeping.empty());
+    const string cpu = std::to_string(housekeeping.back());
+
+    string report;
+    std::thread worker([&]() {
+        REQUIRE(placement.place("test_placement_thread", "test", 0, cpu));
+
+        char name[16] = {0};
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        REQUIRE(string(name) == "test_placement_");
+
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        REQUIRE(sched_getaffinity(0, sizeof(mask), &mask) == 0);
+        REQUIRE(CPU_COUNT(&mask) == 1);
+        REQUIRE(CPU_ISSET(housekeeping.back(), &mask));
+
+        ostringstream os;
+        placement.report(os);
+        report = os.str();
+    });
+    worker.join();
+
+    REQUIRE(report.find("online cpu ") == 0);
+    size_t line = report.find("test_placement_thread");
+    REQUIRE(line != string::npos);
+    REQUIRE(report.find("test", line + 21) != string::npos);
+
+    // exited thread is dropped from report
+    ostringstream os;
+    placement.report(os);
+    REQUIRE(os.str().find("test_placement_thread") == string::npos);
+}
@@ -0,0 +1,115 @@
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "catch.hpp"
+#include "process/MidasThreadPool.h"
+
+using namespace std;
+using namespace midas;
+
+TEST_CASE("WorkStealingDeque owner and thief", "[ThreadPool]") {
+    detail::WorkStealingDeque<int*> deque(4);
+    vector<int> values(100);
+    for (int i = 0; i < 100; ++i) {
+        values[i] = i;
+        deque.push(&values[i]);
+    }
+    REQUIRE(deque.size() == 100);
+
+    int* v = nullptr;
+    REQUIRE(deque.pop(v));
+    REQUIRE(*v == 99);  // owner is LIFO
+    REQUIRE(deque.steal(v));
+    REQUIRE(*v == 0);  // thief is FIFO
+
+    const int thieves = 3;
+    std::atomic<int> taken{0};
+    std::atomic<long> sum{0};
+    vector<std::thread> threads;
+    for (int t = 0; t < thieves; ++t) {
+        threads.emplace_back([&]() {
+            int* p;
+            while (taken.load() < 98) {
+                if (deque.steal(p)) {
+                    sum += *p;
+                    ++taken;
+                }
+            }
+        });
+    }
+    int* p;
+    while (taken.load() < 98) {
+        if (deque.pop(p)) {
+            sum += *p;
+            ++taken;
+        }
+    }
+    for (auto& t : threads) t.join();
+    REQUIRE(taken.load() == 98);
+    REQUIRE(sum.load() == 4950 - 99);
+    REQUIRE(!deque.pop(p));
+    REQUIRE(!deque.steal(p));
+}
+
+TEST_CASE("ThreadPool push and continuation", "[ThreadPool]") {
+    ThreadPool pool(4);
+    auto f = pool.push([](int id) { return 20; });
+    auto g = pool.then(std::move(f), [](int id, int v) { return v + 1; });
+    REQUIRE(g.get() == 21);
+
+    auto h = pool.push([](int id) {});
+    auto k = pool.then(std::move(h), [](int id) { return string("done"); });
+    REQUIRE(k.get() == "done");
+
+    auto bad = pool.push([](int id) -> int { throw std::runtime_error("bad"); });
+    auto next = pool.then(std::move(bad), [](int id, int v) { return v; });
+    REQUIRE_THROWS_AS(next.get(), std::runtime_error);
+}
+
+TEST_CASE("ThreadPool parallel_for and parallel_reduce", "[ThreadPool]") {
+    ThreadPool pool(4);
+    const size_t n = 100000;
+    vector<int> hits(n, 0);
+    pool.parallel_for(0, n, [&hits](int id, size_t i) { hits[i] += 1; });
+    REQUIRE(std::accumulate(hits.begin(), hits.end(), 0L) == static_cast<long>(n));
+    REQUIRE(std::count(hits.begin(), hits.end(), 1) == static_cast<long>(n));
+
+    long sum = pool.parallel_reduce(size_t(1), n + 1, 0L, [](int id, size_t i) { return static_cast<long>(i); },
+                                    [](long a, long b) { return a + b; });
+    REQUIRE(sum == static_cast<long>(n * (n + 1) / 2));
+
+    // order preserving for non commutative reduce
+    string word = pool.parallel_reduce(0, 26, string(), [](int id, size_t i) { return string(1, char('a' + i)); },
+                                       [](const string& a, const string& b) { return a + b; }, 3);
+    REQUIRE(word == "abcdefghijklmnopqrstuvwxyz");
+
+    // nested parallel_for from inside workers must not deadlock
+    std::atomic<long> nested{0};
+    pool.parallel_for(0, 16, [&](int, size_t) { pool.parallel_for(0, 1000, [&](int, size_t) { ++nested; }, 10); }, 1);
+    REQUIRE(nested.load() == 16000);
+
+    REQUIRE_THROWS_AS(pool.parallel_for(0, 100,
+                                        [](int, size_t i) {
+                                            if (i == 57) throw std::runtime_error("57");
+                                        },
+                                        10),
+                      std::runtime_error);
+}
+
+TEST_CASE("ThreadPool resize and stop", "[ThreadPool]") {
+    ThreadPool pool(2);
+    std::atomic<int> count{0};
+    vector<std::future<void>> futures;
+    for (int i = 0; i < 1000; ++i) futures.push_back(pool.push([&count](int) { ++count; }));
+    pool.resize(4);
+    REQUIRE(pool.size() == 4);
+    for (int i = 0; i < 1000; ++i) futures.push_back(pool.push([&count](int) { ++count; }));
+    for (auto& f : futures) f.get();
+    REQUIRE(count.load() == 2000);
+
+    ThreadPool empty(0);
+    long sum = empty.parallel_reduce(0, 10, 0L, [](int, size_t i) { return static_cast<long>(i); },
+                                     [](long a, long b) { return a + b; });
+    REQUIRE(sum == 45);
+}
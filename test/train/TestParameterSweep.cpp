@@ -0,0 +1,102 @@
+#include <set>
+#include "catch.hpp"
+#include "train/ParameterSweep.h"
+
+TEST_CASE("ParameterDimension", "[ParameterSweep]") {
+    ParameterDimension dimension;
+    REQUIRE(ParameterDimension::parse("slowPeriod:20:60:20", dimension));
+    REQUIRE(dimension.name == "slowPeriod");
+    REQUIRE(dimension.values() == vector<double>{20, 40, 60});
+
+    REQUIRE(ParameterDimension::parse("singleDouble:0.8:1.2:0.1", dimension));
+    REQUIRE(dimension.values().size() == 5);
+
+    REQUIRE(ParameterDimension::parse("fastPeriod:5", dimension));
+    REQUIRE(dimension.values() == vector<double>{5});
+
+    REQUIRE(!ParameterDimension::parse("fastPeriod", dimension));
+    REQUIRE(!ParameterDimension::parse("fastPeriod:10:5:1", dimension));
+}
+
+namespace {
+/**
+ * 16 bins a day over 25 days, instruments move with different period so trials see different crossings
+ */
+std::shared_ptr<CtpData> make_data() {
+    std::shared_ptr<CtpData> data = make_shared<CtpData>();
+    double period = 0.05;
+    for (string id : {"cu1801", "rb1801"}) {
+        vector<CandleData> history;
+        for (int i = 0; i < 400; ++i) {
+            double price = 3000 + 50 * std::sin(i * period) + 20 * std::sin(i * 0.31);
+            history.emplace_back(20180102 + i / 16, 90000 + (i % 16) * 100, price, price + 1, price - 1, price, 10);
+        }
+        auto instrument = make_shared<CtpInstrument>(id, TradeSessions());
+        instrument->load_historic_candle(history, CandleScale::Minute15);
+        instrument->isMasterContract = true;
+        data->instruments.insert({id, instrument});
+        period *= 1.7;
+    }
+    return data;
+}
+}
+
+TEST_CASE("ParameterSweep", "[ParameterSweep]") {
+    std::shared_ptr<CtpData> data = make_data();
+    midas::ThreadPool pool(4);
+    vector<ParameterDimension> dimensions{{"slowPeriod", 20, 100, 10}, {"fastPeriod", 5, 15, 5}};
+
+    ParameterSweep grid(StrategyType::TBiMaStrategy, SweepType::Grid, dimensions);
+    StrategyParameter parameter = grid.to_parameter({30, 10});
+    REQUIRE(parameter.get("slowPeriod", 0) == 30);
+    REQUIRE(parameter.get("fastPeriod", 0) == 10);
+    REQUIRE(parameter.get("unknown", 7) == 7);
+
+    vector<SweepTrial> trials = grid.run(data, pool);
+    REQUIRE(trials.size() == 27);
+    REQUIRE(grid.finishedTrials == 27);
+    REQUIRE(!grid.isRunning);
+
+    ParameterSweep random(StrategyType::TBiMaStrategy, SweepType::Random, dimensions);
+    random.randomTrials = 10;
+    REQUIRE(random.run(data, pool).size() == 10);
+
+    // 27 candidates, eta 3: 27 at 1/9 budget, 9 at 1/3, 3 at full budget
+    ParameterSweep halving(StrategyType::TBiMaStrategy, SweepType::SuccessiveHalving, dimensions);
+    trials = halving.run(data, pool);
+    REQUIRE(trials.size() == 3);
+    REQUIRE(trials[0].budget == 1.0);
+    REQUIRE(halving.finishedTrials == 27 + 9 + 3);
+    REQUIRE(halving.report(5).find("id,budget,score,slowPeriod,fastPeriod") != string::npos);
+}
+
+TEST_CASE("ParameterSweep scores depend on parameter and match serial run", "[ParameterSweep]") {
+    std::shared_ptr<CtpData> data = make_data();
+    midas::ThreadPool pool(4);
+    vector<ParameterDimension> dimensions{{"slowPeriod", 20, 100, 10}, {"fastPeriod", 5, 15, 5}};
+    ParameterSweep grid(StrategyType::TBiMaStrategy, SweepType::Grid, dimensions);
+    vector<SweepTrial> trials = grid.run(data, pool);
+    REQUIRE(trials.size() == 27);
+
+    std::set<double> scores;
+    for (auto& trial : trials) {
+        REQUIRE(trial.result.cnt > 0);
+        REQUIRE(trial.result.stdDev > 0);
+        scores.insert(trial.score);
+    }
+    REQUIRE(scores.size() > trials.size() / 2);
+    REQUIRE(trials.front().score > trials.back().score);
+
+    // every trial again on this thread, one simulator after another
+    for (auto& trial : trials) {
+        StrategyParameter parameter = grid.to_parameter(trial.point);
+        Simulator simulator(data, StrategyType::TBiMaStrategy, parameter.scale);
+        simulator.apply(parameter);
+        BacktestResult serial = simulator.get_performance();
+        REQUIRE(serial.cnt == trial.result.cnt);
+        REQUIRE(serial.events == trial.result.events);
+        REQUIRE(serial.dayPerformance == trial.result.dayPerformance);
+        REQUIRE(serial.stdDev == trial.result.stdDev);
+        REQUIRE(serial.sharpeRatio == trial.score);
+    }
+}
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <set>
+#include "catch.hpp"
+#include "train/Simulator.h"
+
+namespace {
+std::shared_ptr<CtpInstrument> make_instrument(const string& id, int count, int stride) {
+    vector<CandleData> history;
+    for (int i = 0; i < count; ++i) {
+        double price = 3000 + i % 7;
+        history.emplace_back(20180102 + i * stride / 10, 90000 + (i * stride % 10) * 100, price, price + 1,
+                             price - 1, price, 10);
+    }
+    auto instrument = make_shared<CtpInstrument>(id, TradeSessions());
+    instrument->load_historic_candle(history, CandleScale::Minute15);
+    instrument->isMasterContract = true;
+    return instrument;
+}
+
+/**
+ * records instrument and merge key of every signal calculation in call order
+ */
+class RecordingStrategy : public StrategyBase {
+public:
+    string id;
+    vector<pair<int64_t, string>>& visits;
+
+    RecordingStrategy(const Candles& candles_, const string& id_, vector<pair<int64_t, string>>& visits_)
+        : StrategyBase(candles_), id(id_), visits(visits_) {}
+
+    void init() override {}
+
+    void calculate(size_t index) override {
+        const midas::Timestamp& now = candles.get(index + 1).timestamp;
+        visits.push_back({static_cast<int64_t>(now.cob) * 1000000 + now.time, id});
+    }
+
+    string get_csv_header() override { return ""; }
+
+    string get_csv_line(size_t index) override { return ""; }
+};
+}
+
+TEST_CASE("Simulator merges instruments by time", "[Simulator]") {
+    std::shared_ptr<CtpData> data = make_shared<CtpData>();
+    data->instruments.insert({"cu1801", make_instrument("cu1801", 120, 2)});
+    data->instruments.insert({"rb1801", make_instrument("rb1801", 80, 3)});
+    data->instruments.insert({"zn1801", make_instrument("zn1801", 0, 1)});
+
+    std::set<std::pair<int, int>> distinct;
+    long total = 0;
+    for (auto& item : data->instruments) {
+        const Candles& candles = item.second->get_candle_reference(CandleScale::Minute15);
+        for (int i = 0; i < candles.historicDataCount; ++i) {
+            distinct.insert({candles.get(i).timestamp.cob, candles.get(i).timestamp.time});
+        }
+        total += candles.historicDataCount;
+    }
+
+    Simulator simulator(data, StrategyType::TBiMaStrategy, CandleScale::Minute15);
+    BacktestResult result = simulator.get_performance();
+    REQUIRE(result.events == total);
+    REQUIRE(result.steps == static_cast<long>(distinct.size()));
+    for (auto& item : simulator.strategies) {
+        REQUIRE(!item.second->is_valid_time());
+    }
+
+    simulator.budget = 0.5;
+    result = simulator.get_performance();
+    REQUIRE(result.events == 60 + 40);
+}
+
+TEST_CASE("Simulator visits bins in time order", "[Simulator]") {
+    std::shared_ptr<CtpData> data = make_shared<CtpData>();
+    data->instruments.insert({"cu1801", make_instrument("cu1801", 90, 2)});
+    data->instruments.insert({"rb1801", make_instrument("rb1801", 70, 3)});
+    data->instruments.insert({"zn1801", make_instrument("zn1801", 50, 5)});
+
+    // reference merge: every bin after the first, stable sorted by time, equal times keep instrument order
+    vector<pair<int64_t, string>> expected, visits;
+    for (auto& item : data->instruments) {
+        const Candles& candles = item.second->get_candle_reference(CandleScale::Minute15);
+        for (int i = 1; i < candles.historicDataCount; ++i) {
+            const midas::Timestamp& now = candles.get(i).timestamp;
+            expected.push_back({static_cast<int64_t>(now.cob) * 1000000 + now.time, item.first});
+        }
+        item.second->strategy.reset(new RecordingStrategy(candles, item.first, visits));
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const pair<int64_t, string>& l, const pair<int64_t, string>& r) { return l.first < r.first; });
+
+    Simulator simulator(data);
+    simulator.get_performance();
+    REQUIRE(visits.size() == expected.size());
+    REQUIRE(visits == expected);
+    REQUIRE(std::is_sorted(visits.begin(), visits.end()));
+}
@@ -0,0 +1,154 @@
+#include <model/CtpCompactTick.h>
+#include <net/disruptor/DisruptorGraph.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace midas;
+
+/**
+ * normalize raw depth data through DisruptorGraph, copy path against in place fill path
+ * reports tick writes per tick, normalize counts as one write and every copy of tick as another
+ * usage: claim_bench [ticks] [burst], fill path hands burst raw ticks to disruptor at once
+ */
+namespace {
+
+std::atomic<long> copies{0};
+
+struct CountedTick {
+    CtpCompactTick tick;
+
+    CountedTick() {}
+    CountedTick(const CountedTick& other) : tick(other.tick) { ++copies; }
+    CountedTick& operator=(const CountedTick& other) {
+        tick = other.tick;
+        ++copies;
+        return *this;
+    }
+};
+
+typedef PayloadObject<CountedTick> BenchPayload;
+
+class CopyProducer {
+public:
+    typedef std::shared_ptr<CopyProducer> SharedPtr;
+    std::function<size_t(const CountedTick&, uint64_t, int64_t)> callback;
+
+    template <typename F>
+    void register_data_callback(F f) {
+        callback = f;
+    }
+};
+
+class FillProducer {
+public:
+    typedef std::shared_ptr<FillProducer> SharedPtr;
+    typedef CThostFtdcDepthMarketDataField SourceType;
+    const CtpTickNormalizer* normalizer{nullptr};
+    std::function<size_t(const SourceType*, size_t, uint64_t, int64_t)> callback;
+
+    template <typename F>
+    void register_data_callback(F f) {
+        callback = f;
+    }
+
+    bool fill(const SourceType& raw, CountedTick& counted, long sequence) {
+        return normalizer->normalize(raw, counted.tick);
+    }
+};
+
+vector<CThostFtdcDepthMarketDataField> synthetic_ticks(size_t count, InstrumentIndex& index) {
+    vector<CThostFtdcDepthMarketDataField> ticks(count);
+    for (size_t i = 0; i < count; ++i) {
+        CThostFtdcDepthMarketDataField& field = ticks[i];
+        memset(&field, 0, sizeof(field));
+        snprintf(field.InstrumentID, sizeof(field.InstrumentID), "rb18%02zu", i % 12 + 1);
+        strcpy(field.ActionDay, "20171010");
+        snprintf(field.UpdateTime, sizeof(field.UpdateTime), "%02zu:%02zu:%02zu", 9 + i / 3600 % 6, i / 60 % 60, i % 60);
+        field.LastPrice = field.HighestPrice = field.LowestPrice = 3500 + i % 17;
+        field.BidPrice1 = field.LastPrice - 1;
+        field.AskPrice1 = field.LastPrice + 1;
+        field.BidVolume1 = field.AskVolume1 = 10;
+        field.Volume = static_cast<int>(i);
+        index.intern(field.InstrumentID);
+    }
+    return ticks;
+}
+
+void report(const char* name, double seconds, size_t ticks, long tickCopies, long checksum) {
+    printf("%-12s %10.3f ms %8.1f ns/tick %6.2f copies/tick %6.2f writes/tick checksum %ld\n", name, seconds * 1e3,
+           seconds * 1e9 / ticks, double(tickCopies) / ticks, 1 + double(tickCopies) / ticks, checksum);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t burst = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1;
+    if (count == 0 || burst == 0 || burst > 1024) {
+        fprintf(stderr, "usage: claim_bench [ticks] [burst <= 1024]\n");
+        return 1;
+    }
+    count -= count % burst;
+
+    const string cfgPath = "claim_bench.disruptor";
+    Config::instance().put(cfgPath + ".wait_strategy", "yield");
+    Config::instance().put(cfgPath + ".ring_size_exponent", 12);
+
+    InstrumentIndex index;
+    vector<CThostFtdcDepthMarketDataField> raws = synthetic_ticks(count, index);
+    CtpTickNormalizer normalizer;
+    normalizer.init(index);
+    for (size_t i = 0; i < index.size(); ++i) normalizer.set_price_tick(static_cast<int>(i), 1);
+    printf("ticks %zu, burst %zu, raw %zu bytes, compact %zu bytes\n", count, burst,
+           sizeof(CThostFtdcDepthMarketDataField), sizeof(CtpCompactTick));
+
+    std::atomic<size_t> received{0};
+    long checksum = 0;
+    auto consume = [&](BenchPayload& payload) {
+        checksum += payload.get_data().tick.lastPrice;  // read in place
+        received.store(received.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    };
+
+    {
+        vector<CopyProducer::SharedPtr> producers{std::make_shared<CopyProducer>()};
+        DisruptorGraph<CopyProducer, BenchPayload> graph("claim_bench_copy", cfgPath, producers);
+        graph.add_consumer("read", consume);
+        graph.start();
+        copies = 0;
+        auto start = std::chrono::steady_clock::now();
+        CountedTick local;
+        for (size_t i = 0; i < count; ++i) {
+            normalizer.normalize(raws[i], local.tick);
+            producers[0]->callback(local, 0, 1);
+        }
+        while (received.load(std::memory_order_acquire) < count) sched_yield();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        report("copy", elapsed.count(), count, copies.load(), checksum);
+        graph.stop();
+    }
+
+    received = 0;
+    checksum = 0;
+    {
+        vector<FillProducer::SharedPtr> producers{std::make_shared<FillProducer>()};
+        producers[0]->normalizer = &normalizer;
+        DisruptorGraph<FillProducer, BenchPayload> graph("claim_bench_fill", cfgPath, producers);
+        graph.add_consumer("read", consume);
+        graph.start();
+        copies = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i += burst) producers[0]->callback(&raws[i], burst, 0, 1);
+        while (received.load(std::memory_order_acquire) < count) sched_yield();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        report(burst > 1 ? "fill batch" : "fill", elapsed.count(), count, copies.load(), checksum);
+        graph.stop();
+    }
+    return 0;
+}
@@ -1,11 +1,11 @@
 #include <model/CtpData.h>
+#include <model/CtpTickSchema.h>
 #include <trade/TradeStatusManager.h>
 #include <boost/lexical_cast.hpp>
 #include <boost/program_options.hpp>
 #include <fstream>
 #include <iostream>
 #include "InstrumentStats.h"
-#include "Utils.h"
 
 using namespace std;
 using namespace midas;
@@ -54,14 +54,15 @@ int main(int argc, char** argv) {
     data.tradeStatusManager.load_trade_session(tradeSessionFile);
     map<string, InstrumentStats> stats;
     string line;
-    MidasTick tick;
+    CtpTick tick;
     MktDataPayload payload;
+    CtpTickDepth depth;
     while (getline(*is, line)) {
         if (line.empty() || *(line.end() - 1) != ';') continue;
-        tick.parse(line.c_str(), line.size());
-        CThostFtdcDepthMarketDataField field = convert(tick);
-        payload.data_ = field;
-        payload.rcvt = tick["rcvt"];
+        memset(&tick, 0, sizeof(tick));
+        CtpTickCodec::parse_text(line.c_str(), line.size(), tick);
+        const CThostFtdcDepthMarketDataField& field = tick.data;
+        payload.rcvt = tick.rcvt;
         string instrumentId{field.InstrumentID};
 
         auto itr = stats.find(instrumentId);
@@ -72,14 +73,14 @@ int main(int argc, char** argv) {
             stats[instrumentId].update(field);
         }
 
-        auto itr1 = data.instruments.find(instrumentId);
-        if (itr1 != data.instruments.end()) {
-            itr1->second->update_tick(payload);
-        } else {
+        if (data.instruments.find(instrumentId) == data.instruments.end()) {
             const TradeSessions& pts = data.tradeStatusManager.get_session(instrumentId);
-            std::shared_ptr<CtpInstrument> instrument = make_shared<CtpInstrument>(instrumentId, pts);
-            instrument->update_tick(payload);
-            data.instruments.insert({instrumentId, instrument});
+            data.instruments.insert({instrumentId, make_shared<CtpInstrument>(instrumentId, pts)});
+            data.build_instrument_index();  // instrument info is not available, default price scale is used
+        }
+        if (data.normalizer.normalize(field, payload.data_)) {
+            data.normalizer.normalize_depth(field, payload.data_, depth);
+            data.update(payload, &depth);
         }
     }
 
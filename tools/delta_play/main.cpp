@@ -1,42 +1,22 @@
+#include <ctp/ThostFtdcUserApiStruct.h>
+#include <io/BinaryJournalReplayer.h>
 #include <utils/convert/TimeHelper.h>
 #include <zlib.h>
 #include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/program_options.hpp>
 #include <iostream>
+#include "helper/CtpVisualHelper.h"
 
 using namespace std;
 using namespace boost::filesystem;
 namespace po = boost::program_options;
 
-int main(int argc, char** argv) {
-    double start, end;
-    po::options_description desc("Program options");
-    desc.add_options()("help,h", "print_trading_hour help")
-            ("directory,d", po::value<string>()->default_value("."), "directory to play")
-            ("start,s", po::value<double>(&start)->default_value(-1), "start time to play")
-            ("end,e", po::value<double>(&end)->default_value(-1), "end time to play");
-
-    po::variables_map vm;
-    auto parsed = po::parse_command_line(argc, argv, desc);
-    po::store(parsed, vm);
-    po::notify(vm);
-
-    if (vm.count("help")) {
-        cout << desc << '\n';
-        return 0;
-    }
-
+/**
+ * text journal written before binary journal, whole file is inflated and rcvt is parsed from every line
+ */
+int play_text_journal(const path& dir, double start, double end) {
     uint64_t snTime = 0, enTime = 0;
-
-    string directory = vm["directory"].as<string>();
-
-    path dir(directory);
-    if (!is_directory(dir)) {
-        cerr << "invalid directory: " << directory << '\n';
-        return -1;
-    }
-
     vector<string> files;
     vector<double> times;
     directory_iterator itrEnd;
@@ -73,7 +53,6 @@ int main(int argc, char** argv) {
     const int GZ_BUF_SIZE = READ_SIZE + 1;
     char buf[GZ_BUF_SIZE];
     for (long i = si; i < ei; ++i) {
-        //        cout << files[i] << '\n';     // keep here for trouble shooting
         bool isFirstFile = (i == si);
         bool isLastFile = (i == (ei - 1));
 
@@ -108,3 +87,54 @@ int main(int argc, char** argv) {
     }
     return 0;
 }
+
+int main(int argc, char** argv) {
+    double start, end, speed;
+    po::options_description desc("Program options");
+    desc.add_options()("help,h", "print_trading_hour help")
+            ("directory,d", po::value<string>()->default_value("."), "directory to play")
+            ("start,s", po::value<double>(&start)->default_value(-1), "start time to play, yyyymmdd.hhmmss")
+            ("end,e", po::value<double>(&end)->default_value(-1), "end time to play, yyyymmdd.hhmmss")
+            ("speed,x", po::value<double>(&speed)->default_value(0), "0 as fast as possible, 1 recorded pace, N N times faster")
+            ("quiet,q", "do not print ticks, only replay stats");
+
+    po::variables_map vm;
+    auto parsed = po::parse_command_line(argc, argv, desc);
+    po::store(parsed, vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        cout << desc << '\n';
+        return 0;
+    }
+
+    string directory = vm["directory"].as<string>();
+
+    path dir(directory);
+    if (!is_directory(dir)) {
+        cerr << "invalid directory: " << directory << '\n';
+        return -1;
+    }
+
+    midas::BinaryJournalReplayer<CThostFtdcDepthMarketDataField> replayer(speed);
+    replayer.load(directory, cerr);
+    if (replayer.segments.empty()) {
+        return play_text_journal(dir, start, end);
+    }
+
+    uint64_t snTime = (start > 0 ? midas::ntime_from_double(start) : 0);
+    uint64_t enTime = (end > 0 ? midas::ntime_from_double(end) : 0);
+    bool isQuiet = vm.count("quiet") > 0;
+
+    // same text layout as text journal so output can be piped to latmon
+    replayer.play(snTime, enTime,
+                  [isQuiet](const CThostFtdcDepthMarketDataField& data, uint64_t rcvt, int64_t id) -> size_t {
+                      if (!isQuiet) cout << "id_ " << id << " ,rcvt " << rcvt << " ," << data << '\n';
+                      return 0;
+                  },
+                  cerr);
+
+    // records outside window or in unreadable segments are reported even when ticks go to stdout
+    replayer.stats(isQuiet ? cout : cerr);
+    return 0;
+}
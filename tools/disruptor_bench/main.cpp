@@ -0,0 +1,375 @@
+#include <net/disruptor/DisruptorGraph.h>
+#include <sched.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <boost/algorithm/string.hpp>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "utils/math/LatencyHistogram.h"
+
+using namespace std;
+using namespace midas;
+namespace po = boost::program_options;
+
+/**
+ * sweep disruptor over claim, wait and consumer strategies, producer counts, ring sizes and payload sizes
+ * every case runs a throughput phase, producers publish as fast as they can, then a latency phase at fixed rate
+ * latency phase is open loop, message carries the time it was scheduled to be sent and latency is taken from that,
+ * so a stalled producer does not hide the queueing delay of messages it should have sent (coordinated omission)
+ * results go to stdout as a table and to --out as csv, --baseline compares with csv of an earlier run
+ * and exits with 1 if throughput dropped or p99 grew by more than --threshold percent
+ */
+namespace {
+
+/**
+ * head of every message, rest of payload is padding
+ */
+struct Stamp {
+    int64_t intended;  // scheduled send time, 0 in throughput phase
+    int64_t sent;
+};
+
+struct Case {
+    string claim;
+    string wait;
+    string consumer;
+    int producers;
+    int ringExponent;
+    int payloadSize;
+
+    string key() const {
+        ostringstream os;
+        os << claim << ',' << wait << ',' << consumer << ',' << producers << ',' << ringExponent << ',' << payloadSize;
+        return os.str();
+    }
+};
+
+struct Result {
+    double msgsPerSecond{0};
+    uint64_t p50{0};
+    uint64_t p90{0};
+    uint64_t p99{0};
+    uint64_t p999{0};
+    uint64_t max{0};
+    uint64_t uncorrectedP99{0};  // taken from actual send time, what a closed loop benchmark would report
+};
+
+struct Settings {
+    size_t messages;
+    size_t latencyMessages;
+    double rate;
+    double timeoutSeconds;
+};
+
+const string CsvHeader = "claim,wait,consumer,producers,ring_exp,payload,msgs_per_sec,p50,p90,p99,p999,max,raw_p99";
+
+inline int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+class BenchProducer {
+public:
+    typedef std::shared_ptr<BenchProducer> SharedPtr;
+    std::function<size_t(const char*, size_t, uint64_t, int64_t)> callback;
+
+    template <typename F>
+    void register_data_callback(F f) {
+        callback = f;
+    }
+};
+
+/**
+ * one consumer reads every message, batch consumer gets several messages appended into one payload
+ */
+class BenchConsumer {
+public:
+    const size_t payloadSize;
+    std::atomic<size_t> received{0};
+    LatencyHistogram corrected;
+    LatencyHistogram uncorrected;
+
+public:
+    explicit BenchConsumer(size_t payloadSize_) : payloadSize(payloadSize_) {}
+
+    void on_payload(midas::Payload& payload) {
+        const int64_t now = now_ns();
+        const size_t count = payload.get_size() / payloadSize;
+        for (size_t i = 0; i < count; ++i) {
+            Stamp stamp;
+            memcpy(&stamp, payload.buffer() + i * payloadSize, sizeof(stamp));
+            if (stamp.intended == 0) continue;
+            corrected.record(static_cast<uint64_t>(std::max<int64_t>(0, now - stamp.intended)));
+            uncorrected.record(static_cast<uint64_t>(std::max<int64_t>(0, now - stamp.sent)));
+        }
+        received.store(received.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+};
+
+/**
+ * run producers on their own threads and wait until consumer has seen all their messages
+ * @param interval ns between scheduled sends of one producer, 0 to send as fast as possible
+ * @return seconds from start until last message was consumed
+ */
+double run_phase(vector<BenchProducer::SharedPtr>& producers, BenchConsumer& consumer, size_t perProducer,
+                 int64_t interval, double timeoutSeconds) {
+    const size_t expected = consumer.received.load() + perProducer * producers.size();
+    std::atomic<bool> isGo{false};
+    vector<std::thread> threads;
+    for (auto& producer : producers) {
+        BenchProducer* p = producer.get();
+        threads.emplace_back([p, perProducer, interval, &isGo, &consumer]() {
+            vector<char> message(consumer.payloadSize, 0);
+            Stamp stamp{0, 0};
+            while (!isGo.load(std::memory_order_acquire)) sched_yield();
+            const int64_t start = now_ns();
+            for (size_t i = 0; i < perProducer; ++i) {
+                if (interval > 0) {
+                    stamp.intended = start + static_cast<int64_t>(i) * interval;
+                    while ((stamp.sent = now_ns()) < stamp.intended) {
+                    }
+                    memcpy(message.data(), &stamp, sizeof(stamp));
+                }
+                p->callback(message.data(), message.size(), 0, 1);
+            }
+        });
+    }
+
+    const int64_t start = now_ns();
+    isGo.store(true, std::memory_order_release);
+    const int64_t deadline = start + static_cast<int64_t>(timeoutSeconds * 1e9);
+    while (consumer.received.load(std::memory_order_acquire) < expected) {
+        if (now_ns() > deadline) {
+            // producers may be stuck in claim, their threads cannot be joined
+            cerr << "timeout after " << timeoutSeconds << " s, consumed " << consumer.received.load() << " of "
+                 << expected << '\n';
+            _exit(-1);
+        }
+        sched_yield();
+    }
+    const double seconds = (now_ns() - start) * 1e-9;
+    for (auto& t : threads) t.join();
+    return seconds;
+}
+
+template <class ClaimStrategy, class WaitStrategy, class ConsumerStrategy>
+Result run_case(const Case& c, const Settings& settings) {
+    const string cfgPath = "disruptor_bench.disruptor";
+    vector<BenchProducer::SharedPtr> producers;
+    for (int i = 0; i < c.producers; ++i) producers.push_back(std::make_shared<BenchProducer>());
+
+    BenchConsumer consumer(static_cast<size_t>(c.payloadSize));
+    DisruptorGraphImpl<BenchProducer, midas::Payload, ClaimStrategy, WaitStrategy, ConsumerStrategy> graph(
+        "disruptor_bench", c.payloadSize, c.ringExponent, producers, cfgPath);
+    graph.add_consumer("bench", [&consumer](midas::Payload& payload) { consumer.on_payload(payload); },
+                       vector<int>());
+    graph.start();
+
+    Result result;
+    const size_t perProducer = std::max<size_t>(1, settings.messages / producers.size());
+    const double seconds = run_phase(producers, consumer, perProducer, 0, settings.timeoutSeconds);
+    result.msgsPerSecond = perProducer * producers.size() / seconds;
+
+    const size_t latencyPerProducer = std::max<size_t>(1, settings.latencyMessages / producers.size());
+    const int64_t interval = static_cast<int64_t>(1e9 * producers.size() / settings.rate);
+    run_phase(producers, consumer, latencyPerProducer, std::max<int64_t>(1, interval), settings.timeoutSeconds);
+    graph.stop();
+
+    LatencyHistogram::Snapshot s = consumer.corrected.snapshot();
+    result.p50 = s.percentile(50);
+    result.p90 = s.percentile(90);
+    result.p99 = s.percentile(99);
+    result.p999 = s.percentile(99.9);
+    result.max = s.max;
+    result.uncorrectedP99 = consumer.uncorrected.snapshot().percentile(99);
+    return result;
+}
+
+template <class ClaimStrategy, class WaitStrategy>
+Result run_by_consumer(const Case& c, const Settings& settings) {
+    if (c.consumer == "sequential")
+        return run_case<ClaimStrategy, WaitStrategy, SequentialConsumerStrategy<>>(c, settings);
+    if (c.consumer == "batch") return run_case<ClaimStrategy, WaitStrategy, BatchConsumerStrategy<>>(c, settings);
+    THROW_MIDAS_EXCEPTION("unknown consumer strategy " << c.consumer);
+}
+
+template <class ClaimStrategy>
+Result run_by_wait(const Case& c, const Settings& settings) {
+    if (c.wait == "busy_spin") return run_by_consumer<ClaimStrategy, BusySpinWaitStrategy>(c, settings);
+    if (c.wait == "yield") return run_by_consumer<ClaimStrategy, YieldWaitStrategy>(c, settings);
+    if (c.wait == "block") return run_by_consumer<ClaimStrategy, BlockWaitStrategy>(c, settings);
+    if (c.wait == "adaptive") return run_by_consumer<ClaimStrategy, AdaptiveWaitStrategy>(c, settings);
+    THROW_MIDAS_EXCEPTION("unknown wait strategy " << c.wait);
+}
+
+Result run(const Case& c, const Settings& settings) {
+    if (c.claim == "single") return run_by_wait<SingleThreadedStrategy>(c, settings);
+    if (c.claim == "multi") return run_by_wait<MultiThreadedStrategy>(c, settings);
+    THROW_MIDAS_EXCEPTION("unknown claim strategy " << c.claim);
+}
+
+vector<string> split_list(const string& list) {
+    vector<string> items;
+    boost::split(items, list, boost::is_any_of(","), boost::token_compress_on);
+    items.erase(std::remove(items.begin(), items.end(), string()), items.end());
+    return items;
+}
+
+vector<int> split_int_list(const string& list) {
+    vector<int> values;
+    for (const string& item : split_list(list)) values.push_back(std::stoi(item));
+    return values;
+}
+
+string csv_line(const Case& c, const Result& r) {
+    ostringstream os;
+    os << c.key() << ',' << static_cast<uint64_t>(r.msgsPerSecond) << ',' << r.p50 << ',' << r.p90 << ',' << r.p99
+       << ',' << r.p999 << ',' << r.max << ',' << r.uncorrectedP99;
+    return os.str();
+}
+
+/**
+ * @return results of baseline csv by case key, first 6 columns are the key
+ */
+map<string, Result> load_baseline(const string& path) {
+    ifstream ifs(path);
+    if (!ifs) THROW_MIDAS_EXCEPTION("cannot open baseline " << path);
+    map<string, Result> baseline;
+    string line;
+    while (getline(ifs, line)) {
+        if (line.empty() || line == CsvHeader) continue;
+        vector<string> cols;
+        boost::split(cols, line, boost::is_any_of(","));
+        if (cols.size() != 13) THROW_MIDAS_EXCEPTION("malformed baseline line: " << line);
+        Result r;
+        r.msgsPerSecond = std::stod(cols[6]);
+        r.p50 = std::stoull(cols[7]);
+        r.p90 = std::stoull(cols[8]);
+        r.p99 = std::stoull(cols[9]);
+        r.p999 = std::stoull(cols[10]);
+        r.max = std::stoull(cols[11]);
+        r.uncorrectedP99 = std::stoull(cols[12]);
+        baseline[boost::join(vector<string>(cols.begin(), cols.begin() + 6), ",")] = r;
+    }
+    return baseline;
+}
+
+/**
+ * @return number of regressions, p99 change below minDelta ns is treated as noise
+ */
+int compare(const Case& c, const Result& r, const map<string, Result>& baseline, double threshold,
+            uint64_t minDelta) {
+    auto itr = baseline.find(c.key());
+    if (itr == baseline.end()) return 0;
+    const Result& b = itr->second;
+    int regressions = 0;
+    if (r.msgsPerSecond < b.msgsPerSecond * (1 - threshold / 100)) {
+        printf("REGRESSION %s throughput %.0f < baseline %.0f msgs/s\n", c.key().c_str(), r.msgsPerSecond,
+               b.msgsPerSecond);
+        ++regressions;
+    }
+    if (r.p99 > b.p99 * (1 + threshold / 100) && r.p99 - b.p99 > minDelta) {
+        printf("REGRESSION %s p99 %lu > baseline %lu ns\n", c.key().c_str(), r.p99, b.p99);
+        ++regressions;
+    }
+    return regressions;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    po::options_description desc("Program options");
+    desc.add_options()("help,h", "print help")
+            ("claim", po::value<string>()->default_value("single,multi"), "claim strategies, single runs 1 producer")
+            ("wait", po::value<string>()->default_value("busy_spin,yield,block,adaptive"), "wait strategies")
+            ("consumer", po::value<string>()->default_value("sequential,batch"), "consumer strategies")
+            ("producers", po::value<string>()->default_value("1,2"), "producer counts")
+            ("ring", po::value<string>()->default_value("10,14"), "ring size exponents")
+            ("payload", po::value<string>()->default_value("16,64,512"), "payload sizes in bytes, at least 16")
+            ("messages", po::value<size_t>()->default_value(500000), "messages of throughput phase")
+            ("latency-messages", po::value<size_t>()->default_value(100000), "messages of latency phase")
+            ("rate", po::value<double>()->default_value(200000), "msgs/s of all producers in latency phase")
+            ("timeout", po::value<double>()->default_value(60), "seconds one phase may take")
+            ("out,o", po::value<string>(), "write csv results to file")
+            ("baseline,b", po::value<string>(), "csv of earlier run to compare with")
+            ("threshold", po::value<double>()->default_value(20), "percent of throughput drop or p99 growth to fail")
+            ("min-delta", po::value<uint64_t>()->default_value(500), "ns of p99 growth ignored as noise")
+            ("verbose,v", "keep disruptor log, ring full warnings are expected");
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    } catch (const std::exception& e) {
+        cerr << e.what() << '\n' << desc << '\n';
+        return 1;
+    }
+
+    if (vm.count("help")) {
+        cout << desc << '\n';
+        return 0;
+    }
+    if (!vm.count("verbose")) MIDAS_LOG_SET_PRIORITY(midas::ERROR);
+
+    try {
+        Settings settings{vm["messages"].as<size_t>(), vm["latency-messages"].as<size_t>(), vm["rate"].as<double>(),
+                          vm["timeout"].as<double>()};
+        if (settings.rate <= 0) THROW_MIDAS_EXCEPTION("rate must be positive");
+
+        vector<Case> cases;
+        for (const string& claim : split_list(vm["claim"].as<string>()))
+            for (const string& wait : split_list(vm["wait"].as<string>()))
+                for (const string& consumer : split_list(vm["consumer"].as<string>()))
+                    for (int producers : split_int_list(vm["producers"].as<string>()))
+                        for (int ring : split_int_list(vm["ring"].as<string>()))
+                            for (int payload : split_int_list(vm["payload"].as<string>())) {
+                                if (producers < 1 || (claim == "single" && producers > 1)) continue;
+                                if (payload < static_cast<int>(sizeof(Stamp)))
+                                    THROW_MIDAS_EXCEPTION("payload " << payload << " is below " << sizeof(Stamp));
+                                if (ring < 1 || ring > 24) THROW_MIDAS_EXCEPTION("ring exponent " << ring);
+                                cases.push_back(Case{claim, wait, consumer, producers, ring, payload});
+                            }
+
+        map<string, Result> baseline;
+        if (vm.count("baseline")) baseline = load_baseline(vm["baseline"].as<string>());
+        ofstream out;
+        if (vm.count("out")) {
+            out.open(vm["out"].as<string>());
+            if (!out) THROW_MIDAS_EXCEPTION("cannot open " << vm["out"].as<string>());
+            out << CsvHeader << '\n';
+        }
+
+        printf("%-6s %-9s %-10s %4s %4s %5s %12s %8s %8s %8s %8s %10s %8s\n", "claim", "wait", "consumer", "prod",
+               "ring", "bytes", "msgs/s", "p50", "p90", "p99", "p99.9", "max", "raw p99");
+        int regressions = 0;
+        for (const Case& c : cases) {
+            Result r = run(c, settings);
+            printf("%-6s %-9s %-10s %4d %4d %5d %12.0f %8lu %8lu %8lu %8lu %10lu %8lu\n", c.claim.c_str(),
+                   c.wait.c_str(), c.consumer.c_str(), c.producers, c.ringExponent, c.payloadSize, r.msgsPerSecond,
+                   r.p50, r.p90, r.p99, r.p999, r.max, r.uncorrectedP99);
+            fflush(stdout);
+            if (out) out << csv_line(c, r) << endl;
+            regressions += compare(c, r, baseline, vm["threshold"].as<double>(), vm["min-delta"].as<uint64_t>());
+        }
+
+        if (regressions > 0) {
+            printf("%d regressions against baseline\n", regressions);
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        cerr << e.what() << '\n';
+        return -1;
+    }
+    return 0;
+}
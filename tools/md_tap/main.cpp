@@ -0,0 +1,67 @@
+#include <ctp/ThostFtdcUserApiStruct.h>
+#include <net/shm/MarketDataBus.h>
+#include <unistd.h>
+#include <atomic>
+#include <boost/program_options.hpp>
+#include <csignal>
+#include <ctime>
+#include <iostream>
+#include "helper/CtpVisualHelper.h"
+
+using namespace std;
+namespace po = boost::program_options;
+
+static std::atomic<bool> isRunning{true};
+
+/**
+ * attach to market data bus published by midas, print ticks in same text layout as delta_play
+ */
+int main(int argc, char** argv) {
+    po::options_description desc("Program options");
+    desc.add_options()("help,h", "print help")
+            ("name,n", po::value<string>()->default_value("/midas_md"), "shared memory name of bus")
+            ("snapshot,s", "print last value of every instrument before streaming")
+            ("oldest,o", "start from oldest record in ring instead of live")
+            ("quiet,q", "do not print ticks, only print stats every second");
+
+    po::variables_map vm;
+    auto parsed = po::parse_command_line(argc, argv, desc);
+    po::store(parsed, vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        cout << desc << '\n';
+        return 0;
+    }
+
+    std::signal(SIGINT, [](int) { isRunning = false; });
+    std::signal(SIGTERM, [](int) { isRunning = false; });
+
+    bool isQuiet = vm.count("quiet") > 0;
+    try {
+        midas::MarketDataBusReader<CThostFtdcDepthMarketDataField> reader(vm["name"].as<string>(),
+                                                                         vm.count("oldest") > 0);
+        if (vm.count("snapshot")) {
+            reader.snapshot([](const char*, const CThostFtdcDepthMarketDataField& data, uint64_t rcvt) {
+                cout << "id_ 0 ,rcvt " << rcvt << " ," << data << '\n';
+            });
+        }
+
+        time_t lastStats = time(nullptr);
+        while (isRunning) {
+            size_t n = reader.poll([isQuiet](const CThostFtdcDepthMarketDataField& data, uint64_t rcvt, uint64_t id) {
+                if (!isQuiet) cout << "id_ " << id << " ,rcvt " << rcvt << " ," << data << '\n';
+            });
+            if (n == 0) usleep(100);
+            if (isQuiet && time(nullptr) != lastStats) {
+                lastStats = time(nullptr);
+                reader.stats(cout);
+            }
+        }
+        reader.stats(cerr);
+    } catch (const std::exception& e) {
+        cerr << e.what() << '\n';
+        return -1;
+    }
+    return 0;
+}
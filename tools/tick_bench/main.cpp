@@ -0,0 +1,171 @@
+#include <model/CtpTickSchema.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "helper/CtpVisualHelper.h"
+#include "midas/MidasTick.h"
+
+using namespace std;
+using namespace midas;
+
+/**
+ * compare MidasTick text parsing with schema codec text and binary path on recorded ticks
+ * usage: tick_bench [tick file] [rounds], synthetic ticks are used without tick file
+ */
+namespace {
+
+int rounds = 20;
+
+inline void copy_chars(char* dest, size_t n, const string& src) {
+    strncpy(dest, src.c_str(), n - 1);
+    dest[n - 1] = '\0';
+}
+
+/**
+ * what ctp_stats did per line before tick codec
+ */
+CtpTick legacy_decode(const MidasTick& tick) {
+    CtpTick t;
+    memset(&t, 0, sizeof(t));
+    CThostFtdcDepthMarketDataField& field = t.data;
+    copy_chars(field.ExchangeID, sizeof(field.ExchangeID), tick["e"]);
+    copy_chars(field.InstrumentID, sizeof(field.InstrumentID), tick["id"]);
+    field.LastPrice = tick["tp"];
+    field.Volume = tick["ts"];
+    field.PreSettlementPrice = tick["lsp"];
+    field.PreClosePrice = tick["lccp"];
+    field.PreOpenInterest = tick["lois"];
+    field.OpenPrice = tick["op"];
+    field.HighestPrice = tick["hp"];
+    field.LowestPrice = tick["lp"];
+    field.Turnover = tick["to"];
+    field.OpenInterest = tick["ois"];
+    field.ClosePrice = tick["cp"];
+    field.SettlementPrice = tick["sp"];
+    field.UpperLimitPrice = tick["ulp"];
+    field.LowerLimitPrice = tick["llp"];
+    field.PreDelta = tick["pd"];
+    field.CurrDelta = tick["cd"];
+    copy_chars(field.UpdateTime, sizeof(field.UpdateTime), tick["ut"]);
+    field.UpdateMillisec = tick["um"];
+    field.BidPrice1 = tick["bbp1"];
+    field.BidVolume1 = tick["bbs1"];
+    field.AskPrice1 = tick["bap1"];
+    field.AskVolume1 = tick["bas1"];
+    field.AveragePrice = tick["avgp"];
+    copy_chars(field.TradingDay, sizeof(field.TradingDay), tick["tpd"]);
+    copy_chars(field.ActionDay, sizeof(field.ActionDay), tick["ad"]);
+    t.rcvt = tick["rcvt"];
+    return t;
+}
+
+vector<string> synthetic_ticks(size_t count) {
+    vector<string> lines;
+    CThostFtdcDepthMarketDataField field;
+    memset(&field, 0, sizeof(field));
+    strcpy(field.ExchangeID, "SHFE");
+    strcpy(field.TradingDay, "20171010");
+    strcpy(field.ActionDay, "20171010");
+    field.UpperLimitPrice = 3800;
+    field.LowerLimitPrice = 3200;
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(field.InstrumentID, sizeof(field.InstrumentID), "rb18%02zu", i % 12 + 1);
+        field.LastPrice = 3500 + static_cast<double>(i % 97);
+        field.Volume = static_cast<int>(1000 + i);
+        field.Turnover = field.LastPrice * field.Volume * 10;
+        field.OpenInterest = 2000000 + static_cast<double>(i);
+        field.BidPrice1 = field.LastPrice - 1;
+        field.AskPrice1 = field.LastPrice + 1;
+        field.BidVolume1 = static_cast<int>(i % 50);
+        field.AskVolume1 = static_cast<int>(i % 30);
+        snprintf(field.UpdateTime, sizeof(field.UpdateTime), "%02zu:%02zu:%02zu", 9 + i / 3600 % 6, i / 60 % 60, i % 60);
+        field.UpdateMillisec = (i % 2) * 500;
+        ostringstream os;
+        os << field;
+        string line = os.str();
+        line.insert(line.size() - 1, "rcvt " + to_string(1507597200000000000ULL + i * 500000000ULL) + " ,");
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+template <typename F>
+double run(F f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void report(const char* name, double seconds, size_t ticks, double checksum) {
+    uint64_t total = static_cast<uint64_t>(ticks) * rounds;
+    printf("%-16s %10.3f ms %12.0f tick/s %8.1f ns/tick checksum %.0f\n", name, seconds * 1e3, total / seconds,
+           seconds * 1e9 / total, checksum);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    vector<string> lines;
+    if (argc > 1) {
+        ifstream ifs(argv[1]);
+        if (!ifs.good()) {
+            fprintf(stderr, "cannot open %s\n", argv[1]);
+            return 1;
+        }
+        string line;
+        while (getline(ifs, line)) {
+            if (!line.empty() && *(line.end() - 1) == ';') lines.push_back(line);
+        }
+    } else {
+        lines = synthetic_ticks(100000);
+    }
+    if (argc > 2) rounds = atoi(argv[2]);
+    if (lines.empty()) {
+        fprintf(stderr, "no tick found\n");
+        return 1;
+    }
+    printf("ticks %zu, rounds %d, binary record %zu bytes\n", lines.size(), rounds, CtpTickCodec::wire_size());
+
+    double checksum = 0;
+    MidasTick midasTick;
+    double seconds = run([&]() {
+        for (const string& line : lines) {
+            midasTick.parse(line.c_str(), line.size());
+            checksum += legacy_decode(midasTick).data.LastPrice;
+        }
+    });
+    report("MidasTick", seconds, lines.size(), checksum);
+
+    checksum = 0;
+    CtpTick tick;
+    seconds = run([&]() {
+        for (const string& line : lines) {
+            memset(&tick, 0, sizeof(tick));
+            CtpTickCodec::parse_text(line.c_str(), line.size(), tick);
+            checksum += tick.data.LastPrice;
+        }
+    });
+    report("codec text", seconds, lines.size(), checksum);
+
+    // recorded ticks converted once to binary records
+    vector<char> records(lines.size() * CtpTickCodec::wire_size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        memset(&tick, 0, sizeof(tick));
+        CtpTickCodec::parse_text(lines[i].c_str(), lines[i].size(), tick);
+        CtpTickCodec::encode(tick, &records[i * CtpTickCodec::wire_size()], CtpTickCodec::wire_size());
+    }
+    checksum = 0;
+    seconds = run([&]() {
+        for (size_t i = 0; i < lines.size(); ++i) {
+            CtpTickCodec::decode(&records[i * CtpTickCodec::wire_size()], CtpTickCodec::wire_size(), tick);
+            checksum += tick.data.LastPrice;
+        }
+    });
+    report("codec binary", seconds, lines.size(), checksum);
+    return 0;
+}